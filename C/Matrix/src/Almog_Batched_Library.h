@@ -0,0 +1,699 @@
+/**
+ * @file
+ * @brief Batched kernels for many small matrices of the same size.
+ *
+ * Rotations, projections and small least-squares systems come in thousands of
+ * 3x3, 4x4 or 6x6 matrices, where the general Aml_Mat2d routines spend more
+ * time on loops, strides and allocation than on arithmetic. An Abl_Batch keeps
+ * such a set interleaved (structure of arrays): entry `(i, j)` of every matrix
+ * is stored contiguously, so the innermost loop of every kernel runs over the
+ * matrices and the compiler puts a different matrix in every SIMD lane.
+ *
+ * The kernels are generated per size by macros, so every loop over rows and
+ * columns has a compile-time trip count and is unrolled. Supported sizes are
+ * 3, 4 and 6. There is no pivoting across matrices and no branching on
+ * values: singular or indefinite matrices are reported by count, with
+ * unspecified (but finite where possible) results for those matrices.
+ *
+ * Vectorization is left to the compiler; build with optimizations (`/O2`,
+ * `-O2`) and, where available, an instruction set with wide vectors.
+ */
+
+#ifndef ALMOG_BATCHED_LIBRARY_H_
+#define ALMOG_BATCHED_LIBRARY_H_
+
+#include "Almog_Matrix_Library.h"
+
+#ifndef ABL_ASSERT
+#define ABL_ASSERT AML_ASSERT
+#endif //ABL_ASSERT
+
+/**
+ * @brief A set of `count` matrices of one size, interleaved.
+ *
+ * Entry `(i, j)` of matrix `b` is at `elements[(i * cols + j) * stride + b]`;
+ * use ABL_BATCH_AT().
+ *
+ * @var Abl_Batch::count
+ * Number of matrices.
+ * @var Abl_Batch::rows
+ * Rows of every matrix.
+ * @var Abl_Batch::cols
+ * Columns of every matrix.
+ * @var Abl_Batch::stride
+ * Distance between consecutive entries of one matrix, at least @p count.
+ * @var Abl_Batch::elements
+ * `rows * cols * stride` values.
+ */
+struct Abl_Batch {
+    size_t count;
+    size_t rows;
+    size_t cols;
+    size_t stride;
+    aml_real *elements;
+};
+
+#ifndef ABL_DEF
+    #ifdef ABL_DEF_STATIC
+        #define ABL_DEF static
+    #else
+        #define ABL_DEF extern
+    #endif
+#endif
+
+/* matrices handled together by the pivoting kernels; a whole number of
+ * vector registers for float and double */
+#define ABL_CHUNK 16
+
+#define ABL_BATCH_AT(batch, b, i, j) (batch).elements[(ABL_ASSERT((b) < (batch).count && (i) < (batch).rows && (j) < (batch).cols), ((i) * (batch).cols + (j)) * (batch).stride + (b))]
+
+ABL_DEF struct Abl_Batch            abl_batch_alloc(size_t count, size_t rows, size_t cols);
+ABL_DEF size_t                      abl_batch_cholesky(struct Abl_Batch L, struct Abl_Batch A);
+ABL_DEF void                        abl_batch_cholesky_solve(struct Abl_Batch X, struct Abl_Batch L, struct Abl_Batch B);
+ABL_DEF void                        abl_batch_det(aml_real *det, struct Abl_Batch A);
+ABL_DEF void                        abl_batch_dot(struct Abl_Batch C, struct Abl_Batch A, struct Abl_Batch B);
+ABL_DEF void                        abl_batch_free(struct Abl_Batch batch);
+ABL_DEF void                        abl_batch_get(struct Aml_Mat2d des, struct Abl_Batch src, size_t index);
+ABL_DEF size_t                      abl_batch_invert(struct Abl_Batch des, struct Abl_Batch src);
+ABL_DEF void                        abl_batch_set(struct Abl_Batch des, size_t index, struct Aml_Mat2d src);
+ABL_DEF size_t                      abl_batch_solve(struct Abl_Batch X, struct Abl_Batch A, struct Abl_Batch B);
+
+#endif // ALMOG_BATCHED_LIBRARY_H_
+
+#ifdef ALMOG_BATCHED_LIBRARY_IMPLEMENTATION
+#undef ALMOG_BATCHED_LIBRARY_IMPLEMENTATION
+
+#define ABL_ASSERT_SIZE(n) ABL_ASSERT(((n) == 3 || (n) == 4 || (n) == 6) && "supported sizes are 3, 4 and 6")
+
+/* The kernels below work on a chunk: ABL_CHUNK matrices copied to the stack,
+ * entry e = i * cols + j of lane l at chunk[e][l]. Every step is one of the
+ * lane primitives, a fixed-length loop over the lanes of distinct entries
+ * that compiles to a few vector instructions, and the row and column loops
+ * around them have compile-time bounds. */
+
+static void abl_lanes_mul(aml_real *AML_RESTRICT y, const aml_real *AML_RESTRICT a, const aml_real *AML_RESTRICT b)
+{
+    for (size_t l = 0; l < ABL_CHUNK; l++) {
+        y[l] = a[l] * b[l];
+    }
+}
+
+static void abl_lanes_fma(aml_real *AML_RESTRICT y, const aml_real *AML_RESTRICT a, const aml_real *AML_RESTRICT b)
+{
+    for (size_t l = 0; l < ABL_CHUNK; l++) {
+        y[l] += a[l] * b[l];
+    }
+}
+
+static void abl_lanes_fnma(aml_real *AML_RESTRICT y, const aml_real *AML_RESTRICT a, const aml_real *AML_RESTRICT b)
+{
+    for (size_t l = 0; l < ABL_CHUNK; l++) {
+        y[l] -= a[l] * b[l];
+    }
+}
+
+static void abl_lanes_scale(aml_real *AML_RESTRICT y, const aml_real *AML_RESTRICT s)
+{
+    for (size_t l = 0; l < ABL_CHUNK; l++) {
+        y[l] *= s[l];
+    }
+}
+
+static void abl_lanes_div(aml_real *AML_RESTRICT y, const aml_real *AML_RESTRICT s)
+{
+    for (size_t l = 0; l < ABL_CHUNK; l++) {
+        y[l] /= s[l];
+    }
+}
+
+static void abl_lanes_sqrt(aml_real *AML_RESTRICT y)
+{
+    for (size_t l = 0; l < ABL_CHUNK; l++) {
+        y[l] = aml_sqrt(y[l]);
+    }
+}
+
+/* Track per lane the row `i` whose entry `a` is largest in magnitude so far. */
+static void abl_lanes_pivot_search(aml_real *AML_RESTRICT row, aml_real *AML_RESTRICT best, const aml_real *AML_RESTRICT a, aml_real i)
+{
+    for (size_t l = 0; l < ABL_CHUNK; l++) {
+        row[l] = aml_fabs(a[l]) > best[l] ? i : row[l];
+    }
+    for (size_t l = 0; l < ABL_CHUNK; l++) {
+        best[l] = aml_fabs(a[l]) > best[l] ? aml_fabs(a[l]) : best[l];
+    }
+}
+
+/* Swap x and y in the lanes whose pivot row is `i`. */
+static void abl_lanes_swap_if(aml_real *AML_RESTRICT x, aml_real *AML_RESTRICT y, const aml_real *AML_RESTRICT row, aml_real i)
+{
+    aml_real new_x[ABL_CHUNK];
+    aml_real new_y[ABL_CHUNK];
+    for (size_t l = 0; l < ABL_CHUNK; l++) {
+        new_x[l] = row[l] == i ? y[l] : x[l];
+        new_y[l] = row[l] == i ? x[l] : y[l];
+    }
+    for (size_t l = 0; l < ABL_CHUNK; l++) {
+        x[l] = new_x[l];
+        y[l] = new_y[l];
+    }
+}
+
+/* Fold pivot `d` of step k into the determinants, singular flags and inverse
+ * pivots; a zero pivot gets inverse 0 so it does not spread NaNs. */
+static void abl_lanes_pivot_take(aml_real *AML_RESTRICT det, aml_real *AML_RESTRICT singular, aml_real *AML_RESTRICT inv, const aml_real *AML_RESTRICT d, const aml_real *AML_RESTRICT row, aml_real k)
+{
+    for (size_t l = 0; l < ABL_CHUNK; l++) {
+        det[l] *= row[l] != k ? -d[l] : d[l];
+    }
+    for (size_t l = 0; l < ABL_CHUNK; l++) {
+        singular[l] = d[l] == 0 ? 1 : singular[l];
+    }
+    for (size_t l = 0; l < ABL_CHUNK; l++) {
+        inv[l] = d[l] == 0 ? 0 : 1 / d[l];
+    }
+}
+
+/* C = A * B for N x N matrices A and N x K matrices B, entry e of each at
+ * p + e * stride so full chunks run in place on the batches. */
+#define ABL_DEFINE_DOT(N, K)                                                                        \
+static void abl_dot_chunk_##N##x##K(aml_real *c, size_t cs, const aml_real *a, size_t as, const aml_real *b, size_t bs) \
+{                                                                                                   \
+    for (size_t i = 0; i < N; i++) {                                                                \
+        for (size_t j = 0; j < K; j++) {                                                            \
+            abl_lanes_mul(c + (i * K + j) * cs, a + i * N * as, b + j * bs);                        \
+            for (size_t k = 1; k < N; k++) {                                                        \
+                abl_lanes_fma(c + (i * K + j) * cs, a + (i * N + k) * as, b + (k * K + j) * bs);    \
+            }                                                                                       \
+        }                                                                                           \
+    }                                                                                               \
+}
+
+/* Gaussian elimination with partial pivoting on N x N matrices `a`, carrying
+ * the N x r_cols right-hand sides `r` along and back-substituting into them
+ * when r_cols > 0. Each lane picks its own pivot rows by selects, not
+ * branches. A zero pivot flags the lane in `singular`; `det` gets the
+ * determinants. */
+#define ABL_DEFINE_LU(N)                                                                            \
+static void abl_lu_chunk_##N(aml_real a[][ABL_CHUNK], aml_real r[][ABL_CHUNK], size_t r_cols, aml_real det[ABL_CHUNK], aml_real singular[ABL_CHUNK]) \
+{                                                                                                   \
+    aml_real best[ABL_CHUNK];                                                                       \
+    aml_real pivot_row[ABL_CHUNK];                                                                  \
+    aml_real inv_diag[N][ABL_CHUNK];                                                                \
+    for (size_t l = 0; l < ABL_CHUNK; l++) {                                                        \
+        det[l] = 1;                                                                                 \
+        singular[l] = 0;                                                                            \
+    }                                                                                               \
+    for (size_t k = 0; k < N; k++) {                                                                \
+        for (size_t l = 0; l < ABL_CHUNK; l++) {                                                    \
+            best[l] = aml_fabs(a[k * N + k][l]);                                                    \
+            pivot_row[l] = (aml_real)k;                                                             \
+        }                                                                                           \
+        for (size_t i = k + 1; i < N; i++) {                                                        \
+            abl_lanes_pivot_search(pivot_row, best, a[i * N + k], (aml_real)i);                     \
+        }                                                                                           \
+        for (size_t i = k + 1; i < N; i++) {                                                        \
+            for (size_t j = k; j < N; j++) {                                                        \
+                abl_lanes_swap_if(a[k * N + j], a[i * N + j], pivot_row, (aml_real)i);              \
+            }                                                                                       \
+            for (size_t j = 0; j < r_cols; j++) {                                                   \
+                abl_lanes_swap_if(r[k * r_cols + j], r[i * r_cols + j], pivot_row, (aml_real)i);    \
+            }                                                                                       \
+        }                                                                                           \
+        abl_lanes_pivot_take(det, singular, inv_diag[k], a[k * N + k], pivot_row, (aml_real)k);     \
+        for (size_t i = k + 1; i < N; i++) {                                                        \
+            abl_lanes_scale(a[i * N + k], inv_diag[k]);                                             \
+            for (size_t j = k + 1; j < N; j++) {                                                    \
+                abl_lanes_fnma(a[i * N + j], a[i * N + k], a[k * N + j]);                           \
+            }                                                                                       \
+            for (size_t j = 0; j < r_cols; j++) {                                                   \
+                abl_lanes_fnma(r[i * r_cols + j], a[i * N + k], r[k * r_cols + j]);                 \
+            }                                                                                       \
+        }                                                                                           \
+    }                                                                                               \
+    for (size_t j = 0; j < r_cols; j++) {                                                           \
+        for (size_t i = N; i-- > 0;) {                                                              \
+            for (size_t k = i + 1; k < N; k++) {                                                    \
+                abl_lanes_fnma(r[i * r_cols + j], a[i * N + k], r[k * r_cols + j]);                 \
+            }                                                                                       \
+            abl_lanes_scale(r[i * r_cols + j], inv_diag[i]);                                        \
+        }                                                                                           \
+    }                                                                                               \
+}
+
+/* L * L^T = A in place for N x N symmetric A, reading only its lower
+ * triangle. A failed pivot turns every later entry into NaN or an infinity,
+ * so the last diagonal entry alone tells whether a matrix was positive
+ * definite. */
+#define ABL_DEFINE_CHOLESKY(N)                                                                      \
+static void abl_cholesky_chunk_##N(aml_real a[][ABL_CHUNK])                                         \
+{                                                                                                   \
+    for (size_t j = 0; j < N; j++) {                                                                \
+        for (size_t k = 0; k < j; k++) {                                                            \
+            abl_lanes_fnma(a[j * N + j], a[j * N + k], a[j * N + k]);                               \
+        }                                                                                           \
+        abl_lanes_sqrt(a[j * N + j]);                                                               \
+        for (size_t i = j + 1; i < N; i++) {                                                        \
+            for (size_t k = 0; k < j; k++) {                                                        \
+                abl_lanes_fnma(a[i * N + j], a[i * N + k], a[j * N + k]);                           \
+            }                                                                                       \
+            abl_lanes_div(a[i * N + j], a[j * N + j]);                                              \
+        }                                                                                           \
+    }                                                                                               \
+    for (size_t i = 0; i < N; i++) {                                                                \
+        for (size_t j = i + 1; j < N; j++) {                                                        \
+            for (size_t l = 0; l < ABL_CHUNK; l++) {                                                \
+                a[i * N + j][l] = 0;                                                                \
+            }                                                                                       \
+        }                                                                                           \
+    }                                                                                               \
+}
+
+/* x = (L * L^T)^-1 * x in place for N x x_cols right-hand sides. */
+#define ABL_DEFINE_CHOLESKY_SOLVE(N)                                                                \
+static void abl_cholesky_solve_chunk_##N(aml_real L[][ABL_CHUNK], aml_real x[][ABL_CHUNK], size_t x_cols) \
+{                                                                                                   \
+    for (size_t c = 0; c < x_cols; c++) {                                                           \
+        for (size_t i = 0; i < N; i++) {                                                            \
+            for (size_t k = 0; k < i; k++) {                                                        \
+                abl_lanes_fnma(x[i * x_cols + c], L[i * N + k], x[k * x_cols + c]);                 \
+            }                                                                                       \
+            abl_lanes_div(x[i * x_cols + c], L[i * N + i]);                                         \
+        }                                                                                           \
+        for (size_t i = N; i-- > 0;) {                                                              \
+            for (size_t k = i + 1; k < N; k++) {                                                    \
+                abl_lanes_fnma(x[i * x_cols + c], L[k * N + i], x[k * x_cols + c]);                 \
+            }                                                                                       \
+            abl_lanes_div(x[i * x_cols + c], L[i * N + i]);                                         \
+        }                                                                                           \
+    }                                                                                               \
+}
+
+#define ABL_DEFINE_KERNELS(N)   \
+    ABL_DEFINE_DOT(N, N)        \
+    ABL_DEFINE_DOT(N, 1)        \
+    ABL_DEFINE_LU(N)            \
+    ABL_DEFINE_CHOLESKY(N)      \
+    ABL_DEFINE_CHOLESKY_SOLVE(N)
+
+ABL_DEFINE_KERNELS(3)
+ABL_DEFINE_KERNELS(4)
+ABL_DEFINE_KERNELS(6)
+
+/* Copy matrices [b0, b0 + lanes) of `batch` into a chunk. Unused lanes get
+ * the identity (or zero) so they never produce NaNs. */
+static void abl_chunk_load(aml_real chunk[][ABL_CHUNK], struct Abl_Batch batch, size_t b0, size_t lanes, bool identity)
+{
+    for (size_t i = 0; i < batch.rows; i++) {
+        for (size_t j = 0; j < batch.cols; j++) {
+            const size_t e = i * batch.cols + j;
+            const aml_real *src = batch.elements + e * batch.stride + b0;
+            for (size_t l = 0; l < lanes; l++) {
+                chunk[e][l] = src[l];
+            }
+            for (size_t l = lanes; l < ABL_CHUNK; l++) {
+                chunk[e][l] = identity && i == j ? 1 : 0;
+            }
+        }
+    }
+}
+
+static void abl_chunk_store(struct Abl_Batch batch, size_t b0, size_t lanes, aml_real chunk[][ABL_CHUNK])
+{
+    for (size_t e = 0; e < batch.rows * batch.cols; e++) {
+        aml_real *des = batch.elements + e * batch.stride + b0;
+        for (size_t l = 0; l < lanes; l++) {
+            des[l] = chunk[e][l];
+        }
+    }
+}
+
+/* Run the pivoting kernel over A chunk by chunk. `R` receives the solutions
+ * of A * R = B, or of A * R = I when B.elements is NULL, and is skipped when
+ * R.elements is NULL; `det` (may be NULL) gets the determinants. Returns the
+ * number of singular matrices. */
+static size_t abl_lu_solve(struct Abl_Batch A, struct Abl_Batch B, struct Abl_Batch R, aml_real *det)
+{
+    const size_t n = A.rows;
+    const size_t r_cols = R.elements ? R.cols : 0;
+    aml_real a[6 * 6][ABL_CHUNK];
+    aml_real r[6 * 6][ABL_CHUNK];
+    aml_real chunk_det[ABL_CHUNK];
+    aml_real singular[ABL_CHUNK];
+    size_t singular_count = 0;
+
+    for (size_t b0 = 0; b0 < A.count; b0 += ABL_CHUNK) {
+        const size_t lanes = aml_min((size_t)ABL_CHUNK, A.count - b0);
+        abl_chunk_load(a, A, b0, lanes, true);
+        if (r_cols > 0 && B.elements) {
+            abl_chunk_load(r, B, b0, lanes, false);
+        } else if (r_cols > 0) {
+            for (size_t e = 0; e < n * n; e++) {
+                for (size_t l = 0; l < ABL_CHUNK; l++) {
+                    r[e][l] = e % (n + 1) == 0 ? 1 : 0;
+                }
+            }
+        }
+
+        switch (n) {
+            case 3:
+                abl_lu_chunk_3(a, r, r_cols, chunk_det, singular);
+                break;
+            case 4:
+                abl_lu_chunk_4(a, r, r_cols, chunk_det, singular);
+                break;
+            case 6:
+                abl_lu_chunk_6(a, r, r_cols, chunk_det, singular);
+                break;
+            default:
+                ABL_ASSERT_SIZE(n);
+        }
+
+        if (r_cols > 0) {
+            abl_chunk_store(R, b0, lanes, r);
+        }
+        for (size_t l = 0; l < lanes; l++) {
+            singular_count += singular[l] != 0;
+            if (det) {
+                det[b0 + l] = chunk_det[l];
+            }
+        }
+    }
+
+    return singular_count;
+}
+
+/**
+ * @brief Allocate a batch of @p count matrices of @p rows x @p cols.
+ *
+ * The stride is rounded up to a multiple of ABL_CHUNK. The values are not
+ * initialized.
+ *
+ * @param count Number of matrices.
+ * @param rows Rows of every matrix.
+ * @param cols Columns of every matrix.
+ * @return The batch; release it with abl_batch_free().
+ */
+ABL_DEF struct Abl_Batch abl_batch_alloc(size_t count, size_t rows, size_t cols)
+{
+    struct Abl_Batch batch;
+    batch.count = count;
+    batch.rows = rows;
+    batch.cols = cols;
+    batch.stride = (count + ABL_CHUNK - 1) / ABL_CHUNK * ABL_CHUNK;
+    batch.elements = (aml_real *)AML_MALLOC(sizeof(aml_real) * (rows * cols * batch.stride + 1));
+    ABL_ASSERT(batch.elements != NULL);
+
+    return batch;
+}
+
+/**
+ * @brief Cholesky factor every matrix of a batch, `A = L * L^T`.
+ *
+ * @param L Output lower triangular factors, same shape as @p A. May be @p A.
+ * @param A Symmetric positive definite n x n matrices, n in {3, 4, 6}. Only
+ * the lower triangle is read.
+ * @return Number of matrices that are not positive definite; their factors
+ * hold NaNs or infinities.
+ */
+ABL_DEF size_t abl_batch_cholesky(struct Abl_Batch L, struct Abl_Batch A)
+{
+    ABL_ASSERT(A.rows == A.cols);
+    ABL_ASSERT_SIZE(A.rows);
+    ABL_ASSERT(L.rows == A.rows && L.cols == A.cols && L.count == A.count);
+
+    const size_t n = A.rows;
+    aml_real a[6 * 6][ABL_CHUNK];
+    size_t failed = 0;
+
+    for (size_t b0 = 0; b0 < A.count; b0 += ABL_CHUNK) {
+        const size_t lanes = aml_min((size_t)ABL_CHUNK, A.count - b0);
+        abl_chunk_load(a, A, b0, lanes, true);
+        switch (n) {
+            case 3:
+                abl_cholesky_chunk_3(a);
+                break;
+            case 4:
+                abl_cholesky_chunk_4(a);
+                break;
+            case 6:
+                abl_cholesky_chunk_6(a);
+                break;
+        }
+        abl_chunk_store(L, b0, lanes, a);
+        for (size_t l = 0; l < lanes; l++) {
+            failed += !(a[n * n - 1][l] > 0);
+        }
+    }
+
+    return failed;
+}
+
+/**
+ * @brief Solve `L * L^T * X = B` for every matrix of a batch.
+ *
+ * Together with abl_batch_cholesky() this solves symmetric positive definite
+ * systems, e.g. the normal equations of small least-squares fits.
+ *
+ * @param X Output solutions, same shape as @p B. May be @p B.
+ * @param L Factors from abl_batch_cholesky().
+ * @param B Right-hand sides, n x k with k <= n.
+ */
+ABL_DEF void abl_batch_cholesky_solve(struct Abl_Batch X, struct Abl_Batch L, struct Abl_Batch B)
+{
+    ABL_ASSERT(L.rows == L.cols);
+    ABL_ASSERT_SIZE(L.rows);
+    ABL_ASSERT(B.rows == L.rows && B.cols >= 1 && B.cols <= B.rows && B.count == L.count);
+    ABL_ASSERT(X.rows == B.rows && X.cols == B.cols && X.count == B.count);
+
+    aml_real l_chunk[6 * 6][ABL_CHUNK];
+    aml_real x[6 * 6][ABL_CHUNK];
+
+    for (size_t b0 = 0; b0 < L.count; b0 += ABL_CHUNK) {
+        const size_t lanes = aml_min((size_t)ABL_CHUNK, L.count - b0);
+        abl_chunk_load(l_chunk, L, b0, lanes, true);
+        abl_chunk_load(x, B, b0, lanes, false);
+        switch (L.rows) {
+            case 3:
+                abl_cholesky_solve_chunk_3(l_chunk, x, B.cols);
+                break;
+            case 4:
+                abl_cholesky_solve_chunk_4(l_chunk, x, B.cols);
+                break;
+            case 6:
+                abl_cholesky_solve_chunk_6(l_chunk, x, B.cols);
+                break;
+        }
+        abl_chunk_store(X, b0, lanes, x);
+    }
+}
+
+/**
+ * @brief Determinant of every matrix of a batch.
+ *
+ * 3x3 matrices use the cofactor expansion; larger ones LU with partial
+ * pivoting.
+ *
+ * @param det Output array of @p A.count determinants.
+ * @param A Square n x n matrices, n in {3, 4, 6}.
+ */
+ABL_DEF void abl_batch_det(aml_real *det, struct Abl_Batch A)
+{
+    ABL_ASSERT(A.rows == A.cols);
+    ABL_ASSERT_SIZE(A.rows);
+
+    if (A.rows == 3) {
+        const size_t s = A.stride;
+        const aml_real *a = A.elements;
+        for (size_t b = 0; b < A.count; b++) {
+            det[b] = a[0 * s + b] * (a[4 * s + b] * a[8 * s + b] - a[5 * s + b] * a[7 * s + b])
+                   - a[1 * s + b] * (a[3 * s + b] * a[8 * s + b] - a[5 * s + b] * a[6 * s + b])
+                   + a[2 * s + b] * (a[3 * s + b] * a[7 * s + b] - a[4 * s + b] * a[6 * s + b]);
+        }
+        return;
+    }
+
+    struct Abl_Batch none = {0};
+    abl_lu_solve(A, none, none, det);
+}
+
+/**
+ * @brief Multiply every pair of matrices of two batches, `C = A * B`.
+ *
+ * @param C Output products. Must not overlap @p A or @p B.
+ * @param A Square n x n matrices, n in {3, 4, 6}.
+ * @param B n x n matrices or n x 1 vectors (e.g. points to transform).
+ */
+ABL_DEF void abl_batch_dot(struct Abl_Batch C, struct Abl_Batch A, struct Abl_Batch B)
+{
+    ABL_ASSERT(A.rows == A.cols && B.rows == A.cols);
+    ABL_ASSERT_SIZE(A.rows);
+    ABL_ASSERT(B.cols == B.rows || B.cols == 1);
+    ABL_ASSERT(C.rows == A.rows && C.cols == B.cols);
+    ABL_ASSERT(A.count == B.count && C.count == A.count);
+    ABL_ASSERT(C.elements != A.elements && C.elements != B.elements);
+
+    aml_real a[6 * 6][ABL_CHUNK];
+    aml_real b[6 * 6][ABL_CHUNK];
+    aml_real c[6 * 6][ABL_CHUNK];
+
+    for (size_t b0 = 0; b0 < A.count; b0 += ABL_CHUNK) {
+        const size_t lanes = aml_min((size_t)ABL_CHUNK, A.count - b0);
+
+        /* full chunks in place, the last partial one through the stack */
+        aml_real *cp = C.elements + b0;
+        const aml_real *ap = A.elements + b0;
+        const aml_real *bp = B.elements + b0;
+        size_t cs = C.stride, as = A.stride, bs = B.stride;
+        if (lanes < ABL_CHUNK) {
+            abl_chunk_load(a, A, b0, lanes, false);
+            abl_chunk_load(b, B, b0, lanes, false);
+            cp = c[0];
+            ap = a[0];
+            bp = b[0];
+            cs = as = bs = ABL_CHUNK;
+        }
+
+        switch (A.rows * 8 + (B.cols == 1)) {
+            case 3 * 8:
+                abl_dot_chunk_3x3(cp, cs, ap, as, bp, bs);
+                break;
+            case 3 * 8 + 1:
+                abl_dot_chunk_3x1(cp, cs, ap, as, bp, bs);
+                break;
+            case 4 * 8:
+                abl_dot_chunk_4x4(cp, cs, ap, as, bp, bs);
+                break;
+            case 4 * 8 + 1:
+                abl_dot_chunk_4x1(cp, cs, ap, as, bp, bs);
+                break;
+            case 6 * 8:
+                abl_dot_chunk_6x6(cp, cs, ap, as, bp, bs);
+                break;
+            case 6 * 8 + 1:
+                abl_dot_chunk_6x1(cp, cs, ap, as, bp, bs);
+                break;
+        }
+
+        if (lanes < ABL_CHUNK) {
+            abl_chunk_store(C, b0, lanes, c);
+        }
+    }
+}
+
+/**
+ * @brief Free a batch allocated with abl_batch_alloc().
+ *
+ * @param batch The batch.
+ */
+ABL_DEF void abl_batch_free(struct Abl_Batch batch)
+{
+    AML_FREE(batch.elements);
+}
+
+/**
+ * @brief Copy one matrix out of a batch.
+ *
+ * @param des Output matrix with the batch's shape.
+ * @param src The batch.
+ * @param index Which matrix.
+ */
+ABL_DEF void abl_batch_get(struct Aml_Mat2d des, struct Abl_Batch src, size_t index)
+{
+    ABL_ASSERT(des.rows == src.rows && des.cols == src.cols);
+    ABL_ASSERT(index < src.count);
+
+    for (size_t i = 0; i < src.rows; i++) {
+        for (size_t j = 0; j < src.cols; j++) {
+            AML_MAT2D_AT(des, i, j) = ABL_BATCH_AT(src, index, i, j);
+        }
+    }
+}
+
+/**
+ * @brief Invert every matrix of a batch.
+ *
+ * 3x3 matrices use the adjugate; larger ones LU with partial pivoting.
+ *
+ * @param des Output inverses. May be @p src.
+ * @param src Square n x n matrices, n in {3, 4, 6}.
+ * @return Number of singular matrices (a zero determinant or pivot); their
+ * inverses are unspecified.
+ */
+ABL_DEF size_t abl_batch_invert(struct Abl_Batch des, struct Abl_Batch src)
+{
+    ABL_ASSERT(src.rows == src.cols);
+    ABL_ASSERT(des.rows == src.rows && des.cols == src.cols && des.count == src.count);
+    ABL_ASSERT_SIZE(src.rows);
+
+    if (src.rows == 3) {
+        const size_t s = src.stride, ds = des.stride;
+        const aml_real *a = src.elements;
+        aml_real *d = des.elements;
+        size_t singular = 0;
+        for (size_t b = 0; b < src.count; b++) {
+            const aml_real a0 = a[0 * s + b], a1 = a[1 * s + b], a2 = a[2 * s + b];
+            const aml_real a3 = a[3 * s + b], a4 = a[4 * s + b], a5 = a[5 * s + b];
+            const aml_real a6 = a[6 * s + b], a7 = a[7 * s + b], a8 = a[8 * s + b];
+            const aml_real c0 = a4 * a8 - a5 * a7;
+            const aml_real c1 = a5 * a6 - a3 * a8;
+            const aml_real c2 = a3 * a7 - a4 * a6;
+            const aml_real det = a0 * c0 + a1 * c1 + a2 * c2;
+            singular += det == 0;
+            const aml_real inv = det == 0 ? 0 : 1 / det;
+            d[0 * ds + b] = c0 * inv;
+            d[1 * ds + b] = (a2 * a7 - a1 * a8) * inv;
+            d[2 * ds + b] = (a1 * a5 - a2 * a4) * inv;
+            d[3 * ds + b] = c1 * inv;
+            d[4 * ds + b] = (a0 * a8 - a2 * a6) * inv;
+            d[5 * ds + b] = (a2 * a3 - a0 * a5) * inv;
+            d[6 * ds + b] = c2 * inv;
+            d[7 * ds + b] = (a1 * a6 - a0 * a7) * inv;
+            d[8 * ds + b] = (a0 * a4 - a1 * a3) * inv;
+        }
+        return singular;
+    }
+
+    struct Abl_Batch identity = {0};
+    return abl_lu_solve(src, identity, des, NULL);
+}
+
+/**
+ * @brief Copy a matrix into a batch.
+ *
+ * @param des The batch.
+ * @param index Which matrix.
+ * @param src Matrix with the batch's shape.
+ */
+ABL_DEF void abl_batch_set(struct Abl_Batch des, size_t index, struct Aml_Mat2d src)
+{
+    ABL_ASSERT(des.rows == src.rows && des.cols == src.cols);
+    ABL_ASSERT(index < des.count);
+
+    for (size_t i = 0; i < des.rows; i++) {
+        for (size_t j = 0; j < des.cols; j++) {
+            ABL_BATCH_AT(des, index, i, j) = AML_MAT2D_AT(src, i, j);
+        }
+    }
+}
+
+/**
+ * @brief Solve `A * X = B` for every matrix of a batch, by LU with partial
+ * pivoting.
+ *
+ * @param X Output solutions, same shape as @p B. May be @p B.
+ * @param A Square n x n matrices, n in {3, 4, 6}.
+ * @param B Right-hand sides, n x k with k <= n.
+ * @return Number of singular matrices; their solutions are unspecified.
+ */
+ABL_DEF size_t abl_batch_solve(struct Abl_Batch X, struct Abl_Batch A, struct Abl_Batch B)
+{
+    ABL_ASSERT(A.rows == A.cols);
+    ABL_ASSERT_SIZE(A.rows);
+    ABL_ASSERT(B.rows == A.rows && B.cols >= 1 && B.cols <= B.rows && B.count == A.count);
+    ABL_ASSERT(X.rows == B.rows && X.cols == B.cols && X.count == B.count);
+
+    return abl_lu_solve(A, B, X, NULL);
+}
+
+#endif // ALMOG_BATCHED_LIBRARY_IMPLEMENTATION
@@ -43,6 +43,129 @@ enum Ala_Upper_Triangulate_Flag{
     ALA_UPPER_TRIANGULATE_ROW_SWAPPING = 1 << 1,
 };
 
+/**
+ * @brief Which eigenvalues the Krylov solvers (ala_eig_lanczos(),
+ * ala_eig_arnoldi()) compute.
+ */
+enum Ala_Eig_Which {
+    /**
+     * Largest `|lambda|`.
+     */
+    ALA_EIG_LARGEST_MAGNITUDE,
+    /**
+     * Largest real part (largest algebraic for symmetric matrices).
+     */
+    ALA_EIG_LARGEST_REAL,
+    /**
+     * Smallest real part (smallest algebraic for symmetric matrices).
+     */
+    ALA_EIG_SMALLEST_REAL,
+};
+
+/**
+ * @brief Matrix-vector product `y = A * x` for the Krylov solvers.
+ *
+ * @p x and @p y are n x 1 and do not alias. @p context is whatever the caller
+ * passed to the solver, e.g. the matrix; see ala_matvec_dense().
+ */
+typedef void (*Ala_Matvec)(struct Aml_Mat2d y, struct Aml_Mat2d x, void *context);
+
+/**
+ * @brief Caller-provided scratch memory for the `_ws` routines.
+ *
+ * A bump allocator: a routine takes its temporaries from @p memory and hands
+ * them back before it returns, so a workspace of ala_workspace_size() bytes
+ * serves any number of calls of that routine, on that size or smaller,
+ * without touching the heap. Create one with ala_workspace_alloc() or wrap
+ * an existing buffer with ala_workspace_from_buffer(). Threads running at the
+ * same time need a workspace each.
+ *
+ * The GEMM engine still allocates its packing buffers for products above its
+ * small-product threshold (about `48^3` multiply-adds); problems below that
+ * run entirely out of the workspace.
+ *
+ * @var Ala_Workspace::memory
+ * Start of the scratch memory.
+ * @var Ala_Workspace::size
+ * Size of @p memory in bytes.
+ * @var Ala_Workspace::used
+ * Bytes currently taken.
+ * @var Ala_Workspace::peak
+ * Largest @p used so far, to size a workspace by measurement.
+ */
+struct Ala_Workspace {
+    unsigned char *memory;
+    size_t size;
+    size_t used;
+    size_t peak;
+};
+
+/**
+ * @brief Routines whose workspace ala_workspace_size() reports, and what its
+ * `rows` and `cols` arguments mean for each.
+ */
+enum Ala_Workspace_Routine {
+    /**
+     * ala_det_ws(), on the n x n matrix.
+     */
+    ALA_WORKSPACE_DET,
+    /**
+     * ala_invert_ws(), on the n x n matrix.
+     */
+    ALA_WORKSPACE_INVERT,
+    /**
+     * ala_solve_linear_sys_LUP_decomposition_ws(), on the n x n system
+     * matrix.
+     */
+    ALA_WORKSPACE_SOLVE_LINEAR_SYS,
+    /**
+     * ala_QR_factor_ws(), on the factored matrix.
+     */
+    ALA_WORKSPACE_QR_FACTOR,
+    /**
+     * ala_QR_apply_Q_ws(), on the matrix `B` the factor is applied to.
+     */
+    ALA_WORKSPACE_QR_APPLY_Q,
+    /**
+     * ala_hessenberg_decomposition_householder_blocked_ws(), on the n x n
+     * matrix.
+     */
+    ALA_WORKSPACE_HESSENBERG,
+    /**
+     * ala_symmetric_tridiagonalize_householder_blocked_ws(), on the n x n
+     * matrix.
+     */
+    ALA_WORKSPACE_SYMMETRIC_TRIDIAGONALIZE,
+    /**
+     * ala_symmetric_eig_QR_tridiagonalize_implicit_shift_ws(), on the n x n
+     * matrix.
+     */
+    ALA_WORKSPACE_SYMMETRIC_EIG,
+    /**
+     * ala_SVD_golub_kahan_ws(), on the input matrix, thin or full.
+     */
+    ALA_WORKSPACE_SVD,
+};
+
+/**
+ * @brief Outcome of ala_solve_linear_sys_mixed_precision().
+ *
+ * @var Ala_Refinement_Info::iterations
+ * Refinement steps taken; all right-hand sides are refined together.
+ * @var Ala_Refinement_Info::backward_error
+ * Largest `||b - A x||_inf / (||A||_inf ||x||_inf + ||b||_inf)` over the
+ * right-hand sides, computed in double.
+ * @var Ala_Refinement_Info::converged
+ * Whether refinement on the float factorization reached full accuracy. If
+ * false, the solution came from ala_solve_linear_sys_LUP_decomposition()
+ * instead.
+ */
+struct Ala_Refinement_Info {
+    size_t iterations;
+    double backward_error;
+    bool converged;
+};
+
 #ifndef ALA_DEF
     #ifdef ALA_DEF_STATIC
         #define ALA_DEF static
@@ -57,6 +180,13 @@ enum Ala_Upper_Triangulate_Flag{
 #define ALA_SYMMETRIC_TRIDIAGONAL_EIG_QR_MAX_ITERATIONS_MULTIPLAYER 150
 #define ALA_SYMMETRIC_TRIDIAGONAL_EIG_QR_IMPLICIT_MAX_ITERATIONS_MULTIPLAYER 150
 #define ALA_HESSENBERG_SCHUR_DECOMPOSITION_MAX_ITERATIONS_MULTIPLAYER 150
+#define ALA_LUP_BLOCK_SIZE 64
+#define ALA_HOUSEHOLDER_BLOCK_SIZE 32
+#define ALA_SVD_BIDIAGONAL_QR_MAX_ITERATIONS_MULTIPLAYER 150
+#define ALA_KRYLOV_MAX_RESTARTS 300
+#define ALA_WORKSPACE_ALIGNMENT 64
+#define ALA_MIXED_PRECISION_MAX_ITERATIONS 30
+#define ALA_PARALLEL_MIN_WORK (1 << 21)
 
 ALA_DEF void                                ala_apply_givens_2x2_left(struct Aml_Mat2d A, size_t i, size_t js, size_t je, aml_real c, aml_real s);
 ALA_DEF void                                ala_apply_givens_2x2_right(struct Aml_Mat2d A, size_t j, size_t is, size_t ie, aml_real c, aml_real s);
@@ -70,8 +200,11 @@ ALA_DEF void                                ala_convolve(struct Aml_Mat2d m, str
 
 ALA_DEF aml_real                            ala_det(struct Aml_Mat2d m);
 ALA_DEF aml_real                            ala_det_2x2_mat(struct Aml_Mat2d m);
+ALA_DEF aml_real                            ala_det_ws(struct Aml_Mat2d m, struct Ala_Workspace *ws);
 
+ALA_DEF size_t                              ala_eig_arnoldi(Ala_Matvec matvec, void *context, struct Aml_Mat2d eigenvalues, struct Aml_Mat2d eigenvectors, enum Ala_Eig_Which which, size_t basis_size, aml_real tolerance);
 ALA_DEF bool                                ala_eig_check(struct Aml_Mat2d A, struct Aml_Mat2d eigenvalues, struct Aml_Mat2d eigenvectors, struct Aml_Mat2d res);
+ALA_DEF size_t                              ala_eig_lanczos(Ala_Matvec matvec, void *context, struct Aml_Mat2d eigenvalues, struct Aml_Mat2d eigenvectors, enum Ala_Eig_Which which, size_t basis_size, aml_real tolerance);
 ALA_DEF void                                ala_eig_power_iteration(struct Aml_Mat2d A, struct Aml_Mat2d eigenvalues, struct Aml_Mat2d eigenvectors, struct Aml_Mat2d init_vector, bool norm_inf_vectors);
 ALA_DEF void                                ala_eigenpairs_sort(struct Aml_Mat2d eigenvalues, struct Aml_Mat2d eigenvectors);
 ALA_DEF bool                                ala_eigenvalues_real_2x2(aml_real a, aml_real b, aml_real c, aml_real d);
@@ -79,6 +212,8 @@ ALA_DEF bool                                ala_eigenvalues_real_2x2(aml_real a,
 ALA_DEF aml_real                            ala_givens_2x2_rotations_get_c_and_s(aml_real a11, aml_real a21, aml_real *c, aml_real *s);
 
 ALA_DEF void                                ala_hessenberg_decomposition_householder(struct Aml_Mat2d Q, struct Aml_Mat2d H, struct Aml_Mat2d A);
+ALA_DEF void                                ala_hessenberg_decomposition_householder_blocked(struct Aml_Mat2d Q, struct Aml_Mat2d H, struct Aml_Mat2d A, bool compute_Q);
+ALA_DEF void                                ala_hessenberg_decomposition_householder_blocked_ws(struct Aml_Mat2d Q, struct Aml_Mat2d H, struct Aml_Mat2d A, bool compute_Q, struct Ala_Workspace *ws);
 ALA_DEF void                                ala_hessenberg_calc_double_shift(struct Aml_Mat2d m, size_t last, aml_real *trace, aml_real *det);
 ALA_DEF bool                                ala_hessenberg_deflate_tail(struct Aml_Mat2d m, size_t *first, size_t *last, aml_real eps);
 ALA_DEF void                                ala_hessenberg_QUQm1_schur_decomposition_given(struct Aml_Mat2d Q, struct Aml_Mat2d U, struct Aml_Mat2d H);
@@ -89,36 +224,56 @@ ALA_DEF void                                ala_householder_matrix_get(struct Am
 ALA_DEF void                                ala_householder_top_element_vector_get(struct Aml_Mat2d v_des, struct Aml_Mat2d x);
 
 ALA_DEF void                                ala_invert(struct Aml_Mat2d des, struct Aml_Mat2d src);
+ALA_DEF void                                ala_invert_ws(struct Aml_Mat2d des, struct Aml_Mat2d src, struct Ala_Workspace *ws);
 
 ALA_DEF void                                ala_LUP_decomposition_with_swap(struct Aml_Mat2d src, struct Aml_Mat2d l, struct Aml_Mat2d p, struct Aml_Mat2d u);
+ALA_DEF aml_real                            ala_LUP_det(struct Aml_Mat2d LU, const size_t *pivots);
+ALA_DEF bool                                ala_LUP_factor(struct Aml_Mat2d LU, size_t *pivots);
+ALA_DEF void                                ala_LUP_invert(struct Aml_Mat2d des, struct Aml_Mat2d LU, const size_t *pivots);
+ALA_DEF void                                ala_LUP_solve(struct Aml_Mat2d LU, const size_t *pivots, struct Aml_Mat2d B);
 
 ALA_DEF void                                ala_make_orthogonal_Gaussian_elimination(struct Aml_Mat2d des, struct Aml_Mat2d A);
 ALA_DEF void                                ala_make_orthogonal_modified_Gram_Schmidt(struct Aml_Mat2d des, struct Aml_Mat2d A);
+ALA_DEF void                                ala_matvec_dense(struct Aml_Mat2d y, struct Aml_Mat2d x, void *A);
 
 ALA_DEF bool                                ala_positive_definite_check(struct Aml_Mat2d A);
 ALA_DEF bool                                ala_positive_definite_RTR_Cholesky_decomposition(struct Aml_Mat2d R, struct Aml_Mat2d A);
 ALA_DEF int                                 ala_power_iterate(struct Aml_Mat2d A, struct Aml_Mat2d v, aml_real *lambda, aml_real shift, bool norm_inf_v);
 ALA_DEF void                                ala_project_out_columns(struct Aml_Mat2d v, struct Aml_Mat2d basis, size_t used_cols);
 
+ALA_DEF void                                ala_QR_apply_Q(struct Aml_Mat2d QR, const aml_real *tau, struct Aml_Mat2d B, bool transpose);
+ALA_DEF void                                ala_QR_apply_Q_ws(struct Aml_Mat2d QR, const aml_real *tau, struct Aml_Mat2d B, bool transpose, struct Ala_Workspace *ws);
 ALA_DEF void                                ala_QR_decomposition_householder(struct Aml_Mat2d Q, struct Aml_Mat2d R, struct Aml_Mat2d src);
+ALA_DEF void                                ala_QR_decomposition_householder_blocked(struct Aml_Mat2d Q, struct Aml_Mat2d R, struct Aml_Mat2d src, bool compute_Q);
 ALA_DEF void                                ala_QR_decomposition_householder_fast(struct Aml_Mat2d Q, struct Aml_Mat2d R, struct Aml_Mat2d src);
+ALA_DEF void                                ala_QR_factor(struct Aml_Mat2d QR, aml_real *tau);
+ALA_DEF void                                ala_QR_factor_ws(struct Aml_Mat2d QR, aml_real *tau, struct Ala_Workspace *ws);
+ALA_DEF void                                ala_QR_Q_get(struct Aml_Mat2d Q, struct Aml_Mat2d QR, const aml_real *tau);
 
 ALA_DEF size_t                              ala_reduce(struct Aml_Mat2d m);
 
 ALA_DEF aml_real                            ala_schur_residual(struct Aml_Mat2d H0, struct Aml_Mat2d Q, struct Aml_Mat2d U);
 ALA_DEF void                                ala_solve_linear_sys_LUP_decomposition(struct Aml_Mat2d A, struct Aml_Mat2d x, struct Aml_Mat2d B);
+ALA_DEF void                                ala_solve_linear_sys_LUP_decomposition_ws(struct Aml_Mat2d A, struct Aml_Mat2d x, struct Aml_Mat2d B, struct Ala_Workspace *ws);
+ALA_DEF struct Ala_Refinement_Info          ala_solve_linear_sys_mixed_precision(struct Aml_Mat2d A, struct Aml_Mat2d x, struct Aml_Mat2d B);
 ALA_DEF void                                ala_SVD_full(struct Aml_Mat2d A, struct Aml_Mat2d U, struct Aml_Mat2d S, struct Aml_Mat2d V, struct Aml_Mat2d init_vec_u, struct Aml_Mat2d init_vec_v, bool return_v_transpose);
+ALA_DEF void                                ala_SVD_golub_kahan(struct Aml_Mat2d A, struct Aml_Mat2d U, struct Aml_Mat2d S, struct Aml_Mat2d V, bool compute_UV, bool return_v_transpose);
+ALA_DEF void                                ala_SVD_golub_kahan_ws(struct Aml_Mat2d A, struct Aml_Mat2d U, struct Aml_Mat2d S, struct Aml_Mat2d V, bool compute_UV, bool return_v_transpose, struct Ala_Workspace *ws);
+ALA_DEF void                                ala_SVD_randomized(struct Aml_Mat2d A, struct Aml_Mat2d U, struct Aml_Mat2d S, struct Aml_Mat2d V, size_t oversampling, size_t power_iterations, bool return_v_transpose);
 ALA_DEF void                                ala_SVD_thin(struct Aml_Mat2d A, struct Aml_Mat2d U, struct Aml_Mat2d S, struct Aml_Mat2d V, struct Aml_Mat2d init_vec_u, struct Aml_Mat2d init_vec_v, bool return_v_transpose);
 
 ALA_DEF void                                ala_symmetric_eig_QR_shift(struct Aml_Mat2d A, struct Aml_Mat2d eigenvalues, struct Aml_Mat2d eigenvectors);
 ALA_DEF void                                ala_symmetric_eig_QR_tridiagonalize(struct Aml_Mat2d A, struct Aml_Mat2d eigenvalues, struct Aml_Mat2d eigenvectors);
 ALA_DEF void                                ala_symmetric_eig_QR_tridiagonalize_implicit_shift(struct Aml_Mat2d A, struct Aml_Mat2d eigenvalues, struct Aml_Mat2d eigenvectors);
+ALA_DEF void                                ala_symmetric_eig_QR_tridiagonalize_implicit_shift_ws(struct Aml_Mat2d A, struct Aml_Mat2d eigenvalues, struct Aml_Mat2d eigenvectors, struct Ala_Workspace *ws);
 ALA_DEF void                                ala_symmetric_eigen_approximation(struct Aml_Mat2d approx, struct Aml_Mat2d A, size_t order);
 ALA_DEF void                                ala_symmetric_eigen_approximation_build(struct Aml_Mat2d approx, struct Aml_Mat2d eigenvalues, struct Aml_Mat2d eigenvectors, size_t order);
 ALA_DEF struct Ala_Symmetric_Spectrum_Info  ala_symmetric_spectrum_analyze(struct Aml_Mat2d eigenvalues, aml_real rel_tol_multiplier);
 ALA_DEF void                                ala_symmetric_spectrum_info_print(const struct Ala_Symmetric_Spectrum_Info info);
 
 ALA_DEF void                                ala_symmetric_tridiagonalize_householder(struct Aml_Mat2d Q, struct Aml_Mat2d T, struct Aml_Mat2d src);
+ALA_DEF void                                ala_symmetric_tridiagonalize_householder_blocked(struct Aml_Mat2d Q, struct Aml_Mat2d T, struct Aml_Mat2d src, bool compute_Q);
+ALA_DEF void                                ala_symmetric_tridiagonalize_householder_blocked_ws(struct Aml_Mat2d Q, struct Aml_Mat2d T, struct Aml_Mat2d src, bool compute_Q, struct Ala_Workspace *ws);
 ALA_DEF aml_real                            ala_symmetric_tridiagonal_calc_shift(struct Aml_Mat2d m, size_t last);
 ALA_DEF void                                ala_symmetric_tridiagonal_cleanup(struct Aml_Mat2d T, size_t first, size_t last);
 ALA_DEF bool                                ala_symmetric_tridiagonal_deflate_tail(struct Aml_Mat2d m, size_t *first, size_t *last, aml_real eps);
@@ -130,11 +285,114 @@ ALA_DEF void                                ala_symmetric_tridiagonal_QR(struct
 
 ALA_DEF aml_real                            ala_upper_triangulate(struct Aml_Mat2d m, enum Ala_Upper_Triangulate_Flag flags);
 
+ALA_DEF struct Ala_Workspace                ala_workspace_alloc(size_t size);
+ALA_DEF void                                ala_workspace_free(struct Ala_Workspace ws);
+ALA_DEF struct Ala_Workspace                ala_workspace_from_buffer(void *buffer, size_t size);
+ALA_DEF void                                ala_workspace_reset(struct Ala_Workspace *ws);
+ALA_DEF size_t                              ala_workspace_size(enum Ala_Workspace_Routine routine, size_t rows, size_t cols);
+
 #endif // ALMOG_LINEAR_ALGEBRA_H_
 
 #ifdef ALMOG_LINEAR_ALGEBRA_IMPLEMENTATION
 #undef ALMOG_LINEAR_ALGEBRA_IMPLEMENTATION
 
+/* Bytes a request of `bytes` takes from a workspace; every block starts
+ * ALA_WORKSPACE_ALIGNMENT bytes after the previous one begins, rounded up. */
+static size_t ala_workspace_bytes(size_t bytes)
+{
+    return (bytes + ALA_WORKSPACE_ALIGNMENT - 1) / ALA_WORKSPACE_ALIGNMENT * ALA_WORKSPACE_ALIGNMENT;
+}
+
+static size_t ala_workspace_mat2d_bytes(size_t rows, size_t cols)
+{
+    return ala_workspace_bytes(sizeof(aml_real) * rows * cols);
+}
+
+/* Take `bytes` from the workspace. Callers give everything back at once by
+ * restoring ws->used to its value on entry. */
+static void *ala_workspace_take(struct Ala_Workspace *ws, size_t bytes)
+{
+    const size_t size = ala_workspace_bytes(bytes);
+    ALA_ASSERT(ws->size - ws->used >= size && "workspace too small, see ala_workspace_size()");
+
+    void *block = ws->memory + ws->used;
+    ws->used += size;
+    if (ws->used > ws->peak) {
+        ws->peak = ws->used;
+    }
+
+    return block;
+}
+
+static struct Aml_Mat2d ala_workspace_mat2d(struct Ala_Workspace *ws, size_t rows, size_t cols)
+{
+    struct Aml_Mat2d m;
+    m.rows = rows;
+    m.cols = cols;
+    m.stride_r = cols;
+    m.elements = (aml_real *)ala_workspace_take(ws, sizeof(aml_real) * rows * cols);
+
+    return m;
+}
+
+/* Workspace bytes of the routines below, upper bounds that mirror their
+ * ala_workspace_take() calls; k = ALA_HOUSEHOLDER_BLOCK_SIZE bounds every
+ * panel width. */
+static size_t ala_workspace_block_apply_left_bytes(size_t v_rows, size_t c_cols)
+{
+    const size_t nb = ALA_HOUSEHOLDER_BLOCK_SIZE;
+    return ala_workspace_mat2d_bytes(nb, v_rows) + ala_workspace_mat2d_bytes(nb, nb) + 2 * ala_workspace_mat2d_bytes(nb, c_cols);
+}
+
+static size_t ala_workspace_block_apply_right_bytes(size_t c_rows, size_t v_rows)
+{
+    const size_t nb = ALA_HOUSEHOLDER_BLOCK_SIZE;
+    return ala_workspace_mat2d_bytes(nb, v_rows) + 2 * ala_workspace_mat2d_bytes(c_rows, nb);
+}
+
+static size_t ala_workspace_QR_bytes(size_t rows, size_t cols)
+{
+    const size_t nb = ALA_HOUSEHOLDER_BLOCK_SIZE;
+    return ala_workspace_mat2d_bytes(rows, nb) + ala_workspace_mat2d_bytes(nb, nb) + ala_workspace_block_apply_left_bytes(rows, cols);
+}
+
+static size_t ala_workspace_LUP_bytes(size_t n)
+{
+    return ala_workspace_mat2d_bytes(n, n) + ala_workspace_bytes(sizeof(size_t) * n);
+}
+
+static size_t ala_workspace_hessenberg_bytes(size_t n)
+{
+    const size_t nb = ALA_HOUSEHOLDER_BLOCK_SIZE;
+    size_t panel = aml_max(ala_workspace_mat2d_bytes(nb, n), ala_workspace_block_apply_left_bytes(n, n));
+    panel = aml_max(panel, ala_workspace_block_apply_right_bytes(n, n));
+    return 2 * ala_workspace_mat2d_bytes(n, nb) + ala_workspace_mat2d_bytes(nb, nb) + ala_workspace_mat2d_bytes(n, 1) + panel;
+}
+
+static size_t ala_workspace_tridiagonalize_bytes(size_t n)
+{
+    const size_t nb = ALA_HOUSEHOLDER_BLOCK_SIZE;
+    const size_t panel = aml_max(ala_workspace_mat2d_bytes(nb, n), ala_workspace_block_apply_right_bytes(n, n));
+    return 2 * ala_workspace_mat2d_bytes(n, nb) + ala_workspace_mat2d_bytes(nb, nb) + ala_workspace_mat2d_bytes(nb, 1) + ala_workspace_mat2d_bytes(n, 1) + panel;
+}
+
+static size_t ala_workspace_bidiagonalize_bytes(size_t m, size_t n)
+{
+    const size_t nb = ALA_HOUSEHOLDER_BLOCK_SIZE;
+    return ala_workspace_mat2d_bytes(m, nb) + ala_workspace_mat2d_bytes(n, nb) + ala_workspace_mat2d_bytes(m, 1) + ala_workspace_mat2d_bytes(nb, n);
+}
+
+/* ala_SVD_tall() of an m x n matrix into an m x u_cols U */
+static size_t ala_workspace_SVD_tall_bytes(size_t m, size_t n, size_t u_cols)
+{
+    size_t kept = 4 * ala_workspace_mat2d_bytes(n, 1) + 3 * ala_workspace_mat2d_bytes(n, n);
+    size_t steps = aml_max(ala_workspace_QR_bytes(m, n), ala_workspace_bidiagonalize_bytes(n, n));
+    steps = aml_max(steps, ala_workspace_QR_bytes(n, n));
+    steps = aml_max(steps, ala_workspace_QR_bytes(m, u_cols));
+    steps = aml_max(steps, ala_workspace_mat2d_bytes(n, n) + ala_workspace_QR_bytes(n, n));
+    return kept + steps;
+}
+
 
 /**
  * @brief Apply a Givens rotation from the left to two adjacent rows.
@@ -350,12 +608,9 @@ ALA_DEF void ala_convolve(struct Aml_Mat2d m, struct Aml_Mat2d a, struct Aml_Mat
 /**
  * @brief Compute the determinant of a square matrix.
  *
- * The implementation:
- * - returns 0 early if it finds an exactly zero row or column,
- * - copies the matrix,
- * - upper-triangularizes it with row swapping,
- * - multiplies the diagonal,
- * - corrects the sign/factor using the elimination return value.
+ * Factors a copy of @p m with ala_LUP_factor() and returns ala_LUP_det(). To
+ * also solve systems with the same matrix, factor it once and call
+ * ala_LUP_det() and ala_LUP_solve() on the factorization.
  *
  * @param m Input square matrix.
  * @return Determinant of @p m.
@@ -363,36 +618,16 @@ ALA_DEF void ala_convolve(struct Aml_Mat2d m, struct Aml_Mat2d a, struct Aml_Mat
  * Complexity
  * `O(n^3)`.
  *
- * @note This is the general determinant routine.
+ * @note This is the general determinant routine. ala_det_ws() does the same
+ * without allocating.
  */
 ALA_DEF aml_real ala_det(struct Aml_Mat2d m)
 {
-    ALA_ASSERT(m.cols == m.rows && "should be a square matrix");
-
-    /* checking if there is a row or column with all zeros */
-    /* checking rows */
-    for (size_t i = 0; i < m.rows; i++) {
-        if (aml_row_is_all_the_same(m, 0, i)) {
-            return 0;
-        }
-    }
-    /* checking cols */
-    for (size_t j = 0; j < m.rows; j++) {
-        if (aml_col_is_all_the_same(m, 0, j)) {
-            return 0;
-        }
-    }
+    struct Ala_Workspace ws = ala_workspace_alloc(ala_workspace_size(ALA_WORKSPACE_DET, m.rows, m.cols));
+    aml_real det = ala_det_ws(m, &ws);
+    ala_workspace_free(ws);
 
-    struct Aml_Mat2d temp_m = aml_mat2d_alloc(m.rows, m.cols);
-    aml_copy(temp_m, m);
-    aml_real factor = ala_upper_triangulate(temp_m, ALA_UPPER_TRIANGULATE_ROW_SWAPPING);
-    aml_real diag_mul = 1; 
-    for (size_t i = 0; i < temp_m.rows; i++) {
-        diag_mul *= AML_MAT2D_AT(temp_m, i, i);
-    }
-    aml_mat2d_free(temp_m);
-
-    return diag_mul / factor;
+    return det;
 }
 
 /**
@@ -413,331 +648,1389 @@ ALA_DEF aml_real ala_det_2x2_mat(struct Aml_Mat2d m)
 }
 
 /**
- * @brief Verify a symmetric eigendecomposition.
- *
- * This routine checks:
- * - that @p eigenvalues is diagonal,
- * - orthogonality of `eigenvectors`,
- * - the residual `A V - V D`,
- * - the reconstruction `V D V^T - A`.
- *
- * Workspace is written into @p res.
- *
- * @param A Original square matrix.
- * @param eigenvalues Diagonal matrix `D`.
- * @param eigenvectors Eigenvector matrix `V`.
- * @param res Workspace / residual matrix.
- * @return `true` if all checks pass within a tolerance.
- *
- * Complexity
- * `O(n^3)`.
+ * @brief ala_det() with its temporaries taken from a workspace.
  *
- * @note This routine assumes an orthonormal eigenbasis and the relation
- * `A = V D V^T`.
+ * @param m Input square matrix.
+ * @param ws Workspace of at least
+ * `ala_workspace_size(ALA_WORKSPACE_DET, m.rows, m.cols)` bytes.
+ * @return Determinant of @p m.
  */
-ALA_DEF bool ala_eig_check(struct Aml_Mat2d A, struct Aml_Mat2d eigenvalues, struct Aml_Mat2d eigenvectors, struct Aml_Mat2d res)
+ALA_DEF aml_real ala_det_ws(struct Aml_Mat2d m, struct Ala_Workspace *ws)
 {
-    ALA_ASSERT(A.cols == A.rows); 
-    ALA_ASSERT(eigenvalues.cols == A.cols);
-    ALA_ASSERT(eigenvalues.rows == A.rows);
-    ALA_ASSERT(eigenvectors.cols == A.cols);
-    ALA_ASSERT(eigenvectors.rows == A.rows);
-    ALA_ASSERT(res.cols == A.cols);
-    ALA_ASSERT(res.rows == A.rows);
+    ALA_ASSERT(m.cols == m.rows && "should be a square matrix");
 
-    struct Aml_Mat2d VL = aml_mat2d_alloc(A.rows, A.cols);
+    const size_t mark = ws->used;
+    struct Aml_Mat2d LU = ala_workspace_mat2d(ws, m.rows, m.cols);
+    size_t *pivots = (size_t *)ala_workspace_take(ws, sizeof(*pivots) * m.rows);
 
-    aml_real eps = AML_EPS * (aml_real)1e3;
-    aml_real norma;
+    aml_copy(LU, m);
+    ala_LUP_factor(LU, pivots);
+    aml_real det = ala_LUP_det(LU, pivots);
 
-    bool return_value = true;
+    ws->used = mark;
 
-    if (!aml_is_diagonal(eigenvalues)) {
-        aml_dprintWARNING("%s", "eigenvalues matrix is not diagonal.");
-        return_value = false;
-    }
+    return det;
+}
 
-    /* orthogonality check */
-    aml_transpose(VL, eigenvectors);
-    aml_dot(res, VL, eigenvectors);
-    aml_set_identity(VL);
-    aml_sub(res, VL);
-    norma = aml_calc_norma(res);
-    if (aml_fabs(norma) > eps) {
-        aml_dprintWARNING("|V^T V - I| is to big = %g", norma);
-        return_value = false;
+/* x^T * y of n contiguous entries. Four partial sums let the compiler keep
+ * several multiply-adds in flight instead of one dependent chain. */
+static aml_real ala_dot_contiguous(const aml_real *x, const aml_real *y, size_t n)
+{
+    aml_real s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += x[i] * y[i];
+        s1 += x[i + 1] * y[i + 1];
+        s2 += x[i + 2] * y[i + 2];
+        s3 += x[i + 3] * y[i + 3];
     }
-
-    /* |res| check */
-    aml_dot(res, A, eigenvectors);
-    aml_dot(VL, eigenvectors, eigenvalues);
-    aml_sub(res, VL);
-    norma = aml_calc_norma(res) / aml_calc_norma(A);
-    if (aml_fabs(norma) > eps) {
-        aml_dprintWARNING("|AV - VD| is to big = %g", norma);
-        return_value = false;
+    for (; i < n; i++) {
+        s0 += x[i] * y[i];
     }
+    return (s0 + s1) + (s2 + s3);
+}
 
-    /* reconstruction check */
-    aml_transpose(VL, eigenvectors);
-    aml_dot(res, eigenvalues, VL);
-    aml_copy(VL, res);
-    aml_dot(res, eigenvectors, VL);
-    aml_sub(res, A);
-    norma = aml_calc_norma(res) / aml_calc_norma(A);
-    if (aml_fabs(norma) > eps) {
-        aml_dprintWARNING("|V D V^T - A| is to big = %g", norma);
-        return_value = false;
+/* Row i of Vt as an n x 1 vector. The Krylov solvers keep their basis as the
+ * rows of Vt so every vector handed to the matvec callback is contiguous. */
+static struct Aml_Mat2d ala_krylov_vector(struct Aml_Mat2d Vt, size_t i)
+{
+    struct Aml_Mat2d v = {.rows = Vt.cols,
+                          .cols = 1,
+                          .stride_r = 1,
+                          .elements = &AML_MAT2D_AT(Vt, i, 0)};
+    return v;
+}
+
+/* w <- w - sum_i <w, v_i> v_i over rows [0, count) of Vt, done twice so the
+ * result is orthogonal to working precision. The coefficients are added to h
+ * unless it is NULL. Returns |w|. */
+static aml_real ala_krylov_orthogonalize(struct Aml_Mat2d Vt, size_t count, aml_real *w, aml_real *h)
+{
+    const size_t n = Vt.cols;
+
+    for (int pass = 0; pass < 2; pass++) {
+        for (size_t i = 0; i < count; i++) {
+            const aml_real *v = &AML_MAT2D_AT(Vt, i, 0);
+            const aml_real c = ala_dot_contiguous(v, w, n);
+            if (h) h[i] += c;
+            for (size_t p = 0; p < n; p++) {
+                w[p] -= c * v[p];
+            }
+        }
     }
 
-    aml_mat2d_free(VL);
-    return return_value;
+    return aml_sqrt(ala_dot_contiguous(w, w, n));
 }
 
-/**
- * @brief Compute eigenpairs by repeated power iteration with deflation.
- *
- * The routine repeatedly:
- * - seeds the next vector from @p init_vector,
- * - projects out previously found columns,
- * - calls ala_power_iterate(),
- * - stores the eigenpair,
- * - deflates `B <- B - lambda * v v^T`.
- *
- * @param A Input square matrix.
- * @param eigenvalues Output diagonal matrix of eigenvalues.
- * @param eigenvectors Output matrix whose columns are eigenvectors.
- * @param init_vector Initial vector reused for each eigenpair.
- * @param norm_inf_vectors If true, renormalize output eigenvectors with the
- * infinity norm at the end.
- *
- * Complexity
- * Approximately `O(AML_MAX_POWER_ITERATION * n^3)`.
- *
- * @note Best for small educational problems or when only a few dominant
- * eigenpairs are needed and the assumptions roughly hold.
- * @warning The source comment states assumptions that the eigenvectors form an
- * orthonormal basis and that the largest eigenvalue is positive and unique.
- */
-ALA_DEF void ala_eig_power_iteration(struct Aml_Mat2d A, struct Aml_Mat2d eigenvalues, struct Aml_Mat2d eigenvectors, struct Aml_Mat2d init_vector, bool norm_inf_vectors)
+/* Row j of Vt <- a random unit vector orthogonal to rows [0, j). Returns
+ * false if the rows already span the whole space. */
+static bool ala_krylov_random_vector(struct Aml_Mat2d Vt, size_t j)
 {
-    /* https://www.youtube.com/watch?v=c8DIOzuZqBs */
+    const size_t n = Vt.cols;
+    const aml_real eps = (aml_real)(sizeof(aml_real) == sizeof(float) ? FLT_EPSILON : DBL_EPSILON);
+    aml_real *w = &AML_MAT2D_AT(Vt, j, 0);
+
+    for (int attempt = 0; attempt < 3; attempt++) {
+        aml_set_rand(ala_krylov_vector(Vt, j), -1, 1);
+        aml_real norm0 = aml_sqrt(ala_dot_contiguous(w, w, n));
+        aml_real norm = ala_krylov_orthogonalize(Vt, j, w, NULL);
+        if (norm > aml_sqrt(eps) * norm0) {
+            for (size_t p = 0; p < n; p++) {
+                w[p] /= norm;
+            }
+            return true;
+        }
+    }
+    for (size_t p = 0; p < n; p++) {
+        w[p] = 0;
+    }
+    return false;
+}
 
-    /** Conditions:
-     *      - The eigenvectors must form an orthonormal basis 
-     *      - The largest eigenvalue must be positive and unique
-     */ 
+/* Grow the Arnoldi factorization A * V_j = V_j * H_j + f * e_j^T from j0 to m
+ * steps. Rows [0, j0] of Vt hold the orthonormal basis on entry (row j0 is the
+ * next vector to multiply). On return row m holds f / |f| and H(m, m-1) = |f|.
+ * For a symmetric operator only the tridiagonal part of H is kept, which is
+ * the Lanczos recurrence with full reorthogonalization. h is m scratch
+ * entries. */
+static void ala_krylov_extend(Ala_Matvec matvec, void *context, struct Aml_Mat2d Vt, struct Aml_Mat2d H, size_t j0, size_t m, bool symmetric, aml_real *h)
+{
+    const size_t n = Vt.cols;
+    const aml_real eps = (aml_real)(sizeof(aml_real) == sizeof(float) ? FLT_EPSILON : DBL_EPSILON);
 
-    ALA_ASSERT(A.cols == A.rows); 
-    ALA_ASSERT(eigenvalues.cols == A.cols);
-    ALA_ASSERT(eigenvalues.rows == A.rows);
-    ALA_ASSERT(eigenvectors.cols == A.cols);
-    ALA_ASSERT(eigenvectors.rows == A.rows);
-    ALA_ASSERT(init_vector.cols == 1);
-    ALA_ASSERT(init_vector.rows == A.rows);
-    ALA_ASSERT(aml_calc_norma_inf(init_vector) > 0);
+    for (size_t j = j0; j < m; j++) {
+        aml_real *w = &AML_MAT2D_AT(Vt, j + 1, 0);
+        matvec(ala_krylov_vector(Vt, j + 1), ala_krylov_vector(Vt, j), context);
 
-    aml_fill(eigenvalues, 0);
-    struct Aml_Mat2d B = aml_mat2d_alloc(A.rows, A.cols);
-    struct Aml_Mat2d temp_mat = aml_mat2d_alloc(A.rows, A.cols);
-    aml_copy(B, A);
+        for (size_t i = 0; i <= j; i++) {
+            h[i] = 0;
+        }
+        aml_real w_norm = aml_sqrt(ala_dot_contiguous(w, w, n));
+        aml_real beta = ala_krylov_orthogonalize(Vt, j + 1, w, h);
 
-    for (int i = 0, shift_value = 0; i < (int)A.rows; i++) {
-        aml_copy_src_to_des_window(eigenvectors, init_vector, 0, i, init_vector.rows-1, i);
-        struct Aml_Mat2d v = {.cols = init_vector.cols,
-                   .elements = &AML_MAT2D_AT(eigenvectors, 0, i),
-                   .rows = init_vector.rows,
-                   .stride_r = eigenvectors.stride_r};
-        ala_project_out_columns(v, eigenvectors, i);
-        if (!AML_IS_ZERO(aml_calc_norma(v))) {
-            aml_normalize(v);
+        if (symmetric) {
+            AML_MAT2D_AT(H, j, j) = h[j];
+            if (j > 0) AML_MAT2D_AT(H, j - 1, j) = AML_MAT2D_AT(H, j, j - 1);
+        } else {
+            for (size_t i = 0; i <= j; i++) {
+                AML_MAT2D_AT(H, i, j) = h[i];
+            }
         }
-        if (ala_power_iterate(B, v, &AML_MAT2D_AT(eigenvalues, i, i), (aml_real)shift_value, 0)) { /* norm_inf_v must be zero*/
-            shift_value++;
-            i--;
-            continue;
+
+        if (beta > eps * w_norm) {
+            for (size_t p = 0; p < n; p++) {
+                w[p] /= beta;
+            }
+            AML_MAT2D_AT(H, j + 1, j) = beta;
         } else {
-            shift_value = 0;
+            /* invariant subspace: continue with a fresh direction, or leave
+             * f = 0 if this was the last step */
+            AML_MAT2D_AT(H, j + 1, j) = 0;
+            if (j + 1 == m || !ala_krylov_random_vector(Vt, j + 1)) {
+                for (size_t p = 0; p < n; p++) {
+                    w[p] = 0;
+                }
+            }
         }
-        if (!AML_IS_ZERO(aml_calc_norma(v))) {
-            aml_normalize(v);
+    }
+}
+
+/* One implicitly shifted QR sweep over the leading m x m Hessenberg block of
+ * H, with the real shift re (im == 0) or the complex pair re +- i * im as a
+ * Francis double step. The orthogonal transformation is accumulated into the
+ * columns of Q. With an unwanted Ritz value as the shift this is the implicit
+ * restart: it removes that direction from the starting vector. */
+static void ala_krylov_shift_apply(struct Aml_Mat2d H, struct Aml_Mat2d Q, size_t m, aml_real re, aml_real im)
+{
+    if (im == 0) {
+        aml_real x = AML_MAT2D_AT(H, 0, 0) - re;
+        aml_real z = AML_MAT2D_AT(H, 1, 0);
+        for (size_t k = 0; k + 1 < m; k++) {
+            aml_real r = aml_hypot(x, z);
+            aml_real c = r == 0 ? (aml_real)1 : x / r;
+            aml_real s = r == 0 ? (aml_real)0 : z / r;
+
+            ala_apply_givens_2x2_left(H, k, k == 0 ? 0 : k - 1, m - 1, c, s);
+            if (k > 0) AML_MAT2D_AT(H, k + 1, k - 1) = 0;
+            ala_apply_givens_2x2_right(H, k, 0, aml_min(k + 2, m - 1), c, s);
+            ala_apply_givens_2x2_right(Q, k, 0, Q.rows - 1, c, s);
+
+            if (k + 2 < m) {
+                x = AML_MAT2D_AT(H, k + 1, k);
+                z = AML_MAT2D_AT(H, k + 2, k);
+            }
         }
-        aml_outer_product(temp_mat, v);
-        aml_mult(temp_mat, AML_MAT2D_AT(eigenvalues, i, i));
-        aml_sub(B, temp_mat);
+        return;
     }
 
-    if (norm_inf_vectors) {
-        for (size_t c = 0; c < eigenvectors.cols; c++) {
-            struct Aml_Mat2d v = {.cols = init_vector.cols,
-                    .elements = &AML_MAT2D_AT(eigenvectors, 0, c),
-                    .rows = init_vector.rows,
-                    .stride_r = eigenvectors.stride_r};
-            aml_normalize_inf(v);
+    const aml_real trace = 2 * re;
+    const aml_real det = re * re + im * im;
+    aml_real h00 = AML_MAT2D_AT(H, 0, 0);
+    aml_real h10 = AML_MAT2D_AT(H, 1, 0);
+    aml_real x = h00 * h00 + AML_MAT2D_AT(H, 0, 1) * h10 - trace * h00 + det;
+    aml_real y = h10 * (h00 + AML_MAT2D_AT(H, 1, 1) - trace);
+    aml_real z = m > 2 ? h10 * AML_MAT2D_AT(H, 2, 1) : 0;
+
+    for (size_t k = 0; k + 2 < m; k++) {
+        aml_real scale = aml_fabs(x) + aml_fabs(y) + aml_fabs(z);
+        if (scale > 0) {
+            x /= scale;
+            y /= scale;
+            z /= scale;
+            aml_real norm = aml_sqrt(x * x + y * y + z * z);
+            aml_real v0 = x + (x >= 0 ? norm : -norm);
+            aml_real beta = 2 / (v0 * v0 + y * y + z * z);
+            ala_apply_householder_left3(H, k, k == 0 ? 0 : k - 1, m - 1, v0, y, z, beta);
+            ala_apply_householder_right3(H, 0, aml_min(k + 3, m - 1), k, v0, y, z, beta);
+            ala_apply_householder_right3(Q, 0, Q.rows - 1, k, v0, y, z, beta);
+            if (k > 0) {
+                AML_MAT2D_AT(H, k + 1, k - 1) = 0;
+                AML_MAT2D_AT(H, k + 2, k - 1) = 0;
+            }
         }
+        x = AML_MAT2D_AT(H, k + 1, k);
+        y = AML_MAT2D_AT(H, k + 2, k);
+        z = k + 3 < m ? AML_MAT2D_AT(H, k + 3, k) : 0;
     }
 
-    aml_mat2d_free(B);
-    aml_mat2d_free(temp_mat);
+    /* the last 2 x 2 step is a rotation */
+    size_t k = m - 2;
+    aml_real r = aml_hypot(x, y);
+    if (r > 0) {
+        aml_real c = x / r;
+        aml_real s = y / r;
+        ala_apply_givens_2x2_left(H, k, k == 0 ? 0 : k - 1, m - 1, c, s);
+        if (k > 0) AML_MAT2D_AT(H, k + 1, k - 1) = 0;
+        ala_apply_givens_2x2_right(H, k, 0, m - 1, c, s);
+        ala_apply_givens_2x2_right(Q, k, 0, Q.rows - 1, c, s);
+    }
 }
 
-ALA_DEF void ala_eigenpairs_sort(struct Aml_Mat2d eigenvalues, struct Aml_Mat2d eigenvectors)
+/* Eigenvalues and eigenvectors of the symmetric tridiagonal matrix with
+ * diagonal d and off-diagonal e[0..n-2] by implicit QL (tql2). The rotations
+ * are accumulated into the columns of Z, which should start as I. d is
+ * overwritten with the eigenvalues and e is destroyed. Returns false if an
+ * eigenvalue did not converge in 30 sweeps. */
+static bool ala_symmetric_tridiagonal_QL(aml_real *d, aml_real *e, size_t n, struct Aml_Mat2d Z)
 {
-    for (size_t i = 0; i < eigenvalues.cols - 1; i++) {
-        for (size_t j = i + 1; j < eigenvalues.cols; j++) {
-            if (aml_fabs(AML_MAT2D_AT(eigenvalues, i, i)) < aml_fabs(AML_MAT2D_AT(eigenvalues, j, j))) {
-                aml_cols_swap(eigenvalues, i, j);
-                aml_rows_swap(eigenvalues, i, j);
-                aml_cols_swap(eigenvectors, i, j);
+    const aml_real eps = (aml_real)(sizeof(aml_real) == sizeof(float) ? FLT_EPSILON : DBL_EPSILON);
+    const int N = (int)n;
+
+    e[n - 1] = 0;
+    for (int l = 0; l < N; l++) {
+        int iterations = 0;
+        int m;
+        do {
+            for (m = l; m < N - 1; m++) {
+                aml_real dd = aml_fabs(d[m]) + aml_fabs(d[m + 1]);
+                if (aml_fabs(e[m]) <= eps * dd) break;
             }
-        }
+            if (m == l) break;
+            if (iterations++ == 30) return false;
+
+            aml_real g = (d[l + 1] - d[l]) / (2 * e[l]);
+            aml_real r = aml_hypot(g, (aml_real)1);
+            g = d[m] - d[l] + e[l] / (g + (g >= 0 ? r : -r));
+            aml_real s = 1, c = 1, p = 0;
+            int i;
+            for (i = m - 1; i >= l; i--) {
+                aml_real f = s * e[i];
+                aml_real b = c * e[i];
+                r = aml_hypot(f, g);
+                e[i + 1] = r;
+                if (r == 0) {
+                    d[i + 1] -= p;
+                    e[m] = 0;
+                    break;
+                }
+                s = f / r;
+                c = g / r;
+                g = d[i + 1] - p;
+                r = (d[i] - g) * s + 2 * c * b;
+                p = s * r;
+                d[i + 1] = g + p;
+                g = c * r - b;
+                for (size_t k = 0; k < Z.rows; k++) {
+                    aml_real *zi = &AML_MAT2D_AT(Z, k, (size_t)i);
+                    f = zi[1];
+                    zi[1] = s * zi[0] + c * f;
+                    zi[0] = c * zi[0] - s * f;
+                }
+            }
+            if (r == 0 && i >= l) continue;
+            d[l] -= p;
+            e[l] = g;
+            e[m] = 0;
+        } while (m != l);
     }
+
+    return true;
 }
 
-ALA_DEF bool ala_eigenvalues_real_2x2(aml_real a, aml_real b, aml_real c, aml_real d)
+/* Eigenvalues wr + i * wi of the n x n upper Hessenberg H (destroyed) by the
+ * Francis double-shift QR iteration (hqr). A complex pair comes out as two
+ * neighbours with opposite wi. Returns false if an eigenvalue did not
+ * converge in 60 iterations. */
+static bool ala_hessenberg_eigenvalues(struct Aml_Mat2d H, aml_real *wr, aml_real *wi)
 {
-    aml_real discriminant = (a - d) * (a - d) + 4 * b * c;
-    return (discriminant > 0) || (AML_IS_ZERO(discriminant)); 
+    #define ALA_H(i, j) AML_MAT2D_AT(H, (size_t)(i), (size_t)(j))
+    const int n = (int)H.rows;
+    aml_real norm = 0;
+    for (int i = 0; i < n; i++) {
+        for (int j = i > 0 ? i - 1 : 0; j < n; j++) {
+            norm += aml_fabs(ALA_H(i, j));
+        }
+    }
+
+    int nn = n - 1;
+    aml_real t = 0;
+    bool converged = true;
+    while (nn >= 0 && converged) {
+        int iterations = 0;
+        int l;
+        do {
+            for (l = nn; l >= 1; l--) {
+                aml_real s = aml_fabs(ALA_H(l - 1, l - 1)) + aml_fabs(ALA_H(l, l));
+                if (s == 0) s = norm;
+                if (aml_fabs(ALA_H(l, l - 1)) + s == s) {
+                    ALA_H(l, l - 1) = 0;
+                    break;
+                }
+            }
+            aml_real x = ALA_H(nn, nn);
+            if (l == nn) {
+                wr[nn] = x + t;
+                wi[nn] = 0;
+                nn--;
+                continue;
+            }
+            aml_real y = ALA_H(nn - 1, nn - 1);
+            aml_real w = ALA_H(nn, nn - 1) * ALA_H(nn - 1, nn);
+            if (l == nn - 1) {
+                aml_real p = (aml_real)0.5 * (y - x);
+                aml_real q = p * p + w;
+                aml_real z = aml_sqrt(aml_fabs(q));
+                x += t;
+                if (q >= 0) {
+                    z = p + (p >= 0 ? z : -z);
+                    wr[nn - 1] = wr[nn] = x + z;
+                    if (z != 0) wr[nn] = x - w / z;
+                    wi[nn - 1] = wi[nn] = 0;
+                } else {
+                    wr[nn - 1] = wr[nn] = x + p;
+                    wi[nn] = z;
+                    wi[nn - 1] = -z;
+                }
+                nn -= 2;
+                continue;
+            }
+
+            if (iterations == 60) {
+                converged = false;
+                break;
+            }
+            if (iterations == 10 || iterations == 20) {
+                /* exceptional shift */
+                t += x;
+                for (int i = 0; i <= nn; i++) {
+                    ALA_H(i, i) -= x;
+                }
+                aml_real s = aml_fabs(ALA_H(nn, nn - 1)) + aml_fabs(ALA_H(nn - 1, nn - 2));
+                y = x = (aml_real)0.75 * s;
+                w = (aml_real)-0.4375 * s * s;
+            }
+            iterations++;
+
+            int m;
+            aml_real p = 0, q = 0, r = 0, z = 0;
+            for (m = nn - 2; m >= l; m--) {
+                z = ALA_H(m, m);
+                r = x - z;
+                aml_real s = y - z;
+                p = (r * s - w) / ALA_H(m + 1, m) + ALA_H(m, m + 1);
+                q = ALA_H(m + 1, m + 1) - z - r - s;
+                r = ALA_H(m + 2, m + 1);
+                s = aml_fabs(p) + aml_fabs(q) + aml_fabs(r);
+                p /= s;
+                q /= s;
+                r /= s;
+                if (m == l) break;
+                aml_real u = aml_fabs(ALA_H(m, m - 1)) * (aml_fabs(q) + aml_fabs(r));
+                aml_real v = aml_fabs(p) * (aml_fabs(ALA_H(m - 1, m - 1)) + aml_fabs(z) + aml_fabs(ALA_H(m + 1, m + 1)));
+                if (u + v == v) break;
+            }
+            for (int i = m + 2; i <= nn; i++) {
+                ALA_H(i, i - 2) = 0;
+                if (i != m + 2) ALA_H(i, i - 3) = 0;
+            }
+            for (int k = m; k <= nn - 1; k++) {
+                if (k != m) {
+                    p = ALA_H(k, k - 1);
+                    q = ALA_H(k + 1, k - 1);
+                    r = k != nn - 1 ? ALA_H(k + 2, k - 1) : 0;
+                    x = aml_fabs(p) + aml_fabs(q) + aml_fabs(r);
+                    if (x != 0) {
+                        p /= x;
+                        q /= x;
+                        r /= x;
+                    }
+                }
+                aml_real s = aml_sqrt(p * p + q * q + r * r);
+                if (p < 0) s = -s;
+                if (s == 0) continue;
+                if (k == m) {
+                    if (l != m) ALA_H(k, k - 1) = -ALA_H(k, k - 1);
+                } else {
+                    ALA_H(k, k - 1) = -s * x;
+                }
+                p += s;
+                x = p / s;
+                y = q / s;
+                z = r / s;
+                q /= p;
+                r /= p;
+                for (int j = k; j <= nn; j++) {
+                    p = ALA_H(k, j) + q * ALA_H(k + 1, j);
+                    if (k != nn - 1) {
+                        p += r * ALA_H(k + 2, j);
+                        ALA_H(k + 2, j) -= p * z;
+                    }
+                    ALA_H(k + 1, j) -= p * y;
+                    ALA_H(k, j) -= p * x;
+                }
+                int i_max = nn < k + 3 ? nn : k + 3;
+                for (int i = l; i <= i_max; i++) {
+                    p = x * ALA_H(i, k) + y * ALA_H(i, k + 1);
+                    if (k != nn - 1) {
+                        p += z * ALA_H(i, k + 2);
+                        ALA_H(i, k + 2) -= p * r;
+                    }
+                    ALA_H(i, k + 1) -= p * q;
+                    ALA_H(i, k) -= p;
+                }
+            }
+        } while (l < nn - 1);
+    }
+
+    #undef ALA_H
+    return converged;
 }
 
-/**
- * @brief Compute Givens rotation parameters that zero the second entry.
- *
- * For inputs `(a11, a21)`, this returns `r = hypot(a11, a21)` and optionally
- * stores `c = a11/r`, `s = a21/r`, so that applying the corresponding rotation
- * from the left maps `[a11, a21]^T` to `[r, 0]^T`.
- *
- * @param a11 Top entry.
- * @param a21 Bottom entry.
- * @param c Optional output cosine.
- * @param s Optional output sine.
- * @return The rotated top value `r`.
- *
- * Complexity
- * `O(1)`.
- */
-ALA_DEF aml_real ala_givens_2x2_rotations_get_c_and_s(aml_real a11, aml_real a21, aml_real *c, aml_real *s)
+/* Unit eigenvector yr + i * yi of the m x m Hessenberg H for its eigenvalue
+ * re + i * im, by two steps of inverse iteration. A complex shift is solved as
+ * the real system [H - re*I, im*I; -im*I, H - re*I] of twice the size. LU is
+ * at least 2m x 2m, rhs 2m x 1 and pivots 2m entries. */
+static void ala_hessenberg_eigenvector_get(struct Aml_Mat2d H, aml_real re, aml_real im, aml_real *yr, aml_real *yi, struct Aml_Mat2d LU, size_t *pivots, struct Aml_Mat2d rhs)
 {
-    if (AML_IS_ZERO(a21)) {
-        if (c) *c = (aml_real)1;
-        if (s) *s = (aml_real)0;
-        return a11;
+    const aml_real eps = (aml_real)(sizeof(aml_real) == sizeof(float) ? FLT_EPSILON : DBL_EPSILON);
+    const size_t m = H.rows;
+    const size_t s = im == 0 ? m : 2 * m;
+
+    aml_real norm = 0;
+    for (size_t i = 0; i < m; i++) {
+        for (size_t j = 0; j < m; j++) {
+            norm += aml_fabs(AML_MAT2D_AT(H, i, j));
+        }
+    }
+    norm = aml_max(norm + aml_fabs(re) + aml_fabs(im), (aml_real)FLT_MIN);
+
+    struct Aml_Mat2d lu = aml_create_block_ref(LU, 0, 0, s, s);
+    struct Aml_Mat2d b = aml_create_block_ref(rhs, 0, 0, s, 1);
+    aml_fill(lu, 0);
+    for (size_t i = 0; i < m; i++) {
+        for (size_t j = 0; j < m; j++) {
+            aml_real hij = AML_MAT2D_AT(H, i, j) - (i == j ? re : 0);
+            AML_MAT2D_AT(lu, i, j) = hij;
+            if (im != 0) AML_MAT2D_AT(lu, m + i, m + j) = hij;
+        }
+        if (im != 0) {
+            AML_MAT2D_AT(lu, i, m + i) = im;
+            AML_MAT2D_AT(lu, m + i, i) = -im;
+        }
+    }
+    ala_LUP_factor(lu, pivots);
+    /* the shift is an eigenvalue, so the smallest pivot is zero up to
+     * rounding; any tiny value gives the eigenvector direction */
+    for (size_t i = 0; i < s; i++) {
+        aml_real *u = &AML_MAT2D_AT(lu, i, i);
+        if (aml_fabs(*u) < eps * norm) *u = *u < 0 ? -eps * norm : eps * norm;
     }
 
-    aml_real r = aml_hypot(a11, a21);
-    if (c) *c = a11 / r;
-    if (s) *s = a21 / r;
-    return r;
+    aml_fill(b, 1);
+    for (int step = 0; step < 2; step++) {
+        ala_LUP_solve(lu, pivots, b);
+        aml_real b_norm = aml_sqrt(aml_inner_product(b));
+        aml_mult(b, 1 / b_norm);
+    }
+
+    for (size_t i = 0; i < m; i++) {
+        yr[i] = AML_MAT2D_AT(b, i, 0);
+        yi[i] = im != 0 ? AML_MAT2D_AT(b, m + i, 0) : 0;
+    }
 }
 
-ALA_DEF void ala_hessenberg_decomposition_householder(struct Aml_Mat2d Q, struct Aml_Mat2d H, struct Aml_Mat2d A)
+/* Does the Ritz value a + i * a_im come before b + i * b_im for `which`?
+ * Conjugate pairs stay adjacent, positive imaginary part first. */
+static bool ala_eig_which_before(enum Ala_Eig_Which which, aml_real a, aml_real a_im, aml_real b, aml_real b_im)
 {
-    ALA_ASSERT(A.rows == A.cols);
-    ALA_ASSERT(Q.rows == Q.cols);
-    ALA_ASSERT(H.rows == H.cols);
-    ALA_ASSERT(Q.rows == A.rows);
-    ALA_ASSERT(H.rows == A.rows);
+    aml_real key_a = 0, key_b = 0;
+    switch (which) {
+        case ALA_EIG_LARGEST_MAGNITUDE:
+            key_a = aml_hypot(a, a_im);
+            key_b = aml_hypot(b, b_im);
+            break;
+        case ALA_EIG_LARGEST_REAL:
+            key_a = a;
+            key_b = b;
+            break;
+        case ALA_EIG_SMALLEST_REAL:
+            key_a = -a;
+            key_b = -b;
+            break;
+    }
+    if (key_a != key_b) return key_a > key_b;
+    return a_im > b_im;
+}
 
-    size_t n = A.rows;
-    aml_copy(H, A);
-    aml_set_identity(Q);
+/* Implicitly restarted Arnoldi / Lanczos behind ala_eig_arnoldi() and
+ * ala_eig_lanczos(). */
+static size_t ala_eig_krylov(Ala_Matvec matvec, void *context, struct Aml_Mat2d eigenvalues, struct Aml_Mat2d eigenvectors, enum Ala_Eig_Which which, size_t basis_size, aml_real tolerance, bool symmetric)
+{
+    const size_t n = eigenvectors.rows;
+    const size_t k = eigenvectors.cols;
+    const aml_real eps = (aml_real)(sizeof(aml_real) == sizeof(float) ? FLT_EPSILON : DBL_EPSILON);
+    const aml_real eps23 = (aml_real)pow(eps, 2.0 / 3.0);
+    /* the residual estimates bottom out a little above eps */
+    const aml_real tol = tolerance > 0 ? tolerance : 64 * eps;
+
+    ALA_ASSERT(eigenvalues.rows == k);
+    ALA_ASSERT(eigenvalues.cols == k);
+    ALA_ASSERT(k >= 1);
+    ALA_ASSERT((symmetric ? k + 1 : k + 2) <= n && "k must leave room for the Krylov basis");
+
+    size_t m = basis_size ? basis_size : aml_max(2 * k + 1, (size_t)20);
+    m = aml_max(m, symmetric ? k + 1 : k + 2);
+    m = aml_min(m, n);
+
+    struct Aml_Mat2d Vt   = aml_mat2d_alloc(m + 1, n);
+    struct Aml_Mat2d W    = aml_mat2d_alloc(m, n);
+    struct Aml_Mat2d H    = aml_mat2d_alloc(m + 1, m);
+    struct Aml_Mat2d Hw   = aml_mat2d_alloc(m, m);
+    struct Aml_Mat2d Q    = aml_mat2d_alloc(m, m);
+    struct Aml_Mat2d QT   = aml_mat2d_alloc(m, m);
+    struct Aml_Mat2d Ysel = aml_mat2d_alloc(k, m);
+    struct Aml_Mat2d LU   = aml_mat2d_alloc(2 * m, 2 * m);
+    struct Aml_Mat2d rhs  = aml_mat2d_alloc(2 * m, 1);
+    aml_real *h      = (aml_real *)AML_MALLOC(sizeof(*h) * m * 5);
+    size_t *order    = (size_t *)AML_MALLOC(sizeof(*order) * m);
+    size_t *pivots   = (size_t *)AML_MALLOC(sizeof(*pivots) * 2 * m);
+    ALA_ASSERT(h != NULL && order != NULL && pivots != NULL);
+    aml_real *wr = h + m;
+    aml_real *wi = h + 2 * m;
+    aml_real *yr = h + 3 * m;
+    aml_real *yi = h + 4 * m;
+
+    struct Aml_Mat2d Hm = aml_create_block_ref(H, 0, 0, m, m);
+
+    aml_fill(H, 0);
+    aml_fill(Ysel, 0);
+    aml_fill(eigenvalues, 0);
+    ala_krylov_random_vector(Vt, 0);
+
+    /* a complex pair that would only half fit in the last slot is left out */
+    size_t target = k;
+    size_t converged = 0;
+    size_t j0 = 0;
+    for (size_t restart = 0; ; restart++) {
+        ala_krylov_extend(matvec, context, Vt, H, j0, m, symmetric, h);
+        const aml_real beta = AML_MAT2D_AT(H, m, m - 1);
+
+        /* Ritz values (and for Lanczos, vectors) of the projection */
+        bool ok;
+        if (symmetric) {
+            for (size_t i = 0; i < m; i++) {
+                wr[i] = AML_MAT2D_AT(Hm, i, i);
+                wi[i] = 0;
+                yr[i] = i + 1 < m ? AML_MAT2D_AT(Hm, i + 1, i) : 0;
+            }
+            aml_set_identity(Hw);
+            ok = ala_symmetric_tridiagonal_QL(wr, yr, m, Hw);
+        } else {
+            aml_copy(Hw, Hm);
+            ok = ala_hessenberg_eigenvalues(Hw, wr, wi);
+        }
+        if (!ok) {
+            aml_dprintWARNING("%s", "Ritz values of the projected matrix did not converge.");
+            converged = 0;
+            aml_fill(Ysel, 0);
+            aml_fill(eigenvalues, 0);
+            break;
+        }
 
-    if (n <= 2) return;
+        for (size_t i = 0; i < m; i++) {
+            size_t j = i;
+            while (j > 0 && ala_eig_which_before(which, wr[i], wi[i], wr[order[j - 1]], wi[order[j - 1]])) {
+                order[j] = order[j - 1];
+                j--;
+            }
+            order[j] = i;
+        }
 
-    struct Aml_Mat2d vbuf = aml_mat2d_alloc(n, 1);
+        aml_real theta_max = 0;
+        for (size_t i = 0; i < m; i++) {
+            theta_max = aml_max(theta_max, aml_hypot(wr[i], wi[i]));
+        }
 
-    for (size_t k = 0; k < n - 2; ++k) {
-        struct Aml_Mat2d x = {
-            .rows = n - (k + 1),
-            .cols = 1,
-            .stride_r = H.stride_r,
-            .elements = &AML_MAT2D_AT(H, k + 1, k),
-        };
-        struct Aml_Mat2d v = {
-            .rows = x.rows,
-            .cols = 1,
-            .stride_r = vbuf.stride_r,
-            .elements = &AML_MAT2D_AT(vbuf, k + 1, 0),
-        };
+        /* residual |A x - theta x| = beta * |e_m^T y| of the wanted pairs */
+        converged = 0;
+        target = k;
+        aml_fill(eigenvalues, 0);
+        for (size_t w = 0; w < k;) {
+            const size_t idx = order[w];
+            const aml_real theta = aml_hypot(wr[idx], wi[idx]);
+            const aml_real bound = tol * aml_max(theta, eps23 * theta_max);
+            if (wi[idx] == 0) {
+                if (symmetric) {
+                    for (size_t i = 0; i < m; i++) {
+                        AML_MAT2D_AT(Ysel, w, i) = AML_MAT2D_AT(Hw, i, idx);
+                    }
+                } else {
+                    ala_hessenberg_eigenvector_get(Hm, wr[idx], 0, &AML_MAT2D_AT(Ysel, w, 0), yi, LU, pivots, rhs);
+                }
+                AML_MAT2D_AT(eigenvalues, w, w) = wr[idx];
+                if (beta * aml_fabs(AML_MAT2D_AT(Ysel, w, m - 1)) <= bound) converged++;
+                w++;
+            } else if (w + 1 < k) {
+                aml_real *ry = &AML_MAT2D_AT(Ysel, w, 0);
+                aml_real *iy = &AML_MAT2D_AT(Ysel, w + 1, 0);
+                ala_hessenberg_eigenvector_get(Hm, wr[idx], aml_fabs(wi[idx]), ry, iy, LU, pivots, rhs);
+                AML_MAT2D_AT(eigenvalues, w, w)         = wr[idx];
+                AML_MAT2D_AT(eigenvalues, w, w + 1)     = aml_fabs(wi[idx]);
+                AML_MAT2D_AT(eigenvalues, w + 1, w)     = -aml_fabs(wi[idx]);
+                AML_MAT2D_AT(eigenvalues, w + 1, w + 1) = wr[idx];
+                if (beta * aml_hypot(ry[m - 1], iy[m - 1]) <= bound) converged += 2;
+                w += 2;
+            } else {
+                aml_fill(aml_create_block_ref(Ysel, w, 0, 1, m), 0);
+                target = k - 1;
+                w++;
+            }
+        }
+        if (converged >= target) {
+            break;
+        }
+        if (restart + 1 == ALA_KRYLOV_MAX_RESTARTS) {
+            aml_dprintWARNING("Did not converged after %zu iterations.", (size_t)ALA_KRYLOV_MAX_RESTARTS);
+            break;
+        }
 
-        ala_householder_top_element_vector_get(v, x);
-        if (AML_IS_ZERO(aml_inner_product(v))) {
-            continue;
+        /* implicit restart: filter the unwanted Ritz values out with exact
+         * shifts and keep a few extra vectors once some pairs converged */
+        size_t keep = aml_min(k + aml_min(converged, (m - k) / 2), m - 1);
+        if (!symmetric && wi[order[keep - 1]] > 0 && wi[order[keep]] < 0) {
+            keep = keep + 1 < m ? keep + 1 : keep - 1;
+        }
+        aml_set_identity(Q);
+        for (size_t i = keep; i < m; i++) {
+            const size_t idx = order[i];
+            if (wi[idx] < 0) continue;
+            ala_krylov_shift_apply(Hm, Q, m, wr[idx], wi[idx]);
+        }
+        for (size_t i = 0; i < m; i++) {
+            for (size_t j = 0; j < m; j++) {
+                if (i > j + 1 || (symmetric && j > i + 1)) AML_MAT2D_AT(Hm, i, j) = 0;
+            }
+            if (symmetric && i + 1 < m) {
+                aml_real off = (AML_MAT2D_AT(Hm, i + 1, i) + AML_MAT2D_AT(Hm, i, i + 1)) / 2;
+                AML_MAT2D_AT(Hm, i + 1, i) = off;
+                AML_MAT2D_AT(Hm, i, i + 1) = off;
+            }
         }
 
-        ala_apply_householder_left(H, k + 1, k, v);
-        ala_apply_householder_right(H, k + 1, v);
-        ala_apply_householder_right(Q, k + 1, v);
+        /* V_keep <- V * Q(:, 0:keep), f <- v_keep * H(keep, keep-1) + f * Q(m-1, keep-1) */
+        const aml_real h_keep = AML_MAT2D_AT(Hm, keep, keep - 1);
+        const aml_real sigma = AML_MAT2D_AT(Q, m - 1, keep - 1);
+        aml_transpose(QT, Q);
+        struct Aml_Mat2d Wk = aml_create_block_ref(W, 0, 0, keep + 1, n);
+        aml_gemm(Wk, 1, aml_create_block_ref(QT, 0, 0, keep + 1, m), aml_create_block_ref(Vt, 0, 0, m, n), 0);
+        aml_real *f = &AML_MAT2D_AT(W, keep, 0);
+        const aml_real *v_m = &AML_MAT2D_AT(Vt, m, 0);
+        for (size_t p = 0; p < n; p++) {
+            f[p] = h_keep * f[p] + beta * sigma * v_m[p];
+        }
+        aml_copy(aml_create_block_ref(Vt, 0, 0, keep + 1, n), Wk);
 
-        for (size_t i = k + 2; i < n; ++i) {
-            AML_MAT2D_AT(H, i, k) = 0;
+        for (size_t i = 0; i <= m; i++) {
+            for (size_t j = keep; j < m; j++) {
+                AML_MAT2D_AT(H, i, j) = 0;
+            }
+        }
+        for (size_t j = 0; j < keep; j++) {
+            AML_MAT2D_AT(H, keep, j) = 0;
+        }
+        aml_real *v_keep = &AML_MAT2D_AT(Vt, keep, 0);
+        aml_real f_norm = ala_krylov_orthogonalize(Vt, keep, v_keep, NULL);
+        if (f_norm > eps * (aml_fabs(h_keep) + aml_fabs(beta * sigma))) {
+            for (size_t p = 0; p < n; p++) {
+                v_keep[p] /= f_norm;
+            }
+            AML_MAT2D_AT(H, keep, keep - 1) = f_norm;
+        } else {
+            ala_krylov_random_vector(Vt, keep);
         }
+        j0 = keep;
     }
 
-    aml_mat2d_free(vbuf);
+    /* eigenvectors = V * Y */
+    struct Aml_Mat2d Xt = aml_create_block_ref(W, 0, 0, k, n);
+    aml_gemm(Xt, 1, Ysel, aml_create_block_ref(Vt, 0, 0, m, n), 0);
+    aml_transpose(eigenvectors, Xt);
+
+    aml_mat2d_free(Vt);
+    aml_mat2d_free(W);
+    aml_mat2d_free(H);
+    aml_mat2d_free(Hw);
+    aml_mat2d_free(Q);
+    aml_mat2d_free(QT);
+    aml_mat2d_free(Ysel);
+    aml_mat2d_free(LU);
+    aml_mat2d_free(rhs);
+    AML_FREE(h);
+    AML_FREE(order);
+    AML_FREE(pivots);
+
+    return converged;
 }
 
-ALA_DEF void ala_hessenberg_calc_double_shift(struct Aml_Mat2d m, size_t last, aml_real *trace, aml_real *det)
+/**
+ * @brief Compute k eigenpairs of a general matrix by implicitly restarted
+ * Arnoldi.
+ *
+ * The matrix is only touched through @p matvec, so dense, sparse and
+ * matrix-free operators all work; pass ala_matvec_dense() with a pointer to
+ * an Aml_Mat2d for a dense matrix. Each restart extends an orthonormal Krylov
+ * basis of @p basis_size vectors, then applies the unwanted Ritz values as
+ * exact shifts (implicit QR sweeps on the small Hessenberg projection), which
+ * keeps the wanted part of the spectrum without new matrix-vector products.
+ *
+ * Complex eigenvalues are returned in real form: a pair `a +- ib` occupies a
+ * 2x2 block `[[a, b], [-b, a]]` of @p eigenvalues, and the two matching
+ * columns of @p eigenvectors hold the real and imaginary parts of the
+ * eigenvector of `a + ib`. So `A * X = X * D` holds in real arithmetic.
+ *
+ * @param matvec Callback computing `y = A * x` for n x 1 vectors.
+ * @param context Passed through to @p matvec.
+ * @param eigenvalues Output k x k block diagonal matrix.
+ * @param eigenvectors Output n x k matrix; its shape sets n and k.
+ * @param which Which end of the spectrum to compute.
+ * @param basis_size Krylov basis size m, `k + 2 <= m <= n`; 0 picks
+ * `max(2k + 1, 20)`.
+ * @param tolerance Relative residual tolerance; 0 means `64 * epsilon`.
+ * @return Number of converged eigenvalues (a complex pair counts twice).
+ *
+ * Complexity
+ * `O(m)` matvecs and `O(n * m^2)` work per restart.
+ *
+ * @note If the k-th value is the first of a complex pair, that pair does not
+ * fit; its slot is left zero and at most k - 1 values are returned.
+ * @note The starting vector comes from aml_set_rand(), so results are
+ * reproducible for a fixed srand() seed.
+ */
+ALA_DEF size_t ala_eig_arnoldi(Ala_Matvec matvec, void *context, struct Aml_Mat2d eigenvalues, struct Aml_Mat2d eigenvectors, enum Ala_Eig_Which which, size_t basis_size, aml_real tolerance)
 {
-    ALA_ASSERT(aml_is_hessenberg(m));
-    ALA_ASSERT(m.rows > 0); 
-    ALA_ASSERT(last < m.rows); 
-    ALA_ASSERT(last > 0);
-
-    aml_real a, b, c, d;
-    
-    a = AML_MAT2D_AT(m, last - 1, last - 1);
-    b = AML_MAT2D_AT(m, last - 1, last);
-    c = AML_MAT2D_AT(m, last, last - 1);
-    d = AML_MAT2D_AT(m, last, last);
-
-    if (trace) *trace = a + d;
-    if (det) *det = a * d - b * c;
+    return ala_eig_krylov(matvec, context, eigenvalues, eigenvectors, which, basis_size, tolerance, false);
 }
 
-ALA_DEF bool ala_hessenberg_deflate_tail(struct Aml_Mat2d m, size_t *first, size_t *last, aml_real eps)
+/**
+ * @brief Verify a symmetric eigendecomposition.
+ *
+ * This routine checks:
+ * - that @p eigenvalues is diagonal,
+ * - orthogonality of `eigenvectors`,
+ * - the residual `A V - V D`,
+ * - the reconstruction `V D V^T - A`.
+ *
+ * Workspace is written into @p res.
+ *
+ * @param A Original square matrix.
+ * @param eigenvalues Diagonal matrix `D`.
+ * @param eigenvectors Eigenvector matrix `V`.
+ * @param res Workspace / residual matrix.
+ * @return `true` if all checks pass within a tolerance.
+ *
+ * Complexity
+ * `O(n^3)`.
+ *
+ * @note This routine assumes an orthonormal eigenbasis and the relation
+ * `A = V D V^T`.
+ */
+ALA_DEF bool ala_eig_check(struct Aml_Mat2d A, struct Aml_Mat2d eigenvalues, struct Aml_Mat2d eigenvectors, struct Aml_Mat2d res)
 {
-    ALA_ASSERT(aml_is_hessenberg(m));
-    ALA_ASSERT(m.rows == m.cols);
-    ALA_ASSERT(m.rows > 0);
+    ALA_ASSERT(A.cols == A.rows); 
+    ALA_ASSERT(eigenvalues.cols == A.cols);
+    ALA_ASSERT(eigenvalues.rows == A.rows);
+    ALA_ASSERT(eigenvectors.cols == A.cols);
+    ALA_ASSERT(eigenvectors.rows == A.rows);
+    ALA_ASSERT(res.cols == A.cols);
+    ALA_ASSERT(res.rows == A.rows);
 
-    size_t l = m.rows - 1;
+    struct Aml_Mat2d VL = aml_mat2d_alloc(A.rows, A.cols);
 
-    while (l > 1) {
-        aml_real sub_l = aml_fabs(AML_MAT2D_AT(m, l, l - 1));
-        aml_real sub_lm1 = aml_fabs(AML_MAT2D_AT(m, l - 1, l - 2));
-        aml_real dlm2 = aml_fabs(AML_MAT2D_AT(m, l - 2, l - 2));
-        aml_real dlm1 = aml_fabs(AML_MAT2D_AT(m, l - 1, l - 1));
-        aml_real dl = aml_fabs(AML_MAT2D_AT(m, l, l));
+    aml_real eps = AML_EPS * (aml_real)1e3;
+    aml_real norma;
 
-        /* first checking the 1x1 block and then the 2x2 block */
-        if (sub_l <= eps * (dl + dlm1)) {
-            AML_MAT2D_AT(m, l, l - 1) = 0;
-            --l;
-            continue;
-        }
-        // aml_real a = AML_MAT2D_AT(m, l - 1, l - 1);
-        // aml_real b = AML_MAT2D_AT(m, l - 1, l);
-        // aml_real c = AML_MAT2D_AT(m, l, l - 1);
-        // aml_real d = AML_MAT2D_AT(m, l, l);
-        // if (sub_lm1 <= eps * (dl + dlm1 + dlm2) && !ala_eigenvalues_real_2x2(a, b, c, d)) {
-        if (sub_lm1 <= eps * (dl + dlm1 + dlm2)) {
-            AML_MAT2D_AT(m, l - 1, l - 2) = 0;
-            l -= 2;
-            continue;
-        }
+    bool return_value = true;
 
-        break;
+    if (!aml_is_diagonal(eigenvalues)) {
+        aml_dprintWARNING("%s", "eigenvalues matrix is not diagonal.");
+        return_value = false;
     }
 
-    if (l == 0 || l == 1) {
-        if (first) *first = 0;
-        if (last)  *last = l;
-        return true;
+    /* orthogonality check */
+    aml_transpose(VL, eigenvectors);
+    aml_dot(res, VL, eigenvectors);
+    aml_set_identity(VL);
+    aml_sub(res, VL);
+    norma = aml_calc_norma(res);
+    if (aml_fabs(norma) > eps) {
+        aml_dprintWARNING("|V^T V - I| is to big = %g", norma);
+        return_value = false;
     }
 
-    size_t f = 0;
-    for (size_t k = l; k > 1; --k) {
+    /* |res| check */
+    aml_dot(res, A, eigenvectors);
+    aml_dot(VL, eigenvectors, eigenvalues);
+    aml_sub(res, VL);
+    norma = aml_calc_norma(res) / aml_calc_norma(A);
+    if (aml_fabs(norma) > eps) {
+        aml_dprintWARNING("|AV - VD| is to big = %g", norma);
+        return_value = false;
+    }
+
+    /* reconstruction check */
+    aml_transpose(VL, eigenvectors);
+    aml_dot(res, eigenvalues, VL);
+    aml_copy(VL, res);
+    aml_dot(res, eigenvectors, VL);
+    aml_sub(res, A);
+    norma = aml_calc_norma(res) / aml_calc_norma(A);
+    if (aml_fabs(norma) > eps) {
+        aml_dprintWARNING("|V D V^T - A| is to big = %g", norma);
+        return_value = false;
+    }
+
+    aml_mat2d_free(VL);
+    return return_value;
+}
+
+/**
+ * @brief Compute k eigenpairs of a symmetric matrix by implicitly restarted
+ * Lanczos.
+ *
+ * The symmetric counterpart of ala_eig_arnoldi(): the projection is kept
+ * tridiagonal, its eigenpairs come from an implicit QL iteration, and the
+ * basis is reorthogonalized in full so the Ritz vectors stay orthonormal.
+ * Only k vectors of length n plus the basis are stored, so this scales to
+ * matrices far too large for the dense eigensolvers.
+ *
+ * @param matvec Callback computing `y = A * x` for n x 1 vectors; `A` must be
+ * symmetric.
+ * @param context Passed through to @p matvec.
+ * @param eigenvalues Output k x k diagonal matrix, ordered by @p which.
+ * @param eigenvectors Output n x k matrix with orthonormal columns; its shape
+ * sets n and k.
+ * @param which Which end of the spectrum to compute.
+ * @param basis_size Krylov basis size m, `k + 1 <= m <= n`; 0 picks
+ * `max(2k + 1, 20)`.
+ * @param tolerance Relative residual tolerance; 0 means `64 * epsilon`.
+ * @return Number of converged eigenpairs.
+ *
+ * Complexity
+ * `O(m)` matvecs and `O(n * m^2)` work per restart.
+ *
+ * @note Clustered eigenvalues need a larger @p basis_size, not more restarts.
+ * @note The starting vector comes from aml_set_rand(), so results are
+ * reproducible for a fixed srand() seed.
+ */
+ALA_DEF size_t ala_eig_lanczos(Ala_Matvec matvec, void *context, struct Aml_Mat2d eigenvalues, struct Aml_Mat2d eigenvectors, enum Ala_Eig_Which which, size_t basis_size, aml_real tolerance)
+{
+    return ala_eig_krylov(matvec, context, eigenvalues, eigenvectors, which, basis_size, tolerance, true);
+}
+
+/**
+ * @brief Compute eigenpairs by repeated power iteration with deflation.
+ *
+ * The routine repeatedly:
+ * - seeds the next vector from @p init_vector,
+ * - projects out previously found columns,
+ * - calls ala_power_iterate(),
+ * - stores the eigenpair,
+ * - deflates `B <- B - lambda * v v^T`.
+ *
+ * @param A Input square matrix.
+ * @param eigenvalues Output diagonal matrix of eigenvalues.
+ * @param eigenvectors Output matrix whose columns are eigenvectors.
+ * @param init_vector Initial vector reused for each eigenpair.
+ * @param norm_inf_vectors If true, renormalize output eigenvectors with the
+ * infinity norm at the end.
+ *
+ * Complexity
+ * Approximately `O(AML_MAX_POWER_ITERATION * n^3)`.
+ *
+ * @note Best for small educational problems or when only a few dominant
+ * eigenpairs are needed and the assumptions roughly hold.
+ * @warning The source comment states assumptions that the eigenvectors form an
+ * orthonormal basis and that the largest eigenvalue is positive and unique.
+ */
+ALA_DEF void ala_eig_power_iteration(struct Aml_Mat2d A, struct Aml_Mat2d eigenvalues, struct Aml_Mat2d eigenvectors, struct Aml_Mat2d init_vector, bool norm_inf_vectors)
+{
+    /* https://www.youtube.com/watch?v=c8DIOzuZqBs */
+
+    /** Conditions:
+     *      - The eigenvectors must form an orthonormal basis 
+     *      - The largest eigenvalue must be positive and unique
+     */ 
+
+    ALA_ASSERT(A.cols == A.rows); 
+    ALA_ASSERT(eigenvalues.cols == A.cols);
+    ALA_ASSERT(eigenvalues.rows == A.rows);
+    ALA_ASSERT(eigenvectors.cols == A.cols);
+    ALA_ASSERT(eigenvectors.rows == A.rows);
+    ALA_ASSERT(init_vector.cols == 1);
+    ALA_ASSERT(init_vector.rows == A.rows);
+    ALA_ASSERT(aml_calc_norma_inf(init_vector) > 0);
+
+    aml_fill(eigenvalues, 0);
+    struct Aml_Mat2d B = aml_mat2d_alloc(A.rows, A.cols);
+    struct Aml_Mat2d temp_mat = aml_mat2d_alloc(A.rows, A.cols);
+    aml_copy(B, A);
+
+    for (int i = 0, shift_value = 0; i < (int)A.rows; i++) {
+        aml_copy_src_to_des_window(eigenvectors, init_vector, 0, i, init_vector.rows-1, i);
+        struct Aml_Mat2d v = {.cols = init_vector.cols,
+                   .elements = &AML_MAT2D_AT(eigenvectors, 0, i),
+                   .rows = init_vector.rows,
+                   .stride_r = eigenvectors.stride_r};
+        ala_project_out_columns(v, eigenvectors, i);
+        if (!AML_IS_ZERO(aml_calc_norma(v))) {
+            aml_normalize(v);
+        }
+        if (ala_power_iterate(B, v, &AML_MAT2D_AT(eigenvalues, i, i), (aml_real)shift_value, 0)) { /* norm_inf_v must be zero*/
+            shift_value++;
+            i--;
+            continue;
+        } else {
+            shift_value = 0;
+        }
+        if (!AML_IS_ZERO(aml_calc_norma(v))) {
+            aml_normalize(v);
+        }
+        aml_outer_product(temp_mat, v);
+        aml_mult(temp_mat, AML_MAT2D_AT(eigenvalues, i, i));
+        aml_sub(B, temp_mat);
+    }
+
+    if (norm_inf_vectors) {
+        for (size_t c = 0; c < eigenvectors.cols; c++) {
+            struct Aml_Mat2d v = {.cols = init_vector.cols,
+                    .elements = &AML_MAT2D_AT(eigenvectors, 0, c),
+                    .rows = init_vector.rows,
+                    .stride_r = eigenvectors.stride_r};
+            aml_normalize_inf(v);
+        }
+    }
+
+    aml_mat2d_free(B);
+    aml_mat2d_free(temp_mat);
+}
+
+ALA_DEF void ala_eigenpairs_sort(struct Aml_Mat2d eigenvalues, struct Aml_Mat2d eigenvectors)
+{
+    for (size_t i = 0; i < eigenvalues.cols - 1; i++) {
+        for (size_t j = i + 1; j < eigenvalues.cols; j++) {
+            if (aml_fabs(AML_MAT2D_AT(eigenvalues, i, i)) < aml_fabs(AML_MAT2D_AT(eigenvalues, j, j))) {
+                aml_cols_swap(eigenvalues, i, j);
+                aml_rows_swap(eigenvalues, i, j);
+                aml_cols_swap(eigenvectors, i, j);
+            }
+        }
+    }
+}
+
+ALA_DEF bool ala_eigenvalues_real_2x2(aml_real a, aml_real b, aml_real c, aml_real d)
+{
+    aml_real discriminant = (a - d) * (a - d) + 4 * b * c;
+    return (discriminant > 0) || (AML_IS_ZERO(discriminant)); 
+}
+
+/**
+ * @brief Compute Givens rotation parameters that zero the second entry.
+ *
+ * For inputs `(a11, a21)`, this returns `r = hypot(a11, a21)` and optionally
+ * stores `c = a11/r`, `s = a21/r`, so that applying the corresponding rotation
+ * from the left maps `[a11, a21]^T` to `[r, 0]^T`.
+ *
+ * @param a11 Top entry.
+ * @param a21 Bottom entry.
+ * @param c Optional output cosine.
+ * @param s Optional output sine.
+ * @return The rotated top value `r`.
+ *
+ * Complexity
+ * `O(1)`.
+ */
+ALA_DEF aml_real ala_givens_2x2_rotations_get_c_and_s(aml_real a11, aml_real a21, aml_real *c, aml_real *s)
+{
+    if (AML_IS_ZERO(a21)) {
+        if (c) *c = (aml_real)1;
+        if (s) *s = (aml_real)0;
+        return a11;
+    }
+
+    aml_real r = aml_hypot(a11, a21);
+    if (c) *c = a11 / r;
+    if (s) *s = a21 / r;
+    return r;
+}
+
+ALA_DEF void ala_hessenberg_decomposition_householder(struct Aml_Mat2d Q, struct Aml_Mat2d H, struct Aml_Mat2d A)
+{
+    ALA_ASSERT(A.rows == A.cols);
+    ALA_ASSERT(Q.rows == Q.cols);
+    ALA_ASSERT(H.rows == H.cols);
+    ALA_ASSERT(Q.rows == A.rows);
+    ALA_ASSERT(H.rows == A.rows);
+
+    size_t n = A.rows;
+    aml_copy(H, A);
+    aml_set_identity(Q);
+
+    if (n <= 2) return;
+
+    struct Aml_Mat2d vbuf = aml_mat2d_alloc(n, 1);
+
+    for (size_t k = 0; k < n - 2; ++k) {
+        struct Aml_Mat2d x = {
+            .rows = n - (k + 1),
+            .cols = 1,
+            .stride_r = H.stride_r,
+            .elements = &AML_MAT2D_AT(H, k + 1, k),
+        };
+        struct Aml_Mat2d v = {
+            .rows = x.rows,
+            .cols = 1,
+            .stride_r = vbuf.stride_r,
+            .elements = &AML_MAT2D_AT(vbuf, k + 1, 0),
+        };
+
+        ala_householder_top_element_vector_get(v, x);
+        if (AML_IS_ZERO(aml_inner_product(v))) {
+            continue;
+        }
+
+        ala_apply_householder_left(H, k + 1, k, v);
+        ala_apply_householder_right(H, k + 1, v);
+        ala_apply_householder_right(Q, k + 1, v);
+
+        for (size_t i = k + 2; i < n; ++i) {
+            AML_MAT2D_AT(H, i, k) = 0;
+        }
+    }
+
+    aml_mat2d_free(vbuf);
+}
+
+/* Householder reflector H = I - tau * v * v^T with H * x = beta * e_0 for the
+ * n entries of x at stride s. v[0] = 1 is not stored, v[1..n) overwrites
+ * x[1..n). Returns beta; tau = 0 means H = I. */
+static aml_real ala_householder_reflector_make(aml_real *x, size_t s, size_t n, aml_real *tau)
+{
+    const aml_real alpha = x[0];
+    aml_real scale = 0;
+    for (size_t i = 1; i < n; i++) {
+        scale = aml_fmax(scale, aml_fabs(x[i * s]));
+    }
+    if (scale == 0) {
+        *tau = 0;
+        return alpha;
+    }
+
+    /* scaled so that nearly eliminated columns do not underflow */
+    aml_real sum = 0;
+    for (size_t i = 1; i < n; i++) {
+        const aml_real xi = x[i * s] / scale;
+        sum += xi * xi;
+    }
+    aml_real beta = aml_hypot(alpha, scale * aml_sqrt(sum));
+    if (alpha >= 0) {
+        beta = -beta;
+    }
+    *tau = (beta - alpha) / beta;
+    const aml_real inv = 1 / (alpha - beta);
+    for (size_t i = 1; i < n; i++) {
+        x[i * s] *= inv;
+    }
+
+    return beta;
+}
+
+/* Column i of the upper triangular T of the compact WY form
+ * H_0 * ... * H_i = I - V * T * V^T, given its columns [0, i). V is unit lower
+ * trapezoidal. Leaves w[0..i) = V(:, 0:i)^T * V(:, i). */
+static void ala_householder_T_column_set(struct Aml_Mat2d T, struct Aml_Mat2d V, aml_real tau, size_t i, aml_real *w)
+{
+    for (size_t l = 0; l < i; l++) {
+        w[l] = AML_MAT2D_AT(V, i, l);
+    }
+    for (size_t r = i + 1; r < V.rows; r++) {
+        const aml_real *vrow = &AML_MAT2D_AT(V, r, 0);
+        const aml_real vr = vrow[i];
+        for (size_t l = 0; l < i; l++) {
+            w[l] += vrow[l] * vr;
+        }
+    }
+
+    for (size_t l = 0; l < i; l++) {
+        aml_real sum = 0;
+        for (size_t q = l; q < i; q++) {
+            sum += AML_MAT2D_AT(T, l, q) * w[q];
+        }
+        AML_MAT2D_AT(T, l, i) = -tau * sum;
+    }
+    AML_MAT2D_AT(T, i, i) = tau;
+}
+
+/* C <- (I - V * T * V^T) * C, or (I - V * T^T * V^T) * C when transpose is
+ * set, as three aml_gemm() calls. */
+static void ala_householder_block_apply_left(struct Aml_Mat2d C, struct Aml_Mat2d V, struct Aml_Mat2d T, bool transpose, struct Ala_Workspace *ws)
+{
+    const size_t k = V.cols;
+    if (C.rows == 0 || C.cols == 0 || k == 0) return;
+
+    const size_t mark = ws->used;
+    struct Aml_Mat2d Vt = ala_workspace_mat2d(ws, k, V.rows);
+    struct Aml_Mat2d Tx = ala_workspace_mat2d(ws, k, k);
+    struct Aml_Mat2d W  = ala_workspace_mat2d(ws, k, C.cols);
+    struct Aml_Mat2d TW = ala_workspace_mat2d(ws, k, C.cols);
+
+    aml_transpose(Vt, V);
+    if (transpose) {
+        aml_transpose(Tx, T);
+    } else {
+        aml_copy(Tx, T);
+    }
+    aml_gemm(W, 1, Vt, C, 0);
+    aml_gemm(TW, 1, Tx, W, 0);
+    aml_gemm(C, -1, V, TW, 1);
+
+    ws->used = mark;
+}
+
+/* C <- C * (I - V * T * V^T), as three aml_gemm() calls. */
+static void ala_householder_block_apply_right(struct Aml_Mat2d C, struct Aml_Mat2d V, struct Aml_Mat2d T, struct Ala_Workspace *ws)
+{
+    const size_t k = V.cols;
+    if (C.rows == 0 || C.cols == 0 || k == 0) return;
+
+    const size_t mark = ws->used;
+    struct Aml_Mat2d Vt = ala_workspace_mat2d(ws, k, V.rows);
+    struct Aml_Mat2d W  = ala_workspace_mat2d(ws, C.rows, k);
+    struct Aml_Mat2d WT = ala_workspace_mat2d(ws, C.rows, k);
+
+    aml_transpose(Vt, V);
+    aml_gemm(W, 1, C, V, 0);
+    aml_gemm(WT, 1, W, T, 0);
+    aml_gemm(C, -1, WT, Vt, 1);
+
+    ws->used = mark;
+}
+
+/**
+ * @brief Reduce a square matrix to upper Hessenberg form with blocked
+ * Householder reflectors.
+ *
+ * Same result as ala_hessenberg_decomposition_householder(), `H = Q^T * A * Q`,
+ * but the reflectors of each panel of ALA_HOUSEHOLDER_BLOCK_SIZE columns are
+ * gathered in compact WY form `I - V * T * V^T` together with `Y = A * V * T`.
+ * Each panel column is brought up to date from `V`, `T` and `Y` only; the rest
+ * of the matrix and `Q` are then updated once per panel with aml_gemm().
+ *
+ * @param Q Output orthogonal matrix. Not referenced if @p compute_Q is false.
+ * @param H Output upper Hessenberg matrix.
+ * @param A Input square matrix.
+ * @param compute_Q Whether to accumulate @p Q.
+ *
+ * Complexity
+ * `O(n^3)`; about 80% of the flops go through aml_gemm() (half of the
+ * reduction itself is matrix-vector products with the trailing matrix).
+ *
+ * @note ala_hessenberg_decomposition_householder_blocked_ws() does the same
+ * without allocating.
+ */
+ALA_DEF void ala_hessenberg_decomposition_householder_blocked(struct Aml_Mat2d Q, struct Aml_Mat2d H, struct Aml_Mat2d A, bool compute_Q)
+{
+    struct Ala_Workspace ws = ala_workspace_alloc(ala_workspace_size(ALA_WORKSPACE_HESSENBERG, A.rows, A.cols));
+    ala_hessenberg_decomposition_householder_blocked_ws(Q, H, A, compute_Q, &ws);
+    ala_workspace_free(ws);
+}
+
+/**
+ * @brief ala_hessenberg_decomposition_householder_blocked() with its
+ * temporaries taken from a workspace.
+ *
+ * @param Q Output orthogonal matrix. Not referenced if @p compute_Q is false.
+ * @param H Output upper Hessenberg matrix.
+ * @param A Input square matrix.
+ * @param compute_Q Whether to accumulate @p Q.
+ * @param ws Workspace of at least
+ * `ala_workspace_size(ALA_WORKSPACE_HESSENBERG, n, n)` bytes.
+ */
+ALA_DEF void ala_hessenberg_decomposition_householder_blocked_ws(struct Aml_Mat2d Q, struct Aml_Mat2d H, struct Aml_Mat2d A, bool compute_Q, struct Ala_Workspace *ws)
+{
+    ALA_ASSERT(A.rows == A.cols);
+    ALA_ASSERT(H.rows == H.cols);
+    ALA_ASSERT(H.rows == A.rows);
+    if (compute_Q) {
+        ALA_ASSERT(Q.rows == Q.cols);
+        ALA_ASSERT(Q.rows == A.rows);
+    }
+
+    const size_t n = A.rows;
+    aml_copy(H, A);
+    if (compute_Q) {
+        aml_set_identity(Q);
+    }
+
+    if (n <= 2) return;
+
+    const size_t nb = ALA_HOUSEHOLDER_BLOCK_SIZE;
+    const size_t s = H.stride_r;
+    aml_real *h = H.elements;
+    aml_real w[ALA_HOUSEHOLDER_BLOCK_SIZE];
+
+    const size_t mark = ws->used;
+    struct Aml_Mat2d Vbuf = ala_workspace_mat2d(ws, n, nb);
+    struct Aml_Mat2d Tbuf = ala_workspace_mat2d(ws, nb, nb);
+    struct Aml_Mat2d Ybuf = ala_workspace_mat2d(ws, n, nb);
+    aml_real *v = (aml_real *)ala_workspace_take(ws, sizeof(*v) * n);
+    const size_t panel_mark = ws->used;
+
+    for (size_t j0 = 0; j0 < n - 2; j0 += nb) {
+        const size_t jb = aml_min(nb, n - 2 - j0);
+        const size_t j1 = j0 + jb;
+        const size_t r0 = j0 + 1;
+        struct Aml_Mat2d V  = aml_create_block_ref(Vbuf, 0, 0, n - r0, jb);
+        struct Aml_Mat2d Tb = aml_create_block_ref(Tbuf, 0, 0, jb, jb);
+        struct Aml_Mat2d Y  = aml_create_block_ref(Ybuf, 0, 0, n, jb);
+        aml_fill(Tb, 0);
+
+        for (size_t i = 0; i < jb; i++) {
+            const size_t c = j0 + i;
+
+            if (i > 0) {
+                /* A(:, c) -= Y(:, 0:i) * V(c, 0:i)^T */
+                const aml_real *vc = &AML_MAT2D_AT(V, c - r0, 0);
+                for (size_t r = 0; r < n; r++) {
+                    const aml_real *yrow = &AML_MAT2D_AT(Y, r, 0);
+                    aml_real sum = 0;
+                    for (size_t l = 0; l < i; l++) {
+                        sum += yrow[l] * vc[l];
+                    }
+                    h[r * s + c] -= sum;
+                }
+
+                /* A(r0:, c) -= V * T^T * V^T * A(r0:, c) */
+                for (size_t l = 0; l < i; l++) {
+                    w[l] = 0;
+                }
+                for (size_t r = r0; r < n; r++) {
+                    const aml_real *vrow = &AML_MAT2D_AT(V, r - r0, 0);
+                    const aml_real x = h[r * s + c];
+                    for (size_t l = 0; l < i; l++) {
+                        w[l] += vrow[l] * x;
+                    }
+                }
+                for (size_t l = i; l-- > 0;) {
+                    aml_real sum = 0;
+                    for (size_t q = 0; q <= l; q++) {
+                        sum += AML_MAT2D_AT(Tb, q, l) * w[q];
+                    }
+                    w[l] = sum;
+                }
+                for (size_t r = r0; r < n; r++) {
+                    const aml_real *vrow = &AML_MAT2D_AT(V, r - r0, 0);
+                    aml_real sum = 0;
+                    for (size_t l = 0; l < i; l++) {
+                        sum += vrow[l] * w[l];
+                    }
+                    h[r * s + c] -= sum;
+                }
+            }
+
+            aml_real tau;
+            const aml_real beta = ala_householder_reflector_make(h + (c + 1) * s + c, s, n - c - 1, &tau);
+            v[0] = 1;
+            for (size_t l = 1; l < n - c - 1; l++) {
+                v[l] = h[(c + 1 + l) * s + c];
+            }
+            for (size_t l = 0; l < V.rows; l++) {
+                AML_MAT2D_AT(V, l, i) = l < i ? (aml_real)0 : v[l - i];
+            }
+            h[(c + 1) * s + c] = beta;
+            for (size_t r = c + 2; r < n; r++) {
+                h[r * s + c] = 0;
+            }
+            ala_householder_T_column_set(Tb, V, tau, i, w);
+
+            /* Y(:, i) = tau * (A * v - Y(:, 0:i) * V^T * v); the columns
+             * right of c are still those of A at the start of the panel */
+            for (size_t r = 0; r < n; r++) {
+                const aml_real *hrow = h + r * s + c + 1;
+                const aml_real *yrow = &AML_MAT2D_AT(Y, r, 0);
+                aml_real sum = ala_dot_contiguous(hrow, v, n - c - 1);
+                for (size_t q = 0; q < i; q++) {
+                    sum -= yrow[q] * w[q];
+                }
+                AML_MAT2D_AT(Y, r, i) = tau * sum;
+            }
+        }
+
+        /* A(:, j1:) -= Y * V(j1:, :)^T, then A(r0:, j1:) <- Q_panel^T * A(r0:, j1:) */
+        struct Aml_Mat2d Vt = ala_workspace_mat2d(ws, jb, n - j1);
+        aml_transpose(Vt, aml_create_block_ref(V, j1 - r0, 0, n - j1, jb));
+        aml_gemm(aml_create_block_ref(H, 0, j1, n, n - j1), -1, Y, Vt, 1);
+        ws->used = panel_mark;
+        ala_householder_block_apply_left(aml_create_block_ref(H, r0, j1, n - r0, n - j1), V, Tb, true, ws);
+
+        if (compute_Q) {
+            ala_householder_block_apply_right(aml_create_block_ref(Q, 0, r0, n, n - r0), V, Tb, ws);
+        }
+    }
+
+    ws->used = mark;
+}
+
+ALA_DEF void ala_hessenberg_calc_double_shift(struct Aml_Mat2d m, size_t last, aml_real *trace, aml_real *det)
+{
+    ALA_ASSERT(aml_is_hessenberg(m));
+    ALA_ASSERT(m.rows > 0); 
+    ALA_ASSERT(last < m.rows); 
+    ALA_ASSERT(last > 0);
+
+    aml_real a, b, c, d;
+    
+    a = AML_MAT2D_AT(m, last - 1, last - 1);
+    b = AML_MAT2D_AT(m, last - 1, last);
+    c = AML_MAT2D_AT(m, last, last - 1);
+    d = AML_MAT2D_AT(m, last, last);
+
+    if (trace) *trace = a + d;
+    if (det) *det = a * d - b * c;
+}
+
+ALA_DEF bool ala_hessenberg_deflate_tail(struct Aml_Mat2d m, size_t *first, size_t *last, aml_real eps)
+{
+    ALA_ASSERT(aml_is_hessenberg(m));
+    ALA_ASSERT(m.rows == m.cols);
+    ALA_ASSERT(m.rows > 0);
+
+    size_t l = m.rows - 1;
+
+    while (l > 1) {
+        aml_real sub_l = aml_fabs(AML_MAT2D_AT(m, l, l - 1));
+        aml_real sub_lm1 = aml_fabs(AML_MAT2D_AT(m, l - 1, l - 2));
+        aml_real dlm2 = aml_fabs(AML_MAT2D_AT(m, l - 2, l - 2));
+        aml_real dlm1 = aml_fabs(AML_MAT2D_AT(m, l - 1, l - 1));
+        aml_real dl = aml_fabs(AML_MAT2D_AT(m, l, l));
+
+        /* first checking the 1x1 block and then the 2x2 block */
+        if (sub_l <= eps * (dl + dlm1)) {
+            AML_MAT2D_AT(m, l, l - 1) = 0;
+            --l;
+            continue;
+        }
+        // aml_real a = AML_MAT2D_AT(m, l - 1, l - 1);
+        // aml_real b = AML_MAT2D_AT(m, l - 1, l);
+        // aml_real c = AML_MAT2D_AT(m, l, l - 1);
+        // aml_real d = AML_MAT2D_AT(m, l, l);
+        // if (sub_lm1 <= eps * (dl + dlm1 + dlm2) && !ala_eigenvalues_real_2x2(a, b, c, d)) {
+        if (sub_lm1 <= eps * (dl + dlm1 + dlm2)) {
+            AML_MAT2D_AT(m, l - 1, l - 2) = 0;
+            l -= 2;
+            continue;
+        }
+
+        break;
+    }
+
+    if (l == 0 || l == 1) {
+        if (first) *first = 0;
+        if (last)  *last = l;
+        return true;
+    }
+
+    size_t f = 0;
+    for (size_t k = l; k > 1; --k) {
         aml_real sub_k = aml_fabs(AML_MAT2D_AT(m, k, k - 1));
         aml_real sub_km1 = aml_fabs(AML_MAT2D_AT(m, k - 1, k - 2));
         aml_real dkm2 = aml_fabs(AML_MAT2D_AT(m, k - 2, k - 2));
@@ -1280,10 +2573,10 @@ ALA_DEF void ala_householder_top_element_vector_get(struct Aml_Mat2d v_des, stru
 }
 
 /**
- * @brief Invert a square matrix by Gauss-Jordan elimination.
+ * @brief Invert a square matrix.
  *
- * The implementation forms `[src | I]`, reduces it to RREF using ala_reduce(),
- * and copies the right block into @p des.
+ * Factors a copy of @p src with ala_LUP_factor() and solves `src * des = I`
+ * with ala_LUP_invert().
  *
  * @param des Output inverse matrix.
  * @param src Input square matrix.
@@ -1291,32 +2584,49 @@ ALA_DEF void ala_householder_top_element_vector_get(struct Aml_Mat2d v_des, stru
  * Complexity
  * `O(n^3)`.
  *
- * @warning No explicit singularity handling beyond what the reduction routine
- * naturally produces.
+ * @warning A singular @p src is reported with a warning and yields
+ * non-finite entries.
+ * @note ala_invert_ws() does the same without allocating.
  */
 ALA_DEF void ala_invert(struct Aml_Mat2d des, struct Aml_Mat2d src)
+{
+    struct Ala_Workspace ws = ala_workspace_alloc(ala_workspace_size(ALA_WORKSPACE_INVERT, src.rows, src.cols));
+    ala_invert_ws(des, src, &ws);
+    ala_workspace_free(ws);
+}
+
+/**
+ * @brief ala_invert() with its temporaries taken from a workspace.
+ *
+ * @param des Output inverse matrix.
+ * @param src Input square matrix.
+ * @param ws Workspace of at least
+ * `ala_workspace_size(ALA_WORKSPACE_INVERT, n, n)` bytes.
+ */
+ALA_DEF void ala_invert_ws(struct Aml_Mat2d des, struct Aml_Mat2d src, struct Ala_Workspace *ws)
 {
     ALA_ASSERT(src.cols == src.rows && "Must be an NxN matrix");
     ALA_ASSERT(des.cols == src.cols && des.rows == des.cols);
 
-    struct Aml_Mat2d m = aml_mat2d_alloc(src.rows, src.cols * 2);
-    aml_copy_src_to_des_window(m, src, 0, 0, src.rows-1, src.cols-1);
-
-    aml_set_identity(des);
-    aml_copy_src_to_des_window(m, des, 0, src.cols, des.rows-1, 2 * des.cols-1);
-    
-    ala_reduce(m);
+    const size_t mark = ws->used;
+    struct Aml_Mat2d LU = ala_workspace_mat2d(ws, src.rows, src.cols);
+    size_t *pivots = (size_t *)ala_workspace_take(ws, sizeof(*pivots) * src.rows);
 
-    aml_copy_src_window_to_des(des, m, 0, src.cols, des.rows-1, 2 * des.cols-1);
+    aml_copy(LU, src);
+    if (!ala_LUP_factor(LU, pivots)) {
+        aml_dprintWARNING("%s", "matrix is singular.");
+    }
+    ala_LUP_invert(des, LU, pivots);
 
-    aml_mat2d_free(m);
+    ws->used = mark;
 }
 
 /**
- * @brief Compute an LUP decomposition with row swaps when a pivot is zero.
+ * @brief Compute an LUP decomposition into separate `P`, `L` and `U`.
  *
- * On return, `src` has been decomposed into permutation matrix `p`, unit-lower
- * triangular `l`, and upper triangular `u`.
+ * On return, `P * src = L * U` with permutation matrix `p`, unit-lower
+ * triangular `l`, and upper triangular `u`. The factorization itself is
+ * ala_LUP_factor() (blocked, partial pivoting), run in @p u.
  *
  * @param src Input matrix.
  * @param l Output lower-triangular factor with unit diagonal.
@@ -1326,15 +2636,11 @@ ALA_DEF void ala_invert(struct Aml_Mat2d des, struct Aml_Mat2d src)
  * Complexity
  * `O(n^3)` for square matrices.
  *
- * @note This implementation only searches for a pivot row when the current
- * diagonal pivot is numerically zero; it is not full partial pivoting at every
- * step.
- * @note Best as a simple/reference LU decomposition. For difficult numerical
- * problems, always-on pivoting would be better.
+ * @note To solve, invert or take the determinant, ala_LUP_factor() with its
+ * pivot vector avoids the dense `P`, `L` and `U` copies.
  */
 ALA_DEF void ala_LUP_decomposition_with_swap(struct Aml_Mat2d src, struct Aml_Mat2d l, struct Aml_Mat2d p, struct Aml_Mat2d u)
 {
-    /* performing LU decomposition Following the Wikipedia page: https://en.wikipedia.org/wiki/LU_decomposition */
     /**
      * Rectangular LUP decomposition with partial pivoting:
      *
@@ -1353,55 +2659,260 @@ ALA_DEF void ala_LUP_decomposition_with_swap(struct Aml_Mat2d src, struct Aml_Ma
     ALA_ASSERT(u.rows == l.cols);
     ALA_ASSERT(u.cols == src.cols);
 
+    size_t steps = aml_min(src.rows, src.cols);
+    size_t *pivots = (size_t *)AML_MALLOC(sizeof(*pivots) * (steps ? steps : 1));
+    ALA_ASSERT(pivots != NULL);
+
     aml_copy(u, src);
+    ala_LUP_factor(u, pivots);
+
     aml_set_identity(p);
     aml_set_identity(l);
+    for (size_t i = 0; i < steps; i++) {
+        if (pivots[i] != i) {
+            aml_rows_swap(p, i, pivots[i]);
+        }
+    }
+    for (size_t i = 1; i < u.rows; i++) {
+        for (size_t j = 0; j < aml_min(i, steps); j++) {
+            AML_MAT2D_AT(l, i, j) = AML_MAT2D_AT(u, i, j);
+            AML_MAT2D_AT(u, i, j) = 0;
+        }
+    }
 
-    aml_real scale = aml_calc_norma_inf(src);
-    if (AML_IS_ZERO(scale)) return;
+    AML_FREE(pivots);
+}
 
-    aml_real tol = AML_EPS * scale;
-    size_t steps = aml_min(src.rows, src.cols);
-    for (size_t i = 0; i < steps; i++) {
-        /* partial pivoting: find largest entry in column i from row i downward */
-        size_t pivot_r = i;
-        aml_real best = aml_fabs(AML_MAT2D_AT(u, i, i));
-        for (size_t r = i + 1; r < u.rows; r++) {
-            aml_real v = aml_fabs(AML_MAT2D_AT(u, r, i));
+/**
+ * @brief Compute the determinant from an LUP factorization.
+ *
+ * Multiplies the diagonal of `U` and flips the sign once per row swap
+ * recorded in @p pivots.
+ *
+ * @param LU Square matrix factored by ala_LUP_factor().
+ * @param pivots Pivot indices from ala_LUP_factor().
+ * @return Determinant of the original matrix.
+ *
+ * Complexity
+ * `O(n)`.
+ */
+ALA_DEF aml_real ala_LUP_det(struct Aml_Mat2d LU, const size_t *pivots)
+{
+    ALA_ASSERT(LU.rows == LU.cols && "should be a square matrix");
+
+    aml_real det = 1;
+    for (size_t i = 0; i < LU.rows; i++) {
+        det *= AML_MAT2D_AT(LU, i, i);
+        if (pivots[i] != i) {
+            det = -det;
+        }
+    }
+
+    return det;
+}
+
+/* Unblocked right-looking LU of columns [k0, k0 + kb) of rows [k0, rows),
+ * swapping whole rows so the columns outside the panel follow the pivots. */
+static bool ala_LUP_factor_panel(struct Aml_Mat2d LU, size_t *pivots, size_t k0, size_t kb)
+{
+    const size_t s = LU.stride_r;
+    aml_real *a = LU.elements;
+    bool nonsingular = true;
+
+    for (size_t k = k0; k < k0 + kb; k++) {
+        size_t pivot_r = k;
+        aml_real best = aml_fabs(a[k * s + k]);
+        for (size_t r = k + 1; r < LU.rows; r++) {
+            aml_real v = aml_fabs(a[r * s + k]);
             if (v > best) {
                 best = v;
                 pivot_r = r;
             }
         }
-        /* if whole pivot column below i is zero, skip this column */
-        if (AML_IS_ZERO(best)) {
-            for (size_t temp_r = i + 1; temp_r < u.rows; temp_r++) {
-                AML_MAT2D_AT(u, temp_r, i) = 0;
+        pivots[k] = pivot_r;
+        if (pivot_r != k) {
+            aml_rows_swap(LU, k, pivot_r);
+        }
+        if (best == 0) {
+            /* the column is already eliminated, U(k,k) stays 0 */
+            nonsingular = false;
+            continue;
+        }
+
+        const aml_real inv_pivot = 1 / a[k * s + k];
+        const aml_real *urow = a + k * s;
+        for (size_t r = k + 1; r < LU.rows; r++) {
+            aml_real *arow = a + r * s;
+            const aml_real l = arow[k] * inv_pivot;
+            arow[k] = l;
+            for (size_t j = k + 1; j < k0 + kb; j++) {
+                arow[j] -= l * urow[j];
             }
+        }
+    }
+
+    return nonsingular;
+}
+
+/**
+ * @brief Factor a matrix in place as `P * A = L * U` with partial pivoting.
+ *
+ * Blocked right-looking algorithm: each panel of ALA_LUP_BLOCK_SIZE columns is
+ * factored with partial pivoting (the largest entry of the column becomes the
+ * pivot at every step), the block row of `U` to its right is solved against
+ * the panel's unit-lower triangle, and the trailing matrix is updated with a
+ * single aml_gemm(). Almost all of the work is in the GEMM updates.
+ *
+ * On return the strict lower part of @p LU holds `L` (its unit diagonal is not
+ * stored) and the upper part holds `U`. Row `i` was swapped with row
+ * `pivots[i]` at step `i`. The factorization can be reused for many solves
+ * (ala_LUP_solve()), the inverse (ala_LUP_invert()) and the determinant
+ * (ala_LUP_det()).
+ *
+ * @param LU Matrix `A` on input, `L` and `U` on output. May be rectangular.
+ * @param pivots Output array of `min(rows, cols)` pivot row indices.
+ * @return `false` if some pivot is exactly zero, i.e. `A` is singular; the
+ * factorization is still completed.
+ *
+ * Complexity
+ * `O(rows * cols * min(rows, cols))`.
+ */
+ALA_DEF bool ala_LUP_factor(struct Aml_Mat2d LU, size_t *pivots)
+{
+    const size_t steps = aml_min(LU.rows, LU.cols);
+    const size_t s = LU.stride_r;
+    aml_real *a = LU.elements;
+    bool nonsingular = true;
+
+    for (size_t k0 = 0; k0 < steps; k0 += ALA_LUP_BLOCK_SIZE) {
+        const size_t kb = aml_min((size_t)ALA_LUP_BLOCK_SIZE, steps - k0);
+        const size_t k1 = k0 + kb;
+
+        if (!ala_LUP_factor_panel(LU, pivots, k0, kb)) {
+            nonsingular = false;
+        }
+        if (k1 >= LU.cols) {
             continue;
         }
-        if (pivot_r != i) {
-            aml_rows_swap(u, i, pivot_r);
-            aml_rows_swap(p, i, pivot_r);
-            /* Swap only the already computed multipliers in L: columns [0, i) */
-            for (size_t c = 0; c < i; c++) {
-                aml_real tmp = AML_MAT2D_AT(l, i, c);
-                AML_MAT2D_AT(l, i, c) = AML_MAT2D_AT(l, pivot_r, c);
-                AML_MAT2D_AT(l, pivot_r, c) = tmp;
-            }
-        }
-        aml_real pivot = AML_MAT2D_AT(u, i, i);
-        for (size_t temp_r = i + 1; temp_r < u.rows; temp_r++) {
-            aml_real a = AML_MAT2D_AT(u, temp_r, i);
-            if (aml_fabs(a) <= tol) {
-                AML_MAT2D_AT(u, temp_r, i) = 0;
-                continue;
+
+        /* U12 = inv(L11) * A12 */
+        for (size_t i = k0 + 1; i < k1; i++) {
+            aml_real *arow = a + i * s;
+            for (size_t r = k0; r < i; r++) {
+                const aml_real l = arow[r];
+                const aml_real *urow = a + r * s;
+                for (size_t j = k1; j < LU.cols; j++) {
+                    arow[j] -= l * urow[j];
+                }
+            }
+        }
+
+        /* A22 -= L21 * U12 */
+        if (k1 < LU.rows) {
+            struct Aml_Mat2d a22 = aml_create_block_ref(LU, k1, k1, LU.rows - k1, LU.cols - k1);
+            struct Aml_Mat2d l21 = aml_create_block_ref(LU, k1, k0, LU.rows - k1, kb);
+            struct Aml_Mat2d u12 = aml_create_block_ref(LU, k0, k1, kb, LU.cols - k1);
+            aml_gemm(a22, -1, l21, u12, 1);
+        }
+    }
+
+    return nonsingular;
+}
+
+/**
+ * @brief Compute the inverse from an LUP factorization.
+ *
+ * Solves `A * X = I` with ala_LUP_solve().
+ *
+ * @param des Output inverse matrix.
+ * @param LU Square matrix factored by ala_LUP_factor().
+ * @param pivots Pivot indices from ala_LUP_factor().
+ *
+ * Complexity
+ * `O(n^3)`.
+ */
+ALA_DEF void ala_LUP_invert(struct Aml_Mat2d des, struct Aml_Mat2d LU, const size_t *pivots)
+{
+    ALA_ASSERT(LU.rows == LU.cols && "Must be an NxN matrix");
+    ALA_ASSERT(des.rows == LU.rows && des.cols == LU.cols);
+
+    aml_set_identity(des);
+    ala_LUP_solve(LU, pivots, des);
+}
+
+/**
+ * @brief Solve `A * X = B` in place from an LUP factorization.
+ *
+ * Applies the row swaps to @p B, then runs blocked forward substitution with
+ * `L` and back substitution with `U`; off-diagonal blocks are applied with
+ * aml_gemm(), so many right-hand sides are solved at GEMM speed.
+ *
+ * @param LU Square matrix factored by ala_LUP_factor().
+ * @param pivots Pivot indices from ala_LUP_factor().
+ * @param B Right-hand sides on input (one per column), solutions on output.
+ *
+ * Complexity
+ * `O(n^2 * B.cols)`.
+ *
+ * @warning A singular factorization divides by zero.
+ */
+ALA_DEF void ala_LUP_solve(struct Aml_Mat2d LU, const size_t *pivots, struct Aml_Mat2d B)
+{
+    ALA_ASSERT(LU.rows == LU.cols && "Must be an NxN matrix");
+    ALA_ASSERT(B.rows == LU.rows);
+
+    const size_t n = LU.rows;
+    const size_t nb = ALA_LUP_BLOCK_SIZE;
+    const size_t ls = LU.stride_r;
+    const size_t bs = B.stride_r;
+    const aml_real *lu = LU.elements;
+    aml_real *b = B.elements;
+
+    for (size_t i = 0; i < n; i++) {
+        if (pivots[i] != i) {
+            aml_rows_swap(B, i, pivots[i]);
+        }
+    }
+
+    /* L * Y = P * B */
+    for (size_t i0 = 0; i0 < n; i0 += nb) {
+        const size_t i1 = aml_min(i0 + nb, n);
+        if (i0 > 0) {
+            aml_gemm(aml_create_block_ref(B, i0, 0, i1 - i0, B.cols), -1, aml_create_block_ref(LU, i0, 0, i1 - i0, i0), aml_create_block_ref(B, 0, 0, i0, B.cols), 1);
+        }
+        for (size_t i = i0 + 1; i < i1; i++) {
+            aml_real *brow = b + i * bs;
+            for (size_t r = i0; r < i; r++) {
+                const aml_real l = lu[i * ls + r];
+                const aml_real *yrow = b + r * bs;
+                for (size_t j = 0; j < B.cols; j++) {
+                    brow[j] -= l * yrow[j];
+                }
+            }
+        }
+    }
+
+    /* U * X = Y, last block first */
+    for (size_t i1 = n; i1 > 0;) {
+        const size_t i0 = i1 > nb ? i1 - nb : 0;
+        if (i1 < n) {
+            aml_gemm(aml_create_block_ref(B, i0, 0, i1 - i0, B.cols), -1, aml_create_block_ref(LU, i0, i1, i1 - i0, n - i1), aml_create_block_ref(B, i1, 0, n - i1, B.cols), 1);
+        }
+        for (size_t i = i1; i-- > i0;) {
+            aml_real *brow = b + i * bs;
+            for (size_t r = i + 1; r < i1; r++) {
+                const aml_real u = lu[i * ls + r];
+                const aml_real *xrow = b + r * bs;
+                for (size_t j = 0; j < B.cols; j++) {
+                    brow[j] -= u * xrow[j];
+                }
+            }
+            const aml_real inv_diag = 1 / lu[i * ls + i];
+            for (size_t j = 0; j < B.cols; j++) {
+                brow[j] *= inv_diag;
             }
-            aml_real mult = a / pivot;
-            AML_MAT2D_AT(l, temp_r, i) = mult;
-            aml_sub_src_row_time_factor_from_des_row_range(u, temp_r, i, mult, i, u.cols-1);
-            AML_MAT2D_AT(u, temp_r, i) = 0;
         }
+        i1 = i0;
     }
 }
 
@@ -1529,6 +3040,29 @@ ALA_DEF void ala_make_orthogonal_modified_Gram_Schmidt(struct Aml_Mat2d des, str
     aml_mat2d_free(temp_col);    
 }
 
+/**
+ * @brief Ala_Matvec callback for a dense matrix: `y = A * x`.
+ *
+ * @param y Output n x 1 vector.
+ * @param x Input vector.
+ * @param A Pointer to the `struct Aml_Mat2d` to multiply with.
+ */
+ALA_DEF void ala_matvec_dense(struct Aml_Mat2d y, struct Aml_Mat2d x, void *A)
+{
+    const struct Aml_Mat2d a = *(const struct Aml_Mat2d *)A;
+    ALA_ASSERT(a.cols == x.rows);
+    ALA_ASSERT(a.rows == y.rows);
+    ALA_ASSERT(x.cols == 1 && y.cols == 1);
+
+    if (x.stride_r != 1) {
+        aml_gemm(y, 1, a, x, 0);
+        return;
+    }
+    for (size_t i = 0; i < a.rows; i++) {
+        AML_MAT2D_AT(y, i, 0) = ala_dot_contiguous(&AML_MAT2D_AT(a, i, 0), x.elements, a.cols);
+    }
+}
+
 ALA_DEF bool ala_positive_definite_check(struct Aml_Mat2d A)
 {
     ALA_ASSERT(A.rows == A.cols);
@@ -1714,6 +3248,85 @@ ALA_DEF void ala_project_out_columns(struct Aml_Mat2d v, struct Aml_Mat2d basis,
     aml_mat2d_free(temp);
 }
 
+/* Explicit V (unit lower trapezoidal) and T of the compact WY form of the jb
+ * reflectors that ala_QR_factor() stored in columns [j0, j0 + jb). */
+static void ala_QR_block_WY_get(struct Aml_Mat2d V, struct Aml_Mat2d T, struct Aml_Mat2d QR, const aml_real *tau, size_t j0, aml_real *w)
+{
+    for (size_t r = 0; r < V.rows; r++) {
+        for (size_t l = 0; l < V.cols; l++) {
+            AML_MAT2D_AT(V, r, l) = r < l ? (aml_real)0 : r == l ? (aml_real)1 : AML_MAT2D_AT(QR, j0 + r, j0 + l);
+        }
+    }
+    aml_fill(T, 0);
+    for (size_t i = 0; i < V.cols; i++) {
+        ala_householder_T_column_set(T, V, tau[j0 + i], i, w);
+    }
+}
+
+/**
+ * @brief Apply the orthogonal factor of ala_QR_factor() to a matrix in place.
+ *
+ * Computes `B <- Q^T * B` (@p transpose) or `B <- Q * B` without forming `Q`:
+ * the reflectors are applied one block of ALA_HOUSEHOLDER_BLOCK_SIZE at a time
+ * in compact WY form with aml_gemm(). Use it for least squares (`Q^T * b`) or
+ * to get only the columns of `Q` that are needed.
+ *
+ * @param QR Matrix factored by ala_QR_factor().
+ * @param tau Reflector scalars from ala_QR_factor().
+ * @param B Matrix with `QR.rows` rows, overwritten with the product.
+ * @param transpose Apply `Q^T` instead of `Q`.
+ *
+ * Complexity
+ * `O(QR.rows * min(QR.rows, QR.cols) * B.cols)`.
+ *
+ * @note ala_QR_apply_Q_ws() does the same without allocating.
+ */
+ALA_DEF void ala_QR_apply_Q(struct Aml_Mat2d QR, const aml_real *tau, struct Aml_Mat2d B, bool transpose)
+{
+    struct Ala_Workspace ws = ala_workspace_alloc(ala_workspace_size(ALA_WORKSPACE_QR_APPLY_Q, B.rows, B.cols));
+    ala_QR_apply_Q_ws(QR, tau, B, transpose, &ws);
+    ala_workspace_free(ws);
+}
+
+/**
+ * @brief ala_QR_apply_Q() with its temporaries taken from a workspace.
+ *
+ * @param QR Matrix factored by ala_QR_factor().
+ * @param tau Reflector scalars from ala_QR_factor().
+ * @param B Matrix with `QR.rows` rows, overwritten with the product.
+ * @param transpose Apply `Q^T` instead of `Q`.
+ * @param ws Workspace of at least
+ * `ala_workspace_size(ALA_WORKSPACE_QR_APPLY_Q, B.rows, B.cols)` bytes.
+ */
+ALA_DEF void ala_QR_apply_Q_ws(struct Aml_Mat2d QR, const aml_real *tau, struct Aml_Mat2d B, bool transpose, struct Ala_Workspace *ws)
+{
+    ALA_ASSERT(B.rows == QR.rows);
+
+    const size_t m = QR.rows;
+    const size_t steps = aml_min(QR.rows, QR.cols);
+    const size_t nb = ALA_HOUSEHOLDER_BLOCK_SIZE;
+    if (steps == 0 || B.cols == 0) return;
+
+    aml_real w[ALA_HOUSEHOLDER_BLOCK_SIZE];
+    const size_t mark = ws->used;
+    struct Aml_Mat2d Vbuf = ala_workspace_mat2d(ws, m, nb);
+    struct Aml_Mat2d Tbuf = ala_workspace_mat2d(ws, nb, nb);
+
+    /* Q = H_0 * H_1 * ... so Q^T applies the first block first */
+    const size_t blocks = (steps + nb - 1) / nb;
+    for (size_t b = 0; b < blocks; b++) {
+        const size_t j0 = (transpose ? b : blocks - 1 - b) * nb;
+        const size_t jb = aml_min(nb, steps - j0);
+        struct Aml_Mat2d V = aml_create_block_ref(Vbuf, 0, 0, m - j0, jb);
+        struct Aml_Mat2d T = aml_create_block_ref(Tbuf, 0, 0, jb, jb);
+
+        ala_QR_block_WY_get(V, T, QR, tau, j0, w);
+        ala_householder_block_apply_left(aml_create_block_ref(B, j0, 0, m - j0, B.cols), V, T, transpose, ws);
+    }
+
+    ws->used = mark;
+}
+
 /**
  * @brief Compute a QR decomposition using explicit Householder matrices.
  *
@@ -1800,6 +3413,53 @@ ALA_DEF void ala_QR_decomposition_householder(struct Aml_Mat2d Q, struct Aml_Mat
     aml_mat2d_free(prev_R);
 }
 
+/**
+ * @brief Compute a QR decomposition with blocked Householder reflectors.
+ *
+ * Runs ala_QR_factor() on a copy of @p src, so almost all of the work is done
+ * by aml_gemm(), then forms `Q` with ala_QR_Q_get() if requested. The
+ * reflectors follow the same sign convention as
+ * ala_QR_decomposition_householder_fast(), so both return the same `Q` and
+ * `R` up to rounding.
+ *
+ * @param Q Output orthogonal matrix (`src.rows x src.rows`). Not referenced if
+ * @p compute_Q is false.
+ * @param R Output upper-triangular matrix.
+ * @param src Input matrix.
+ * @param compute_Q Whether to form @p Q. Callers that only need `Q^T * b`
+ * should use ala_QR_factor() and ala_QR_apply_Q() instead.
+ *
+ * Complexity
+ * `O(rows * cols * min(rows, cols))`, plus `O(rows^2 * min(rows, cols))` for
+ * `Q`.
+ */
+ALA_DEF void ala_QR_decomposition_householder_blocked(struct Aml_Mat2d Q, struct Aml_Mat2d R, struct Aml_Mat2d src, bool compute_Q)
+{
+    ALA_ASSERT(R.rows == src.rows);
+    ALA_ASSERT(R.cols == src.cols);
+    if (compute_Q) {
+        ALA_ASSERT(Q.rows == Q.cols);
+        ALA_ASSERT(Q.rows == src.rows);
+    }
+
+    const size_t steps = aml_min(src.rows, src.cols);
+    aml_real *tau = (aml_real *)AML_MALLOC(sizeof(*tau) * (steps ? steps : 1));
+    ALA_ASSERT(tau != NULL);
+
+    aml_copy(R, src);
+    ala_QR_factor(R, tau);
+    if (compute_Q) {
+        ala_QR_Q_get(Q, R, tau);
+    }
+    for (size_t i = 1; i < R.rows; i++) {
+        for (size_t j = 0; j < aml_min(i, R.cols); j++) {
+            AML_MAT2D_AT(R, i, j) = 0;
+        }
+    }
+
+    AML_FREE(tau);
+}
+
 /**
  * @brief Compute a QR decomposition using implicit Householder applications.
  *
@@ -1849,15 +3509,168 @@ ALA_DEF void ala_QR_decomposition_householder_fast(struct Aml_Mat2d Q, struct Am
             .elements = &AML_MAT2D_AT(vbuf, k, 0),
         };
 
-        ala_householder_top_element_vector_get(v, x);
-        if (AML_IS_ZERO(aml_inner_product(v))) {
-            continue;
+        ala_householder_top_element_vector_get(v, x);
+        if (AML_IS_ZERO(aml_inner_product(v))) {
+            continue;
+        }
+
+        ala_apply_householder_left(R, k, k, v);
+        ala_apply_householder_right(Q, k, v);
+    }
+    aml_mat2d_free(vbuf);
+}
+
+/**
+ * @brief Factor a matrix in place as `A = Q * R` with blocked Householder
+ * reflectors, keeping `Q` implicit.
+ *
+ * Each panel of ALA_HOUSEHOLDER_BLOCK_SIZE columns is reduced one reflector at
+ * a time; the panel's reflectors are then gathered in compact WY form
+ * `I - V * T * V^T` and applied to the trailing columns with aml_gemm().
+ *
+ * On return the upper triangle of @p QR holds `R`. Below the diagonal, column
+ * `j` holds reflector `v_j` (its leading 1 is not stored), and
+ * `Q = H_0 * H_1 * ... * H_{k-1}` with `H_j = I - tau[j] * v_j * v_j^T`.
+ * Apply `Q` or `Q^T` with ala_QR_apply_Q(), or form it with ala_QR_Q_get().
+ *
+ * @param QR Matrix `A` on input, `R` and the reflectors on output. May be
+ * rectangular.
+ * @param tau Output array of `min(rows, cols)` reflector scalars.
+ *
+ * Complexity
+ * `O(rows * cols * min(rows, cols))`.
+ *
+ * @note ala_QR_factor_ws() does the same without allocating.
+ */
+ALA_DEF void ala_QR_factor(struct Aml_Mat2d QR, aml_real *tau)
+{
+    struct Ala_Workspace ws = ala_workspace_alloc(ala_workspace_size(ALA_WORKSPACE_QR_FACTOR, QR.rows, QR.cols));
+    ala_QR_factor_ws(QR, tau, &ws);
+    ala_workspace_free(ws);
+}
+
+/**
+ * @brief ala_QR_factor() with its temporaries taken from a workspace.
+ *
+ * @param QR Matrix `A` on input, `R` and the reflectors on output.
+ * @param tau Output array of `min(rows, cols)` reflector scalars.
+ * @param ws Workspace of at least
+ * `ala_workspace_size(ALA_WORKSPACE_QR_FACTOR, QR.rows, QR.cols)` bytes.
+ */
+ALA_DEF void ala_QR_factor_ws(struct Aml_Mat2d QR, aml_real *tau, struct Ala_Workspace *ws)
+{
+    const size_t m = QR.rows;
+    const size_t steps = aml_min(QR.rows, QR.cols);
+    const size_t nb = ALA_HOUSEHOLDER_BLOCK_SIZE;
+    const size_t s = QR.stride_r;
+    aml_real *a = QR.elements;
+    aml_real w[ALA_HOUSEHOLDER_BLOCK_SIZE];
+
+    const size_t mark = ws->used;
+    struct Aml_Mat2d Vbuf = {0};
+    struct Aml_Mat2d Tbuf = {0};
+    if (steps < QR.cols || steps > nb) {
+        Vbuf = ala_workspace_mat2d(ws, m, nb);
+        Tbuf = ala_workspace_mat2d(ws, nb, nb);
+    }
+
+    for (size_t j0 = 0; j0 < steps; j0 += nb) {
+        const size_t jb = aml_min(nb, steps - j0);
+        const size_t j1 = j0 + jb;
+
+        /* unblocked QR of the panel */
+        for (size_t c = j0; c < j1; c++) {
+            const aml_real beta = ala_householder_reflector_make(a + c * s + c, s, m - c, &tau[c]);
+            if (tau[c] != 0 && c + 1 < j1) {
+                /* A(c:, c+1:j1) -= tau * v * (v^T * A(c:, c+1:j1)) */
+                const size_t cols = j1 - c - 1;
+                const aml_real *crow = a + c * s + c + 1;
+                for (size_t q = 0; q < cols; q++) {
+                    w[q] = crow[q];
+                }
+                for (size_t r = c + 1; r < m; r++) {
+                    const aml_real vr = a[r * s + c];
+                    const aml_real *arow = a + r * s + c + 1;
+                    for (size_t q = 0; q < cols; q++) {
+                        w[q] += vr * arow[q];
+                    }
+                }
+                for (size_t q = 0; q < cols; q++) {
+                    w[q] *= tau[c];
+                    a[c * s + c + 1 + q] -= w[q];
+                }
+                for (size_t r = c + 1; r < m; r++) {
+                    const aml_real vr = a[r * s + c];
+                    aml_real *arow = a + r * s + c + 1;
+                    for (size_t q = 0; q < cols; q++) {
+                        arow[q] -= vr * w[q];
+                    }
+                }
+            }
+            a[c * s + c] = beta;
         }
 
-        ala_apply_householder_left(R, k, k, v);
-        ala_apply_householder_right(Q, k, v);
+        /* A(j0:, j1:) <- (I - V * T^T * V^T) * A(j0:, j1:) */
+        if (j1 < QR.cols) {
+            struct Aml_Mat2d V = aml_create_block_ref(Vbuf, 0, 0, m - j0, jb);
+            struct Aml_Mat2d T = aml_create_block_ref(Tbuf, 0, 0, jb, jb);
+            ala_QR_block_WY_get(V, T, QR, tau, j0, w);
+            ala_householder_block_apply_left(aml_create_block_ref(QR, j0, j1, m - j0, QR.cols - j1), V, T, true, ws);
+        }
     }
-    aml_mat2d_free(vbuf);
+
+    ws->used = mark;
+}
+
+/**
+ * @brief Form the orthogonal factor of ala_QR_factor() explicitly.
+ *
+ * Fills @p Q with the leading `Q.cols` columns of `Q`: pass a
+ * `rows x rows` matrix for the full factor or `rows x min(rows, cols)` for the
+ * thin one. The reflector blocks are applied last to first, so every block
+ * only touches the columns it can change.
+ *
+ * @param Q Output matrix with `QR.rows` rows and at most `QR.rows` columns.
+ * @param QR Matrix factored by ala_QR_factor().
+ * @param tau Reflector scalars from ala_QR_factor().
+ *
+ * Complexity
+ * `O(QR.rows * Q.cols * min(QR.rows, QR.cols))`.
+ */
+ALA_DEF void ala_QR_Q_get(struct Aml_Mat2d Q, struct Aml_Mat2d QR, const aml_real *tau)
+{
+    ALA_ASSERT(Q.rows == QR.rows);
+    ALA_ASSERT(Q.cols <= Q.rows);
+
+    const size_t m = QR.rows;
+    const size_t steps = aml_min(QR.rows, QR.cols);
+    const size_t nb = ALA_HOUSEHOLDER_BLOCK_SIZE;
+
+    for (size_t i = 0; i < Q.rows; i++) {
+        for (size_t j = 0; j < Q.cols; j++) {
+            AML_MAT2D_AT(Q, i, j) = i == j ? (aml_real)1 : (aml_real)0;
+        }
+    }
+    if (steps == 0 || Q.cols == 0) return;
+
+    aml_real w[ALA_HOUSEHOLDER_BLOCK_SIZE];
+    struct Ala_Workspace ws = ala_workspace_alloc(ala_workspace_QR_bytes(m, Q.cols));
+    struct Aml_Mat2d Vbuf = ala_workspace_mat2d(&ws, m, nb);
+    struct Aml_Mat2d Tbuf = ala_workspace_mat2d(&ws, nb, nb);
+
+    /* while applying H_j0 ... the columns left of j0 are still e_i there */
+    for (size_t j0 = (steps - 1) / nb * nb;; j0 -= nb) {
+        const size_t jb = aml_min(nb, steps - j0);
+        if (j0 < Q.cols) {
+            struct Aml_Mat2d V = aml_create_block_ref(Vbuf, 0, 0, m - j0, jb);
+            struct Aml_Mat2d T = aml_create_block_ref(Tbuf, 0, 0, jb, jb);
+            ala_QR_block_WY_get(V, T, QR, tau, j0, w);
+            ala_householder_block_apply_left(aml_create_block_ref(Q, j0, j0, m - j0, Q.cols - j0), V, T, false, &ws);
+        }
+        if (j0 == 0) break;
+    }
+
+    ala_workspace_free(ws);
 }
 
 /**
@@ -1895,82 +3708,959 @@ ALA_DEF size_t ala_reduce(struct Aml_Mat2d m)
             aml_real factor = AML_MAT2D_AT(m, i, c);
             aml_sub_src_row_time_factor_from_des_row(m, i, r, factor);
         }
-        rank++;
+        rank++;
+    }
+
+    return rank;
+}
+
+ALA_DEF aml_real ala_schur_residual(struct Aml_Mat2d H0, struct Aml_Mat2d Q, struct Aml_Mat2d U)
+{
+    struct Aml_Mat2d t1 = aml_mat2d_alloc(H0.rows, H0.cols);
+    struct Aml_Mat2d t2 = aml_mat2d_alloc(H0.rows, H0.cols);
+
+    aml_transpose(t1, Q);
+    aml_dot(t2, t1, H0);
+    aml_dot(t1, t2, Q);
+    aml_sub(t1, U);
+
+    aml_real r = aml_calc_norma(t1) / aml_calc_norma(H0);
+
+    aml_mat2d_free(t1);
+    aml_mat2d_free(t2);
+    return r;
+}
+
+/**
+ * @brief Solve a linear system using LUP decomposition.
+ *
+ * Factors a copy of @p A with ala_LUP_factor() and solves every column of
+ * @p B with ala_LUP_solve(). To solve with the same matrix again, keep the
+ * factorization and call ala_LUP_solve() directly.
+ *
+ * @param A System matrix.
+ * @param x Output solutions, one column per column of @p B.
+ * @param B Right-hand sides.
+ *
+ * Complexity
+ * `O(n^3 + n^2 * B.cols)`.
+ *
+ * @note ala_solve_linear_sys_LUP_decomposition_ws() does the same without
+ * allocating.
+ */
+ALA_DEF void ala_solve_linear_sys_LUP_decomposition(struct Aml_Mat2d A, struct Aml_Mat2d x, struct Aml_Mat2d B)
+{
+    struct Ala_Workspace ws = ala_workspace_alloc(ala_workspace_size(ALA_WORKSPACE_SOLVE_LINEAR_SYS, A.rows, A.cols));
+    ala_solve_linear_sys_LUP_decomposition_ws(A, x, B, &ws);
+    ala_workspace_free(ws);
+}
+
+/**
+ * @brief ala_solve_linear_sys_LUP_decomposition() with its temporaries taken
+ * from a workspace.
+ *
+ * @param A System matrix.
+ * @param x Output solutions, one column per column of @p B.
+ * @param B Right-hand sides.
+ * @param ws Workspace of at least
+ * `ala_workspace_size(ALA_WORKSPACE_SOLVE_LINEAR_SYS, n, n)` bytes.
+ */
+ALA_DEF void ala_solve_linear_sys_LUP_decomposition_ws(struct Aml_Mat2d A, struct Aml_Mat2d x, struct Aml_Mat2d B, struct Ala_Workspace *ws)
+{
+    ALA_ASSERT(A.rows == A.cols);
+    ALA_ASSERT(A.cols == x.rows);
+    ALA_ASSERT(A.rows == B.rows);
+    ALA_ASSERT(x.cols == B.cols);
+
+    const size_t mark = ws->used;
+    struct Aml_Mat2d LU = ala_workspace_mat2d(ws, A.rows, A.cols);
+    size_t *pivots = (size_t *)ala_workspace_take(ws, sizeof(*pivots) * A.rows);
+
+    aml_copy(LU, A);
+    if (!ala_LUP_factor(LU, pivots)) {
+        aml_dprintWARNING("%s", "matrix is singular.");
+    }
+    aml_copy(x, B);
+    ala_LUP_solve(LU, pivots, x);
+
+    ws->used = mark;
+}
+
+/* Micro-tile of the float trailing update: MR rows by NR columns of A22 are
+ * accumulated over the whole panel before they are written back. */
+enum { ALA_LUP_FLOAT_MR = 6, ALA_LUP_FLOAT_NR = 16 };
+
+/* c[0..MR)[0..NR) -= l[0..MR)[0..kb) * u[0..kb)[0..NR), every operand with
+ * row stride n */
+typedef void (*Ala_LUP_Float_Tile)(size_t kb, size_t n, const float *AML_RESTRICT l, const float *AML_RESTRICT u, float *AML_RESTRICT c);
+
+static void ala_LUP_float_tile_scalar(size_t kb, size_t n, const float *AML_RESTRICT l, const float *AML_RESTRICT u, float *AML_RESTRICT c)
+{
+    float acc[ALA_LUP_FLOAT_MR][ALA_LUP_FLOAT_NR] = {{0}};
+
+    for (size_t p = 0; p < kb; p++) {
+        const float *AML_RESTRICT u_p = u + p * n;
+        for (size_t r = 0; r < ALA_LUP_FLOAT_MR; r++) {
+            const float l_rp = l[r * n + p];
+            for (size_t j = 0; j < ALA_LUP_FLOAT_NR; j++) {
+                acc[r][j] += l_rp * u_p[j];
+            }
+        }
+    }
+
+    for (size_t r = 0; r < ALA_LUP_FLOAT_MR; r++) {
+        for (size_t j = 0; j < ALA_LUP_FLOAT_NR; j++) {
+            c[r * n + j] -= acc[r][j];
+        }
+    }
+}
+
+#if AML_SIMD_X86
+/* Same micro-tile in twelve named ymm accumulators, as in
+ * aml_gemm_kernel_avx2(). */
+#define ALA_LUP_FLOAT_ACC_DECLARE(r) __m256 c##r##0 = _mm256_setzero_ps(), c##r##1 = _mm256_setzero_ps()
+
+#define ALA_LUP_FLOAT_ACC_FMADD(r)                          \
+    do {                                                    \
+        __m256 l_r = _mm256_set1_ps(l[(r) * n + p]);        \
+        c##r##0 = _mm256_fmadd_ps(l_r, u0, c##r##0);        \
+        c##r##1 = _mm256_fmadd_ps(l_r, u1, c##r##1);        \
+    } while (0)
+
+#define ALA_LUP_FLOAT_ACC_STORE(r)                                              \
+    do {                                                                        \
+        float *c_r = c + (r) * n;                                               \
+        _mm256_storeu_ps(c_r, _mm256_sub_ps(_mm256_loadu_ps(c_r), c##r##0));    \
+        _mm256_storeu_ps(c_r + 8, _mm256_sub_ps(_mm256_loadu_ps(c_r + 8), c##r##1)); \
+    } while (0)
+
+static AML_TARGET("avx2,fma") void ala_LUP_float_tile_avx2(size_t kb, size_t n, const float *AML_RESTRICT l, const float *AML_RESTRICT u, float *AML_RESTRICT c)
+{
+    ALA_LUP_FLOAT_ACC_DECLARE(0);
+    ALA_LUP_FLOAT_ACC_DECLARE(1);
+    ALA_LUP_FLOAT_ACC_DECLARE(2);
+    ALA_LUP_FLOAT_ACC_DECLARE(3);
+    ALA_LUP_FLOAT_ACC_DECLARE(4);
+    ALA_LUP_FLOAT_ACC_DECLARE(5);
+
+    for (size_t p = 0; p < kb; p++) {
+        __m256 u0 = _mm256_loadu_ps(u + p * n);
+        __m256 u1 = _mm256_loadu_ps(u + p * n + 8);
+        ALA_LUP_FLOAT_ACC_FMADD(0);
+        ALA_LUP_FLOAT_ACC_FMADD(1);
+        ALA_LUP_FLOAT_ACC_FMADD(2);
+        ALA_LUP_FLOAT_ACC_FMADD(3);
+        ALA_LUP_FLOAT_ACC_FMADD(4);
+        ALA_LUP_FLOAT_ACC_FMADD(5);
+    }
+
+    ALA_LUP_FLOAT_ACC_STORE(0);
+    ALA_LUP_FLOAT_ACC_STORE(1);
+    ALA_LUP_FLOAT_ACC_STORE(2);
+    ALA_LUP_FLOAT_ACC_STORE(3);
+    ALA_LUP_FLOAT_ACC_STORE(4);
+    ALA_LUP_FLOAT_ACC_STORE(5);
+}
+#endif /* AML_SIMD_X86 */
+
+/* A22 -= L21 * U12 for rows [first, last) of the n x n float matrix a, where
+ * the panel spans rows and columns [k0, k1). Whole micro-tiles go through
+ * tile; the ragged right and bottom edges are updated row by row. */
+static void ala_LUP_float_update_rows(Ala_LUP_Float_Tile tile, float *a, size_t n, size_t k0, size_t k1, size_t first, size_t last)
+{
+    const size_t kb = k1 - k0;
+    size_t i = first;
+    for (; i + ALA_LUP_FLOAT_MR <= last; i += ALA_LUP_FLOAT_MR) {
+        size_t j = k1;
+        for (; j + ALA_LUP_FLOAT_NR <= n; j += ALA_LUP_FLOAT_NR) {
+            tile(kb, n, a + i * n + k0, a + k0 * n + j, a + i * n + j);
+        }
+        for (size_t r = i; j < n && r < i + ALA_LUP_FLOAT_MR; r++) {
+            float *AML_RESTRICT a_r = a + r * n;
+            for (size_t p = k0; p < k1; p++) {
+                const float l = a_r[p];
+                const float *AML_RESTRICT u_p = a + p * n;
+                for (size_t jj = j; jj < n; jj++) {
+                    a_r[jj] -= l * u_p[jj];
+                }
+            }
+        }
+    }
+    for (; i < last; i++) {
+        float *AML_RESTRICT a_i = a + i * n;
+        for (size_t p = k0; p < k1; p++) {
+            const float l = a_i[p];
+            const float *AML_RESTRICT u_p = a + p * n;
+            for (size_t j = k1; j < n; j++) {
+                a_i[j] -= l * u_p[j];
+            }
+        }
+    }
+}
+
+/* Shared state of one multi-threaded trailing update in
+ * ala_LUP_factor_float(). */
+struct Ala_LUP_Float_Job {
+    Ala_LUP_Float_Tile tile;
+    float *a;
+    size_t n;
+    size_t k0;
+    size_t k1;
+    size_t rows_per_task;
+};
+
+static void ala_LUP_float_update_task(void *context, size_t task, size_t worker)
+{
+    struct Ala_LUP_Float_Job *job = (struct Ala_LUP_Float_Job *)context;
+    size_t first = job->k1 + task * job->rows_per_task;
+    size_t last = aml_min(first + job->rows_per_task, job->n);
+    ala_LUP_float_update_rows(job->tile, job->a, job->n, job->k0, job->k1, first, last);
+    AML_UNUSED(worker);
+}
+
+/* ala_LUP_factor() on a compact n x n float matrix, blocked by
+ * ALA_LUP_BLOCK_SIZE. Trailing updates of at least ALA_PARALLEL_MIN_WORK
+ * multiply-adds are split over worker threads in row chunks. Returns false on
+ * a zero pivot. */
+static bool ala_LUP_factor_float(float *a, size_t n, size_t *pivots)
+{
+    bool nonsingular = true;
+    Ala_LUP_Float_Tile tile = ala_LUP_float_tile_scalar;
+#if AML_SIMD_X86
+    if (aml_simd_level_get() >= AML_SIMD_AVX2) {
+        tile = ala_LUP_float_tile_avx2;
+    }
+#endif
+
+    for (size_t k0 = 0; k0 < n; k0 += ALA_LUP_BLOCK_SIZE) {
+        const size_t k1 = aml_min(k0 + ALA_LUP_BLOCK_SIZE, n);
+
+        /* panel: unblocked factorization of columns [k0, k1), swapping whole
+         * rows */
+        for (size_t k = k0; k < k1; k++) {
+            size_t pivot_row = k;
+            float pivot_abs = fabsf(a[k * n + k]);
+            for (size_t r = k + 1; r < n; r++) {
+                if (fabsf(a[r * n + k]) > pivot_abs) {
+                    pivot_abs = fabsf(a[r * n + k]);
+                    pivot_row = r;
+                }
+            }
+            pivots[k] = pivot_row;
+            if (pivot_row != k) {
+                float *AML_RESTRICT a_k = a + k * n;
+                float *AML_RESTRICT a_p = a + pivot_row * n;
+                for (size_t j = 0; j < n; j++) {
+                    const float t = a_k[j];
+                    a_k[j] = a_p[j];
+                    a_p[j] = t;
+                }
+            }
+            if (pivot_abs == 0) {
+                nonsingular = false;
+                continue;
+            }
+
+            const float inv_pivot = 1.0f / a[k * n + k];
+            for (size_t r = k + 1; r < n; r++) {
+                float *AML_RESTRICT a_r = a + r * n;
+                const float *AML_RESTRICT a_k = a + k * n;
+                const float l = a_r[k] * inv_pivot;
+                a_r[k] = l;
+                for (size_t j = k + 1; j < k1; j++) {
+                    a_r[j] -= l * a_k[j];
+                }
+            }
+        }
+        if (k1 == n) {
+            continue;
+        }
+
+        /* U12 = inv(L11) * A12 */
+        for (size_t i = k0 + 1; i < k1; i++) {
+            float *AML_RESTRICT a_i = a + i * n;
+            for (size_t r = k0; r < i; r++) {
+                const float l = a_i[r];
+                const float *AML_RESTRICT u_r = a + r * n;
+                for (size_t j = k1; j < n; j++) {
+                    a_i[j] -= l * u_r[j];
+                }
+            }
+        }
+
+        /* A22 -= L21 * U12 */
+        const size_t rows = n - k1;
+        size_t num_of_threads = aml_cpu_count_get();
+#if defined(AML_NO_THREADS)
+        num_of_threads = 1;
+#endif
+        if (num_of_threads <= 1 || rows * rows * (k1 - k0) < ALA_PARALLEL_MIN_WORK) {
+            ala_LUP_float_update_rows(tile, a, n, k0, k1, k1, n);
+            continue;
+        }
+        const size_t row_tiles = (rows + ALA_LUP_FLOAT_MR - 1) / ALA_LUP_FLOAT_MR;
+        size_t num_of_tasks = aml_min(num_of_threads * 4, row_tiles);
+        struct Ala_LUP_Float_Job job;
+        job.tile = tile;
+        job.a = a;
+        job.n = n;
+        job.k0 = k0;
+        job.k1 = k1;
+        job.rows_per_task = (row_tiles + num_of_tasks - 1) / num_of_tasks * ALA_LUP_FLOAT_MR;
+        num_of_tasks = (rows + job.rows_per_task - 1) / job.rows_per_task;
+        aml_parallel_for(num_of_tasks, ala_LUP_float_update_task, &job, num_of_threads);
+    }
+
+    return nonsingular;
+}
+
+/* Lanes of the partial sums in ala_dot_float() and ala_dot_mixed(); eight
+ * independent chains hide the add latency and map onto one vector. */
+#define ALA_DOT_LANES 8
+
+/* sum of a[j] * b[j] over [0, len) */
+static float ala_dot_float(const float *AML_RESTRICT a, const float *AML_RESTRICT b, size_t len)
+{
+    float acc[ALA_DOT_LANES] = {0};
+    size_t j = 0;
+    for (; j + ALA_DOT_LANES <= len; j += ALA_DOT_LANES) {
+        for (size_t t = 0; t < ALA_DOT_LANES; t++) {
+            acc[t] += a[j + t] * b[j + t];
+        }
+    }
+    float sum = 0;
+    for (; j < len; j++) {
+        sum += a[j] * b[j];
+    }
+    for (size_t t = 0; t < ALA_DOT_LANES; t++) {
+        sum += acc[t];
+    }
+    return sum;
+}
+
+/* sum of a[j] * b[j] over [0, len), accumulated in double */
+static double ala_dot_mixed(const aml_real *AML_RESTRICT a, const double *AML_RESTRICT b, size_t len)
+{
+    double acc[ALA_DOT_LANES] = {0};
+    size_t j = 0;
+    for (; j + ALA_DOT_LANES <= len; j += ALA_DOT_LANES) {
+        for (size_t t = 0; t < ALA_DOT_LANES; t++) {
+            acc[t] += (double)a[j + t] * b[j + t];
+        }
+    }
+    double sum = 0;
+    for (; j < len; j++) {
+        sum += (double)a[j] * b[j];
+    }
+    for (size_t t = 0; t < ALA_DOT_LANES; t++) {
+        sum += acc[t];
+    }
+    return sum;
+}
+
+/* ala_LUP_solve() on one right-hand side x with the factorization of
+ * ala_LUP_factor_float(). */
+static void ala_LUP_solve_float(const float *lu, size_t n, const size_t *pivots, float *x)
+{
+    for (size_t i = 0; i < n; i++) {
+        if (pivots[i] != i) {
+            const float t = x[i];
+            x[i] = x[pivots[i]];
+            x[pivots[i]] = t;
+        }
+    }
+    for (size_t i = 1; i < n; i++) {
+        x[i] -= ala_dot_float(lu + i * n, x, i);
+    }
+    for (size_t i = n; i-- > 0;) {
+        const float *u_i = lu + i * n;
+        x[i] = (x[i] - ala_dot_float(u_i + i + 1, x + i + 1, n - i - 1)) / u_i[i];
+    }
+}
+
+/* R = B - A * X in double, rounded to float into R. X and R hold one
+ * column of n entries per column of B, back to back; every row of A is read
+ * once for all of them. Stores ||R_c||_inf in rnorm[c] and ||X_c||_inf in
+ * xnorm[c]. */
+static void ala_residual_columns(struct Aml_Mat2d A, const double *X, struct Aml_Mat2d B, float *R, double *rnorm, double *xnorm)
+{
+    const size_t n = A.rows;
+    for (size_t c = 0; c < B.cols; c++) {
+        rnorm[c] = 0;
+        xnorm[c] = 0;
+        for (size_t i = 0; i < n; i++) {
+            xnorm[c] = fmax(xnorm[c], fabs(X[c * n + i]));
+        }
+    }
+    for (size_t i = 0; i < n; i++) {
+        const aml_real *a_i = &AML_MAT2D_AT(A, i, 0);
+        for (size_t c = 0; c < B.cols; c++) {
+            const double r_i = AML_MAT2D_AT(B, i, c) - ala_dot_mixed(a_i, X + c * n, n);
+            R[c * n + i] = (float)r_i;
+            rnorm[c] = fmax(rnorm[c], fabs(r_i));
+        }
+    }
+}
+
+/**
+ * @brief Solve a linear system with a single-precision LU factorization and
+ * double-precision iterative refinement.
+ *
+ * Factors a float copy of @p A, solves in float, then refines every column
+ * with residuals `r = b - A x` accumulated in double and corrections solved
+ * with the float factors, `x += inv(LU) r`. The factorization, the `O(n^3)`
+ * part, runs at float speed and bandwidth, and the refined solution has the
+ * accuracy of ala_solve_linear_sys_LUP_decomposition() as long as `cond(A)`
+ * is well below `1 / FLT_EPSILON`. A column has converged when
+ * `||r||_inf <= sqrt(n) * eps * ||A||_inf * ||x||_inf`, with `eps` the machine
+ * epsilon of `aml_real` (LAPACK's dsgesv criterion).
+ *
+ * If @p A does not fit in float, its float factorization hits a zero pivot,
+ * or any column stalls (the residual stops decreasing) or needs more than
+ * `ALA_MIXED_PRECISION_MAX_ITERATIONS` refinement steps, the whole system is
+ * solved again with ala_solve_linear_sys_LUP_decomposition().
+ *
+ * In the `AML_SINGLE_PRECISION` build the factorization is already in the
+ * working precision; the routine then gives ordinary refinement with
+ * extra-precise residuals.
+ *
+ * @param A System matrix.
+ * @param x Output solutions, one column per column of @p B. Must not alias
+ * @p B.
+ * @param B Right-hand sides.
+ * @return Iterations, backward error and whether refinement converged; see
+ * Ala_Refinement_Info.
+ *
+ * Complexity
+ * `O(n^3)` float operations plus `O(n^2 * B.cols)` per refinement step.
+ */
+ALA_DEF struct Ala_Refinement_Info ala_solve_linear_sys_mixed_precision(struct Aml_Mat2d A, struct Aml_Mat2d x, struct Aml_Mat2d B)
+{
+    ALA_ASSERT(A.rows == A.cols);
+    ALA_ASSERT(A.cols == x.rows);
+    ALA_ASSERT(A.rows == B.rows);
+    ALA_ASSERT(x.cols == B.cols);
+    ALA_ASSERT(x.elements != B.elements);
+
+    const size_t n = A.rows;
+    const size_t k = B.cols;
+    const double eps = sizeof(aml_real) == sizeof(float) ? FLT_EPSILON : DBL_EPSILON;
+    const double tolerance = sqrt((double)n) * eps;
+
+    struct Ala_Refinement_Info info;
+    info.iterations = 0;
+    info.backward_error = 0;
+    info.converged = true;
+
+    /* lu: n x n float factors, then the float right-hand sides and
+     * corrections D; X: the solutions in double; norms: per column
+     * ||R||_inf, previous ||R||_inf, ||X||_inf, ||B||_inf */
+    float *lu = (float *)AML_MALLOC(sizeof(float) * (n * n + n * k + 1));
+    size_t *pivots = (size_t *)AML_MALLOC(sizeof(size_t) * (n + 1));
+    double *X = (double *)AML_MALLOC(sizeof(double) * (n * k + 4 * k + 1));
+    ALA_ASSERT(lu != NULL && pivots != NULL && X != NULL);
+    float *D = lu + n * n;
+    double *rnorm = X + n * k;
+    double *prev_rnorm = rnorm + k;
+    double *xnorm = prev_rnorm + k;
+    double *bnorm = xnorm + k;
+
+    double anorm = 0;
+    for (size_t i = 0; i < n; i++) {
+        double row_sum = 0;
+        for (size_t j = 0; j < n; j++) {
+            const double a_ij = AML_MAT2D_AT(A, i, j);
+            if (!(fabs(a_ij) <= FLT_MAX)) {
+                info.converged = false;
+            }
+            lu[i * n + j] = (float)a_ij;
+            row_sum += fabs(a_ij);
+        }
+        anorm = fmax(anorm, row_sum);
+    }
+    for (size_t c = 0; c < k; c++) {
+        bnorm[c] = 0;
+        prev_rnorm[c] = HUGE_VAL;
+        for (size_t i = 0; i < n; i++) {
+            const double b_i = AML_MAT2D_AT(B, i, c);
+            if (!(fabs(b_i) <= FLT_MAX)) {
+                info.converged = false;
+            }
+            D[c * n + i] = (float)b_i;
+            bnorm[c] = fmax(bnorm[c], fabs(b_i));
+        }
+    }
+    if (info.converged) {
+        info.converged = ala_LUP_factor_float(lu, n, pivots);
+    }
+
+    if (info.converged) {
+        for (size_t c = 0; c < k; c++) {
+            ala_LUP_solve_float(lu, n, pivots, D + c * n);
+            for (size_t i = 0; i < n; i++) {
+                X[c * n + i] = D[c * n + i];
+            }
+        }
+
+        /* refine all columns together, so every step reads A once */
+        for (;; info.iterations++) {
+            ala_residual_columns(A, X, B, D, rnorm, xnorm);
+            bool done = true;
+            for (size_t c = 0; c < k; c++) {
+                if (rnorm[c] <= tolerance * anorm * xnorm[c]) {
+                    continue;
+                }
+                done = false;
+                /* a column whose residual stops decreasing will not
+                 * converge; NaN fails the comparison too */
+                if (!(rnorm[c] < prev_rnorm[c])) {
+                    info.converged = false;
+                }
+                prev_rnorm[c] = rnorm[c];
+            }
+            if (done || !info.converged || info.iterations == ALA_MIXED_PRECISION_MAX_ITERATIONS) {
+                info.converged = done;
+                break;
+            }
+            for (size_t c = 0; c < k; c++) {
+                ala_LUP_solve_float(lu, n, pivots, D + c * n);
+                for (size_t i = 0; i < n; i++) {
+                    X[c * n + i] += D[c * n + i];
+                }
+            }
+        }
+    }
+
+    if (info.converged) {
+        for (size_t c = 0; c < k; c++) {
+            for (size_t i = 0; i < n; i++) {
+                AML_MAT2D_AT(x, i, c) = (aml_real)X[c * n + i];
+            }
+        }
+    } else {
+        ala_solve_linear_sys_LUP_decomposition(A, x, B);
+        for (size_t c = 0; c < k; c++) {
+            for (size_t i = 0; i < n; i++) {
+                X[c * n + i] = AML_MAT2D_AT(x, i, c);
+            }
+        }
+        ala_residual_columns(A, X, B, D, rnorm, xnorm);
+    }
+
+    for (size_t c = 0; c < k; c++) {
+        const double denominator = anorm * xnorm[c] + bnorm[c];
+        info.backward_error = fmax(info.backward_error, denominator > 0 ? rnorm[c] / denominator : rnorm[c]);
+    }
+
+    AML_FREE(lu);
+    AML_FREE(pivots);
+    AML_FREE(X);
+    return info;
+}
+
+/* row p <- c * row p + s * row q, row q <- -s * row p + c * row q */
+static void ala_rows_rotate(struct Aml_Mat2d M, size_t p, size_t q, aml_real c, aml_real s)
+{
+    aml_real *rp = &AML_MAT2D_AT(M, p, 0);
+    aml_real *rq = &AML_MAT2D_AT(M, q, 0);
+    for (size_t j = 0; j < M.cols; j++) {
+        const aml_real x = rp[j];
+        const aml_real y = rq[j];
+        rp[j] = c * x + s * y;
+        rq[j] = -s * x + c * y;
+    }
+}
+
+/* Reduce A (m x n, m >= n) in place to upper bidiagonal B = Q^T * A * P
+ * (LAPACK's dgebrd). d and e receive the diagonal and superdiagonal of B.
+ * Column j keeps the left reflector v_j below the diagonal and row j keeps
+ * the right reflector u_j right of the superdiagonal (unit entries not
+ * stored): Q = H_0 * ... * H_{n-1} with tauq, P = G_0 * ... * G_{n-2} with
+ * taup. Each panel of ALA_HOUSEHOLDER_BLOCK_SIZE rows and columns keeps X and
+ * Y such that the two-sided update is A - V * Y^T - X * U^T; the panel is
+ * brought up to date from them and the trailing matrix is updated with two
+ * aml_gemm() calls. */
+static void ala_bidiagonalize(struct Aml_Mat2d A, aml_real *d, aml_real *e, aml_real *tauq, aml_real *taup, struct Ala_Workspace *ws)
+{
+    const size_t m = A.rows;
+    const size_t n = A.cols;
+    const size_t nb = ALA_HOUSEHOLDER_BLOCK_SIZE;
+    const size_t s = A.stride_r;
+    aml_real *a = A.elements;
+    aml_real t[ALA_HOUSEHOLDER_BLOCK_SIZE];
+    ALA_ASSERT(m >= n);
+
+    const size_t mark = ws->used;
+    struct Aml_Mat2d X = ala_workspace_mat2d(ws, m, nb);
+    struct Aml_Mat2d Y = ala_workspace_mat2d(ws, n, nb);
+    aml_real *tmp = (aml_real *)ala_workspace_take(ws, sizeof(*tmp) * m);
+    const size_t panel_mark = ws->used;
+    const size_t xs = X.stride_r;
+    const size_t ys = Y.stride_r;
+    aml_real *x = X.elements;
+    aml_real *y = Y.elements;
+
+    for (size_t j0 = 0; j0 < n; j0 += nb) {
+        const size_t jb = aml_min(nb, n - j0);
+        const size_t j1 = j0 + jb;
+
+        for (size_t i = 0; i < jb; i++) {
+            const size_t c = j0 + i;
+
+            /* A(c:, c) -= V * Y(c, :)^T + X * U(:, c) */
+            for (size_t r = c; r < m; r++) {
+                aml_real sum = 0;
+                for (size_t l = 0; l < i; l++) {
+                    sum += a[r * s + j0 + l] * y[c * ys + l] + x[r * xs + l] * a[(j0 + l) * s + c];
+                }
+                a[r * s + c] -= sum;
+            }
+
+            d[c] = ala_householder_reflector_make(a + c * s + c, s, m - c, &tauq[c]);
+            a[c * s + c] = 1;
+
+            if (c + 1 >= n) {
+                taup[c] = 0;
+                continue;
+            }
+            const size_t nc = n - c - 1;
+
+            /* Y(c+1:, i) = tauq * (A^T * v - Y * V^T * v - U^T * X^T * v) */
+            for (size_t q = 0; q < nc; q++) {
+                tmp[q] = 0;
+            }
+            for (size_t r = c; r < m; r++) {
+                const aml_real vr = a[r * s + c];
+                const aml_real *arow = a + r * s + c + 1;
+                for (size_t q = 0; q < nc; q++) {
+                    tmp[q] += vr * arow[q];
+                }
+            }
+            for (size_t l = 0; l < i; l++) {
+                t[l] = 0;
+            }
+            for (size_t r = c; r < m; r++) {
+                const aml_real vr = a[r * s + c];
+                for (size_t l = 0; l < i; l++) {
+                    t[l] += a[r * s + j0 + l] * vr;
+                }
+            }
+            for (size_t q = 0; q < nc; q++) {
+                tmp[q] -= ala_dot_contiguous(y + (c + 1 + q) * ys, t, i);
+            }
+            for (size_t l = 0; l < i; l++) {
+                t[l] = 0;
+            }
+            for (size_t r = c; r < m; r++) {
+                const aml_real vr = a[r * s + c];
+                for (size_t l = 0; l < i; l++) {
+                    t[l] += x[r * xs + l] * vr;
+                }
+            }
+            for (size_t l = 0; l < i; l++) {
+                const aml_real *urow = a + (j0 + l) * s + c + 1;
+                for (size_t q = 0; q < nc; q++) {
+                    tmp[q] -= t[l] * urow[q];
+                }
+            }
+            for (size_t q = 0; q < nc; q++) {
+                y[(c + 1 + q) * ys + i] = tauq[c] * tmp[q];
+            }
+
+            /* A(c, c+1:) -= Y * V(c, :)^T + X(c, :) * U */
+            aml_real *crow = a + c * s + c + 1;
+            for (size_t q = 0; q < nc; q++) {
+                crow[q] -= ala_dot_contiguous(y + (c + 1 + q) * ys, a + c * s + j0, i + 1);
+            }
+            for (size_t l = 0; l < i; l++) {
+                const aml_real xl = x[c * xs + l];
+                const aml_real *urow = a + (j0 + l) * s + c + 1;
+                for (size_t q = 0; q < nc; q++) {
+                    crow[q] -= xl * urow[q];
+                }
+            }
+
+            e[c] = ala_householder_reflector_make(crow, 1, nc, &taup[c]);
+            crow[0] = 1;
+
+            /* X(c+1:, i) = taup * (A * u - V * Y^T * u - X * U * u) */
+            for (size_t l = 0; l <= i; l++) {
+                t[l] = 0;
+            }
+            for (size_t q = 0; q < nc; q++) {
+                const aml_real uq = crow[q];
+                const aml_real *yrow = y + (c + 1 + q) * ys;
+                for (size_t l = 0; l <= i; l++) {
+                    t[l] += yrow[l] * uq;
+                }
+            }
+            for (size_t r = c + 1; r < m; r++) {
+                tmp[r] = ala_dot_contiguous(a + r * s + c + 1, crow, nc) - ala_dot_contiguous(a + r * s + j0, t, i + 1);
+            }
+            for (size_t l = 0; l < i; l++) {
+                t[l] = ala_dot_contiguous(a + (j0 + l) * s + c + 1, crow, nc);
+            }
+            for (size_t r = c + 1; r < m; r++) {
+                x[r * xs + i] = taup[c] * (tmp[r] - ala_dot_contiguous(x + r * xs, t, i));
+            }
+        }
+
+        /* A(j1:, j1:) -= V * Y^T + X * U */
+        if (j1 < n) {
+            struct Aml_Mat2d A22 = aml_create_block_ref(A, j1, j1, m - j1, n - j1);
+            struct Aml_Mat2d Yt = ala_workspace_mat2d(ws, jb, n - j1);
+            aml_transpose(Yt, aml_create_block_ref(Y, j1, 0, n - j1, jb));
+            aml_gemm(A22, -1, aml_create_block_ref(A, j1, j0, m - j1, jb), Yt, 1);
+            aml_gemm(A22, -1, aml_create_block_ref(X, j1, 0, m - j1, jb), aml_create_block_ref(A, j0, j1, jb, n - j1), 1);
+            ws->used = panel_mark;
+        }
+
+        for (size_t c = j0; c < j1; c++) {
+            a[c * s + c] = d[c];
+            if (c + 1 < n) {
+                a[c * s + c + 1] = e[c];
+            }
+        }
     }
 
-    return rank;
+    ws->used = mark;
 }
 
-ALA_DEF aml_real ala_schur_residual(struct Aml_Mat2d H0, struct Aml_Mat2d Q, struct Aml_Mat2d U)
+/* Implicit-shift QR on the upper bidiagonal matrix with diagonal d and
+ * superdiagonal e (Golub-Kahan SVD step with a Wilkinson shift, Demmel-Kahan
+ * style deflation). With vectors set, the left and right rotations are
+ * applied to the rows of UT and VT, i.e. to U^T and V^T of B = U * S * V^T.
+ * On return d holds the singular values in descending order. */
+static bool ala_bidiagonal_SVD_QR(aml_real *d, aml_real *e, size_t n, struct Aml_Mat2d UT, struct Aml_Mat2d VT, bool vectors)
 {
-    struct Aml_Mat2d t1 = aml_mat2d_alloc(H0.rows, H0.cols);
-    struct Aml_Mat2d t2 = aml_mat2d_alloc(H0.rows, H0.cols);
+    const aml_real eps = (aml_real)(sizeof(aml_real) == sizeof(float) ? FLT_EPSILON : DBL_EPSILON);
+    bool converged = true;
 
-    aml_transpose(t1, Q);
-    aml_dot(t2, t1, H0);
-    aml_dot(t1, t2, Q);
-    aml_sub(t1, U);
+    aml_real bnorm = 0;
+    for (size_t i = 0; i < n; i++) {
+        bnorm = aml_fmax(bnorm, aml_fabs(d[i]));
+        if (i + 1 < n) {
+            bnorm = aml_fmax(bnorm, aml_fabs(e[i]));
+        }
+    }
+    const aml_real small = eps * bnorm;
+
+    size_t hi = n ? n - 1 : 0;
+    size_t iterations = 0;
+    while (hi > 0) {
+        if (aml_fabs(e[hi - 1]) <= eps * (aml_fabs(d[hi - 1]) + aml_fabs(d[hi])) || aml_fabs(e[hi - 1]) <= small * eps) {
+            e[hi - 1] = 0;
+            hi--;
+            continue;
+        }
+        if (iterations++ >= ALA_SVD_BIDIAGONAL_QR_MAX_ITERATIONS_MULTIPLAYER * n) {
+            converged = false;
+            break;
+        }
 
-    aml_real r = aml_calc_norma(t1) / aml_calc_norma(H0);
+        size_t lo = hi - 1;
+        while (lo > 0) {
+            if (aml_fabs(e[lo - 1]) <= eps * (aml_fabs(d[lo - 1]) + aml_fabs(d[lo]))) {
+                e[lo - 1] = 0;
+                break;
+            }
+            lo--;
+        }
 
-    aml_mat2d_free(t1);
-    aml_mat2d_free(t2);
-    return r;
+        /* a zero on the diagonal splits the block once its row (or, for the
+         * last one, its column) is rotated away */
+        bool split = false;
+        for (size_t i = lo; i < hi; i++) {
+            if (aml_fabs(d[i]) > small) continue;
+            d[i] = 0;
+            aml_real f = e[i];
+            e[i] = 0;
+            for (size_t j = i + 1; j <= hi && f != 0; j++) {
+                const aml_real r = aml_hypot(d[j], f);
+                const aml_real c = d[j] / r;
+                const aml_real sn = f / r;
+                d[j] = r;
+                if (j < hi) {
+                    f = -sn * e[j];
+                    e[j] = c * e[j];
+                }
+                if (vectors) ala_rows_rotate(UT, j, i, c, sn);
+            }
+            split = true;
+            break;
+        }
+        if (!split && aml_fabs(d[hi]) <= small) {
+            d[hi] = 0;
+            aml_real f = e[hi - 1];
+            e[hi - 1] = 0;
+            for (size_t j = hi; j-- > lo && f != 0;) {
+                const aml_real r = aml_hypot(d[j], f);
+                const aml_real c = d[j] / r;
+                const aml_real sn = f / r;
+                d[j] = r;
+                if (j > lo) {
+                    f = -sn * e[j - 1];
+                    e[j - 1] = c * e[j - 1];
+                }
+                if (vectors) ala_rows_rotate(VT, j, hi, c, sn);
+            }
+            split = true;
+        }
+        if (split) continue;
+
+        /* shift: eigenvalue of the trailing 2x2 of B^T * B closer to its end */
+        const aml_real dm = d[hi - 1];
+        const aml_real dn = d[hi];
+        const aml_real em = e[hi - 1];
+        const aml_real fm = hi - 1 > lo ? e[hi - 2] : 0;
+        const aml_real t11 = dm * dm + fm * fm;
+        const aml_real t12 = dm * em;
+        const aml_real t22 = dn * dn + em * em;
+        const aml_real delta = (t11 - t22) / 2;
+        const aml_real denom = delta + (delta >= 0 ? 1 : -1) * aml_hypot(delta, t12);
+        const aml_real mu = denom != 0 ? t22 - t12 * t12 / denom : t22 - aml_fabs(t12);
+
+        aml_real yv = d[lo] * d[lo] - mu;
+        aml_real zv = d[lo] * e[lo];
+        for (size_t k = lo; k < hi; k++) {
+            /* right rotation of columns k, k+1 */
+            aml_real r = aml_hypot(yv, zv);
+            aml_real c = r != 0 ? yv / r : 1;
+            aml_real sn = r != 0 ? zv / r : 0;
+            if (k > lo) {
+                e[k - 1] = r;
+            }
+            aml_real dk = c * d[k] + sn * e[k];
+            e[k] = -sn * d[k] + c * e[k];
+            const aml_real bulge = sn * d[k + 1];
+            d[k + 1] = c * d[k + 1];
+            if (vectors) ala_rows_rotate(VT, k, k + 1, c, sn);
+
+            /* left rotation of rows k, k+1 */
+            r = aml_hypot(dk, bulge);
+            c = r != 0 ? dk / r : 1;
+            sn = r != 0 ? bulge / r : 0;
+            d[k] = r;
+            const aml_real ek = e[k];
+            e[k] = c * ek + sn * d[k + 1];
+            d[k + 1] = -sn * ek + c * d[k + 1];
+            if (k + 1 < hi) {
+                zv = sn * e[k + 1];
+                e[k + 1] = c * e[k + 1];
+            }
+            yv = e[k];
+            if (vectors) ala_rows_rotate(UT, k, k + 1, c, sn);
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        if (d[i] < 0) {
+            d[i] = -d[i];
+            if (vectors) {
+                for (size_t j = 0; j < VT.cols; j++) {
+                    AML_MAT2D_AT(VT, i, j) = -AML_MAT2D_AT(VT, i, j);
+                }
+            }
+        }
+    }
+    for (size_t i = 0; i + 1 < n; i++) {
+        size_t best = i;
+        for (size_t j = i + 1; j < n; j++) {
+            if (d[j] > d[best]) best = j;
+        }
+        if (best == i) continue;
+        const aml_real tmp = d[i];
+        d[i] = d[best];
+        d[best] = tmp;
+        if (vectors) {
+            aml_rows_swap(UT, i, best);
+            aml_rows_swap(VT, i, best);
+        }
+    }
+
+    return converged;
 }
 
-/**
- * @brief Solve a linear system using LUP decomposition.
- *
- * The implementation computes `P`, `L`, and `U`, explicitly inverts `L` and
- * `U`, and then evaluates:
- * - `x_tmp = P * B`
- * - `y = inv(L) * x_tmp`
- * - `x = inv(U) * y`
- *
- * @param A System matrix.
- * @param x Output solution vector.
- * @param B Right-hand side vector.
- *
- * Complexity
- * `O(n^3)`.
- *
- * @note This matches the implementation, but inverting `L` and `U` explicitly
- * is not the most efficient way to solve triangular systems.
- * @note Best as a simple reference implementation.
- */
-ALA_DEF void ala_solve_linear_sys_LUP_decomposition(struct Aml_Mat2d A, struct Aml_Mat2d x, struct Aml_Mat2d B)
+/* SVD of a tall F (m x n, m >= n), which is destroyed: F = U * diag(s) * V^T
+ * with s descending. U is m x n or m x m and V is n x n; both are only
+ * written if vectors is set. A QR factorization first reduces F to its
+ * n x n triangle when m > n. */
+static bool ala_SVD_tall(struct Aml_Mat2d F, aml_real *s, struct Aml_Mat2d U, struct Aml_Mat2d V, bool vectors, struct Ala_Workspace *ws)
 {
-    ALA_ASSERT(A.cols == x.rows);
-    ALA_ASSERT(1 == x.cols);
-    ALA_ASSERT(A.rows == B.rows);
-    ALA_ASSERT(1 == B.cols);
+    const size_t m = F.rows;
+    const size_t n = F.cols;
+    ALA_ASSERT(m >= n && n > 0);
+
+    const size_t mark = ws->used;
+    aml_real *tau = NULL;
+    struct Aml_Mat2d R = F;
+    if (m > n) {
+        tau = (aml_real *)ala_workspace_take(ws, sizeof(*tau) * n);
+        ala_QR_factor_ws(F, tau, ws);
+        R = ala_workspace_mat2d(ws, n, n);
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < n; j++) {
+                AML_MAT2D_AT(R, i, j) = j >= i ? AML_MAT2D_AT(F, i, j) : (aml_real)0;
+            }
+        }
+    }
+
+    aml_real *e    = (aml_real *)ala_workspace_take(ws, sizeof(*e) * n);
+    aml_real *tauq = (aml_real *)ala_workspace_take(ws, sizeof(*tauq) * n);
+    aml_real *taup = (aml_real *)ala_workspace_take(ws, sizeof(*taup) * n);
+    ala_bidiagonalize(R, s, e, tauq, taup, ws);
+
+    struct Aml_Mat2d UT = {0};
+    struct Aml_Mat2d VT = {0};
+    if (vectors) {
+        UT = ala_workspace_mat2d(ws, n, n);
+        VT = ala_workspace_mat2d(ws, n, n);
+        aml_set_identity(UT);
+        aml_set_identity(VT);
+    }
+    const bool converged = ala_bidiagonal_SVD_QR(s, e, n, UT, VT, vectors);
+
+    if (vectors) {
+        /* U = Q_F * [Q_B * UT^T, 0; 0, I] */
+        for (size_t i = 0; i < U.rows; i++) {
+            for (size_t j = 0; j < U.cols; j++) {
+                AML_MAT2D_AT(U, i, j) = i < n && j < n ? AML_MAT2D_AT(UT, j, i) : i == j ? (aml_real)1 : (aml_real)0;
+            }
+        }
+        struct Aml_Mat2d U_top = aml_create_block_ref(U, 0, 0, n, n);
+        ala_QR_apply_Q_ws(R, tauq, U_top, false, ws);
+        if (m > n) {
+            ala_QR_apply_Q_ws(F, tau, U, false, ws);
+        }
 
-    struct Aml_Mat2d y     = aml_mat2d_alloc(x.rows, x.cols);
-    struct Aml_Mat2d l     = aml_mat2d_alloc(A.rows, A.cols);
-    struct Aml_Mat2d p     = aml_mat2d_alloc(A.rows, A.cols);
-    struct Aml_Mat2d u     = aml_mat2d_alloc(A.rows, A.cols);
-    struct Aml_Mat2d inv_l = aml_mat2d_alloc(l.rows, l.cols);
-    struct Aml_Mat2d inv_u = aml_mat2d_alloc(u.rows, u.cols);
+        /* V = P * VT^T; the right reflectors are the rows of R, shifted */
+        aml_transpose(V, VT);
+        if (n > 1) {
+            struct Aml_Mat2d RT = ala_workspace_mat2d(ws, n, n);
+            aml_transpose(RT, R);
+            ala_QR_apply_Q_ws(aml_create_block_ref(RT, 1, 0, n - 1, n - 1), taup, aml_create_block_ref(V, 1, 0, n - 1, n), false, ws);
+        }
+    }
 
-    ala_LUP_decomposition_with_swap(A, l, p, u);
+    ws->used = mark;
 
-    ala_invert(inv_l, l);
-    ala_invert(inv_u, u);
+    return converged;
+}
 
-    aml_fill(x, 0);   /* x here is only a temp mat*/
-    aml_fill(y, 0);
-    aml_dot(x, p, B);
-    aml_dot(y, inv_l, x);
+/* Replace the columns of Y (rows >= cols) by an orthonormal basis of their
+ * span, using ala_QR_factor(). */
+static void ala_orthonormalize_columns(struct Aml_Mat2d Y)
+{
+    struct Aml_Mat2d F = aml_mat2d_alloc(Y.rows, Y.cols);
+    aml_real *tau = (aml_real *)AML_MALLOC(sizeof(*tau) * Y.cols);
+    ALA_ASSERT(tau != NULL);
 
-    aml_fill(x, 0);
-    aml_dot(x, inv_u, y);
+    aml_copy(F, Y);
+    ala_QR_factor(F, tau);
+    ala_QR_Q_get(Y, F, tau);
 
-    aml_mat2d_free(y);
-    aml_mat2d_free(l);
-    aml_mat2d_free(p);
-    aml_mat2d_free(u);
-    aml_mat2d_free(inv_l);
-    aml_mat2d_free(inv_u);
+    aml_mat2d_free(F);
+    AML_FREE(tau);
 }
 
 /**
@@ -2018,6 +4708,209 @@ ALA_DEF void ala_SVD_full(struct Aml_Mat2d A, struct Aml_Mat2d U, struct Aml_Mat
     aml_mat2d_free(V_full);
 }
 
+/**
+ * @brief Compute an SVD `A = U * S * V^T` directly, by Householder
+ * bidiagonalization and implicit-shift QR on the bidiagonal matrix.
+ *
+ * `A` itself is never squared, so small singular values keep their relative
+ * accuracy. Tall matrices are first reduced with ala_QR_factor() (wide ones
+ * are handled through `A^T`), the triangle is bidiagonalized with blocked
+ * Householder reflectors, and the Golub-Kahan QR sweeps only rotate rows of
+ * the small square factors. Almost all of the `O(n^3)` work outside the QR
+ * sweeps is done by aml_gemm().
+ *
+ * The shapes of @p U, @p S and @p V select the economy or full form, with
+ * `k = min(A.rows, A.cols)`:
+ * - thin: `U` is `A.rows x k`, `S` is `k x k`, `V` is `A.cols x k`;
+ * - full: `U` is `A.rows x A.rows`, `S` is `A.rows x A.cols`, `V` is
+ *   `A.cols x A.cols`.
+ *
+ * @param A Input matrix (not modified).
+ * @param U Output left singular vectors. Not referenced if @p compute_UV is
+ * false.
+ * @param S Output diagonal matrix of singular values, in descending order.
+ * @param V Output right singular vectors, or `V^T` if @p return_v_transpose.
+ * Not referenced if @p compute_UV is false.
+ * @param compute_UV Whether to compute @p U and @p V. Singular values alone
+ * cost only the reductions, `O(A.rows * A.cols * k)`.
+ * @param return_v_transpose If true, return `V^T` in @p V.
+ *
+ * Complexity
+ * `O(A.rows * A.cols * k)` for the reductions plus `O(k^3)` for the QR
+ * sweeps when vectors are requested.
+ *
+ * @note Prefer this to ala_SVD_thin() and ala_SVD_full(), which go through
+ * power iteration on `A * A^T`. For the leading few singular triplets of a
+ * large matrix, see ala_SVD_randomized(). ala_SVD_golub_kahan_ws() does the
+ * same without allocating.
+ */
+ALA_DEF void ala_SVD_golub_kahan(struct Aml_Mat2d A, struct Aml_Mat2d U, struct Aml_Mat2d S, struct Aml_Mat2d V, bool compute_UV, bool return_v_transpose)
+{
+    struct Ala_Workspace ws = ala_workspace_alloc(ala_workspace_size(ALA_WORKSPACE_SVD, A.rows, A.cols));
+    ala_SVD_golub_kahan_ws(A, U, S, V, compute_UV, return_v_transpose, &ws);
+    ala_workspace_free(ws);
+}
+
+/**
+ * @brief ala_SVD_golub_kahan() with its temporaries taken from a workspace.
+ *
+ * @param A Input matrix (not modified).
+ * @param U Output left singular vectors. Not referenced if @p compute_UV is
+ * false.
+ * @param S Output diagonal matrix of singular values, in descending order.
+ * @param V Output right singular vectors, or `V^T` if @p return_v_transpose.
+ * Not referenced if @p compute_UV is false.
+ * @param compute_UV Whether to compute @p U and @p V.
+ * @param return_v_transpose If true, return `V^T` in @p V.
+ * @param ws Workspace of at least
+ * `ala_workspace_size(ALA_WORKSPACE_SVD, A.rows, A.cols)` bytes, which
+ * covers both the thin and the full form.
+ */
+ALA_DEF void ala_SVD_golub_kahan_ws(struct Aml_Mat2d A, struct Aml_Mat2d U, struct Aml_Mat2d S, struct Aml_Mat2d V, bool compute_UV, bool return_v_transpose, struct Ala_Workspace *ws)
+{
+    const size_t m = A.rows;
+    const size_t n = A.cols;
+    const size_t k = aml_min(m, n);
+    ALA_ASSERT(k > 0);
+    ALA_ASSERT(aml_min(S.rows, S.cols) == k);
+    if (compute_UV) {
+        ALA_ASSERT(U.rows == m && U.cols == S.rows);
+        ALA_ASSERT(S.rows == k || S.rows == m);
+        ALA_ASSERT(S.cols == k || S.cols == n);
+        if (return_v_transpose) {
+            ALA_ASSERT(V.rows == S.cols && V.cols == n);
+        } else {
+            ALA_ASSERT(V.rows == n && V.cols == S.cols);
+        }
+    }
+
+    /* work on the tall one of A and A^T */
+    const bool wide = m < n;
+    const size_t mt = wide ? n : m;
+    const size_t mark = ws->used;
+    struct Aml_Mat2d F = ala_workspace_mat2d(ws, mt, k);
+    if (wide) {
+        aml_transpose(F, A);
+    } else {
+        aml_copy(F, A);
+    }
+
+    aml_real *s = (aml_real *)ala_workspace_take(ws, sizeof(*s) * k);
+    struct Aml_Mat2d Ut = {0};
+    struct Aml_Mat2d Vt = {0};
+    if (compute_UV) {
+        Ut = ala_workspace_mat2d(ws, mt, wide ? S.cols : S.rows);
+        Vt = ala_workspace_mat2d(ws, k, k);
+    }
+
+    if (!ala_SVD_tall(F, s, Ut, Vt, compute_UV, ws)) {
+        aml_dprintWARNING("Did not converged after %zu iterations.", (size_t)ALA_SVD_BIDIAGONAL_QR_MAX_ITERATIONS_MULTIPLAYER * k);
+    }
+
+    aml_fill(S, 0);
+    for (size_t i = 0; i < k; i++) {
+        AML_MAT2D_AT(S, i, i) = s[i];
+    }
+
+    if (compute_UV) {
+        /* A^T = Ut * S * Vt^T, so A = Vt * S * Ut^T */
+        struct Aml_Mat2d left  = wide ? Vt : Ut;
+        struct Aml_Mat2d right = wide ? Ut : Vt;
+        aml_copy(U, left);
+        if (return_v_transpose) {
+            aml_transpose(V, right);
+        } else {
+            aml_copy(V, right);
+        }
+    }
+
+    ws->used = mark;
+}
+
+/**
+ * @brief Compute the leading `k` singular triplets of a matrix with a
+ * randomized range finder.
+ *
+ * Multiplies `A` by a random `A.cols x l` matrix, `l = k + oversampling`,
+ * optionally sharpens the sample with power iterations
+ * (`(A * A^T)^q * A * Omega`, re-orthonormalized at every step), and then
+ * computes the SVD of the small projection `Q^T * A` with
+ * ala_SVD_golub_kahan(). Apart from that small SVD, the cost is a few passes
+ * of aml_gemm() over `A`, so it is the method of choice for truncated SVD and
+ * PCA of large matrices.
+ *
+ * @param A Input matrix (not modified).
+ * @param U Output `A.rows x k` left singular vectors.
+ * @param S Output `k x k` diagonal matrix of singular values, descending.
+ * @param V Output `A.cols x k` right singular vectors, or `V^T` if
+ * @p return_v_transpose.
+ * @param oversampling Extra sample columns; 5 to 10 is usually enough.
+ * @param power_iterations Number of power iterations; 1 or 2 helps when the
+ * singular values decay slowly.
+ * @param return_v_transpose If true, return `V^T` in @p V.
+ *
+ * Complexity
+ * `O((2 * power_iterations + 2) * A.rows * A.cols * l)` plus
+ * `O(max(A.rows, A.cols) * l^2)`.
+ *
+ * @note The random sample uses aml_set_rand(), so results are reproducible
+ * for a fixed `srand()` seed.
+ */
+ALA_DEF void ala_SVD_randomized(struct Aml_Mat2d A, struct Aml_Mat2d U, struct Aml_Mat2d S, struct Aml_Mat2d V, size_t oversampling, size_t power_iterations, bool return_v_transpose)
+{
+    const size_t m = A.rows;
+    const size_t n = A.cols;
+    const size_t k = S.rows;
+    ALA_ASSERT(S.rows == S.cols);
+    ALA_ASSERT(k > 0 && k <= aml_min(m, n));
+    ALA_ASSERT(U.rows == m && U.cols == k);
+    if (return_v_transpose) {
+        ALA_ASSERT(V.rows == k && V.cols == n);
+    } else {
+        ALA_ASSERT(V.rows == n && V.cols == k);
+    }
+
+    const size_t l = aml_min(k + oversampling, aml_min(m, n));
+    struct Aml_Mat2d AT    = aml_mat2d_alloc(n, m);
+    struct Aml_Mat2d Omega = aml_mat2d_alloc(n, l);
+    struct Aml_Mat2d Q     = aml_mat2d_alloc(m, l);
+    struct Aml_Mat2d Z     = aml_mat2d_alloc(n, l);
+
+    aml_transpose(AT, A);
+    aml_set_rand(Omega, -1, 1);
+    aml_gemm(Q, 1, A, Omega, 0);
+    ala_orthonormalize_columns(Q);
+    for (size_t i = 0; i < power_iterations; i++) {
+        aml_gemm(Z, 1, AT, Q, 0);
+        ala_orthonormalize_columns(Z);
+        aml_gemm(Q, 1, A, Z, 0);
+        ala_orthonormalize_columns(Q);
+    }
+
+    /* Z = (Q^T * A)^T = Ub * Sb * Vb^T, so A ~ Q * Z^T = (Q * Vb) * Sb * Ub^T */
+    aml_gemm(Z, 1, AT, Q, 0);
+    struct Aml_Mat2d Ub = aml_mat2d_alloc(n, l);
+    struct Aml_Mat2d Sb = aml_mat2d_alloc(l, l);
+    struct Aml_Mat2d Vb = aml_mat2d_alloc(l, l);
+    ala_SVD_golub_kahan(Z, Ub, Sb, Vb, true, false);
+
+    aml_gemm(U, 1, Q, aml_create_block_ref(Vb, 0, 0, l, k), 0);
+    aml_copy(S, aml_create_block_ref(Sb, 0, 0, k, k));
+    if (return_v_transpose) {
+        aml_transpose(V, aml_create_block_ref(Ub, 0, 0, n, k));
+    } else {
+        aml_copy(V, aml_create_block_ref(Ub, 0, 0, n, k));
+    }
+
+    aml_mat2d_free(AT);
+    aml_mat2d_free(Omega);
+    aml_mat2d_free(Q);
+    aml_mat2d_free(Z);
+    aml_mat2d_free(Ub);
+    aml_mat2d_free(Sb);
+    aml_mat2d_free(Vb);
+}
+
 /**
  * @brief Compute an SVD using eigendecomposition of `A A^T` or `A^T A`.
  *
@@ -2242,7 +5135,8 @@ ALA_DEF void ala_symmetric_eig_QR_shift(struct Aml_Mat2d A, struct Aml_Mat2d eig
  * @brief Compute eigenpairs of a symmetric matrix by first tridiagonalizing it.
  *
  * The function:
- * - reduces `A` to `T = Q^T A Q` using Householder reflectors,
+ * - reduces `A` to `T = Q^T A Q` with blocked Householder reflectors
+ *   (ala_symmetric_tridiagonalize_householder_blocked()),
  * - solves the symmetric tridiagonal eigenproblem,
  * - maps eigenvectors back with `Q`.
  *
@@ -2271,7 +5165,7 @@ ALA_DEF void ala_symmetric_eig_QR_tridiagonalize(struct Aml_Mat2d A, struct Aml_
     struct Aml_Mat2d T = aml_mat2d_alloc(A.rows, A.cols);
     struct Aml_Mat2d semi_eigenvectors = aml_mat2d_alloc(A.rows, A.cols);
 
-    ala_symmetric_tridiagonalize_householder(Q, T, A);
+    ala_symmetric_tridiagonalize_householder_blocked(Q, T, A, true);
     ala_symmetric_tridiagonal_cleanup(T, 0, T.cols-1);
     aml_dprintINFO("%s", "made tridiagonal");
 
@@ -2285,6 +5179,23 @@ ALA_DEF void ala_symmetric_eig_QR_tridiagonalize(struct Aml_Mat2d A, struct Aml_
 }
 
 ALA_DEF void ala_symmetric_eig_QR_tridiagonalize_implicit_shift(struct Aml_Mat2d A, struct Aml_Mat2d eigenvalues, struct Aml_Mat2d eigenvectors)
+{
+    struct Ala_Workspace ws = ala_workspace_alloc(ala_workspace_size(ALA_WORKSPACE_SYMMETRIC_EIG, A.rows, A.cols));
+    ala_symmetric_eig_QR_tridiagonalize_implicit_shift_ws(A, eigenvalues, eigenvectors, &ws);
+    ala_workspace_free(ws);
+}
+
+/**
+ * @brief ala_symmetric_eig_QR_tridiagonalize_implicit_shift() with its
+ * temporaries taken from a workspace.
+ *
+ * @param A Input symmetric matrix.
+ * @param eigenvalues Output n x n matrix with the eigenvalues on its diagonal.
+ * @param eigenvectors Output n x n matrix of eigenvector columns.
+ * @param ws Workspace of at least
+ * `ala_workspace_size(ALA_WORKSPACE_SYMMETRIC_EIG, n, n)` bytes.
+ */
+ALA_DEF void ala_symmetric_eig_QR_tridiagonalize_implicit_shift_ws(struct Aml_Mat2d A, struct Aml_Mat2d eigenvalues, struct Aml_Mat2d eigenvectors, struct Ala_Workspace *ws)
 {
     ALA_ASSERT(aml_is_symmetric(A));
     ALA_ASSERT(A.cols == A.rows); 
@@ -2293,11 +5204,12 @@ ALA_DEF void ala_symmetric_eig_QR_tridiagonalize_implicit_shift(struct Aml_Mat2d
     ALA_ASSERT(eigenvectors.cols == A.cols);
     ALA_ASSERT(eigenvectors.rows == A.rows);
 
-    struct Aml_Mat2d Q = aml_mat2d_alloc(A.rows, A.cols);
-    struct Aml_Mat2d T = aml_mat2d_alloc(A.rows, A.cols);
-    struct Aml_Mat2d semi_eigenvectors = aml_mat2d_alloc(A.rows, A.cols);
+    const size_t mark = ws->used;
+    struct Aml_Mat2d Q = ala_workspace_mat2d(ws, A.rows, A.cols);
+    struct Aml_Mat2d T = ala_workspace_mat2d(ws, A.rows, A.cols);
+    struct Aml_Mat2d semi_eigenvectors = ala_workspace_mat2d(ws, A.rows, A.cols);
 
-    ala_symmetric_tridiagonalize_householder(Q, T, A);
+    ala_symmetric_tridiagonalize_householder_blocked_ws(Q, T, A, true, ws);
     ala_symmetric_tridiagonal_cleanup(T, 0, T.cols-1);
     aml_dprintINFO("%s", "made tridiagonal");
 
@@ -2305,11 +5217,23 @@ ALA_DEF void ala_symmetric_eig_QR_tridiagonalize_implicit_shift(struct Aml_Mat2d
 
     aml_dot(eigenvectors, Q, semi_eigenvectors);
 
-    aml_mat2d_free(Q);
-    aml_mat2d_free(T);
-    aml_mat2d_free(semi_eigenvectors);
+    ws->used = mark;
 }
 
+/**
+ * @brief Approximate a symmetric matrix by its @p order largest-magnitude
+ * eigenpairs, `approx = V_k * D_k * V_k^T`.
+ *
+ * A low order (`4 * order < n`) computes just those eigenpairs with
+ * ala_eig_lanczos(), which needs `O(n * order)` memory besides the matrices
+ * and a few hundred matrix-vector products, so it scales to large n. Otherwise
+ * (and for `order == 0`, the full reconstruction) the dense eigensolver is
+ * used and its eigendecomposition check and spectrum summary are printed.
+ *
+ * @param approx Output n x n approximation.
+ * @param A Input symmetric matrix.
+ * @param order Number of eigenpairs to keep; 0 keeps all of them.
+ */
 ALA_DEF void ala_symmetric_eigen_approximation(struct Aml_Mat2d approx, struct Aml_Mat2d A, size_t order)
 {
     AML_ASSERT(order <= A.rows);
@@ -2317,6 +5241,29 @@ ALA_DEF void ala_symmetric_eigen_approximation(struct Aml_Mat2d approx, struct A
     AML_ASSERT(approx.cols == approx.rows);
     AML_ASSERT(aml_is_symmetric(A));
 
+    if (order > 0 && 4 * order < A.rows) {
+        struct Aml_Mat2d eigenvalues  = aml_mat2d_alloc(order, order);
+        struct Aml_Mat2d eigenvectors = aml_mat2d_alloc(A.rows, order);
+        struct Aml_Mat2d scaled       = aml_mat2d_alloc(A.rows, order);
+        struct Aml_Mat2d transposed   = aml_mat2d_alloc(order, A.rows);
+
+        ala_eig_lanczos(ala_matvec_dense, &A, eigenvalues, eigenvectors, ALA_EIG_LARGEST_MAGNITUDE, 0, 0);
+
+        aml_transpose(transposed, eigenvectors);
+        for (size_t i = 0; i < A.rows; i++) {
+            for (size_t j = 0; j < order; j++) {
+                AML_MAT2D_AT(scaled, i, j) = AML_MAT2D_AT(eigenvectors, i, j) * AML_MAT2D_AT(eigenvalues, j, j);
+            }
+        }
+        aml_gemm(approx, 1, scaled, transposed, 0);
+
+        aml_mat2d_free(eigenvalues);
+        aml_mat2d_free(eigenvectors);
+        aml_mat2d_free(scaled);
+        aml_mat2d_free(transposed);
+        return;
+    }
+
     struct Aml_Mat2d eigenvalues  = aml_mat2d_alloc(A.rows, A.cols);
     struct Aml_Mat2d eigenvectors = aml_mat2d_alloc(A.rows, A.cols);
 
@@ -2538,6 +5485,189 @@ ALA_DEF void ala_symmetric_tridiagonalize_householder(struct Aml_Mat2d Q, struct
     aml_mat2d_free(vbuf);
 }
 
+/**
+ * @brief Reduce a symmetric matrix to symmetric tridiagonal form with blocked
+ * Householder reflectors.
+ *
+ * Same result as ala_symmetric_tridiagonalize_householder(),
+ * `T = Q^T * src * Q`. Each panel of ALA_HOUSEHOLDER_BLOCK_SIZE columns keeps
+ * its reflectors in `V` and a matching `W` such that the two-sided update is
+ * the symmetric rank-2k update `A <- A - V * W^T - W * V^T`; the panel columns
+ * are brought up to date from `V` and `W`, and the trailing matrix is updated
+ * once per panel with aml_gemm(). `Q` is accumulated in compact WY form.
+ *
+ * @param Q Output orthogonal matrix. Not referenced if @p compute_Q is false.
+ * @param T Output tridiagonal matrix.
+ * @param src Input symmetric matrix.
+ * @param compute_Q Whether to accumulate @p Q.
+ *
+ * Complexity
+ * `O(n^3)`; `4/3 n^3` flops for `T` (half of them in matrix-vector products
+ * with the trailing matrix), plus `2 n^3` for `Q`.
+ *
+ * @note ala_symmetric_tridiagonalize_householder_blocked_ws() does the same
+ * without allocating.
+ */
+ALA_DEF void ala_symmetric_tridiagonalize_householder_blocked(struct Aml_Mat2d Q, struct Aml_Mat2d T, struct Aml_Mat2d src, bool compute_Q)
+{
+    struct Ala_Workspace ws = ala_workspace_alloc(ala_workspace_size(ALA_WORKSPACE_SYMMETRIC_TRIDIAGONALIZE, src.rows, src.cols));
+    ala_symmetric_tridiagonalize_householder_blocked_ws(Q, T, src, compute_Q, &ws);
+    ala_workspace_free(ws);
+}
+
+/**
+ * @brief ala_symmetric_tridiagonalize_householder_blocked() with its
+ * temporaries taken from a workspace.
+ *
+ * @param Q Output orthogonal matrix. Not referenced if @p compute_Q is false.
+ * @param T Output tridiagonal matrix.
+ * @param src Input symmetric matrix.
+ * @param compute_Q Whether to accumulate @p Q.
+ * @param ws Workspace of at least
+ * `ala_workspace_size(ALA_WORKSPACE_SYMMETRIC_TRIDIAGONALIZE, n, n)` bytes.
+ */
+ALA_DEF void ala_symmetric_tridiagonalize_householder_blocked_ws(struct Aml_Mat2d Q, struct Aml_Mat2d T, struct Aml_Mat2d src, bool compute_Q, struct Ala_Workspace *ws)
+{
+    ALA_ASSERT(aml_is_symmetric(src));
+    ALA_ASSERT(src.rows == src.cols);
+    ALA_ASSERT(T.rows == T.cols);
+    ALA_ASSERT(T.rows == src.rows);
+    if (compute_Q) {
+        ALA_ASSERT(Q.rows == Q.cols);
+        ALA_ASSERT(Q.rows == src.rows);
+    }
+
+    const size_t n = src.rows;
+    aml_copy(T, src);
+    if (compute_Q) {
+        aml_set_identity(Q);
+    }
+
+    if (n <= 2) return;
+
+    const size_t nb = ALA_HOUSEHOLDER_BLOCK_SIZE;
+    const size_t s = T.stride_r;
+    aml_real *t = T.elements;
+    aml_real w[ALA_HOUSEHOLDER_BLOCK_SIZE];
+    aml_real u[ALA_HOUSEHOLDER_BLOCK_SIZE];
+
+    const size_t mark = ws->used;
+    struct Aml_Mat2d Vbuf = ala_workspace_mat2d(ws, n, nb);
+    struct Aml_Mat2d Wbuf = ala_workspace_mat2d(ws, n, nb);
+    struct Aml_Mat2d Tbuf = ala_workspace_mat2d(ws, nb, nb);
+    aml_real *taus = (aml_real *)ala_workspace_take(ws, sizeof(*taus) * nb);
+    aml_real *v = (aml_real *)ala_workspace_take(ws, sizeof(*v) * n);
+    const size_t panel_mark = ws->used;
+
+    for (size_t j0 = 0; j0 < n - 2; j0 += nb) {
+        const size_t jb = aml_min(nb, n - 2 - j0);
+        const size_t j1 = j0 + jb;
+        const size_t r0 = j0 + 1;
+        struct Aml_Mat2d V = aml_create_block_ref(Vbuf, 0, 0, n - r0, jb);
+        struct Aml_Mat2d W = aml_create_block_ref(Wbuf, 0, 0, n - r0, jb);
+
+        for (size_t i = 0; i < jb; i++) {
+            const size_t c = j0 + i;
+
+            /* A(c:, c) -= V * W(c, :)^T + W * V(c, :)^T */
+            if (i > 0) {
+                const aml_real *vc = &AML_MAT2D_AT(V, c - r0, 0);
+                const aml_real *wc = &AML_MAT2D_AT(W, c - r0, 0);
+                for (size_t r = c; r < n; r++) {
+                    const aml_real *vrow = &AML_MAT2D_AT(V, r - r0, 0);
+                    const aml_real *wrow = &AML_MAT2D_AT(W, r - r0, 0);
+                    aml_real sum = 0;
+                    for (size_t l = 0; l < i; l++) {
+                        sum += vrow[l] * wc[l] + wrow[l] * vc[l];
+                    }
+                    t[r * s + c] -= sum;
+                }
+            }
+
+            const aml_real beta = ala_householder_reflector_make(t + (c + 1) * s + c, s, n - c - 1, &taus[i]);
+            const aml_real tau = taus[i];
+            v[0] = 1;
+            for (size_t l = 1; l < n - c - 1; l++) {
+                v[l] = t[(c + 1 + l) * s + c];
+            }
+            for (size_t l = 0; l < V.rows; l++) {
+                AML_MAT2D_AT(V, l, i) = l < i ? (aml_real)0 : v[l - i];
+            }
+            t[(c + 1) * s + c] = beta;
+
+            /* w = tau * (A - V * W^T - W * V^T) * v; the trailing block right
+             * of c is still the matrix at the start of the panel */
+            for (size_t l = 0; l < i; l++) {
+                w[l] = 0;
+                u[l] = 0;
+            }
+            for (size_t r = c + 1; r < n; r++) {
+                const aml_real vr = v[r - c - 1];
+                const aml_real *vrow = &AML_MAT2D_AT(V, r - r0, 0);
+                const aml_real *wrow = &AML_MAT2D_AT(W, r - r0, 0);
+                for (size_t l = 0; l < i; l++) {
+                    w[l] += wrow[l] * vr;
+                    u[l] += vrow[l] * vr;
+                }
+            }
+            aml_real vw = 0;
+            for (size_t r = c + 1; r < n; r++) {
+                const aml_real *trow = t + r * s + c + 1;
+                const aml_real *vrow = &AML_MAT2D_AT(V, r - r0, 0);
+                const aml_real *wrow = &AML_MAT2D_AT(W, r - r0, 0);
+                aml_real sum = ala_dot_contiguous(trow, v, n - c - 1);
+                for (size_t l = 0; l < i; l++) {
+                    sum -= vrow[l] * w[l] + wrow[l] * u[l];
+                }
+                sum *= tau;
+                AML_MAT2D_AT(W, r - r0, i) = sum;
+                vw += sum * v[r - c - 1];
+            }
+            /* w -= tau / 2 * (w^T * v) * v keeps the update symmetric */
+            const aml_real alpha = -(aml_real)0.5 * tau * vw;
+            for (size_t r = c + 1; r < n; r++) {
+                AML_MAT2D_AT(W, r - r0, i) += alpha * v[r - c - 1];
+            }
+            for (size_t r = r0; r <= c; r++) {
+                AML_MAT2D_AT(W, r - r0, i) = 0;
+            }
+        }
+
+        /* A(j1:, j1:) -= V2 * W2^T + W2 * V2^T */
+        struct Aml_Mat2d V2 = aml_create_block_ref(V, j1 - r0, 0, n - j1, jb);
+        struct Aml_Mat2d W2 = aml_create_block_ref(W, j1 - r0, 0, n - j1, jb);
+        struct Aml_Mat2d Xt = ala_workspace_mat2d(ws, jb, n - j1);
+        struct Aml_Mat2d A22 = aml_create_block_ref(T, j1, j1, n - j1, n - j1);
+        aml_transpose(Xt, W2);
+        aml_gemm(A22, -1, V2, Xt, 1);
+        aml_transpose(Xt, V2);
+        aml_gemm(A22, -1, W2, Xt, 1);
+        ws->used = panel_mark;
+
+        if (compute_Q) {
+            struct Aml_Mat2d Tb = aml_create_block_ref(Tbuf, 0, 0, jb, jb);
+            aml_fill(Tb, 0);
+            for (size_t i = 0; i < jb; i++) {
+                ala_householder_T_column_set(Tb, V, taus[i], i, w);
+            }
+            ala_householder_block_apply_right(aml_create_block_ref(Q, 0, r0, n, n - r0), V, Tb, ws);
+        }
+    }
+
+    /* only the lower band was kept up to date */
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            if (j + 1 < i || i + 1 < j) {
+                t[i * s + j] = 0;
+            } else if (j == i + 1) {
+                t[i * s + j] = t[j * s + i];
+            }
+        }
+    }
+
+    ws->used = mark;
+}
+
 /**
  * @brief Compute the Wilkinson-style shift for the trailing 2x2 block of a
  * symmetric tridiagonal matrix.
@@ -3138,8 +6268,115 @@ ALA_DEF aml_real ala_upper_triangulate(struct Aml_Mat2d m, enum Ala_Upper_Triang
     return factor_to_return;
 }
 
+/**
+ * @brief Allocate a workspace of @p size bytes.
+ *
+ * @param size Size in bytes, usually from ala_workspace_size().
+ * @return The workspace; release it with ala_workspace_free().
+ */
+ALA_DEF struct Ala_Workspace ala_workspace_alloc(size_t size)
+{
+    struct Ala_Workspace ws = {0};
+    ws.size = size;
+    if (size > 0) {
+        ws.memory = (unsigned char *)AML_MALLOC(size);
+        ALA_ASSERT(ws.memory != NULL);
+    }
+
+    return ws;
+}
+
+/**
+ * @brief Free a workspace created with ala_workspace_alloc().
+ *
+ * @param ws The workspace. Must not come from ala_workspace_from_buffer().
+ */
+ALA_DEF void ala_workspace_free(struct Ala_Workspace ws)
+{
+    if (ws.memory) {
+        AML_FREE(ws.memory);
+    }
+}
+
+/**
+ * @brief Wrap caller-owned memory as a workspace.
+ *
+ * Blocks are handed out at multiples of ALA_WORKSPACE_ALIGNMENT bytes from
+ * @p buffer, so a buffer aligned to that keeps every temporary cache-line
+ * aligned.
+ *
+ * @param buffer Memory the workspace hands out; it stays owned by the caller.
+ * @param size Size of @p buffer in bytes.
+ * @return The workspace. Do not pass it to ala_workspace_free().
+ */
+ALA_DEF struct Ala_Workspace ala_workspace_from_buffer(void *buffer, size_t size)
+{
+    ALA_ASSERT(buffer != NULL || size == 0);
+
+    struct Ala_Workspace ws = {0};
+    ws.memory = (unsigned char *)buffer;
+    ws.size = size;
+
+    return ws;
+}
+
+/**
+ * @brief Give back everything taken from a workspace.
+ *
+ * The routines already do this on return; this is for a workspace abandoned
+ * part way, and it also clears the peak.
+ *
+ * @param ws The workspace.
+ */
+ALA_DEF void ala_workspace_reset(struct Ala_Workspace *ws)
+{
+    ws->used = 0;
+    ws->peak = 0;
+}
 
+/**
+ * @brief Bytes of workspace a routine needs for a given problem size.
+ *
+ * The result bounds what the routine takes for every problem of that size or
+ * smaller, so one workspace can be allocated up front for the largest
+ * problem and reused.
+ *
+ * @param routine Which routine.
+ * @param rows Rows of the matrix named in the routine's
+ * Ala_Workspace_Routine entry.
+ * @param cols Columns of that matrix.
+ * @return Required size in bytes.
+ */
+ALA_DEF size_t ala_workspace_size(enum Ala_Workspace_Routine routine, size_t rows, size_t cols)
+{
+    switch (routine) {
+        case ALA_WORKSPACE_DET:
+        case ALA_WORKSPACE_INVERT:
+        case ALA_WORKSPACE_SOLVE_LINEAR_SYS:
+            return ala_workspace_LUP_bytes(aml_max(rows, cols));
+        case ALA_WORKSPACE_QR_FACTOR:
+        case ALA_WORKSPACE_QR_APPLY_Q:
+            return ala_workspace_QR_bytes(rows, cols);
+        case ALA_WORKSPACE_HESSENBERG:
+            return ala_workspace_hessenberg_bytes(aml_max(rows, cols));
+        case ALA_WORKSPACE_SYMMETRIC_TRIDIAGONALIZE:
+            return ala_workspace_tridiagonalize_bytes(aml_max(rows, cols));
+        case ALA_WORKSPACE_SYMMETRIC_EIG:
+        {
+            const size_t n = aml_max(rows, cols);
+            return 3 * ala_workspace_mat2d_bytes(n, n) + ala_workspace_tridiagonalize_bytes(n);
+        }
+        case ALA_WORKSPACE_SVD:
+        {
+            const size_t k  = aml_min(rows, cols);
+            const size_t mt = aml_max(rows, cols);
+            return ala_workspace_mat2d_bytes(mt, k) + ala_workspace_mat2d_bytes(k, 1) + ala_workspace_mat2d_bytes(mt, mt) + ala_workspace_mat2d_bytes(k, k) + ala_workspace_SVD_tall_bytes(mt, k, mt);
+        }
+    }
+    ALA_ASSERT(0 && "unknown routine");
 
+    return 0;
+}
 
 #endif // ALMOG_LINEAR_ALGEBRA_IMPLEMENTATION
 
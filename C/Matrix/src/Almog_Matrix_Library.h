@@ -5,6 +5,17 @@
  * The library stores matrices in row-major order. A matrix view may use a
  * custom row stride, so functions should use AML_MAT2D_AT() instead of
  * assuming contiguous compact storage.
+ *
+ * Matrix multiplication (aml_dot(), aml_gemm()) runs on a packed GEMM engine:
+ * panels of both factors are copied into cache-sized contiguous blocks and
+ * multiplied by a register-blocked micro-kernel. The kernel (AVX-512, AVX2 +
+ * FMA or scalar) and the block sizes are picked at runtime from the CPU and
+ * its caches, and large products are split over worker threads.
+ *
+ * Build options:
+ * - Define `AML_NO_SIMD` to build the scalar micro-kernel only.
+ * - Define `AML_NO_THREADS` to build without thread support; every product
+ *   then runs on the calling thread. Otherwise link with `-pthread` on POSIX.
  */
 
 #ifndef ALMOG_MATRIX_LIBRARY_H_
@@ -199,6 +210,51 @@ struct Aml_Mat2d_uint32 {
         .elements = &((name##_storage)[0])          \
     }
 
+/**
+ * @brief Instruction sets the GEMM micro-kernels can use.
+ */
+enum Aml_Simd_Level {
+    AML_SIMD_NONE = 0,
+    AML_SIMD_AVX2,   /* AVX2 + FMA */
+    AML_SIMD_AVX512, /* AVX-512F */
+};
+
+/**
+ * @brief Blocking and threading parameters of the GEMM engine.
+ *
+ * @var Aml_Gemm_Config::simd_level
+ * Instruction set of the micro-kernel.
+ * @var Aml_Gemm_Config::mr
+ * Rows of the micro-tile, fixed by the micro-kernel.
+ * @var Aml_Gemm_Config::nr
+ * Columns of the micro-tile, fixed by the micro-kernel.
+ * @var Aml_Gemm_Config::mc
+ * Rows of a packed block of the left factor, sized for the L2 cache.
+ * @var Aml_Gemm_Config::kc
+ * Depth of the packed panels, sized so a micro-panel of the right factor
+ * stays in the L1 cache.
+ * @var Aml_Gemm_Config::nc
+ * Columns of a packed panel of the right factor, sized for the L3 cache.
+ * @var Aml_Gemm_Config::num_of_threads
+ * Worker threads of large products, 0 means one per logical processor.
+ */
+struct Aml_Gemm_Config {
+    enum Aml_Simd_Level simd_level;
+    size_t mr;
+    size_t nr;
+    size_t mc;
+    size_t kc;
+    size_t nc;
+    size_t num_of_threads;
+};
+
+/**
+ * @brief One task of aml_parallel_for(): runs task number @p task on worker
+ * @p worker (`0 <= worker < num_of_threads`, so per-worker scratch can be
+ * indexed by it).
+ */
+typedef void (*Aml_Parallel_Task)(void *context, size_t task, size_t worker);
+
 #ifndef AML_DEF
     #ifdef AML_DEF_STATIC
         #define AML_DEF static
@@ -225,6 +281,8 @@ AML_DEF void                    aml_copy_col_from_src_to_des(struct Aml_Mat2d de
 AML_DEF void                    aml_copy_row_from_src_to_des(struct Aml_Mat2d des, size_t des_row, struct Aml_Mat2d src, size_t src_row);
 AML_DEF void                    aml_copy_src_to_des_window(struct Aml_Mat2d des, struct Aml_Mat2d src, size_t is, size_t js, size_t ie, size_t je);
 AML_DEF void                    aml_copy_src_window_to_des(struct Aml_Mat2d des, struct Aml_Mat2d src, size_t is, size_t js, size_t ie, size_t je);
+AML_DEF size_t                  aml_cpu_count_get(void);
+AML_DEF struct Aml_Mat2d        aml_create_block_ref(struct Aml_Mat2d src, size_t i, size_t j, size_t rows, size_t cols);
 AML_DEF struct Aml_Mat2d        aml_create_col_ref(struct Aml_Mat2d src, size_t c);
 AML_DEF void                    aml_cross(struct Aml_Mat2d dst, struct Aml_Mat2d v1, struct Aml_Mat2d v2);
 
@@ -240,6 +298,10 @@ AML_DEF void                    aml_fill(struct Aml_Mat2d m, aml_real x);
 AML_DEF void                    aml_fill_sequence(struct Aml_Mat2d m, aml_real start, aml_real step);
 AML_DEF void                    aml_fill_uint32(struct Aml_Mat2d_uint32 m, uint32_t x);
 
+AML_DEF void                    aml_gemm(struct Aml_Mat2d c, aml_real alpha, struct Aml_Mat2d a, struct Aml_Mat2d b, aml_real beta);
+AML_DEF struct Aml_Gemm_Config  aml_gemm_config_get(void);
+AML_DEF void                    aml_gemm_config_set(struct Aml_Gemm_Config config);
+
 AML_DEF aml_real                aml_inner_product(struct Aml_Mat2d v);
 AML_DEF bool                    aml_is_close(aml_real a, aml_real b, aml_real eps);
 AML_DEF bool                    aml_is_diagonal(struct Aml_Mat2d m);
@@ -269,6 +331,7 @@ AML_DEF void                    aml_normalize_inf(struct Aml_Mat2d m);
 AML_DEF size_t                  aml_offset2d(struct Aml_Mat2d m, size_t i, size_t j);
 AML_DEF size_t                  aml_offset2d_uint32(struct Aml_Mat2d_uint32 m, size_t i, size_t j);
 AML_DEF void                    aml_outer_product(struct Aml_Mat2d des, struct Aml_Mat2d v);
+AML_DEF void                    aml_parallel_for(size_t num_of_tasks, Aml_Parallel_Task task, void *context, size_t num_of_threads);
 
 AML_DEF void                    aml_print(struct Aml_Mat2d m, const char *name, size_t padding);
 AML_DEF void                    aml_print_uint32(struct Aml_Mat2d_uint32 m, const char *name, size_t padding);
@@ -293,6 +356,7 @@ AML_DEF void                    aml_set_rot_mat_y(struct Aml_Mat2d m, float angl
 AML_DEF void                    aml_set_rot_mat_z(struct Aml_Mat2d m, float angle_deg);
 AML_DEF void                    aml_shift(struct Aml_Mat2d m, aml_real shift);
 AML_DEF void                    aml_shift_specific(struct Aml_Mat2d m, aml_real shift, size_t is, size_t ie);
+AML_DEF enum Aml_Simd_Level     aml_simd_level_get(void);
 AML_DEF void                    aml_sub(struct Aml_Mat2d dst, struct Aml_Mat2d a);
 AML_DEF void                    aml_sub_col_to_col(struct Aml_Mat2d des, size_t des_col, struct Aml_Mat2d src, size_t src_col);
 AML_DEF void                    aml_sub_row_to_row(struct Aml_Mat2d des, size_t des_row, struct Aml_Mat2d src, size_t src_row);
@@ -307,6 +371,35 @@ AML_DEF void                    aml_transpose_inplace(struct Aml_Mat2d m);
 #ifdef ALMOG_MATRIX_LIBRARY_IMPLEMENTATION
 #undef ALMOG_MATRIX_LIBRARY_IMPLEMENTATION
 
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+#else
+    #include <unistd.h>
+    #if !defined(AML_NO_THREADS)
+        #include <pthread.h>
+    #endif
+#endif
+
+/* x86 GEMM micro-kernels, picked at runtime from aml_simd_level_get(); define
+ * AML_NO_SIMD to build the scalar kernel only */
+#if !defined(AML_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+    #define AML_SIMD_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif
+#else
+    #define AML_SIMD_X86 0
+#endif
+
+/* GCC and Clang need the target attribute to accept the intrinsics of an
+ * instruction set that is only selected at runtime */
+#if defined(__GNUC__) || defined(__clang__)
+    #define AML_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define AML_TARGET(isa)
+#endif
+
 /**
  * @brief Add matrix @p a into @p dst element-wise.
  *
@@ -714,6 +807,55 @@ AML_DEF void aml_copy_src_window_to_des(struct Aml_Mat2d des, struct Aml_Mat2d s
     AML_UNUSED(je);
 }
 
+/**
+ * @brief Return the number of logical processors available to the process.
+ * @return Processor count, at least 1.
+ */
+AML_DEF size_t aml_cpu_count_get(void)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+#else
+    return 1;
+#endif
+}
+
+/**
+ * @brief Create a non-owning view of a rectangular block of a matrix.
+ *
+ * The returned matrix starts at `(i,j)` of @p src, has @p rows x @p cols
+ * elements and shares storage and row stride with @p src, so it can be passed
+ * to any routine (e.g. aml_gemm()) to work on part of a larger matrix.
+ *
+ * @param src Source matrix.
+ * @param i First row of the block.
+ * @param j First column of the block.
+ * @param rows Number of rows of the block.
+ * @param cols Number of columns of the block.
+ * @return A view into @p src.
+ * @pre `i + rows <= src.rows` and `j + cols <= src.cols`.
+ *
+ * Complexity
+ * `O(1)`.
+ */
+AML_DEF struct Aml_Mat2d aml_create_block_ref(struct Aml_Mat2d src, size_t i, size_t j, size_t rows, size_t cols)
+{
+    AML_ASSERT(i + rows <= src.rows);
+    AML_ASSERT(j + cols <= src.cols);
+
+    struct Aml_Mat2d block = {.cols = cols,
+                 .rows = rows,
+                 .stride_r = src.stride_r,
+                 .elements = src.elements + i * src.stride_r + j};
+
+    return block;
+}
+
 /**
  * @brief Create a non-owning column view into an existing matrix.
  *
@@ -772,6 +914,9 @@ void aml_cross(struct Aml_Mat2d dst, struct Aml_Mat2d v1, struct Aml_Mat2d v2)
  * @warning The implementation writes directly into @p dst, so aliasing @p dst
  * with @p a or @p b is unsafe.
  *
+ * Runs on the packed GEMM engine, see aml_gemm(). aml_dot_fast() is the same
+ * product taking the matrices by pointer.
+ *
  * Complexity
  * `O(a.rows * a.cols * b.cols)`.
  */
@@ -810,61 +955,7 @@ AML_DEF void aml_dot_fast(struct Aml_Mat2d *AML_RESTRICT dst, struct Aml_Mat2d *
     AML_ASSERT(dst->elements != a->elements);
     AML_ASSERT(dst->elements != b->elements);
 
-    size_t i, j, k;
-
-    aml_fill(*dst, 0);
-
-    #if 1 /* simple block optimized version */
-    const size_t m = dst->rows;
-    const size_t n = dst->cols;
-    const size_t kmax = a->cols;
-    const size_t as = a->stride_r;
-    const size_t bs = b->stride_r;
-    const size_t cs = dst->stride_r;
-    aml_real *AML_RESTRICT c = dst->elements;
-    const aml_real *AML_RESTRICT ae = a->elements;
-    const aml_real *AML_RESTRICT be = b->elements;
-
-    /**
-     * The best BI/BK/BJ values depend on CPU and whether aml_real is float or double, so benchmark a few combinations. 
-     */
-    enum { BI = 32, BK = 64, BJ = 128 };
-
-    for (size_t ii = 0; ii < m; ii += BI) {
-        const size_t i_end = aml_min(ii + BI, m);
-        for (size_t kk = 0; kk < kmax; kk += BK) {
-            const size_t k_end = aml_min(kk + BK, kmax);
-            for (size_t jj = 0; jj < n; jj += BJ) {
-                const size_t j_end = aml_min(jj + BJ, n);
-                for (i = ii; i < i_end; ++i) {
-                    aml_real *AML_RESTRICT crow = c + i * cs + jj;
-                    for (k = kk; k < k_end; ++k) {
-                        const aml_real aik = ae[i * as + k];
-                        const aml_real *AML_RESTRICT brow = be + k * bs + jj;
-                        for (j = 0; j < j_end - jj; ++j) {
-                            crow[j] += aik * brow[j];
-                        }
-                    }
-                }
-            }
-        }
-    }
-    #else /* simple non block optimized version */
-    for (i = 0; i < dst->rows; i++) {
-        aml_real *AML_RESTRICT a_row = &AML_MAT2D_AT(*a, i, 0);
-        aml_real *AML_RESTRICT dst_row = &AML_MAT2D_AT(*dst, i, 0);
-
-        for (k = 0; k < a->cols; k++) {
-            aml_real aik = *(a_row++);
-            aml_real *AML_RESTRICT b_row = &AML_MAT2D_AT(*b, k, 0);
-
-            for (j = 0; j < dst->cols; j++) {
-                dst_row[j] += aik * *(b_row++);
-            }
-        }
-    }
-    #endif
-
+    aml_gemm(*dst, 1, *a, *b, 0);
 }
 
 /**
@@ -993,6 +1084,739 @@ AML_DEF void aml_fill_uint32(struct Aml_Mat2d_uint32 m, uint32_t x)
     }
 }
 
+/* Micro-tile bounds of every kernel below; the edge tiles of a product are
+ * staged in a buffer of this size. */
+#define AML_GEMM_MAX_MR 12
+#define AML_GEMM_MAX_NR 32
+
+/* products of at most this many multiply-adds, or thinner than one
+ * micro-tile, skip the packing */
+#define AML_GEMM_SMALL_WORK (48 * 48 * 48)
+
+/* multiply-adds that justify one more worker thread */
+#define AML_GEMM_WORK_PER_THREAD (96 * 96 * 96)
+
+/* c[0..mr)[0..nr) (row stride cs) += alpha * a * b over kc packed columns of
+ * a (mr values each) and rows of b (nr values each) */
+typedef void (*Aml_Gemm_Kernel)(size_t kc, aml_real alpha, const aml_real *AML_RESTRICT a, const aml_real *AML_RESTRICT b, aml_real *AML_RESTRICT c, size_t cs);
+
+enum { AML_GEMM_SCALAR_MR = 4, AML_GEMM_SCALAR_NR = 4 };
+
+static void aml_gemm_kernel_scalar(size_t kc, aml_real alpha, const aml_real *AML_RESTRICT a, const aml_real *AML_RESTRICT b, aml_real *AML_RESTRICT c, size_t cs)
+{
+    aml_real acc[AML_GEMM_SCALAR_MR][AML_GEMM_SCALAR_NR] = {{0}};
+
+    for (size_t p = 0; p < kc; p++) {
+        for (size_t r = 0; r < AML_GEMM_SCALAR_MR; r++) {
+            const aml_real ar = a[r];
+            for (size_t j = 0; j < AML_GEMM_SCALAR_NR; j++) {
+                acc[r][j] += ar * b[j];
+            }
+        }
+        a += AML_GEMM_SCALAR_MR;
+        b += AML_GEMM_SCALAR_NR;
+    }
+
+    for (size_t r = 0; r < AML_GEMM_SCALAR_MR; r++) {
+        for (size_t j = 0; j < AML_GEMM_SCALAR_NR; j++) {
+            c[r * cs + j] += alpha * acc[r][j];
+        }
+    }
+}
+
+#if AML_SIMD_X86
+#if defined(AML_SINGLE_PRECISION)
+    #define AML_V256                __m256
+    #define AML_V256_LANES          8
+    #define AML_V256_ZERO()         _mm256_setzero_ps()
+    #define AML_V256_SET1(x)        _mm256_set1_ps(x)
+    #define AML_V256_LOAD(p)        _mm256_loadu_ps(p)
+    #define AML_V256_STORE(p, v)    _mm256_storeu_ps(p, v)
+    #define AML_V256_FMADD(a, b, c) _mm256_fmadd_ps(a, b, c)
+    #define AML_V512                __m512
+    #define AML_V512_LANES          16
+    #define AML_V512_ZERO()         _mm512_setzero_ps()
+    #define AML_V512_SET1(x)        _mm512_set1_ps(x)
+    #define AML_V512_LOAD(p)        _mm512_loadu_ps(p)
+    #define AML_V512_STORE(p, v)    _mm512_storeu_ps(p, v)
+    #define AML_V512_FMADD(a, b, c) _mm512_fmadd_ps(a, b, c)
+#else
+    #define AML_V256                __m256d
+    #define AML_V256_LANES          4
+    #define AML_V256_ZERO()         _mm256_setzero_pd()
+    #define AML_V256_SET1(x)        _mm256_set1_pd(x)
+    #define AML_V256_LOAD(p)        _mm256_loadu_pd(p)
+    #define AML_V256_STORE(p, v)    _mm256_storeu_pd(p, v)
+    #define AML_V256_FMADD(a, b, c) _mm256_fmadd_pd(a, b, c)
+    #define AML_V512                __m512d
+    #define AML_V512_LANES          8
+    #define AML_V512_ZERO()         _mm512_setzero_pd()
+    #define AML_V512_SET1(x)        _mm512_set1_pd(x)
+    #define AML_V512_LOAD(p)        _mm512_loadu_pd(p)
+    #define AML_V512_STORE(p, v)    _mm512_storeu_pd(p, v)
+    #define AML_V512_FMADD(a, b, c) _mm512_fmadd_pd(a, b, c)
+#endif
+
+/* Both kernels keep a micro-tile of mr rows by two vectors in named
+ * accumulators: 12 of the 16 ymm registers for AVX2, 24 of the 32 zmm
+ * registers for AVX-512. */
+enum {
+    AML_GEMM_AVX2_MR   = 6,
+    AML_GEMM_AVX2_NR   = 2 * AML_V256_LANES,
+    AML_GEMM_AVX512_MR = 12,
+    AML_GEMM_AVX512_NR = 2 * AML_V512_LANES,
+};
+
+#define AML_GEMM_ACC_DECLARE(V, r) V c##r##0 = V##_ZERO(), c##r##1 = V##_ZERO()
+
+#define AML_GEMM_ACC_FMADD(V, r)                \
+    do {                                        \
+        V ar = V##_SET1(a[r]);                  \
+        c##r##0 = V##_FMADD(ar, b0, c##r##0);   \
+        c##r##1 = V##_FMADD(ar, b1, c##r##1);   \
+    } while (0)
+
+#define AML_GEMM_ACC_STORE(V, r)                                                            \
+    do {                                                                                    \
+        aml_real *cr = c + (r) * cs;                                                        \
+        V##_STORE(cr, V##_FMADD(alpha_v, c##r##0, V##_LOAD(cr)));                           \
+        V##_STORE(cr + V##_LANES, V##_FMADD(alpha_v, c##r##1, V##_LOAD(cr + V##_LANES)));   \
+    } while (0)
+
+static AML_TARGET("avx2,fma") void aml_gemm_kernel_avx2(size_t kc, aml_real alpha, const aml_real *AML_RESTRICT a, const aml_real *AML_RESTRICT b, aml_real *AML_RESTRICT c, size_t cs)
+{
+    AML_GEMM_ACC_DECLARE(AML_V256, 0);
+    AML_GEMM_ACC_DECLARE(AML_V256, 1);
+    AML_GEMM_ACC_DECLARE(AML_V256, 2);
+    AML_GEMM_ACC_DECLARE(AML_V256, 3);
+    AML_GEMM_ACC_DECLARE(AML_V256, 4);
+    AML_GEMM_ACC_DECLARE(AML_V256, 5);
+
+    for (size_t p = 0; p < kc; p++) {
+        AML_V256 b0 = AML_V256_LOAD(b);
+        AML_V256 b1 = AML_V256_LOAD(b + AML_V256_LANES);
+        AML_GEMM_ACC_FMADD(AML_V256, 0);
+        AML_GEMM_ACC_FMADD(AML_V256, 1);
+        AML_GEMM_ACC_FMADD(AML_V256, 2);
+        AML_GEMM_ACC_FMADD(AML_V256, 3);
+        AML_GEMM_ACC_FMADD(AML_V256, 4);
+        AML_GEMM_ACC_FMADD(AML_V256, 5);
+        a += AML_GEMM_AVX2_MR;
+        b += AML_GEMM_AVX2_NR;
+    }
+
+    AML_V256 alpha_v = AML_V256_SET1(alpha);
+    AML_GEMM_ACC_STORE(AML_V256, 0);
+    AML_GEMM_ACC_STORE(AML_V256, 1);
+    AML_GEMM_ACC_STORE(AML_V256, 2);
+    AML_GEMM_ACC_STORE(AML_V256, 3);
+    AML_GEMM_ACC_STORE(AML_V256, 4);
+    AML_GEMM_ACC_STORE(AML_V256, 5);
+}
+
+static AML_TARGET("avx512f") void aml_gemm_kernel_avx512(size_t kc, aml_real alpha, const aml_real *AML_RESTRICT a, const aml_real *AML_RESTRICT b, aml_real *AML_RESTRICT c, size_t cs)
+{
+    AML_GEMM_ACC_DECLARE(AML_V512, 0);
+    AML_GEMM_ACC_DECLARE(AML_V512, 1);
+    AML_GEMM_ACC_DECLARE(AML_V512, 2);
+    AML_GEMM_ACC_DECLARE(AML_V512, 3);
+    AML_GEMM_ACC_DECLARE(AML_V512, 4);
+    AML_GEMM_ACC_DECLARE(AML_V512, 5);
+    AML_GEMM_ACC_DECLARE(AML_V512, 6);
+    AML_GEMM_ACC_DECLARE(AML_V512, 7);
+    AML_GEMM_ACC_DECLARE(AML_V512, 8);
+    AML_GEMM_ACC_DECLARE(AML_V512, 9);
+    AML_GEMM_ACC_DECLARE(AML_V512, 10);
+    AML_GEMM_ACC_DECLARE(AML_V512, 11);
+
+    for (size_t p = 0; p < kc; p++) {
+        AML_V512 b0 = AML_V512_LOAD(b);
+        AML_V512 b1 = AML_V512_LOAD(b + AML_V512_LANES);
+        AML_GEMM_ACC_FMADD(AML_V512, 0);
+        AML_GEMM_ACC_FMADD(AML_V512, 1);
+        AML_GEMM_ACC_FMADD(AML_V512, 2);
+        AML_GEMM_ACC_FMADD(AML_V512, 3);
+        AML_GEMM_ACC_FMADD(AML_V512, 4);
+        AML_GEMM_ACC_FMADD(AML_V512, 5);
+        AML_GEMM_ACC_FMADD(AML_V512, 6);
+        AML_GEMM_ACC_FMADD(AML_V512, 7);
+        AML_GEMM_ACC_FMADD(AML_V512, 8);
+        AML_GEMM_ACC_FMADD(AML_V512, 9);
+        AML_GEMM_ACC_FMADD(AML_V512, 10);
+        AML_GEMM_ACC_FMADD(AML_V512, 11);
+        a += AML_GEMM_AVX512_MR;
+        b += AML_GEMM_AVX512_NR;
+    }
+
+    AML_V512 alpha_v = AML_V512_SET1(alpha);
+    AML_GEMM_ACC_STORE(AML_V512, 0);
+    AML_GEMM_ACC_STORE(AML_V512, 1);
+    AML_GEMM_ACC_STORE(AML_V512, 2);
+    AML_GEMM_ACC_STORE(AML_V512, 3);
+    AML_GEMM_ACC_STORE(AML_V512, 4);
+    AML_GEMM_ACC_STORE(AML_V512, 5);
+    AML_GEMM_ACC_STORE(AML_V512, 6);
+    AML_GEMM_ACC_STORE(AML_V512, 7);
+    AML_GEMM_ACC_STORE(AML_V512, 8);
+    AML_GEMM_ACC_STORE(AML_V512, 9);
+    AML_GEMM_ACC_STORE(AML_V512, 10);
+    AML_GEMM_ACC_STORE(AML_V512, 11);
+}
+#endif /* AML_SIMD_X86 */
+
+/* L1 data, L2 and L3 cache sizes in bytes, 0 where the OS does not say */
+static void aml_cache_sizes_detect(size_t sizes[3])
+{
+    sizes[0] = sizes[1] = sizes[2] = 0;
+#if defined(_WIN32) || defined(_WIN64)
+    DWORD length = 0;
+    GetLogicalProcessorInformation(NULL, &length);
+    SYSTEM_LOGICAL_PROCESSOR_INFORMATION *info = (SYSTEM_LOGICAL_PROCESSOR_INFORMATION *)AML_MALLOC(length);
+    if (info == NULL) {
+        return;
+    }
+    if (GetLogicalProcessorInformation(info, &length)) {
+        for (size_t i = 0; i < length / sizeof(*info); i++) {
+            if (info[i].Relationship != RelationCache) {
+                continue;
+            }
+            CACHE_DESCRIPTOR cache = info[i].Cache;
+            if (cache.Level >= 1 && cache.Level <= 3 && cache.Type != CacheInstruction) {
+                sizes[cache.Level - 1] = aml_max(sizes[cache.Level - 1], (size_t)cache.Size);
+            }
+        }
+    }
+    AML_FREE(info);
+#else
+    #if defined(_SC_LEVEL1_DCACHE_SIZE)
+    long l1 = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    long l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    sizes[0] = l1 > 0 ? (size_t)l1 : 0;
+    sizes[1] = l2 > 0 ? (size_t)l2 : 0;
+    sizes[2] = l3 > 0 ? (size_t)l3 : 0;
+    #endif
+#endif
+}
+
+static size_t aml_round_down(size_t x, size_t multiple, size_t low, size_t high)
+{
+    x = aml_min(aml_max(x, low), high);
+    return aml_max(x / multiple * multiple, multiple);
+}
+
+static size_t aml_round_up(size_t x, size_t multiple)
+{
+    return (x + multiple - 1) / multiple * multiple;
+}
+
+static struct {
+    bool ready;
+    struct Aml_Gemm_Config config;
+    Aml_Gemm_Kernel kernel;
+} aml_gemm_state;
+
+/* Fill the zero fields of a configuration: the micro-tile follows the
+ * kernel, kc keeps a kc x nr micro-panel of b in half the L1 cache, mc keeps
+ * the packed mc x kc block of a in half the L2 cache and nc keeps the kc x nc
+ * panel of b in half the L3 cache. */
+static void aml_gemm_config_resolve(struct Aml_Gemm_Config *config)
+{
+    if ((int)config->simd_level > (int)aml_simd_level_get()) {
+        config->simd_level = aml_simd_level_get();
+    }
+
+    aml_gemm_state.kernel = aml_gemm_kernel_scalar;
+    config->mr = AML_GEMM_SCALAR_MR;
+    config->nr = AML_GEMM_SCALAR_NR;
+#if AML_SIMD_X86
+    if (config->simd_level == AML_SIMD_AVX512) {
+        aml_gemm_state.kernel = aml_gemm_kernel_avx512;
+        config->mr = AML_GEMM_AVX512_MR;
+        config->nr = AML_GEMM_AVX512_NR;
+    } else if (config->simd_level == AML_SIMD_AVX2) {
+        aml_gemm_state.kernel = aml_gemm_kernel_avx2;
+        config->mr = AML_GEMM_AVX2_MR;
+        config->nr = AML_GEMM_AVX2_NR;
+    }
+#endif
+
+    size_t caches[3];
+    aml_cache_sizes_detect(caches);
+    size_t l1 = caches[0] ? caches[0] : 32 * 1024;
+    size_t l2 = caches[1] ? caches[1] : 256 * 1024;
+    size_t l3 = caches[2] ? caches[2] : 8 * 1024 * 1024;
+
+    if (config->kc == 0) {
+        config->kc = l1 / 2 / (config->nr * sizeof(aml_real));
+    }
+    config->kc = aml_round_down(config->kc, 8, 64, 1024);
+    if (config->mc == 0) {
+        config->mc = l2 / 2 / (config->kc * sizeof(aml_real));
+    }
+    config->mc = aml_round_down(config->mc, config->mr, config->mr, 4096);
+    if (config->nc == 0) {
+        config->nc = l3 / 2 / (config->kc * sizeof(aml_real));
+    }
+    config->nc = aml_round_down(config->nc, config->nr, config->nr, 8192);
+}
+
+static struct Aml_Gemm_Config aml_gemm_config_current(void)
+{
+    if (!aml_gemm_state.ready) {
+        struct Aml_Gemm_Config config = {0};
+        config.simd_level = aml_simd_level_get();
+        aml_gemm_config_resolve(&config);
+        aml_gemm_state.config = config;
+        aml_gemm_state.ready = true;
+    }
+    return aml_gemm_state.config;
+}
+
+/* Shared state of one aml_parallel_for() call. Workers claim tasks in order
+ * through next_task. */
+struct Aml_Parallel_Context {
+    Aml_Parallel_Task task;
+    void *context;
+    size_t num_of_tasks;
+    volatile long next_task;
+};
+
+struct Aml_Parallel_Worker {
+    struct Aml_Parallel_Context *context;
+    size_t index;
+};
+
+static size_t aml_parallel_next_task(struct Aml_Parallel_Context *context)
+{
+#if defined(AML_NO_THREADS)
+    return (size_t)context->next_task++;
+#elif defined(_WIN32) || defined(_WIN64)
+    return (size_t)(InterlockedIncrement(&context->next_task) - 1);
+#else
+    return (size_t)__atomic_fetch_add(&context->next_task, 1, __ATOMIC_RELAXED);
+#endif
+}
+
+static void aml_parallel_worker_run(struct Aml_Parallel_Worker *worker)
+{
+    struct Aml_Parallel_Context *context = worker->context;
+    for (;;) {
+        size_t i = aml_parallel_next_task(context);
+        if (i >= context->num_of_tasks) {
+            break;
+        }
+        context->task(context->context, i, worker->index);
+    }
+}
+
+#if !defined(AML_NO_THREADS)
+#if defined(_WIN32) || defined(_WIN64)
+static DWORD WINAPI aml_parallel_worker_entry(LPVOID arg)
+{
+    aml_parallel_worker_run((struct Aml_Parallel_Worker *)arg);
+    return 0;
+}
+#else
+static void *aml_parallel_worker_entry(void *arg)
+{
+    aml_parallel_worker_run((struct Aml_Parallel_Worker *)arg);
+    return NULL;
+}
+#endif
+#endif
+
+/**
+ * @brief Run `task(context, i, worker)` for every `i` in `[0, num_of_tasks)`
+ * on @p num_of_threads workers.
+ *
+ * Workers claim tasks in increasing order, so uneven tasks balance out. The
+ * calling thread is worker 0 and the call returns when every task is done. A
+ * thread that fails to start only means fewer workers; with `AML_NO_THREADS`
+ * everything runs on the calling thread.
+ *
+ * @param num_of_tasks Number of tasks.
+ * @param task Task callback.
+ * @param context Passed through to @p task.
+ * @param num_of_threads Number of workers, e.g. aml_cpu_count_get().
+ */
+AML_DEF void aml_parallel_for(size_t num_of_tasks, Aml_Parallel_Task task, void *context, size_t num_of_threads)
+{
+#if defined(AML_NO_THREADS)
+    num_of_threads = 1;
+#endif
+    if (num_of_threads > num_of_tasks) {
+        num_of_threads = num_of_tasks;
+    }
+    if (num_of_threads <= 1) {
+        for (size_t i = 0; i < num_of_tasks; i++) {
+            task(context, i, 0);
+        }
+        return;
+    }
+
+    struct Aml_Parallel_Context parallel_context;
+    parallel_context.task = task;
+    parallel_context.context = context;
+    parallel_context.num_of_tasks = num_of_tasks;
+    parallel_context.next_task = 0;
+
+    struct Aml_Parallel_Worker *workers = (struct Aml_Parallel_Worker *)AML_MALLOC(sizeof(*workers) * num_of_threads);
+    AML_ASSERT(workers != NULL);
+    for (size_t t = 0; t < num_of_threads; t++) {
+        workers[t].context = &parallel_context;
+        workers[t].index = t;
+    }
+
+#if defined(AML_NO_THREADS)
+    aml_parallel_worker_run(&workers[0]);
+#elif defined(_WIN32) || defined(_WIN64)
+    HANDLE *threads = (HANDLE *)AML_MALLOC(sizeof(*threads) * num_of_threads);
+    AML_ASSERT(threads != NULL);
+    for (size_t t = 1; t < num_of_threads; t++) {
+        threads[t] = CreateThread(NULL, 0, aml_parallel_worker_entry, &workers[t], 0, NULL);
+    }
+    aml_parallel_worker_run(&workers[0]);
+    for (size_t t = 1; t < num_of_threads; t++) {
+        if (threads[t] != NULL) {
+            WaitForSingleObject(threads[t], INFINITE);
+            CloseHandle(threads[t]);
+        }
+    }
+    AML_FREE(threads);
+#else
+    pthread_t *threads = (pthread_t *)AML_MALLOC(sizeof(*threads) * num_of_threads);
+    bool *started = (bool *)AML_MALLOC(sizeof(*started) * num_of_threads);
+    AML_ASSERT(threads != NULL && started != NULL);
+    for (size_t t = 1; t < num_of_threads; t++) {
+        started[t] = pthread_create(&threads[t], NULL, aml_parallel_worker_entry, &workers[t]) == 0;
+    }
+    aml_parallel_worker_run(&workers[0]);
+    for (size_t t = 1; t < num_of_threads; t++) {
+        if (started[t]) {
+            pthread_join(threads[t], NULL);
+        }
+    }
+    AML_FREE(threads);
+    AML_FREE(started);
+#endif
+
+    AML_FREE(workers);
+}
+
+/* c = beta * c without reading c when beta is 0, so NaN garbage in a fresh
+ * output does not leak into the product */
+static void aml_gemm_scale(aml_real *c, size_t cs, size_t rows, size_t cols, aml_real beta)
+{
+    if (beta == 1) {
+        return;
+    }
+    for (size_t i = 0; i < rows; i++) {
+        aml_real *crow = c + i * cs;
+        for (size_t j = 0; j < cols; j++) {
+            crow[j] = beta == 0 ? 0 : beta * crow[j];
+        }
+    }
+}
+
+/* Pack rows [0, mc) and columns [0, kc) of a into micro-panels of mr rows
+ * stored column by column, zero-padding the last panel. */
+static void aml_gemm_pack_a(aml_real *AML_RESTRICT dst, const aml_real *AML_RESTRICT a, size_t as, size_t mc, size_t kc, size_t mr)
+{
+    for (size_t i = 0; i < mc; i += mr) {
+        const size_t rows = aml_min(mr, mc - i);
+        for (size_t r = 0; r < mr; r++) {
+            const aml_real *arow = a + (i + r) * as;
+            aml_real *d = dst + r;
+            if (r < rows) {
+                for (size_t p = 0; p < kc; p++) {
+                    d[p * mr] = arow[p];
+                }
+            } else {
+                for (size_t p = 0; p < kc; p++) {
+                    d[p * mr] = 0;
+                }
+            }
+        }
+        dst += mr * kc;
+    }
+}
+
+/* Pack rows [0, kc) and columns [0, nc) of b into micro-panels of nr columns
+ * stored row by row, zero-padding the last panel. */
+static void aml_gemm_pack_b(aml_real *AML_RESTRICT dst, const aml_real *AML_RESTRICT b, size_t bs, size_t kc, size_t nc, size_t nr)
+{
+    for (size_t j = 0; j < nc; j += nr) {
+        const size_t cols = aml_min(nr, nc - j);
+        for (size_t p = 0; p < kc; p++) {
+            const aml_real *brow = b + p * bs + j;
+            size_t c = 0;
+            for (; c < cols; c++) {
+                dst[c] = brow[c];
+            }
+            for (; c < nr; c++) {
+                dst[c] = 0;
+            }
+            dst += nr;
+        }
+    }
+}
+
+/* One task of aml_gemm(): the product of an (m x k) band of a and a (k x n)
+ * band of b into an (m x n) tile of c, with per-worker pack buffers. */
+struct Aml_Gemm_Job {
+    const aml_real *a;
+    const aml_real *b;
+    aml_real *c;
+    size_t as;
+    size_t bs;
+    size_t cs;
+    size_t m;
+    size_t n;
+    size_t k;
+    aml_real alpha;
+    aml_real beta;
+    size_t tile_rows;
+    size_t tile_cols;
+    size_t grid_cols;
+    struct Aml_Gemm_Config config;
+    Aml_Gemm_Kernel kernel;
+    aml_real **packed_a;
+    aml_real **packed_b;
+};
+
+static void aml_gemm_task(void *context, size_t task, size_t worker)
+{
+    struct Aml_Gemm_Job *job = (struct Aml_Gemm_Job *)context;
+    const size_t mr = job->config.mr;
+    const size_t nr = job->config.nr;
+    const size_t mc = job->config.mc;
+    const size_t kc = job->config.kc;
+    const size_t nc = job->config.nc;
+    aml_real *packed_a = job->packed_a[worker];
+    aml_real *packed_b = job->packed_b[worker];
+    aml_real edge[AML_GEMM_MAX_MR * AML_GEMM_MAX_NR];
+
+    const size_t i0 = (task / job->grid_cols) * job->tile_rows;
+    const size_t j0 = (task % job->grid_cols) * job->tile_cols;
+    const size_t i1 = aml_min(i0 + job->tile_rows, job->m);
+    const size_t j1 = aml_min(j0 + job->tile_cols, job->n);
+
+    aml_gemm_scale(job->c + i0 * job->cs + j0, job->cs, i1 - i0, j1 - j0, job->beta);
+
+    for (size_t jc = j0; jc < j1; jc += nc) {
+        const size_t ncur = aml_min(nc, j1 - jc);
+        for (size_t pc = 0; pc < job->k; pc += kc) {
+            const size_t kcur = aml_min(kc, job->k - pc);
+            aml_gemm_pack_b(packed_b, job->b + pc * job->bs + jc, job->bs, kcur, ncur, nr);
+
+            for (size_t ic = i0; ic < i1; ic += mc) {
+                const size_t mcur = aml_min(mc, i1 - ic);
+                aml_gemm_pack_a(packed_a, job->a + ic * job->as + pc, job->as, mcur, kcur, mr);
+
+                for (size_t jr = 0; jr < ncur; jr += nr) {
+                    const size_t cols = aml_min(nr, ncur - jr);
+                    for (size_t ir = 0; ir < mcur; ir += mr) {
+                        const size_t rows = aml_min(mr, mcur - ir);
+                        const aml_real *ap = packed_a + ir * kcur;
+                        const aml_real *bp = packed_b + jr * kcur;
+                        aml_real *ct = job->c + (ic + ir) * job->cs + jc + jr;
+
+                        if (rows == mr && cols == nr) {
+                            job->kernel(kcur, job->alpha, ap, bp, ct, job->cs);
+                            continue;
+                        }
+                        /* edge tile: stage c so it sees the same operations
+                         * as a full tile */
+                        for (size_t r = 0; r < mr; r++) {
+                            for (size_t j = 0; j < nr; j++) {
+                                edge[r * nr + j] = (r < rows && j < cols) ? ct[r * job->cs + j] : 0;
+                            }
+                        }
+                        job->kernel(kcur, job->alpha, ap, bp, edge, nr);
+                        for (size_t r = 0; r < rows; r++) {
+                            for (size_t j = 0; j < cols; j++) {
+                                ct[r * job->cs + j] = edge[r * nr + j];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/* i/k/j product for problems too small or too thin to pay for packing */
+static void aml_gemm_small(struct Aml_Mat2d c, aml_real alpha, struct Aml_Mat2d a, struct Aml_Mat2d b, aml_real beta)
+{
+    aml_gemm_scale(c.elements, c.stride_r, c.rows, c.cols, beta);
+
+    for (size_t i = 0; i < c.rows; i++) {
+        aml_real *AML_RESTRICT crow = c.elements + i * c.stride_r;
+        const aml_real *AML_RESTRICT arow = a.elements + i * a.stride_r;
+        for (size_t p = 0; p < a.cols; p++) {
+            const aml_real aip = alpha * arow[p];
+            const aml_real *AML_RESTRICT brow = b.elements + p * b.stride_r;
+            for (size_t j = 0; j < c.cols; j++) {
+                crow[j] += aip * brow[j];
+            }
+        }
+    }
+}
+
+/* count values starting on a 64-byte cache line; *raw is the block to free */
+static aml_real *aml_gemm_buffer_alloc(size_t count, aml_real **raw)
+{
+    *raw = (aml_real *)AML_MALLOC(count * sizeof(aml_real) + 64);
+    AML_ASSERT(*raw != NULL);
+    uintptr_t address = (uintptr_t)*raw;
+    return (aml_real *)((address + 63) & ~(uintptr_t)63);
+}
+
+/**
+ * @brief General matrix multiplication `c = alpha * a * b + beta * c`.
+ *
+ * GotoBLAS / BLIS-style engine: for every kc-deep slice, a kc x nc panel of
+ * @p b and an mc x kc block of @p a are packed into contiguous micro-panels
+ * and an mr x nr register-blocked micro-kernel (AVX-512, AVX2 + FMA or
+ * scalar) runs over them. Large products split @p c into a grid of tiles, one
+ * per worker thread; every element of @p c still sees the same operations in
+ * the same order, so the result does not depend on the thread count. Small or
+ * thin products (fewer rows or columns than a micro-tile, e.g. matrix-vector)
+ * use a plain loop instead. When @p beta is 0, @p c is not read.
+ *
+ * @param c Output matrix, `a.rows x b.cols`.
+ * @param alpha Scale of the product.
+ * @param a Left factor.
+ * @param b Right factor.
+ * @param beta Scale of the previous contents of @p c.
+ * @pre `a.cols == b.rows`, `c.rows == a.rows`, `c.cols == b.cols`.
+ * @warning @p c must not overlap @p a or @p b.
+ *
+ * Complexity
+ * `O(a.rows * a.cols * b.cols)`.
+ */
+AML_DEF void aml_gemm(struct Aml_Mat2d c, aml_real alpha, struct Aml_Mat2d a, struct Aml_Mat2d b, aml_real beta)
+{
+    AML_ASSERT(a.cols == b.rows);
+    AML_ASSERT(a.rows == c.rows);
+    AML_ASSERT(b.cols == c.cols);
+
+    AML_ASSERT(c.elements != a.elements);
+    AML_ASSERT(c.elements != b.elements);
+
+    const size_t m = c.rows;
+    const size_t n = c.cols;
+    const size_t k = a.cols;
+    if (m == 0 || n == 0) {
+        return;
+    }
+    if (k == 0 || alpha == 0) {
+        aml_gemm_scale(c.elements, c.stride_r, m, n, beta);
+        return;
+    }
+
+    struct Aml_Gemm_Config config = aml_gemm_config_current();
+    const double work = (double)m * (double)n * (double)k;
+    if (work <= AML_GEMM_SMALL_WORK || m < config.mr || n < config.nr) {
+        aml_gemm_small(c, alpha, a, b, beta);
+        return;
+    }
+
+    size_t num_of_threads = config.num_of_threads == 0 ? aml_cpu_count_get() : config.num_of_threads;
+#if defined(AML_NO_THREADS)
+    num_of_threads = 1;
+#endif
+    if (work / AML_GEMM_WORK_PER_THREAD < (double)num_of_threads) {
+        num_of_threads = aml_max((size_t)(work / AML_GEMM_WORK_PER_THREAD), 1);
+    }
+
+    /* split c into grid_rows x grid_cols tiles, one per thread, picking the
+     * factorization with the least packing traffic (sum of tile sides) */
+    size_t grid_rows = 1;
+    double best_cost = -1;
+    for (size_t g = 1; g <= num_of_threads; g++) {
+        if (num_of_threads % g != 0) {
+            continue;
+        }
+        double cost = (double)m / g + (double)n / (num_of_threads / g);
+        if (best_cost < 0 || cost < best_cost) {
+            best_cost = cost;
+            grid_rows = g;
+        }
+    }
+
+    struct Aml_Gemm_Job job;
+    job.a = a.elements;
+    job.b = b.elements;
+    job.c = c.elements;
+    job.as = a.stride_r;
+    job.bs = b.stride_r;
+    job.cs = c.stride_r;
+    job.m = m;
+    job.n = n;
+    job.k = k;
+    job.alpha = alpha;
+    job.beta = beta;
+    job.tile_rows = aml_round_up((m + grid_rows - 1) / grid_rows, config.mr);
+    job.tile_cols = aml_round_up((n + num_of_threads / grid_rows - 1) / (num_of_threads / grid_rows), config.nr);
+    job.grid_cols = (n + job.tile_cols - 1) / job.tile_cols;
+    job.config = config;
+    job.kernel = aml_gemm_state.kernel;
+
+    const size_t num_of_tasks = ((m + job.tile_rows - 1) / job.tile_rows) * job.grid_cols;
+    num_of_threads = aml_min(num_of_threads, num_of_tasks);
+
+    const size_t packed_a_count = aml_min(config.mc, aml_round_up(job.tile_rows, config.mr)) * config.kc;
+    const size_t packed_b_count = config.kc * aml_min(config.nc, aml_round_up(job.tile_cols, config.nr));
+    aml_real **buffers = (aml_real **)AML_MALLOC(sizeof(*buffers) * num_of_threads * 4);
+    AML_ASSERT(buffers != NULL);
+    job.packed_a = buffers;
+    job.packed_b = buffers + num_of_threads;
+    aml_real **raw = buffers + 2 * num_of_threads;
+    for (size_t t = 0; t < num_of_threads; t++) {
+        job.packed_a[t] = aml_gemm_buffer_alloc(packed_a_count, &raw[2 * t]);
+        job.packed_b[t] = aml_gemm_buffer_alloc(packed_b_count, &raw[2 * t + 1]);
+    }
+
+    aml_parallel_for(num_of_tasks, aml_gemm_task, &job, num_of_threads);
+
+    for (size_t t = 0; t < 2 * num_of_threads; t++) {
+        AML_FREE(raw[t]);
+    }
+    AML_FREE(buffers);
+}
+
+/**
+ * @brief Return the configuration aml_gemm() runs with.
+ *
+ * The first call detects the instruction set and cache sizes and derives the
+ * block sizes from them.
+ *
+ * @return Current Aml_Gemm_Config.
+ */
+AML_DEF struct Aml_Gemm_Config aml_gemm_config_get(void)
+{
+    return aml_gemm_config_current();
+}
+
+/**
+ * @brief Override the configuration of aml_gemm(), e.g. to tune block sizes.
+ *
+ * Zero `mc`, `kc` and `nc` fields are derived from the cache sizes again, the
+ * others are rounded to the micro-tile; `mr` and `nr` always follow the
+ * kernel of `simd_level`, which is capped at aml_simd_level_get(). Not
+ * thread-safe: call it while no product is running.
+ *
+ * @param config New configuration.
+ */
+AML_DEF void aml_gemm_config_set(struct Aml_Gemm_Config config)
+{
+    aml_gemm_config_resolve(&config);
+    aml_gemm_state.config = config;
+    aml_gemm_state.ready = true;
+}
+
 /**
  * @brief Compute the squared Euclidean norm of a vector-shaped matrix.
  *
@@ -1953,6 +2777,58 @@ AML_DEF void aml_shift_specific(struct Aml_Mat2d m, aml_real shift, size_t is, s
     }
 }
 
+static enum Aml_Simd_Level aml_simd_level_detect(void)
+{
+#if AML_SIMD_X86
+    #if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+    __cpuid(info, 1);
+    bool fma     = (info[2] & (1 << 12)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx     = (info[2] & (1 << 28)) != 0;
+    bool avx2    = false;
+    bool avx512f = false;
+    if (max_leaf >= 7 && osxsave && avx) {
+        unsigned long long xcr0 = _xgetbv(0);
+        __cpuidex(info, 7, 0);
+        avx2    = (xcr0 & 0x6) == 0x6 && (info[1] & (1 << 5)) != 0;
+        avx512f = (xcr0 & 0xe6) == 0xe6 && (info[1] & (1 << 16)) != 0;
+    }
+    #else
+    __builtin_cpu_init();
+    bool fma     = __builtin_cpu_supports("fma");
+    bool avx2    = __builtin_cpu_supports("avx2");
+    bool avx512f = __builtin_cpu_supports("avx512f");
+    #endif
+
+    if (avx512f)     return AML_SIMD_AVX512;
+    if (avx2 && fma) return AML_SIMD_AVX2;
+#endif
+    return AML_SIMD_NONE;
+}
+
+/**
+ * @brief Return the highest instruction set the GEMM micro-kernels can use.
+ *
+ * The CPU is queried on the first call only; AVX2 and AVX-512 are only
+ * reported when the operating system also saves their registers. Concurrent
+ * first calls may both query the CPU, but they store the same value. Built
+ * with `AML_NO_SIMD`, or for a non-x86 target, this is always
+ * `AML_SIMD_NONE`.
+ *
+ * @return Highest supported Aml_Simd_Level.
+ */
+AML_DEF enum Aml_Simd_Level aml_simd_level_get(void)
+{
+    static int cached_level = -1;
+    if (cached_level < 0) {
+        cached_level = (int)aml_simd_level_detect();
+    }
+    return (enum Aml_Simd_Level)cached_level;
+}
+
 /**
  * @brief Subtract matrix @p a from @p dst element-wise.
  *
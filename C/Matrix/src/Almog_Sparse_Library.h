@@ -0,0 +1,1546 @@
+/**
+ * @file
+ * @brief Compressed sparse matrices (CSR/CSC) on top of Aml_Mat2d.
+ *
+ * This layer includes triplet (COO) builders, conversions to and from dense
+ * matrices, multi-threaded sparse matrix times dense matrix (SpMV) and sparse
+ * matrix times sparse matrix (SpGEMM) products, Jacobi and ILU(0)
+ * preconditioners and the CG, BiCGSTAB and GMRES iterative solvers.
+ *
+ * Vectors are dense n x 1 `struct Aml_Mat2d` views, so the results plug
+ * straight into the rest of the library. asl_csr_matvec() is an Ala_Matvec
+ * callback, so the Krylov eigensolvers of Almog_Linear_Algebra.h run on CSR
+ * matrices as well.
+ *
+ * Every builder returns its matrices with the entries of each row (CSR) or
+ * column (CSC) sorted by index and without duplicates, which ILU(0) and the
+ * conversions rely on.
+ *
+ * Some of the algorithms follow
+ *  - Y. Saad, Iterative Methods for Sparse Linear Systems, 2nd ed.: https://www-users.cse.umn.edu/~saad/IterMethBook_2ndEd.pdf
+ */
+
+#ifndef ALMOG_SPARSE_LIBRARY_H_
+#define ALMOG_SPARSE_LIBRARY_H_
+
+#include "Almog_Matrix_Library.h"
+
+#ifndef ASL_ASSERT
+#define ASL_ASSERT AML_ASSERT
+#endif //ASL_ASSERT
+
+/**
+ * @brief Compressed sparse row matrix.
+ *
+ * The entries of row `i` are `values[row_ptr[i] .. row_ptr[i+1]-1]` in the
+ * columns `col_idx[row_ptr[i] .. row_ptr[i+1]-1]`.
+ *
+ * @var Asl_CSR::rows
+ * Number of rows.
+ * @var Asl_CSR::cols
+ * Number of columns.
+ * @var Asl_CSR::nnz
+ * Number of stored entries, `row_ptr[rows]`.
+ * @var Asl_CSR::row_ptr
+ * `rows + 1` offsets of the rows into col_idx / values.
+ * @var Asl_CSR::col_idx
+ * Column of every stored entry.
+ * @var Asl_CSR::values
+ * Value of every stored entry.
+ */
+struct Asl_CSR {
+    size_t rows;
+    size_t cols;
+    size_t nnz;
+    size_t *row_ptr;
+    size_t *col_idx;
+    aml_real *values;
+};
+
+/**
+ * @brief Compressed sparse column matrix, the CSR layout of the transpose.
+ *
+ * @var Asl_CSC::rows
+ * Number of rows.
+ * @var Asl_CSC::cols
+ * Number of columns.
+ * @var Asl_CSC::nnz
+ * Number of stored entries, `col_ptr[cols]`.
+ * @var Asl_CSC::col_ptr
+ * `cols + 1` offsets of the columns into row_idx / values.
+ * @var Asl_CSC::row_idx
+ * Row of every stored entry.
+ * @var Asl_CSC::values
+ * Value of every stored entry.
+ */
+struct Asl_CSC {
+    size_t rows;
+    size_t cols;
+    size_t nnz;
+    size_t *col_ptr;
+    size_t *row_idx;
+    aml_real *values;
+};
+
+/**
+ * @brief One `(row, col, value)` entry of a triplet list.
+ */
+struct Asl_Triplet {
+    size_t row;
+    size_t col;
+    aml_real value;
+};
+
+/**
+ * @brief Growable list of triplets to assemble a sparse matrix from, e.g. one
+ * element matrix at a time. Repeated `(row, col)` entries are summed when the
+ * list is compressed.
+ */
+struct Asl_Triplets {
+    size_t rows;
+    size_t cols;
+    size_t count;
+    size_t capacity;
+    struct Asl_Triplet *elements;
+};
+
+/**
+ * @brief Preconditioners of the iterative solvers.
+ */
+enum Asl_Preconditioner_Type {
+    /**
+     * No preconditioning.
+     */
+    ASL_PRECONDITIONER_NONE,
+    /**
+     * Diagonal scaling, `M = diag(A)`.
+     */
+    ASL_PRECONDITIONER_JACOBI,
+    /**
+     * Incomplete LU factorization without fill-in, `M = L * U` on the
+     * sparsity pattern of `A`.
+     */
+    ASL_PRECONDITIONER_ILU0,
+};
+
+/**
+ * @brief A preconditioner `M ~ A` built by asl_preconditioner_create().
+ *
+ * @var Asl_Preconditioner::type
+ * Kind of preconditioner.
+ * @var Asl_Preconditioner::n
+ * Order of the matrix.
+ * @var Asl_Preconditioner::inv_diag
+ * Jacobi: `1 / a_ii`.
+ * @var Asl_Preconditioner::LU
+ * ILU(0): unit lower `L` below and `U` on and above the diagonal, on the
+ * pattern of `A`.
+ * @var Asl_Preconditioner::diag_idx
+ * ILU(0): position of the diagonal entry of every row of LU.
+ */
+struct Asl_Preconditioner {
+    enum Asl_Preconditioner_Type type;
+    size_t n;
+    aml_real *inv_diag;
+    struct Asl_CSR LU;
+    size_t *diag_idx;
+};
+
+/**
+ * @brief Outcome of an iterative solve.
+ *
+ * @var Asl_Solve_Info::iterations
+ * Iterations done (matrix-vector products for GMRES, steps for CG and
+ * BiCGSTAB).
+ * @var Asl_Solve_Info::residual_norm
+ * Final relative residual `||b - A x|| / ||b||`, recomputed from `x`.
+ * @var Asl_Solve_Info::converged
+ * Whether residual_norm reached the requested tolerance.
+ */
+struct Asl_Solve_Info {
+    size_t iterations;
+    aml_real residual_norm;
+    bool converged;
+};
+
+#ifndef ASL_DEF
+    #ifdef ASL_DEF_STATIC
+        #define ASL_DEF static
+    #else
+        #define ASL_DEF extern
+    #endif
+#endif
+
+#define ASL_TRIPLETS_INIT_CAPACITY 256
+#define ASL_PARALLEL_MIN_NNZ 65536
+#define ASL_PARALLEL_TASKS_PER_THREAD 4
+#define ASL_GMRES_DEFAULT_RESTART 30
+
+ASL_DEF void                              asl_csc_free(struct Asl_CSC A);
+ASL_DEF struct Asl_CSC                    asl_csc_from_triplets(const struct Asl_Triplets *triplets);
+ASL_DEF void                              asl_csc_spmv(struct Aml_Mat2d y, aml_real alpha, struct Asl_CSC A, struct Aml_Mat2d x, aml_real beta);
+ASL_DEF struct Asl_CSR                    asl_csc_to_csr(struct Asl_CSC A);
+ASL_DEF struct Asl_CSR                    asl_csr_alloc(size_t rows, size_t cols, size_t nnz);
+ASL_DEF void                              asl_csr_free(struct Asl_CSR A);
+ASL_DEF struct Asl_CSR                    asl_csr_from_dense(struct Aml_Mat2d m, aml_real drop_tolerance);
+ASL_DEF struct Asl_CSR                    asl_csr_from_triplets(const struct Asl_Triplets *triplets);
+ASL_DEF void                              asl_csr_matvec(struct Aml_Mat2d y, struct Aml_Mat2d x, void *A);
+ASL_DEF struct Asl_CSR                    asl_csr_spgemm(struct Asl_CSR A, struct Asl_CSR B);
+ASL_DEF void                              asl_csr_spmv(struct Aml_Mat2d y, aml_real alpha, struct Asl_CSR A, struct Aml_Mat2d x, aml_real beta);
+ASL_DEF struct Asl_CSC                    asl_csr_to_csc(struct Asl_CSR A);
+ASL_DEF void                              asl_csr_to_dense(struct Aml_Mat2d des, struct Asl_CSR A);
+ASL_DEF struct Asl_CSR                    asl_csr_transpose(struct Asl_CSR A);
+
+ASL_DEF void                              asl_preconditioner_apply(const struct Asl_Preconditioner *P, struct Aml_Mat2d z, struct Aml_Mat2d r);
+ASL_DEF struct Asl_Preconditioner         asl_preconditioner_create(struct Asl_CSR A, enum Asl_Preconditioner_Type type);
+ASL_DEF void                              asl_preconditioner_free(struct Asl_Preconditioner P);
+
+ASL_DEF struct Asl_Solve_Info             asl_solve_BiCGSTAB(struct Asl_CSR A, struct Aml_Mat2d x, struct Aml_Mat2d b, const struct Asl_Preconditioner *P, aml_real tolerance, size_t max_iterations);
+ASL_DEF struct Asl_Solve_Info             asl_solve_CG(struct Asl_CSR A, struct Aml_Mat2d x, struct Aml_Mat2d b, const struct Asl_Preconditioner *P, aml_real tolerance, size_t max_iterations);
+ASL_DEF struct Asl_Solve_Info             asl_solve_GMRES(struct Asl_CSR A, struct Aml_Mat2d x, struct Aml_Mat2d b, const struct Asl_Preconditioner *P, size_t restart, aml_real tolerance, size_t max_iterations);
+
+ASL_DEF void                              asl_triplets_add(struct Asl_Triplets *triplets, size_t row, size_t col, aml_real value);
+ASL_DEF struct Asl_Triplets               asl_triplets_alloc(size_t rows, size_t cols, size_t capacity);
+ASL_DEF void                              asl_triplets_free(struct Asl_Triplets triplets);
+
+#endif // ALMOG_SPARSE_LIBRARY_H_
+
+#ifdef ALMOG_SPARSE_LIBRARY_IMPLEMENTATION
+#undef ALMOG_SPARSE_LIBRARY_IMPLEMENTATION
+
+/* Compress n_major lists of (minor index, value) pairs, given as the triplets
+ * with major index `major_of(t)`, into ptr / idx / values with every list
+ * sorted by minor index and repeated minor indices summed. Two stable
+ * counting sorts, first by minor then by major index, so O(count + rows +
+ * cols). */
+static size_t asl_triplets_compress(const struct Asl_Triplets *triplets, bool by_column, size_t **ptr_out, size_t **idx_out, aml_real **values_out)
+{
+    size_t n_major = by_column ? triplets->cols : triplets->rows;
+    size_t n_minor = by_column ? triplets->rows : triplets->cols;
+    size_t count = triplets->count;
+    const struct Asl_Triplet *t = triplets->elements;
+
+    size_t *minor_count = (size_t *)AML_MALLOC(sizeof(size_t) * (n_minor + 1));
+    size_t *ptr = (size_t *)AML_MALLOC(sizeof(size_t) * (n_major + 1));
+    size_t *by_minor = (size_t *)AML_MALLOC(sizeof(size_t) * (count ? count : 1));
+    size_t *order = (size_t *)AML_MALLOC(sizeof(size_t) * (count ? count : 1));
+    ASL_ASSERT(minor_count != NULL && ptr != NULL && by_minor != NULL && order != NULL);
+
+    for (size_t i = 0; i <= n_minor; i++) {
+        minor_count[i] = 0;
+    }
+    for (size_t i = 0; i <= n_major; i++) {
+        ptr[i] = 0;
+    }
+    for (size_t e = 0; e < count; e++) {
+        size_t major = by_column ? t[e].col : t[e].row;
+        size_t minor = by_column ? t[e].row : t[e].col;
+        minor_count[minor + 1]++;
+        ptr[major + 1]++;
+    }
+    for (size_t i = 0; i < n_minor; i++) {
+        minor_count[i + 1] += minor_count[i];
+    }
+    for (size_t i = 0; i < n_major; i++) {
+        ptr[i + 1] += ptr[i];
+    }
+    for (size_t e = 0; e < count; e++) {
+        by_minor[minor_count[by_column ? t[e].row : t[e].col]++] = e;
+    }
+    /* ptr[major] is used as the insertion point and ends up shifted by one
+     * list */
+    for (size_t k = 0; k < count; k++) {
+        size_t e = by_minor[k];
+        order[ptr[by_column ? t[e].col : t[e].row]++] = e;
+    }
+    for (size_t i = n_major; i > 0; i--) {
+        ptr[i] = ptr[i - 1];
+    }
+    ptr[0] = 0;
+
+    size_t *idx = (size_t *)AML_MALLOC(sizeof(size_t) * (count ? count : 1));
+    aml_real *values = (aml_real *)AML_MALLOC(sizeof(aml_real) * (count ? count : 1));
+    ASL_ASSERT(idx != NULL && values != NULL);
+
+    size_t nnz = 0;
+    for (size_t i = 0; i < n_major; i++) {
+        size_t begin = ptr[i];
+        size_t end = ptr[i + 1];
+        ptr[i] = nnz;
+        for (size_t k = begin; k < end; k++) {
+            const struct Asl_Triplet *e = &t[order[k]];
+            size_t minor = by_column ? e->row : e->col;
+            if (nnz > ptr[i] && idx[nnz - 1] == minor) {
+                values[nnz - 1] += e->value;
+            } else {
+                idx[nnz] = minor;
+                values[nnz] = e->value;
+                nnz++;
+            }
+        }
+    }
+    ptr[n_major] = nnz;
+
+    AML_FREE(minor_count);
+    AML_FREE(by_minor);
+    AML_FREE(order);
+
+    *ptr_out = ptr;
+    *idx_out = idx;
+    *values_out = values;
+    return nnz;
+}
+
+/* Transpose a compressed matrix: n_major lists over n_minor indices become
+ * n_minor lists over n_major indices. A counting sort, so the output lists
+ * come out sorted. */
+static void asl_compressed_transpose(size_t n_major, size_t n_minor, const size_t *ptr, const size_t *idx, const aml_real *values, size_t *t_ptr, size_t *t_idx, aml_real *t_values)
+{
+    size_t nnz = ptr[n_major];
+
+    for (size_t i = 0; i <= n_minor; i++) {
+        t_ptr[i] = 0;
+    }
+    for (size_t k = 0; k < nnz; k++) {
+        t_ptr[idx[k] + 1]++;
+    }
+    for (size_t i = 0; i < n_minor; i++) {
+        t_ptr[i + 1] += t_ptr[i];
+    }
+    for (size_t i = 0; i < n_major; i++) {
+        for (size_t k = ptr[i]; k < ptr[i + 1]; k++) {
+            size_t dst = t_ptr[idx[k]]++;
+            t_idx[dst] = i;
+            t_values[dst] = values[k];
+        }
+    }
+    for (size_t i = n_minor; i > 0; i--) {
+        t_ptr[i] = t_ptr[i - 1];
+    }
+    t_ptr[0] = 0;
+}
+
+/* Split rows [0, rows) into num_of_chunks ranges [bounds[c], bounds[c+1])
+ * of about equal cost, where prefix_cost[i] is the cost of rows [0, i). */
+static void asl_rows_split(const size_t *prefix_cost, size_t rows, size_t num_of_chunks, size_t *bounds)
+{
+    size_t total = prefix_cost[rows];
+
+    bounds[0] = 0;
+    for (size_t c = 1; c < num_of_chunks; c++) {
+        size_t target = (size_t)((double)total * (double)c / (double)num_of_chunks);
+        size_t lo = bounds[c - 1];
+        size_t hi = rows;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (prefix_cost[mid] < target) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        bounds[c] = lo;
+    }
+    bounds[num_of_chunks] = rows;
+}
+
+/* Number of tasks to split `cost` units of work into, 1 below the
+ * threading threshold. */
+static size_t asl_tasks_count(size_t cost, size_t rows, size_t *num_of_threads)
+{
+    *num_of_threads = aml_cpu_count_get();
+#if defined(AML_NO_THREADS)
+    *num_of_threads = 1;
+#endif
+    if (cost < ASL_PARALLEL_MIN_NNZ || *num_of_threads <= 1 || rows < 2) {
+        *num_of_threads = 1;
+        return 1;
+    }
+    size_t num_of_tasks = *num_of_threads * ASL_PARALLEL_TASKS_PER_THREAD;
+    return num_of_tasks < rows ? num_of_tasks : rows;
+}
+
+/**
+ * @brief Free the arrays of a CSC matrix.
+ *
+ * @param A Matrix returned by one of the asl_csc_* builders.
+ */
+ASL_DEF void asl_csc_free(struct Asl_CSC A)
+{
+    AML_FREE(A.col_ptr);
+    AML_FREE(A.row_idx);
+    AML_FREE(A.values);
+}
+
+/**
+ * @brief Build a CSC matrix from a triplet list.
+ *
+ * Repeated `(row, col)` entries are summed; explicit zeros are kept as
+ * stored entries. The row indices of every column come out sorted.
+ *
+ * @param triplets Triplet list; not modified.
+ * @return A `triplets->rows x triplets->cols` matrix, free with
+ * asl_csc_free().
+ *
+ * Complexity
+ * `O(count + rows + cols)`.
+ */
+ASL_DEF struct Asl_CSC asl_csc_from_triplets(const struct Asl_Triplets *triplets)
+{
+    struct Asl_CSC A;
+    A.rows = triplets->rows;
+    A.cols = triplets->cols;
+    A.nnz = asl_triplets_compress(triplets, true, &A.col_ptr, &A.row_idx, &A.values);
+
+    return A;
+}
+
+/**
+ * @brief Sparse CSC times dense product `y = alpha * A * x + beta * y`.
+ *
+ * Every column of @p A scatters into @p y, so this runs on the calling
+ * thread; convert with asl_csc_to_csr() for the multi-threaded
+ * asl_csr_spmv() when many products are needed.
+ *
+ * @param y Output `A.rows x k` matrix. Not read when @p beta is 0.
+ * @param alpha Scale of the product.
+ * @param A Sparse matrix.
+ * @param x Input `A.cols x k` matrix; must not alias @p y.
+ * @param beta Scale of the old @p y.
+ */
+ASL_DEF void asl_csc_spmv(struct Aml_Mat2d y, aml_real alpha, struct Asl_CSC A, struct Aml_Mat2d x, aml_real beta)
+{
+    ASL_ASSERT(A.cols == x.rows);
+    ASL_ASSERT(A.rows == y.rows);
+    ASL_ASSERT(x.cols == y.cols);
+
+    for (size_t i = 0; i < y.rows; i++) {
+        aml_real *y_row = &y.elements[i * y.stride_r];
+        for (size_t c = 0; c < y.cols; c++) {
+            y_row[c] = beta == 0 ? 0 : beta * y_row[c];
+        }
+    }
+    for (size_t j = 0; j < A.cols; j++) {
+        const aml_real *x_row = &x.elements[j * x.stride_r];
+        for (size_t k = A.col_ptr[j]; k < A.col_ptr[j + 1]; k++) {
+            aml_real a = alpha * A.values[k];
+            aml_real *y_row = &y.elements[A.row_idx[k] * y.stride_r];
+            for (size_t c = 0; c < y.cols; c++) {
+                y_row[c] += a * x_row[c];
+            }
+        }
+    }
+}
+
+/**
+ * @brief Convert a CSC matrix to CSR.
+ *
+ * @param A Source matrix; not modified.
+ * @return The same matrix in CSR with sorted rows, free with asl_csr_free().
+ *
+ * Complexity
+ * `O(nnz + rows + cols)`.
+ */
+ASL_DEF struct Asl_CSR asl_csc_to_csr(struct Asl_CSC A)
+{
+    struct Asl_CSR B = asl_csr_alloc(A.rows, A.cols, A.nnz);
+    asl_compressed_transpose(A.cols, A.rows, A.col_ptr, A.row_idx, A.values, B.row_ptr, B.col_idx, B.values);
+
+    return B;
+}
+
+/**
+ * @brief Allocate a CSR matrix with room for @p nnz entries.
+ *
+ * `row_ptr` is zeroed, so the result is a valid all-zero matrix until
+ * entries are written and `row_ptr` is filled in.
+ *
+ * @param rows Number of rows.
+ * @param cols Number of columns.
+ * @param nnz Number of stored entries.
+ * @return The matrix, free with asl_csr_free().
+ */
+ASL_DEF struct Asl_CSR asl_csr_alloc(size_t rows, size_t cols, size_t nnz)
+{
+    struct Asl_CSR A;
+    A.rows = rows;
+    A.cols = cols;
+    A.nnz = nnz;
+    A.row_ptr = (size_t *)AML_MALLOC(sizeof(size_t) * (rows + 1));
+    A.col_idx = (size_t *)AML_MALLOC(sizeof(size_t) * (nnz ? nnz : 1));
+    A.values = (aml_real *)AML_MALLOC(sizeof(aml_real) * (nnz ? nnz : 1));
+    ASL_ASSERT(A.row_ptr != NULL && A.col_idx != NULL && A.values != NULL);
+
+    for (size_t i = 0; i <= rows; i++) {
+        A.row_ptr[i] = 0;
+    }
+
+    return A;
+}
+
+/**
+ * @brief Free the arrays of a CSR matrix.
+ *
+ * @param A Matrix returned by one of the asl_csr_* builders.
+ */
+ASL_DEF void asl_csr_free(struct Asl_CSR A)
+{
+    AML_FREE(A.row_ptr);
+    AML_FREE(A.col_idx);
+    AML_FREE(A.values);
+}
+
+/**
+ * @brief Build a CSR matrix from the entries of a dense matrix.
+ *
+ * @param m Dense matrix.
+ * @param drop_tolerance Entries with `|m_ij| <= drop_tolerance` are not
+ * stored; pass 0 to drop exact zeros only.
+ * @return The matrix, free with asl_csr_free().
+ */
+ASL_DEF struct Asl_CSR asl_csr_from_dense(struct Aml_Mat2d m, aml_real drop_tolerance)
+{
+    size_t nnz = 0;
+    for (size_t i = 0; i < m.rows; i++) {
+        for (size_t j = 0; j < m.cols; j++) {
+            if (aml_fabs(AML_MAT2D_AT(m, i, j)) > drop_tolerance) {
+                nnz++;
+            }
+        }
+    }
+
+    struct Asl_CSR A = asl_csr_alloc(m.rows, m.cols, nnz);
+    size_t k = 0;
+    for (size_t i = 0; i < m.rows; i++) {
+        for (size_t j = 0; j < m.cols; j++) {
+            aml_real value = AML_MAT2D_AT(m, i, j);
+            if (aml_fabs(value) > drop_tolerance) {
+                A.col_idx[k] = j;
+                A.values[k] = value;
+                k++;
+            }
+        }
+        A.row_ptr[i + 1] = k;
+    }
+
+    return A;
+}
+
+/**
+ * @brief Build a CSR matrix from a triplet list.
+ *
+ * Repeated `(row, col)` entries are summed, the usual way finite element
+ * matrices are assembled; explicit zeros are kept as stored entries. The
+ * column indices of every row come out sorted.
+ *
+ * @param triplets Triplet list; not modified.
+ * @return A `triplets->rows x triplets->cols` matrix, free with
+ * asl_csr_free().
+ *
+ * Complexity
+ * `O(count + rows + cols)`.
+ */
+ASL_DEF struct Asl_CSR asl_csr_from_triplets(const struct Asl_Triplets *triplets)
+{
+    struct Asl_CSR A;
+    A.rows = triplets->rows;
+    A.cols = triplets->cols;
+    A.nnz = asl_triplets_compress(triplets, false, &A.row_ptr, &A.col_idx, &A.values);
+
+    return A;
+}
+
+/**
+ * @brief Ala_Matvec callback for a CSR matrix: `y = A * x`.
+ *
+ * @param y Output n x 1 vector.
+ * @param x Input vector.
+ * @param A Pointer to the `struct Asl_CSR` to multiply with.
+ */
+ASL_DEF void asl_csr_matvec(struct Aml_Mat2d y, struct Aml_Mat2d x, void *A)
+{
+    asl_csr_spmv(y, 1, *(const struct Asl_CSR *)A, x, 0);
+}
+
+/* Shared state of one asl_csr_spgemm() call. Every worker owns a dense
+ * accumulator over the columns of B and a marker telling which columns the
+ * current row has touched. */
+struct Asl_Spgemm_Job {
+    struct Asl_CSR A;
+    struct Asl_CSR B;
+    struct Asl_CSR C;
+    const size_t *bounds;
+    size_t **markers;
+    aml_real **accumulators;
+    bool numeric;
+};
+
+static int asl_index_compare(const void *a, const void *b)
+{
+    size_t x = *(const size_t *)a;
+    size_t y = *(const size_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/* One chunk of rows of C = A * B (Gustavson). The symbolic pass counts the
+ * entries of every row into C.row_ptr[i+1]; the numeric pass writes them,
+ * sorted, into the ranges the prefix sum of the counts reserved. */
+static void asl_spgemm_task(void *context, size_t task, size_t worker)
+{
+    struct Asl_Spgemm_Job *job = (struct Asl_Spgemm_Job *)context;
+    const struct Asl_CSR A = job->A;
+    const struct Asl_CSR B = job->B;
+    size_t *marker = job->markers[worker];
+    aml_real *accumulator = job->accumulators[worker];
+
+    for (size_t i = job->bounds[task]; i < job->bounds[task + 1]; i++) {
+        if (!job->numeric) {
+            size_t count = 0;
+            for (size_t ka = A.row_ptr[i]; ka < A.row_ptr[i + 1]; ka++) {
+                size_t r = A.col_idx[ka];
+                for (size_t kb = B.row_ptr[r]; kb < B.row_ptr[r + 1]; kb++) {
+                    size_t j = B.col_idx[kb];
+                    if (marker[j] != i) {
+                        marker[j] = i;
+                        count++;
+                    }
+                }
+            }
+            job->C.row_ptr[i + 1] = count;
+            continue;
+        }
+
+        size_t *cols = &job->C.col_idx[job->C.row_ptr[i]];
+        size_t count = 0;
+        for (size_t ka = A.row_ptr[i]; ka < A.row_ptr[i + 1]; ka++) {
+            size_t r = A.col_idx[ka];
+            aml_real a = A.values[ka];
+            for (size_t kb = B.row_ptr[r]; kb < B.row_ptr[r + 1]; kb++) {
+                size_t j = B.col_idx[kb];
+                if (marker[j] != i) {
+                    marker[j] = i;
+                    accumulator[j] = a * B.values[kb];
+                    cols[count++] = j;
+                } else {
+                    accumulator[j] += a * B.values[kb];
+                }
+            }
+        }
+        qsort(cols, count, sizeof(size_t), asl_index_compare);
+        aml_real *values = &job->C.values[job->C.row_ptr[i]];
+        for (size_t k = 0; k < count; k++) {
+            values[k] = accumulator[cols[k]];
+        }
+    }
+}
+
+/**
+ * @brief Sparse times sparse product `C = A * B`.
+ *
+ * Gustavson's row-by-row algorithm in two passes: a symbolic pass counts the
+ * entries of every row of C so it can be allocated exactly, and a numeric
+ * pass accumulates them. Rows are split over worker threads by their
+ * multiply-add count.
+ *
+ * @param A Left factor.
+ * @param B Right factor, `B.rows == A.cols`.
+ * @return `A.rows x B.cols` product with sorted rows, free with
+ * asl_csr_free(). Entries that cancel to zero are kept.
+ *
+ * Complexity
+ * `O(flops + nnz(C) log(row length))` where flops is the number of
+ * multiply-adds, plus `O(B.cols)` memory per thread.
+ */
+ASL_DEF struct Asl_CSR asl_csr_spgemm(struct Asl_CSR A, struct Asl_CSR B)
+{
+    ASL_ASSERT(A.cols == B.rows);
+
+    size_t *flops = (size_t *)AML_MALLOC(sizeof(size_t) * (A.rows + 1));
+    ASL_ASSERT(flops != NULL);
+    flops[0] = 0;
+    for (size_t i = 0; i < A.rows; i++) {
+        size_t row_flops = 0;
+        for (size_t k = A.row_ptr[i]; k < A.row_ptr[i + 1]; k++) {
+            size_t r = A.col_idx[k];
+            row_flops += B.row_ptr[r + 1] - B.row_ptr[r];
+        }
+        flops[i + 1] = flops[i] + row_flops;
+    }
+
+    size_t num_of_threads;
+    size_t num_of_tasks = asl_tasks_count(flops[A.rows], A.rows, &num_of_threads);
+    size_t *bounds = (size_t *)AML_MALLOC(sizeof(size_t) * (num_of_tasks + 1));
+    ASL_ASSERT(bounds != NULL);
+    asl_rows_split(flops, A.rows, num_of_tasks, bounds);
+
+    struct Asl_Spgemm_Job job;
+    job.A = A;
+    job.B = B;
+    job.C = asl_csr_alloc(A.rows, B.cols, 0);
+    job.bounds = bounds;
+    job.markers = (size_t **)AML_MALLOC(sizeof(size_t *) * num_of_threads);
+    job.accumulators = (aml_real **)AML_MALLOC(sizeof(aml_real *) * num_of_threads);
+    ASL_ASSERT(job.markers != NULL && job.accumulators != NULL);
+    for (size_t t = 0; t < num_of_threads; t++) {
+        job.markers[t] = (size_t *)AML_MALLOC(sizeof(size_t) * (B.cols ? B.cols : 1));
+        job.accumulators[t] = (aml_real *)AML_MALLOC(sizeof(aml_real) * (B.cols ? B.cols : 1));
+        ASL_ASSERT(job.markers[t] != NULL && job.accumulators[t] != NULL);
+        for (size_t j = 0; j < B.cols; j++) {
+            job.markers[t][j] = SIZE_MAX;
+        }
+    }
+
+    job.numeric = false;
+    aml_parallel_for(num_of_tasks, asl_spgemm_task, &job, num_of_threads);
+
+    for (size_t i = 0; i < A.rows; i++) {
+        job.C.row_ptr[i + 1] += job.C.row_ptr[i];
+    }
+    job.C.nnz = job.C.row_ptr[A.rows];
+    AML_FREE(job.C.col_idx);
+    AML_FREE(job.C.values);
+    job.C.col_idx = (size_t *)AML_MALLOC(sizeof(size_t) * (job.C.nnz ? job.C.nnz : 1));
+    job.C.values = (aml_real *)AML_MALLOC(sizeof(aml_real) * (job.C.nnz ? job.C.nnz : 1));
+    ASL_ASSERT(job.C.col_idx != NULL && job.C.values != NULL);
+
+    /* the symbolic pass left row stamps in the markers */
+    for (size_t t = 0; t < num_of_threads; t++) {
+        for (size_t j = 0; j < B.cols; j++) {
+            job.markers[t][j] = SIZE_MAX;
+        }
+    }
+    job.numeric = true;
+    aml_parallel_for(num_of_tasks, asl_spgemm_task, &job, num_of_threads);
+
+    for (size_t t = 0; t < num_of_threads; t++) {
+        AML_FREE(job.markers[t]);
+        AML_FREE(job.accumulators[t]);
+    }
+    AML_FREE(job.markers);
+    AML_FREE(job.accumulators);
+    AML_FREE(bounds);
+    AML_FREE(flops);
+
+    return job.C;
+}
+
+/* Shared state of one multi-threaded asl_csr_spmv() call. */
+struct Asl_Spmv_Job {
+    struct Aml_Mat2d y;
+    aml_real alpha;
+    struct Asl_CSR A;
+    struct Aml_Mat2d x;
+    aml_real beta;
+    const size_t *bounds;
+};
+
+/* y[i] = alpha * A[i,:] * x + beta * y[i] for rows [first, last) */
+static void asl_csr_spmv_rows(struct Aml_Mat2d y, aml_real alpha, struct Asl_CSR A, struct Aml_Mat2d x, aml_real beta, size_t first, size_t last)
+{
+    const size_t *AML_RESTRICT row_ptr = A.row_ptr;
+    const size_t *AML_RESTRICT col_idx = A.col_idx;
+    const aml_real *AML_RESTRICT values = A.values;
+    const aml_real *AML_RESTRICT xe = x.elements;
+
+    if (x.cols == 1) {
+        size_t xs = x.stride_r;
+        for (size_t i = first; i < last; i++) {
+            aml_real sum = 0;
+            for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; k++) {
+                sum += values[k] * xe[col_idx[k] * xs];
+            }
+            aml_real *y_i = &y.elements[i * y.stride_r];
+            *y_i = beta == 0 ? alpha * sum : alpha * sum + beta * *y_i;
+        }
+        return;
+    }
+
+    for (size_t i = first; i < last; i++) {
+        aml_real *y_row = &y.elements[i * y.stride_r];
+        for (size_t c = 0; c < y.cols; c++) {
+            y_row[c] = beta == 0 ? 0 : beta * y_row[c];
+        }
+        for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; k++) {
+            aml_real a = alpha * values[k];
+            const aml_real *x_row = &xe[col_idx[k] * x.stride_r];
+            for (size_t c = 0; c < y.cols; c++) {
+                y_row[c] += a * x_row[c];
+            }
+        }
+    }
+}
+
+static void asl_csr_spmv_task(void *context, size_t task, size_t worker)
+{
+    struct Asl_Spmv_Job *job = (struct Asl_Spmv_Job *)context;
+    asl_csr_spmv_rows(job->y, job->alpha, job->A, job->x, job->beta, job->bounds[task], job->bounds[task + 1]);
+    AML_UNUSED(worker);
+}
+
+/**
+ * @brief Sparse CSR times dense product `y = alpha * A * x + beta * y`.
+ *
+ * @p x may have several columns (a block of vectors). Products with at least
+ * `ASL_PARALLEL_MIN_NNZ` multiply-adds are split over worker threads in row
+ * chunks of about equal entry count; every row is owned by one thread, so the
+ * result does not depend on the thread count.
+ *
+ * @param y Output `A.rows x k` matrix. Not read when @p beta is 0.
+ * @param alpha Scale of the product.
+ * @param A Sparse matrix.
+ * @param x Input `A.cols x k` matrix; must not alias @p y.
+ * @param beta Scale of the old @p y.
+ *
+ * Complexity
+ * `O(nnz * k)`.
+ */
+ASL_DEF void asl_csr_spmv(struct Aml_Mat2d y, aml_real alpha, struct Asl_CSR A, struct Aml_Mat2d x, aml_real beta)
+{
+    ASL_ASSERT(A.cols == x.rows);
+    ASL_ASSERT(A.rows == y.rows);
+    ASL_ASSERT(x.cols == y.cols);
+
+    size_t num_of_threads;
+    size_t num_of_tasks = asl_tasks_count(A.nnz * x.cols, A.rows, &num_of_threads);
+    if (num_of_tasks <= 1) {
+        asl_csr_spmv_rows(y, alpha, A, x, beta, 0, A.rows);
+        return;
+    }
+
+    size_t bounds[64 * ASL_PARALLEL_TASKS_PER_THREAD + 1];
+    if (num_of_tasks > 64 * ASL_PARALLEL_TASKS_PER_THREAD) {
+        num_of_tasks = 64 * ASL_PARALLEL_TASKS_PER_THREAD;
+    }
+    asl_rows_split(A.row_ptr, A.rows, num_of_tasks, bounds);
+
+    struct Asl_Spmv_Job job;
+    job.y = y;
+    job.alpha = alpha;
+    job.A = A;
+    job.x = x;
+    job.beta = beta;
+    job.bounds = bounds;
+    aml_parallel_for(num_of_tasks, asl_csr_spmv_task, &job, num_of_threads);
+}
+
+/**
+ * @brief Convert a CSR matrix to CSC.
+ *
+ * @param A Source matrix; not modified.
+ * @return The same matrix in CSC with sorted columns, free with
+ * asl_csc_free().
+ *
+ * Complexity
+ * `O(nnz + rows + cols)`.
+ */
+ASL_DEF struct Asl_CSC asl_csr_to_csc(struct Asl_CSR A)
+{
+    struct Asl_CSR T = asl_csr_alloc(A.cols, A.rows, A.nnz);
+    asl_compressed_transpose(A.rows, A.cols, A.row_ptr, A.col_idx, A.values, T.row_ptr, T.col_idx, T.values);
+
+    struct Asl_CSC B;
+    B.rows = A.rows;
+    B.cols = A.cols;
+    B.nnz = A.nnz;
+    B.col_ptr = T.row_ptr;
+    B.row_idx = T.col_idx;
+    B.values = T.values;
+
+    return B;
+}
+
+/**
+ * @brief Expand a CSR matrix into a dense one.
+ *
+ * @param des Output `A.rows x A.cols` matrix; entries not stored in @p A are
+ * set to 0.
+ * @param A Sparse matrix.
+ */
+ASL_DEF void asl_csr_to_dense(struct Aml_Mat2d des, struct Asl_CSR A)
+{
+    ASL_ASSERT(des.rows == A.rows && des.cols == A.cols);
+
+    aml_fill(des, 0);
+    for (size_t i = 0; i < A.rows; i++) {
+        for (size_t k = A.row_ptr[i]; k < A.row_ptr[i + 1]; k++) {
+            AML_MAT2D_AT(des, i, A.col_idx[k]) = A.values[k];
+        }
+    }
+}
+
+/**
+ * @brief Transpose a CSR matrix.
+ *
+ * @param A Source matrix; not modified.
+ * @return `A^T` in CSR with sorted rows, free with asl_csr_free().
+ *
+ * Complexity
+ * `O(nnz + rows + cols)`.
+ */
+ASL_DEF struct Asl_CSR asl_csr_transpose(struct Asl_CSR A)
+{
+    struct Asl_CSR T = asl_csr_alloc(A.cols, A.rows, A.nnz);
+    asl_compressed_transpose(A.rows, A.cols, A.row_ptr, A.col_idx, A.values, T.row_ptr, T.col_idx, T.values);
+
+    return T;
+}
+
+/**
+ * @brief Apply a preconditioner, `z = M^-1 * r`.
+ *
+ * @param P Preconditioner, or NULL for none.
+ * @param z Output n x 1 vector; must not alias @p r.
+ * @param r Input n x 1 vector.
+ */
+ASL_DEF void asl_preconditioner_apply(const struct Asl_Preconditioner *P, struct Aml_Mat2d z, struct Aml_Mat2d r)
+{
+    ASL_ASSERT(z.rows == r.rows && z.cols == 1 && r.cols == 1);
+
+    size_t n = r.rows;
+    size_t zs = z.stride_r;
+    size_t rs = r.stride_r;
+    aml_real *ze = z.elements;
+    const aml_real *re = r.elements;
+
+    if (P == NULL || P->type == ASL_PRECONDITIONER_NONE) {
+        for (size_t i = 0; i < n; i++) {
+            ze[i * zs] = re[i * rs];
+        }
+        return;
+    }
+
+    ASL_ASSERT(P->n == n);
+    if (P->type == ASL_PRECONDITIONER_JACOBI) {
+        for (size_t i = 0; i < n; i++) {
+            ze[i * zs] = P->inv_diag[i] * re[i * rs];
+        }
+        return;
+    }
+
+    /* L y = r with unit diagonal, then U z = y */
+    const struct Asl_CSR LU = P->LU;
+    for (size_t i = 0; i < n; i++) {
+        aml_real sum = re[i * rs];
+        for (size_t k = LU.row_ptr[i]; k < P->diag_idx[i]; k++) {
+            sum -= LU.values[k] * ze[LU.col_idx[k] * zs];
+        }
+        ze[i * zs] = sum;
+    }
+    for (size_t i = n; i-- > 0;) {
+        aml_real sum = ze[i * zs];
+        for (size_t k = P->diag_idx[i] + 1; k < LU.row_ptr[i + 1]; k++) {
+            sum -= LU.values[k] * ze[LU.col_idx[k] * zs];
+        }
+        ze[i * zs] = sum / LU.values[P->diag_idx[i]];
+    }
+}
+
+/**
+ * @brief Build a preconditioner for the iterative solvers.
+ *
+ * Jacobi treats a zero diagonal entry as 1. ILU(0) needs every diagonal entry
+ * stored in @p A; a pivot that vanishes during the factorization is replaced
+ * by `sqrt(eps)` times the largest entry of its row, with a warning, so the
+ * preconditioner stays usable.
+ *
+ * @param A Square matrix with sorted rows, as every builder returns.
+ * @param type Kind of preconditioner.
+ * @return The preconditioner, free with asl_preconditioner_free().
+ *
+ * Complexity
+ * Jacobi `O(nnz)`; ILU(0) `O(sum over rows of the row length squared)`.
+ */
+ASL_DEF struct Asl_Preconditioner asl_preconditioner_create(struct Asl_CSR A, enum Asl_Preconditioner_Type type)
+{
+    ASL_ASSERT(A.rows == A.cols);
+
+    struct Asl_Preconditioner P = {0};
+    P.type = type;
+    P.n = A.rows;
+    size_t n = A.rows;
+
+    if (type == ASL_PRECONDITIONER_JACOBI) {
+        P.inv_diag = (aml_real *)AML_MALLOC(sizeof(aml_real) * (n ? n : 1));
+        ASL_ASSERT(P.inv_diag != NULL);
+        for (size_t i = 0; i < n; i++) {
+            aml_real d = 0;
+            for (size_t k = A.row_ptr[i]; k < A.row_ptr[i + 1]; k++) {
+                if (A.col_idx[k] == i) {
+                    d += A.values[k];
+                }
+            }
+            P.inv_diag[i] = d != 0 ? 1 / d : 1;
+        }
+        return P;
+    }
+    if (type != ASL_PRECONDITIONER_ILU0) {
+        return P;
+    }
+
+    P.LU = asl_csr_alloc(n, n, A.nnz);
+    P.diag_idx = (size_t *)AML_MALLOC(sizeof(size_t) * (n ? n : 1));
+    size_t *position = (size_t *)AML_MALLOC(sizeof(size_t) * (n ? n : 1));
+    ASL_ASSERT(P.diag_idx != NULL && position != NULL);
+
+    struct Asl_CSR LU = P.LU;
+    for (size_t i = 0; i <= n; i++) {
+        LU.row_ptr[i] = A.row_ptr[i];
+    }
+    for (size_t k = 0; k < A.nnz; k++) {
+        LU.col_idx[k] = A.col_idx[k];
+        LU.values[k] = A.values[k];
+    }
+    for (size_t i = 0; i < n; i++) {
+        P.diag_idx[i] = SIZE_MAX;
+        for (size_t k = LU.row_ptr[i]; k < LU.row_ptr[i + 1]; k++) {
+            ASL_ASSERT(k == LU.row_ptr[i] || LU.col_idx[k - 1] < LU.col_idx[k]);
+            if (LU.col_idx[k] == i) {
+                P.diag_idx[i] = k;
+            }
+        }
+        ASL_ASSERT(P.diag_idx[i] != SIZE_MAX && "ILU(0) needs every diagonal entry stored");
+        position[i] = SIZE_MAX;
+    }
+
+    aml_real eps = (aml_real)(sizeof(aml_real) == sizeof(float) ? FLT_EPSILON : DBL_EPSILON);
+    size_t num_of_fixed_pivots = 0;
+    /* IKJ variant: eliminate the lower entries of row i with the finished
+     * rows above it, dropping every update outside the pattern of row i */
+    for (size_t i = 0; i < n; i++) {
+        for (size_t k = LU.row_ptr[i]; k < LU.row_ptr[i + 1]; k++) {
+            position[LU.col_idx[k]] = k;
+        }
+        for (size_t k = LU.row_ptr[i]; k < P.diag_idx[i]; k++) {
+            size_t r = LU.col_idx[k];
+            aml_real factor = LU.values[k] / LU.values[P.diag_idx[r]];
+            LU.values[k] = factor;
+            for (size_t q = P.diag_idx[r] + 1; q < LU.row_ptr[r + 1]; q++) {
+                size_t p = position[LU.col_idx[q]];
+                if (p != SIZE_MAX) {
+                    LU.values[p] -= factor * LU.values[q];
+                }
+            }
+        }
+        for (size_t k = LU.row_ptr[i]; k < LU.row_ptr[i + 1]; k++) {
+            position[LU.col_idx[k]] = SIZE_MAX;
+        }
+
+        aml_real *pivot = &LU.values[P.diag_idx[i]];
+        aml_real row_max = 0;
+        for (size_t k = LU.row_ptr[i]; k < LU.row_ptr[i + 1]; k++) {
+            row_max = aml_fmax(row_max, aml_fabs(LU.values[k]));
+        }
+        if (aml_fabs(*pivot) <= eps * row_max) {
+            *pivot = row_max > 0 ? aml_sqrt(eps) * row_max : 1;
+            num_of_fixed_pivots++;
+        }
+    }
+    if (num_of_fixed_pivots) {
+        aml_dprintWARNING("ILU(0) replaced %zu vanishing pivots.", num_of_fixed_pivots);
+    }
+
+    AML_FREE(position);
+
+    return P;
+}
+
+/**
+ * @brief Free a preconditioner built by asl_preconditioner_create().
+ *
+ * @param P Preconditioner.
+ */
+ASL_DEF void asl_preconditioner_free(struct Asl_Preconditioner P)
+{
+    if (P.type == ASL_PRECONDITIONER_JACOBI) {
+        AML_FREE(P.inv_diag);
+    } else if (P.type == ASL_PRECONDITIONER_ILU0) {
+        asl_csr_free(P.LU);
+        AML_FREE(P.diag_idx);
+    }
+}
+
+static aml_real asl_vec_dot(struct Aml_Mat2d a, struct Aml_Mat2d b)
+{
+    aml_real sum = 0;
+    if (a.stride_r == 1 && b.stride_r == 1) {
+        const aml_real *AML_RESTRICT ae = a.elements;
+        const aml_real *AML_RESTRICT be = b.elements;
+        for (size_t i = 0; i < a.rows; i++) {
+            sum += ae[i] * be[i];
+        }
+        return sum;
+    }
+    for (size_t i = 0; i < a.rows; i++) {
+        sum += a.elements[i * a.stride_r] * b.elements[i * b.stride_r];
+    }
+    return sum;
+}
+
+static aml_real asl_vec_norm(struct Aml_Mat2d a)
+{
+    return aml_sqrt(asl_vec_dot(a, a));
+}
+
+/* y = y + alpha * x */
+static void asl_vec_axpy(struct Aml_Mat2d y, aml_real alpha, struct Aml_Mat2d x)
+{
+    if (y.stride_r == 1 && x.stride_r == 1) {
+        aml_real *AML_RESTRICT ye = y.elements;
+        const aml_real *AML_RESTRICT xe = x.elements;
+        for (size_t i = 0; i < y.rows; i++) {
+            ye[i] += alpha * xe[i];
+        }
+        return;
+    }
+    for (size_t i = 0; i < y.rows; i++) {
+        y.elements[i * y.stride_r] += alpha * x.elements[i * x.stride_r];
+    }
+}
+
+/* y = x + beta * y */
+static void asl_vec_xpby(struct Aml_Mat2d y, struct Aml_Mat2d x, aml_real beta)
+{
+    for (size_t i = 0; i < y.rows; i++) {
+        y.elements[i * y.stride_r] = x.elements[i * x.stride_r] + beta * y.elements[i * y.stride_r];
+    }
+}
+
+/* r = b - A * x, returns ||r|| */
+static aml_real asl_residual(struct Aml_Mat2d r, struct Asl_CSR A, struct Aml_Mat2d x, struct Aml_Mat2d b)
+{
+    aml_copy(r, b);
+    asl_csr_spmv(r, -1, A, x, 1);
+    return asl_vec_norm(r);
+}
+
+/* Shared argument checks and defaults of the solvers. Returns the absolute
+ * residual target, or a negative value when b is zero and x was set to 0. */
+static aml_real asl_solve_setup(struct Asl_CSR A, struct Aml_Mat2d x, struct Aml_Mat2d b, aml_real *tolerance, size_t *max_iterations)
+{
+    ASL_ASSERT(A.rows == A.cols);
+    ASL_ASSERT(x.rows == A.rows && x.cols == 1);
+    ASL_ASSERT(b.rows == A.rows && b.cols == 1);
+
+    if (*tolerance <= 0) {
+        *tolerance = aml_sqrt((aml_real)(sizeof(aml_real) == sizeof(float) ? FLT_EPSILON : DBL_EPSILON));
+    }
+    if (*max_iterations == 0) {
+        *max_iterations = 2 * A.rows + 10;
+    }
+    aml_real b_norm = asl_vec_norm(b);
+    if (b_norm == 0) {
+        aml_fill(x, 0);
+        return -1;
+    }
+    return *tolerance * b_norm;
+}
+
+/**
+ * @brief Solve `A x = b` with the (preconditioned) Conjugate Gradient method.
+ *
+ * For symmetric positive definite @p A, and a symmetric positive definite
+ * preconditioner (Jacobi; ILU(0) of a symmetric matrix is close enough in
+ * practice). The residual is recomputed from @p x when the recurrence
+ * reports convergence, and the iteration restarts from there if rounding let
+ * the two drift apart.
+ *
+ * @param A Square sparse matrix.
+ * @param x n x 1 initial guess, overwritten with the solution.
+ * @param b n x 1 right-hand side.
+ * @param P Preconditioner, or NULL for none.
+ * @param tolerance Relative residual target `||b - A x|| <= tolerance *
+ * ||b||`; 0 means `sqrt(eps)`.
+ * @param max_iterations Iteration limit; 0 means `2n + 10`.
+ * @return Iterations, final relative residual and whether it converged. Stops
+ * early, unconverged, when `p^T A p <= 0` shows @p A is not positive
+ * definite.
+ *
+ * Complexity
+ * Per iteration one SpMV, one preconditioner apply and `O(n)` vector work.
+ */
+ASL_DEF struct Asl_Solve_Info asl_solve_CG(struct Asl_CSR A, struct Aml_Mat2d x, struct Aml_Mat2d b, const struct Asl_Preconditioner *P, aml_real tolerance, size_t max_iterations)
+{
+    struct Asl_Solve_Info info = {0};
+    aml_real target = asl_solve_setup(A, x, b, &tolerance, &max_iterations);
+    if (target < 0) {
+        info.converged = true;
+        return info;
+    }
+
+    size_t n = A.rows;
+    struct Aml_Mat2d r = aml_mat2d_alloc(n, 1);
+    struct Aml_Mat2d z = aml_mat2d_alloc(n, 1);
+    struct Aml_Mat2d p = aml_mat2d_alloc(n, 1);
+    struct Aml_Mat2d q = aml_mat2d_alloc(n, 1);
+
+    aml_real r_norm = asl_residual(r, A, x, b);
+    bool restart = true;
+    aml_real rz = 0;
+    while (info.iterations < max_iterations) {
+        if (r_norm <= target) {
+            /* confirm on the true residual */
+            r_norm = asl_residual(r, A, x, b);
+            if (r_norm <= target) {
+                break;
+            }
+            restart = true;
+        }
+        if (restart) {
+            asl_preconditioner_apply(P, z, r);
+            aml_copy(p, z);
+            rz = asl_vec_dot(r, z);
+            restart = false;
+        }
+
+        asl_csr_spmv(q, 1, A, p, 0);
+        aml_real pq = asl_vec_dot(p, q);
+        if (!(pq > 0)) {
+            aml_dprintWARNING("%s", "CG broke down, the matrix is not positive definite.");
+            break;
+        }
+        aml_real alpha = rz / pq;
+        asl_vec_axpy(x, alpha, p);
+        asl_vec_axpy(r, -alpha, q);
+        r_norm = asl_vec_norm(r);
+        info.iterations++;
+
+        asl_preconditioner_apply(P, z, r);
+        aml_real rz_new = asl_vec_dot(r, z);
+        asl_vec_xpby(p, z, rz_new / rz);
+        rz = rz_new;
+    }
+
+    info.residual_norm = asl_residual(r, A, x, b) / asl_vec_norm(b);
+    info.converged = info.residual_norm <= tolerance;
+    if (!info.converged) {
+        aml_dprintWARNING("Did not converged after %zu iterations.", info.iterations);
+    }
+
+    aml_mat2d_free(r);
+    aml_mat2d_free(z);
+    aml_mat2d_free(p);
+    aml_mat2d_free(q);
+
+    return info;
+}
+
+/**
+ * @brief Solve `A x = b` with the right-preconditioned BiCGSTAB method.
+ *
+ * For general (nonsymmetric) square @p A. A breakdown (`rho = 0` or
+ * `omega = 0`) restarts the iteration from the current residual.
+ *
+ * @param A Square sparse matrix.
+ * @param x n x 1 initial guess, overwritten with the solution.
+ * @param b n x 1 right-hand side.
+ * @param P Preconditioner, or NULL for none.
+ * @param tolerance Relative residual target; 0 means `sqrt(eps)`.
+ * @param max_iterations Iteration limit; 0 means `2n + 10`.
+ * @return Iterations, final relative residual and whether it converged.
+ *
+ * Complexity
+ * Per iteration two SpMVs, two preconditioner applies and `O(n)` vector
+ * work.
+ */
+ASL_DEF struct Asl_Solve_Info asl_solve_BiCGSTAB(struct Asl_CSR A, struct Aml_Mat2d x, struct Aml_Mat2d b, const struct Asl_Preconditioner *P, aml_real tolerance, size_t max_iterations)
+{
+    struct Asl_Solve_Info info = {0};
+    aml_real target = asl_solve_setup(A, x, b, &tolerance, &max_iterations);
+    if (target < 0) {
+        info.converged = true;
+        return info;
+    }
+
+    size_t n = A.rows;
+    struct Aml_Mat2d r = aml_mat2d_alloc(n, 1);
+    struct Aml_Mat2d r_hat = aml_mat2d_alloc(n, 1);
+    struct Aml_Mat2d p = aml_mat2d_alloc(n, 1);
+    struct Aml_Mat2d p_hat = aml_mat2d_alloc(n, 1);
+    struct Aml_Mat2d v = aml_mat2d_alloc(n, 1);
+    struct Aml_Mat2d s_hat = aml_mat2d_alloc(n, 1);
+    struct Aml_Mat2d t = aml_mat2d_alloc(n, 1);
+
+    aml_real r_norm = asl_residual(r, A, x, b);
+    bool restart = true;
+    aml_real rho = 1, alpha = 1, omega = 1;
+    while (info.iterations < max_iterations) {
+        if (r_norm <= target) {
+            r_norm = asl_residual(r, A, x, b);
+            if (r_norm <= target) {
+                break;
+            }
+            restart = true;
+        }
+        if (restart) {
+            aml_copy(r_hat, r);
+            aml_fill(p, 0);
+            aml_fill(v, 0);
+            rho = alpha = omega = 1;
+            restart = false;
+        }
+
+        aml_real rho_new = asl_vec_dot(r_hat, r);
+        if (rho_new == 0) {
+            restart = true;
+            r_norm = asl_residual(r, A, x, b);
+            info.iterations++;
+            continue;
+        }
+        /* p = r + beta * (p - omega * v) */
+        aml_real beta = (rho_new / rho) * (alpha / omega);
+        asl_vec_axpy(p, -omega, v);
+        asl_vec_xpby(p, r, beta);
+        rho = rho_new;
+
+        asl_preconditioner_apply(P, p_hat, p);
+        asl_csr_spmv(v, 1, A, p_hat, 0);
+        aml_real r_hat_v = asl_vec_dot(r_hat, v);
+        if (r_hat_v == 0) {
+            restart = true;
+            info.iterations++;
+            continue;
+        }
+        alpha = rho / r_hat_v;
+        asl_vec_axpy(x, alpha, p_hat);
+        /* r becomes s = r - alpha * v */
+        asl_vec_axpy(r, -alpha, v);
+        info.iterations++;
+        r_norm = asl_vec_norm(r);
+        if (r_norm <= target) {
+            continue;
+        }
+
+        asl_preconditioner_apply(P, s_hat, r);
+        asl_csr_spmv(t, 1, A, s_hat, 0);
+        aml_real tt = asl_vec_dot(t, t);
+        omega = tt > 0 ? asl_vec_dot(t, r) / tt : 0;
+        if (omega == 0) {
+            restart = true;
+            continue;
+        }
+        asl_vec_axpy(x, omega, s_hat);
+        asl_vec_axpy(r, -omega, t);
+        r_norm = asl_vec_norm(r);
+    }
+
+    info.residual_norm = asl_residual(r, A, x, b) / asl_vec_norm(b);
+    info.converged = info.residual_norm <= tolerance;
+    if (!info.converged) {
+        aml_dprintWARNING("Did not converged after %zu iterations.", info.iterations);
+    }
+
+    aml_mat2d_free(r);
+    aml_mat2d_free(r_hat);
+    aml_mat2d_free(p);
+    aml_mat2d_free(p_hat);
+    aml_mat2d_free(v);
+    aml_mat2d_free(s_hat);
+    aml_mat2d_free(t);
+
+    return info;
+}
+
+/* Column k of the GMRES basis, stored as the contiguous row k of V. */
+static struct Aml_Mat2d asl_gmres_vector(struct Aml_Mat2d V, size_t k)
+{
+    struct Aml_Mat2d v;
+    v.rows = V.cols;
+    v.cols = 1;
+    v.stride_r = 1;
+    v.elements = &AML_MAT2D_AT(V, k, 0);
+    return v;
+}
+
+/**
+ * @brief Solve `A x = b` with the right-preconditioned restarted GMRES(m)
+ * method.
+ *
+ * For general square @p A. Builds an Arnoldi basis of up to @p restart
+ * vectors with modified Gram-Schmidt, keeps the least-squares problem
+ * triangular with Givens rotations so the residual norm is known every step,
+ * and updates @p x at the end of every cycle. Right preconditioning keeps
+ * that residual the true, unpreconditioned one.
+ *
+ * @param A Square sparse matrix.
+ * @param x n x 1 initial guess, overwritten with the solution.
+ * @param b n x 1 right-hand side.
+ * @param P Preconditioner, or NULL for none.
+ * @param restart Basis size per cycle; 0 means ASL_GMRES_DEFAULT_RESTART.
+ * @param tolerance Relative residual target; 0 means `sqrt(eps)`.
+ * @param max_iterations Limit on the total number of Arnoldi steps; 0 means
+ * `2n + 10`.
+ * @return Arnoldi steps, final relative residual and whether it converged.
+ *
+ * Complexity
+ * Per step one SpMV, one preconditioner apply and `O(n * restart)`
+ * orthogonalization; `O(n * restart)` memory.
+ */
+ASL_DEF struct Asl_Solve_Info asl_solve_GMRES(struct Asl_CSR A, struct Aml_Mat2d x, struct Aml_Mat2d b, const struct Asl_Preconditioner *P, size_t restart, aml_real tolerance, size_t max_iterations)
+{
+    struct Asl_Solve_Info info = {0};
+    aml_real target = asl_solve_setup(A, x, b, &tolerance, &max_iterations);
+    if (target < 0) {
+        info.converged = true;
+        return info;
+    }
+
+    size_t n = A.rows;
+    size_t m = restart ? restart : ASL_GMRES_DEFAULT_RESTART;
+    if (m > n) {
+        m = n;
+    }
+    struct Aml_Mat2d V = aml_mat2d_alloc(m + 1, n);
+    struct Aml_Mat2d H = aml_mat2d_alloc(m + 1, m);
+    struct Aml_Mat2d r = aml_mat2d_alloc(n, 1);
+    struct Aml_Mat2d z = aml_mat2d_alloc(n, 1);
+    aml_real *cs = (aml_real *)AML_MALLOC(sizeof(aml_real) * m);
+    aml_real *sn = (aml_real *)AML_MALLOC(sizeof(aml_real) * m);
+    aml_real *g = (aml_real *)AML_MALLOC(sizeof(aml_real) * (m + 1));
+    ASL_ASSERT(cs != NULL && sn != NULL && g != NULL);
+
+    while (info.iterations < max_iterations) {
+        aml_real beta = asl_residual(r, A, x, b);
+        if (beta <= target) {
+            break;
+        }
+        struct Aml_Mat2d v0 = asl_gmres_vector(V, 0);
+        for (size_t i = 0; i < n; i++) {
+            v0.elements[i] = r.elements[i] / beta;
+        }
+        g[0] = beta;
+
+        size_t j = 0;
+        while (j < m && info.iterations < max_iterations) {
+            struct Aml_Mat2d w = asl_gmres_vector(V, j + 1);
+            asl_preconditioner_apply(P, z, asl_gmres_vector(V, j));
+            asl_csr_spmv(w, 1, A, z, 0);
+            info.iterations++;
+
+            for (size_t i = 0; i <= j; i++) {
+                struct Aml_Mat2d v_i = asl_gmres_vector(V, i);
+                aml_real h = asl_vec_dot(v_i, w);
+                AML_MAT2D_AT(H, i, j) = h;
+                asl_vec_axpy(w, -h, v_i);
+            }
+            aml_real h_next = asl_vec_norm(w);
+            AML_MAT2D_AT(H, j + 1, j) = h_next;
+            if (h_next > 0) {
+                for (size_t i = 0; i < n; i++) {
+                    w.elements[i] /= h_next;
+                }
+            }
+
+            for (size_t i = 0; i < j; i++) {
+                aml_real h0 = AML_MAT2D_AT(H, i, j);
+                aml_real h1 = AML_MAT2D_AT(H, i + 1, j);
+                AML_MAT2D_AT(H, i, j) = cs[i] * h0 + sn[i] * h1;
+                AML_MAT2D_AT(H, i + 1, j) = -sn[i] * h0 + cs[i] * h1;
+            }
+            aml_real h0 = AML_MAT2D_AT(H, j, j);
+            aml_real h1 = AML_MAT2D_AT(H, j + 1, j);
+            aml_real d = aml_hypot(h0, h1);
+            cs[j] = d > 0 ? h0 / d : 1;
+            sn[j] = d > 0 ? h1 / d : 0;
+            AML_MAT2D_AT(H, j, j) = d;
+            AML_MAT2D_AT(H, j + 1, j) = 0;
+            g[j + 1] = -sn[j] * g[j];
+            g[j] = cs[j] * g[j];
+            j++;
+
+            /* h_next == 0 is the lucky breakdown: x is exact in this space */
+            if (aml_fabs(g[j]) <= target || h_next == 0) {
+                break;
+            }
+        }
+
+        /* x += M^-1 * V * y with H y = g */
+        for (size_t i = j; i-- > 0;) {
+            aml_real sum = g[i];
+            for (size_t k = i + 1; k < j; k++) {
+                sum -= AML_MAT2D_AT(H, i, k) * g[k];
+            }
+            g[i] = AML_MAT2D_AT(H, i, i) != 0 ? sum / AML_MAT2D_AT(H, i, i) : 0;
+        }
+        aml_fill(r, 0);
+        for (size_t k = 0; k < j; k++) {
+            asl_vec_axpy(r, g[k], asl_gmres_vector(V, k));
+        }
+        asl_preconditioner_apply(P, z, r);
+        asl_vec_axpy(x, 1, z);
+    }
+
+    info.residual_norm = asl_residual(r, A, x, b) / asl_vec_norm(b);
+    info.converged = info.residual_norm <= tolerance;
+    if (!info.converged) {
+        aml_dprintWARNING("Did not converged after %zu iterations.", info.iterations);
+    }
+
+    aml_mat2d_free(V);
+    aml_mat2d_free(H);
+    aml_mat2d_free(r);
+    aml_mat2d_free(z);
+    AML_FREE(cs);
+    AML_FREE(sn);
+    AML_FREE(g);
+
+    return info;
+}
+
+/**
+ * @brief Append one entry to a triplet list, growing it when full.
+ *
+ * @param triplets Triplet list.
+ * @param row Row index, `< triplets->rows`.
+ * @param col Column index, `< triplets->cols`.
+ * @param value Value, summed with any other entry at `(row, col)`.
+ */
+ASL_DEF void asl_triplets_add(struct Asl_Triplets *triplets, size_t row, size_t col, aml_real value)
+{
+    ASL_ASSERT(row < triplets->rows && col < triplets->cols);
+
+    if (triplets->count >= triplets->capacity) {
+        size_t capacity = triplets->capacity ? 2 * triplets->capacity : ASL_TRIPLETS_INIT_CAPACITY;
+        struct Asl_Triplet *elements = (struct Asl_Triplet *)AML_REALLOC(triplets->elements, sizeof(*elements) * capacity);
+        ASL_ASSERT(elements != NULL);
+        triplets->elements = elements;
+        triplets->capacity = capacity;
+    }
+    struct Asl_Triplet *t = &triplets->elements[triplets->count++];
+    t->row = row;
+    t->col = col;
+    t->value = value;
+}
+
+/**
+ * @brief Allocate an empty triplet list.
+ *
+ * @param rows Number of rows of the matrix to assemble.
+ * @param cols Number of columns of the matrix to assemble.
+ * @param capacity Expected number of entries, 0 for a default; the list
+ * grows as needed.
+ * @return The list, free with asl_triplets_free().
+ */
+ASL_DEF struct Asl_Triplets asl_triplets_alloc(size_t rows, size_t cols, size_t capacity)
+{
+    struct Asl_Triplets triplets;
+    triplets.rows = rows;
+    triplets.cols = cols;
+    triplets.count = 0;
+    triplets.capacity = capacity ? capacity : ASL_TRIPLETS_INIT_CAPACITY;
+    triplets.elements = (struct Asl_Triplet *)AML_MALLOC(sizeof(struct Asl_Triplet) * triplets.capacity);
+    ASL_ASSERT(triplets.elements != NULL);
+
+    return triplets;
+}
+
+/**
+ * @brief Free a triplet list.
+ *
+ * @param triplets List returned by asl_triplets_alloc().
+ */
+ASL_DEF void asl_triplets_free(struct Asl_Triplets triplets)
+{
+    AML_FREE(triplets.elements);
+}
+
+#endif // ALMOG_SPARSE_LIBRARY_IMPLEMENTATION
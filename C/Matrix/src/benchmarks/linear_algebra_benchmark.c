@@ -0,0 +1,612 @@
+// #define AML_SINGLE_PRECISION
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#define ALMOG_MATRIX_LIBRARY_IMPLEMENTATION
+#define ALMOG_LINEAR_ALGEBRA_IMPLEMENTATION
+#include "../Almog_Linear_Algebra.h"
+
+/* Sweeps n = --min, 2 * --min, ... up to --max over the dense routines of aml
+ * and ala on random n x n inputs and reports, for every routine and size, the
+ * best of -n runs as time and GFLOP/s. The flop counts are the nominal ones of
+ * Golub and Van Loan (listed with the cases below), so routines doing the same
+ * job are directly comparable but iterative ones are only rated, not counted.
+ *
+ * Every output of the first run is checked: each case computes a relative
+ * residual (reconstruction, backward error or ala_schur_residual()) and fails
+ * when it exceeds CHECK_FACTOR * n * eps, where eps is the machine epsilon of
+ * the precision the benchmark is built with, or AML_EPS for the iterative
+ * eigensolvers, which deflate at that threshold. Uncomment
+ * AML_SINGLE_PRECISION at the top for the float build.
+ *
+ * --json writes the results; a later run with --baseline compares against
+ * such a file, matching routine, n and precision, and fails when a routine got
+ * slower than the baseline by more than --tolerance or its residual grew by
+ * more than RESIDUAL_GROWTH.
+ *
+ * The Schur and symmetric eigensolvers print their own progress lines.
+ *
+ * usage: linear_algebra_benchmark [-n repetitions] [-t threads] [--min n]
+ *                                 [--max n] [--filter name] [--json path]
+ *                                 [--baseline path] [--tolerance fraction]
+ *   -t           GEMM engine threads, 0 (default) uses every processor
+ *   --filter     only run the routines whose name contains the given text
+ *   --tolerance  allowed GFLOP/s drop against the baseline, default 0.10 */
+
+#define DEFAULT_REPETITIONS 3
+#define DEFAULT_MIN_N 32
+#define DEFAULT_MAX_N 1024
+#define DEFAULT_TOLERANCE 0.10
+#define CHECK_FACTOR 100
+#define RESIDUAL_GROWTH 10
+#define MAX_LINE_LEN 512
+
+#if defined(AML_SINGLE_PRECISION)
+    #define PRECISION_NAME "single"
+    #define PRECISION_EPS FLT_EPSILON
+#else
+    #define PRECISION_NAME "double"
+    #define PRECISION_EPS DBL_EPSILON
+#endif
+
+enum Input_Kind {
+    INPUT_GENERAL,
+    INPUT_SYMMETRIC,
+    INPUT_SPD,
+};
+
+/* matrices and vectors of one size, shared by every case */
+struct Bench_Data {
+    size_t n;
+    struct Aml_Mat2d A;     /* case input */
+    struct Aml_Mat2d B;     /* second factor of the products */
+    struct Aml_Mat2d C;
+    struct Aml_Mat2d W;
+    struct Aml_Mat2d Q;
+    struct Aml_Mat2d U;
+    struct Aml_Mat2d b;
+    struct Aml_Mat2d x;
+    struct Aml_Mat2d y;
+    aml_real *tau;
+    size_t *pivots;
+    struct Ala_Refinement_Info refinement;
+};
+
+struct Bench_Case {
+    const char *name;
+    enum Input_Kind input;
+    /* nominal flops divided by n^3 */
+    double flops_per_n3;
+    /* converges to AML_EPS rather than to machine precision */
+    bool iterative;
+    /* untimed, before every run */
+    void (*prepare)(struct Bench_Data *d);
+    void (*run)(struct Bench_Data *d);
+    /* relative residual of the last run; may overwrite every output */
+    double (*check)(struct Bench_Data *d);
+};
+
+struct Result {
+    const char *name;
+    size_t n;
+    double seconds;
+    double gflops;
+    double residual;
+    const char *check;
+    /* -1 without a baseline entry */
+    double baseline_gflops;
+    double baseline_residual;
+    const char *verdict;
+};
+
+struct Result_List {
+    size_t length;
+    size_t capacity;
+    struct Result *elements;
+};
+
+static double timer_now_sec(void)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    static LARGE_INTEGER frequency = {0};
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+static const char *simd_level_name(enum Aml_Simd_Level level)
+{
+    switch (level) {
+        case AML_SIMD_NONE:   return "scalar";
+        case AML_SIMD_AVX2:   return "avx2";
+        case AML_SIMD_AVX512: return "avx512";
+    }
+    return "?";
+}
+
+static double norm_inf(struct Aml_Mat2d m)
+{
+    double norm = 0;
+    for (size_t i = 0; i < m.rows; i++) {
+        double row_sum = 0;
+        for (size_t j = 0; j < m.cols; j++) {
+            row_sum += aml_fabs(AML_MAT2D_AT(m, i, j));
+        }
+        if (row_sum > norm) norm = row_sum;
+    }
+    return norm;
+}
+
+/* ||X - Y||_F / ||Y||_F, overwriting X */
+static double relative_difference(struct Aml_Mat2d X, struct Aml_Mat2d Y)
+{
+    aml_sub(X, Y);
+    return (double)aml_calc_norma(X) / (double)aml_calc_norma(Y);
+}
+
+/* ||b - A x||_inf / (||A||_inf ||x||_inf + ||b||_inf) */
+static double backward_error(struct Aml_Mat2d A, struct Aml_Mat2d x, struct Aml_Mat2d b, struct Aml_Mat2d r)
+{
+    aml_dot(r, A, x);
+    aml_sub(r, b);
+    return norm_inf(r) / (norm_inf(A) * norm_inf(x) + norm_inf(b));
+}
+
+/* cases */
+
+static void prepare_copy(struct Bench_Data *d)
+{
+    aml_copy(d->W, d->A);
+}
+
+static void run_dot(struct Bench_Data *d)
+{
+    aml_dot(d->C, d->A, d->B);
+}
+
+static void run_dot_fast(struct Bench_Data *d)
+{
+    aml_dot_fast(&d->C, &d->A, &d->B);
+}
+
+/* Freivalds: ||C y - A (B y)|| / (||A|| ||B|| ||y||) for a random y */
+static double check_dot(struct Bench_Data *d)
+{
+    aml_set_rand(d->y, -1, 1);
+    aml_dot(d->b, d->B, d->y);
+    aml_dot(d->x, d->A, d->b);
+    aml_dot(d->b, d->C, d->y);
+    aml_sub(d->b, d->x);
+    return (double)aml_calc_norma(d->b) / ((double)aml_calc_norma(d->A) * aml_calc_norma(d->B) * aml_calc_norma(d->y));
+}
+
+static void run_lup(struct Bench_Data *d)
+{
+    ala_LUP_factor(d->W, d->pivots);
+}
+
+/* ||P A - L U||_F / ||A||_F */
+static double check_lup(struct Bench_Data *d)
+{
+    const size_t n = d->n;
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            aml_real lu = AML_MAT2D_AT(d->W, i, j);
+            AML_MAT2D_AT(d->Q, i, j) = i > j ? lu : (i == j ? 1 : 0);
+            AML_MAT2D_AT(d->U, i, j) = i <= j ? lu : 0;
+        }
+    }
+    aml_dot(d->C, d->Q, d->U);
+    aml_copy(d->W, d->A);
+    for (size_t k = 0; k < n; k++) {
+        if (d->pivots[k] != k) aml_rows_swap(d->W, k, d->pivots[k]);
+    }
+    return relative_difference(d->C, d->W);
+}
+
+static void run_solve_lup(struct Bench_Data *d)
+{
+    ala_solve_linear_sys_LUP_decomposition(d->A, d->x, d->b);
+}
+
+static void run_solve_mixed(struct Bench_Data *d)
+{
+    d->refinement = ala_solve_linear_sys_mixed_precision(d->A, d->x, d->b);
+}
+
+static double check_solve(struct Bench_Data *d)
+{
+    return backward_error(d->A, d->x, d->b, d->y);
+}
+
+static void run_qr(struct Bench_Data *d)
+{
+    ala_QR_factor(d->W, d->tau);
+}
+
+/* ||A - Q R||_F / ||A||_F */
+static double check_qr(struct Bench_Data *d)
+{
+    for (size_t i = 0; i < d->n; i++) {
+        for (size_t j = 0; j < d->n; j++) {
+            AML_MAT2D_AT(d->C, i, j) = i <= j ? AML_MAT2D_AT(d->W, i, j) : 0;
+        }
+    }
+    ala_QR_apply_Q(d->W, d->tau, d->C, false);
+    return relative_difference(d->C, d->A);
+}
+
+static void run_cholesky(struct Bench_Data *d)
+{
+    ala_positive_definite_RTR_Cholesky_decomposition(d->W, d->A);
+}
+
+/* ||R^T R - A||_F / ||A||_F */
+static double check_cholesky(struct Bench_Data *d)
+{
+    aml_transpose(d->Q, d->W);
+    aml_dot(d->C, d->Q, d->W);
+    return relative_difference(d->C, d->A);
+}
+
+static void run_hessenberg(struct Bench_Data *d)
+{
+    ala_hessenberg_decomposition_householder_blocked(d->Q, d->W, d->A, true);
+}
+
+static void run_hessenberg_unblocked(struct Bench_Data *d)
+{
+    ala_hessenberg_decomposition_householder(d->Q, d->W, d->A);
+}
+
+static double check_hessenberg(struct Bench_Data *d)
+{
+    return (double)ala_schur_residual(d->A, d->Q, d->W);
+}
+
+static void run_schur(struct Bench_Data *d)
+{
+    ala_hessenberg_decomposition_householder_blocked(d->Q, d->W, d->A, true);
+    ala_hessenberg_QUQm1_schur_decomposition_householder_fast(d->C, d->U, d->W, true);
+}
+
+/* the Schur vectors are the Hessenberg Q times the QR-iteration Q */
+static double check_schur(struct Bench_Data *d)
+{
+    aml_dot(d->W, d->Q, d->C);
+    return (double)ala_schur_residual(d->A, d->W, d->U);
+}
+
+static void run_symmetric_eig(struct Bench_Data *d)
+{
+    ala_symmetric_eig_QR_tridiagonalize_implicit_shift(d->A, d->U, d->Q);
+}
+
+/* ||A V - V D||_F / ||A||_F, and ala_eig_check() must pass */
+static double check_symmetric_eig(struct Bench_Data *d)
+{
+    if (!ala_eig_check(d->A, d->U, d->Q, d->W)) {
+        return HUGE_VAL;
+    }
+    aml_dot(d->W, d->A, d->Q);
+    aml_dot(d->C, d->Q, d->U);
+    aml_sub(d->W, d->C);
+    return (double)aml_calc_norma(d->W) / (double)aml_calc_norma(d->A);
+}
+
+static void run_svd(struct Bench_Data *d)
+{
+    ala_SVD_golub_kahan(d->A, d->U, d->W, d->Q, true, false);
+}
+
+/* ||A - U S V^T||_F / ||A||_F */
+static double check_svd(struct Bench_Data *d)
+{
+    aml_dot(d->C, d->U, d->W);
+    aml_transpose(d->W, d->Q);
+    aml_dot(d->U, d->C, d->W);
+    return relative_difference(d->U, d->A);
+}
+
+/* nominal flops / n^3: products 2, LU 2/3, Householder QR 4/3, Cholesky 1/3,
+ * Hessenberg with Q 10/3 + 4/3, real Schur with vectors from a full matrix 25,
+ * symmetric eigenpairs 9, SVD with U and V (Golub-Reinsch, m = n) 21 */
+static const struct Bench_Case cases[] = {
+    {"dot",                  INPUT_GENERAL,   2.0,      false, NULL,         run_dot,                  check_dot},
+    {"dot_fast",             INPUT_GENERAL,   2.0,      false, NULL,         run_dot_fast,             check_dot},
+    {"lup",                  INPUT_GENERAL,   2.0 / 3,  false, prepare_copy, run_lup,                  check_lup},
+    {"solve_lup",            INPUT_GENERAL,   2.0 / 3,  false, NULL,         run_solve_lup,            check_solve},
+    {"solve_mixed",          INPUT_GENERAL,   2.0 / 3,  false, NULL,         run_solve_mixed,          check_solve},
+    {"qr",                   INPUT_GENERAL,   4.0 / 3,  false, prepare_copy, run_qr,                   check_qr},
+    {"cholesky",             INPUT_SPD,       1.0 / 3,  false, NULL,         run_cholesky,             check_cholesky},
+    {"hessenberg",           INPUT_GENERAL,   14.0 / 3, false, NULL,         run_hessenberg,           check_hessenberg},
+    {"hessenberg_unblocked", INPUT_GENERAL,   14.0 / 3, false, NULL,         run_hessenberg_unblocked, check_hessenberg},
+    {"schur",                INPUT_GENERAL,   25.0,     true,  NULL,         run_schur,                check_schur},
+    {"symmetric_eig",        INPUT_SYMMETRIC, 9.0,      true,  NULL,         run_symmetric_eig,        check_symmetric_eig},
+    {"svd",                  INPUT_GENERAL,   21.0,     false, NULL,         run_svd,                  check_svd},
+};
+#define NUM_OF_CASES (sizeof(cases) / sizeof(cases[0]))
+
+static struct Bench_Data data_alloc(size_t n)
+{
+    struct Bench_Data d = {0};
+    d.n = n;
+    d.A = aml_mat2d_alloc(n, n);
+    d.B = aml_mat2d_alloc(n, n);
+    d.C = aml_mat2d_alloc(n, n);
+    d.W = aml_mat2d_alloc(n, n);
+    d.Q = aml_mat2d_alloc(n, n);
+    d.U = aml_mat2d_alloc(n, n);
+    d.b = aml_mat2d_alloc(n, 1);
+    d.x = aml_mat2d_alloc(n, 1);
+    d.y = aml_mat2d_alloc(n, 1);
+    d.tau = (aml_real *)AML_MALLOC(sizeof(*d.tau) * n);
+    d.pivots = (size_t *)AML_MALLOC(sizeof(*d.pivots) * n);
+    AML_ASSERT(d.tau != NULL && d.pivots != NULL);
+    aml_set_rand(d.B, -1, 1);
+    aml_set_rand(d.b, -1, 1);
+    return d;
+}
+
+static void data_free(struct Bench_Data d)
+{
+    aml_mat2d_free(d.A);
+    aml_mat2d_free(d.B);
+    aml_mat2d_free(d.C);
+    aml_mat2d_free(d.W);
+    aml_mat2d_free(d.Q);
+    aml_mat2d_free(d.U);
+    aml_mat2d_free(d.b);
+    aml_mat2d_free(d.x);
+    aml_mat2d_free(d.y);
+    AML_FREE(d.tau);
+    AML_FREE(d.pivots);
+}
+
+/* A random in [-1, 1), made symmetric as (M + M^T) / 2 or symmetric positive
+ * definite as M^T M / n + I */
+static void input_make(struct Bench_Data *d, enum Input_Kind kind)
+{
+    aml_set_rand(d->A, -1, 1);
+    if (kind == INPUT_GENERAL) return;
+
+    aml_transpose(d->W, d->A);
+    if (kind == INPUT_SYMMETRIC) {
+        aml_add(d->A, d->W);
+        aml_mult(d->A, (aml_real)0.5);
+        /* exactly symmetric despite the rounding of the additions */
+        for (size_t i = 0; i < d->n; i++) {
+            for (size_t j = 0; j < i; j++) {
+                AML_MAT2D_AT(d->A, i, j) = AML_MAT2D_AT(d->A, j, i);
+            }
+        }
+        return;
+    }
+    aml_dot(d->C, d->W, d->A);
+    aml_copy(d->A, d->C);
+    aml_mult(d->A, (aml_real)1 / (aml_real)d->n);
+    for (size_t i = 0; i < d->n; i++) {
+        AML_MAT2D_AT(d->A, i, i) += 1;
+        for (size_t j = 0; j < i; j++) {
+            AML_MAT2D_AT(d->A, i, j) = AML_MAT2D_AT(d->A, j, i);
+        }
+    }
+}
+
+static void json_string(FILE *fp, const char *s)
+{
+    fputc('"', fp);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', fp);
+        fputc(*s, fp);
+    }
+    fputc('"', fp);
+}
+
+/* One result per line, so baseline_find() can read the file back without a
+ * JSON parser. */
+static bool json_write(const char *path, struct Result_List *results, size_t repetitions, size_t threads)
+{
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL) return false;
+    fprintf(fp, "{\n  \"precision\": \"%s\",\n  \"simd\": \"%s\",\n  \"threads\": %zu,\n  \"repetitions\": %zu,\n  \"results\": [\n",
+            PRECISION_NAME, simd_level_name(aml_simd_level_get()), threads, repetitions);
+    for (size_t i = 0; i < results->length; i++) {
+        struct Result *r = &results->elements[i];
+        fprintf(fp, "    {\"routine\": ");
+        json_string(fp, r->name);
+        fprintf(fp, ", \"n\": %zu, \"precision\": \"%s\", \"seconds\": %.9f, \"gflops\": %.4f, \"residual\": %.6e, \"check\": ",
+                r->n, PRECISION_NAME, r->seconds, r->gflops, r->residual);
+        json_string(fp, r->check);
+        fprintf(fp, "}%s\n", i + 1 < results->length ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    fclose(fp);
+    return true;
+}
+
+/* text after `"key": ` in line, or NULL */
+static const char *json_field(const char *line, const char *key)
+{
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\": ", key);
+    const char *p = strstr(line, pattern);
+    return p != NULL ? p + strlen(pattern) : NULL;
+}
+
+/* Looks up routine, n and this build's precision in a file written by
+ * json_write(). */
+static bool baseline_find(FILE *fp, const char *name, size_t n, double *gflops, double *residual)
+{
+    char line[MAX_LINE_LEN];
+    char quoted[64];
+    snprintf(quoted, sizeof(quoted), "\"%s\"", name);
+    rewind(fp);
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        const char *routine = json_field(line, "routine");
+        const char *size = json_field(line, "n");
+        const char *precision = json_field(line, "precision");
+        const char *g = json_field(line, "gflops");
+        const char *res = json_field(line, "residual");
+        if (routine == NULL || size == NULL || precision == NULL || g == NULL || res == NULL) continue;
+        if (strncmp(routine, quoted, strlen(quoted)) != 0) continue;
+        if (strtoull(size, NULL, 10) != n) continue;
+        if (strncmp(precision, "\"" PRECISION_NAME "\"", strlen(PRECISION_NAME) + 2) != 0) continue;
+        *gflops = strtod(g, NULL);
+        *residual = strtod(res, NULL);
+        return true;
+    }
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    size_t repetitions = DEFAULT_REPETITIONS;
+    size_t threads = 0;
+    size_t min_n = DEFAULT_MIN_N;
+    size_t max_n = DEFAULT_MAX_N;
+    double tolerance = DEFAULT_TOLERANCE;
+    const char *only = NULL;
+    const char *json_path = NULL;
+    const char *baseline_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            repetitions = (size_t)strtoul(argv[++i], NULL, 10);
+            if (repetitions == 0) repetitions = 1;
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            threads = (size_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--min") == 0 && i + 1 < argc) {
+            min_n = (size_t)strtoul(argv[++i], NULL, 10);
+            if (min_n < 4) min_n = 4;
+        } else if (strcmp(argv[i], "--max") == 0 && i + 1 < argc) {
+            max_n = (size_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            only = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            tolerance = strtod(argv[++i], NULL);
+        } else {
+            fprintf(stderr, "usage: %s [-n repetitions] [-t threads] [--min n] [--max n] [--filter name] [--json path] [--baseline path] [--tolerance fraction]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    struct Aml_Gemm_Config config = aml_gemm_config_get();
+    config.num_of_threads = threads;
+    aml_gemm_config_set(config);
+    if (threads == 0) threads = aml_cpu_count_get();
+
+    FILE *baseline = NULL;
+    if (baseline_path != NULL) {
+        baseline = fopen(baseline_path, "r");
+        if (baseline == NULL) {
+            aml_dprintERROR("Cannot read '%s'.", baseline_path);
+            return 1;
+        }
+    }
+
+    printf("n = %zu..%zu, best of %zu, %zu threads, %s precision, %s kernels\n\n", min_n, max_n, repetitions, threads,
+           PRECISION_NAME, simd_level_name(aml_simd_level_get()));
+    printf("%-22s %6s %12s %9s %11s %6s  %s\n", "routine", "n", "ms", "GFLOP/s", "residual", "check", "baseline");
+
+    size_t num_of_sizes = 0;
+    for (size_t n = min_n; n <= max_n; n *= 2) num_of_sizes++;
+    struct Result_List results = {0};
+    results.capacity = num_of_sizes * NUM_OF_CASES;
+    results.elements = (struct Result *)AML_MALLOC(sizeof(*results.elements) * (results.capacity + 1));
+    AML_ASSERT(results.elements != NULL);
+    int rt = 0;
+    size_t failures = 0;
+    size_t regressions = 0;
+
+    for (size_t n = min_n; n <= max_n; n *= 2) {
+        struct Bench_Data d = data_alloc(n);
+        for (size_t k = 0; k < NUM_OF_CASES; k++) {
+            const struct Bench_Case *c = &cases[k];
+            if (only != NULL && strstr(c->name, only) == NULL) continue;
+            input_make(&d, c->input);
+
+            /* the first run warms the caches and gives the output to check */
+            if (c->prepare != NULL) c->prepare(&d);
+            c->run(&d);
+            double residual = c->check(&d);
+            double eps = c->iterative ? (double)AML_EPS : PRECISION_EPS;
+            bool passed = residual <= CHECK_FACTOR * (double)n * eps;
+            if (!passed) {
+                failures++;
+                rt = 1;
+            }
+
+            double best_seconds = 0;
+            for (size_t rep = 0; rep < repetitions; rep++) {
+                if (c->prepare != NULL) c->prepare(&d);
+                double start = timer_now_sec();
+                c->run(&d);
+                double seconds = timer_now_sec() - start;
+                if (rep == 0 || seconds < best_seconds) best_seconds = seconds;
+            }
+
+            struct Result r = {0};
+            r.name = c->name;
+            r.n = n;
+            r.seconds = best_seconds;
+            r.gflops = best_seconds > 0 ? c->flops_per_n3 * (double)n * (double)n * (double)n / best_seconds * 1e-9 : 0;
+            r.residual = residual;
+            r.check = passed ? "pass" : "FAIL";
+            r.baseline_gflops = -1;
+            r.baseline_residual = -1;
+            r.verdict = "";
+
+            char baseline_text[64] = "-";
+            if (baseline != NULL && baseline_find(baseline, c->name, n, &r.baseline_gflops, &r.baseline_residual)) {
+                bool slower = r.gflops < (1 - tolerance) * r.baseline_gflops;
+                bool less_accurate = residual > RESIDUAL_GROWTH * r.baseline_residual &&
+                                     residual > (double)n * eps;
+                r.verdict = slower ? "SLOWER" : less_accurate ? "LESS ACCURATE" : "ok";
+                if (slower || less_accurate) {
+                    regressions++;
+                    rt = 1;
+                }
+                snprintf(baseline_text, sizeof(baseline_text), "%+.1f%% %s",
+                         r.baseline_gflops > 0 ? (r.gflops / r.baseline_gflops - 1) * 100 : 0, r.verdict);
+            }
+            results.elements[results.length++] = r;
+
+            printf("%-22s %6zu %12.3f %9.2f %11.3e %6s  %s\n", r.name, r.n, r.seconds * 1e3, r.gflops, r.residual, r.check,
+                   baseline_text);
+            fflush(stdout);
+        }
+        data_free(d);
+    }
+
+    printf("\n%zu results, %zu failed checks", results.length, failures);
+    if (baseline != NULL) {
+        printf(", %zu regressions against %s", regressions, baseline_path);
+        fclose(baseline);
+    }
+    printf("\n");
+    if (json_path != NULL) {
+        if (json_write(json_path, &results, repetitions, threads)) {
+            printf("wrote %s\n", json_path);
+        } else {
+            aml_dprintERROR("Cannot write '%s'.", json_path);
+            rt = 1;
+        }
+    }
+
+    AML_FREE(results.elements);
+    return rt;
+}
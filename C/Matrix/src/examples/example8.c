@@ -17,7 +17,7 @@ int main(void)
     aml_set_rand(A, -2, 2);
 
     aml_dprintINFO("n = %zu", n);
-    ala_hessenberg_decomposition_householder(Q_h, H, A);
+    ala_hessenberg_decomposition_householder_blocked(Q_h, H, A, true);
     aml_dprintINFO("%s", "Finished hessenberg decomposition.");
 
     ala_hessenberg_QUQm1_schur_decomposition_householder_fast(Q_u, U, H, true);
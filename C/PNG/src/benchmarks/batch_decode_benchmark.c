@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdbool.h>
+
+#define ALMOG_PNG_IMPLEMENTATION
+#include "../include/Almog_PNG.h"
+
+/* Decodes the same list of files with apng_png_batch_load() at 1, 2, 4, ...
+ * threads up to apng_cpu_count_get(), prints the per-image timings of the
+ * widest run and checks that every run decodes the same pixels. */
+
+#define COPIES 8
+
+const char *file_name[] = {
+    "../src/test_images/Bikesgray.png",
+    "../src/test_images/Valve_original.PNG",
+    "../src/test_images/file_example_PNG_3MB.png",
+    "../src/test_images/gaussian_blur_test.png",
+    "../src/test_images/test-png.png",
+    "../src/test_images/test-png2.png",
+    "../src/test_images/test-png5.png",
+    "../src/test_images/test-png7.png",
+    "../src/test_images/test-png_wiki.png",
+    "../src/test_images/PngSuite/Basic-formats/basn0g08.png",
+    "../src/test_images/PngSuite/Basic-formats/basn2c08.png",
+    "../src/test_images/PngSuite/Basic-formats/basn4a08.png",
+    "../src/test_images/PngSuite/Basic-formats/basn6a08.png",
+};
+size_t num_of_images = sizeof(file_name) / sizeof(file_name[0]);
+
+static uint64_t pixels_hash(struct Apng_Pixel_Buffer pixels)
+{
+    uint64_t hash = 1469598103934665603ull;
+    for (size_t i = 0; i < pixels.rows; i++) {
+        for (size_t j = 0; j < pixels.cols; j++) {
+            hash ^= APNG_PIXEL_BUFFER_AT(pixels, i, j);
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+int main(void)
+{
+    /* every file is listed COPIES times to give the pool something to chew on */
+    size_t num_of_files = num_of_images * COPIES;
+    char **files = APNG_MALLOC(sizeof(*files) * num_of_files);
+    struct Apng_Batch_Result *results = APNG_MALLOC(sizeof(*results) * num_of_files);
+    uint64_t *reference = APNG_MALLOC(sizeof(*reference) * num_of_files);
+    APNG_ASSERT(files != NULL && results != NULL && reference != NULL);
+    for (size_t i = 0; i < num_of_files; i++) {
+        files[i] = (char *)file_name[i % num_of_images];
+    }
+
+    size_t max_threads = apng_cpu_count_get();
+    struct Apng_Decode_Options options = {0};
+    int rt = 0;
+    double single_thread_seconds = 0;
+
+    printf("%zu files, %zu logical processors\n\n", num_of_files, max_threads);
+    printf("%8s %10s %12s %8s\n", "threads", "seconds", "images/s", "speedup");
+    for (size_t threads = 1; ; threads *= 2) {
+        if (threads > max_threads) threads = max_threads;
+
+        double start = apng_timer_now_sec();
+        if (APNG_FAIL == apng_png_batch_load(files, num_of_files, results, threads, options)) {
+            rt = 1;
+        }
+        double seconds = apng_timer_now_sec() - start;
+        if (threads == 1) single_thread_seconds = seconds;
+
+        for (size_t i = 0; i < num_of_files; i++) {
+            uint64_t hash = results[i].rt == APNG_SUCCESS ? pixels_hash(results[i].image.pixels) : 0;
+            if (threads == 1) {
+                reference[i] = hash;
+            } else if (hash != reference[i]) {
+                apng_dprintERROR("'%s' decoded differently with %zu threads.", files[i], threads);
+                rt = 1;
+            }
+        }
+        printf("%8zu %10.3f %12.1f %7.2fx\n", threads, seconds, num_of_files / seconds, single_thread_seconds / seconds);
+
+        if (threads == max_threads) break;
+        apng_png_batch_free(results, num_of_files);
+    }
+
+    printf("\n%-52s %6s %10s %10s\n", "image", "worker", "read ms", "decode ms");
+    for (size_t i = 0; i < num_of_images; i++) {
+        printf("%-52s %6zu %10.3f %10.3f\n", results[i].file_name, results[i].worker,
+               results[i].read_seconds * 1e3, results[i].decode_seconds * 1e3);
+    }
+
+    apng_png_batch_free(results, num_of_files);
+    APNG_FREE(files);
+    APNG_FREE(results);
+    APNG_FREE(reference);
+
+    return rt;
+}
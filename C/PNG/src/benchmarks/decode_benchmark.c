@@ -0,0 +1,322 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <ctype.h>
+
+#define ALMOG_PNG_IMPLEMENTATION
+#include "../include/Almog_PNG.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+#else
+    #include <dirent.h>
+#endif
+
+/* Decodes every PNG under test_images/ (PngSuite included) REPETITIONS times,
+ * reports compressed MB/s, output megapixels/s and the time of every decode
+ * stage, and compares the decoded pixels of each file with
+ * reference_hashes.txt. Files that are expected to fail (corrupted or
+ * unsupported) are recorded as FAIL and must keep failing.
+ *
+ * usage: decode_benchmark [-n repetitions] [--update]
+ *   --update  rewrite reference_hashes.txt from the current decoder */
+
+#define TEST_IMAGES_DIR "../src/test_images"
+#define REFERENCE_FILE  "../src/benchmarks/reference_hashes.txt"
+#define DEFAULT_REPETITIONS 5
+#define MAX_PATH_LEN 512
+
+struct File_List {
+    size_t length;
+    size_t capacity;
+    char **elements;
+};
+
+struct Reference {
+    char path[MAX_PATH_LEN];
+    bool ok;
+    size_t rows;
+    size_t cols;
+    uint64_t hash;
+};
+
+struct Reference_List {
+    size_t length;
+    size_t capacity;
+    struct Reference *elements;
+};
+
+static bool has_png_extension(const char *name)
+{
+    size_t len = strlen(name);
+    if (len < 4) return false;
+    const char *ext = name + len - 4;
+    return ext[0] == '.' && tolower((unsigned char)ext[1]) == 'p' &&
+           tolower((unsigned char)ext[2]) == 'n' && tolower((unsigned char)ext[3]) == 'g';
+}
+
+static void file_list_add(struct File_List *files, const char *dir, const char *name)
+{
+    size_t len = strlen(dir) + 1 + strlen(name) + 1;
+    char *path = APNG_MALLOC(len);
+    APNG_ASSERT(path != NULL);
+    snprintf(path, len, "%s/%s", dir, name);
+    ada_appand(char *, *files, path);
+}
+
+/* collects the PNG files under dir, recursing into sub directories */
+static void collect_png_files(const char *dir, struct File_List *files)
+{
+    struct File_List sub_dirs = {0};
+    ada_init_array(char *, sub_dirs);
+
+#if defined(_WIN32) || defined(_WIN64)
+    char pattern[MAX_PATH_LEN];
+    snprintf(pattern, sizeof(pattern), "%s/*", dir);
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA(pattern, &data);
+    if (find != INVALID_HANDLE_VALUE) {
+        do {
+            if (data.cFileName[0] == '.') continue;
+            if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+                file_list_add(&sub_dirs, dir, data.cFileName);
+            } else if (has_png_extension(data.cFileName)) {
+                file_list_add(files, dir, data.cFileName);
+            }
+        } while (FindNextFileA(find, &data));
+        FindClose(find);
+    }
+#else
+    DIR *d = opendir(dir);
+    if (d != NULL) {
+        struct dirent *entry;
+        while ((entry = readdir(d)) != NULL) {
+            if (entry->d_name[0] == '.') continue;
+            char path[MAX_PATH_LEN];
+            snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+            DIR *sub = opendir(path);
+            if (sub != NULL) {
+                closedir(sub);
+                file_list_add(&sub_dirs, dir, entry->d_name);
+            } else if (has_png_extension(entry->d_name)) {
+                file_list_add(files, dir, entry->d_name);
+            }
+        }
+        closedir(d);
+    }
+#endif
+
+    for (size_t i = 0; i < sub_dirs.length; i++) {
+        collect_png_files(sub_dirs.elements[i], files);
+        APNG_FREE(sub_dirs.elements[i]);
+    }
+    APNG_FREE(sub_dirs.elements);
+}
+
+static int compare_paths(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/* path relative to TEST_IMAGES_DIR, so the reference file does not depend on
+ * where the benchmark runs from */
+static const char *relative_path(const char *path)
+{
+    size_t prefix = strlen(TEST_IMAGES_DIR) + 1;
+    return strlen(path) > prefix ? path + prefix : path;
+}
+
+static uint64_t pixels_hash(struct Apng_Pixel_Buffer pixels)
+{
+    uint64_t hash = 1469598103934665603ull;
+    for (size_t i = 0; i < pixels.rows; i++) {
+        for (size_t j = 0; j < pixels.cols; j++) {
+            hash ^= (uint32_t)APNG_PIXEL_BUFFER_AT(pixels, i, j);
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+static bool references_read(struct Reference_List *refs)
+{
+    FILE *fp = fopen(REFERENCE_FILE, "r");
+    if (fp == NULL) return false;
+
+    char line[MAX_PATH_LEN + 64];
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') continue;
+        struct Reference ref = {0};
+        char status[8] = {0};
+        unsigned long long hash = 0;
+        if (sscanf(line, "%7s %zux%zu %llx %511s", status, &ref.rows, &ref.cols, &hash, ref.path) != 5) {
+            apng_dprintERROR("Malformed reference line: %s", line);
+            continue;
+        }
+        ref.ok = strcmp(status, "OK") == 0;
+        ref.hash = (uint64_t)hash;
+        ada_appand(struct Reference, *refs, ref);
+    }
+    fclose(fp);
+    return true;
+}
+
+static struct Reference *reference_find(struct Reference_List *refs, const char *path)
+{
+    for (size_t i = 0; i < refs->length; i++) {
+        if (strcmp(refs->elements[i].path, path) == 0) return &refs->elements[i];
+    }
+    return NULL;
+}
+
+/* apng_png_decode() takes ownership of the byte string, so every repetition
+ * decodes its own copy */
+static struct Apng_Byte_String byte_string_copy(struct Apng_Byte_String bs)
+{
+    struct Apng_Byte_String copy = bs;
+    copy.cursor = 0;
+    copy.name = APNG_MALLOC(strlen(bs.name) + 1);
+    copy.elements = APNG_MALLOC(bs.length);
+    APNG_ASSERT(copy.name != NULL && copy.elements != NULL);
+    strcpy(copy.name, bs.name);
+    memcpy(copy.elements, bs.elements, bs.length);
+    return copy;
+}
+
+int main(int argc, char **argv)
+{
+    size_t repetitions = DEFAULT_REPETITIONS;
+    bool update = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--update") == 0) {
+            update = true;
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            repetitions = (size_t)strtoul(argv[++i], NULL, 10);
+            if (repetitions == 0) repetitions = 1;
+        } else {
+            fprintf(stderr, "usage: %s [-n repetitions] [--update]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    struct File_List files = {0};
+    ada_init_array(char *, files);
+    collect_png_files(TEST_IMAGES_DIR, &files);
+    qsort(files.elements, files.length, sizeof(files.elements[0]), compare_paths);
+    if (files.length == 0) {
+        apng_dprintERROR("No PNG files found under '%s'.", TEST_IMAGES_DIR);
+        return 1;
+    }
+
+    struct Reference_List refs = {0};
+    ada_init_array(struct Reference, refs);
+    if (!update && !references_read(&refs)) {
+        apng_dprintERROR("Cannot read '%s', run with --update to create it.", REFERENCE_FILE);
+        return 1;
+    }
+    FILE *out = NULL;
+    if (update) {
+        out = fopen(REFERENCE_FILE, "w");
+        if (out == NULL) {
+            apng_dprintERROR("Cannot write '%s'.", REFERENCE_FILE);
+            return 1;
+        }
+        fprintf(out, "# status rows x cols  pixel hash  path (relative to test_images/)\n");
+        fprintf(out, "# regenerate with: decode_benchmark --update\n");
+    }
+
+    printf("%zu files, %zu repetitions, %s kernels\n\n", files.length, repetitions, apng_simd_level_name_get(apng_simd_level_get()));
+    printf("%-44s %8s %8s %9s %8s %8s %8s %8s  %s\n",
+           "image", "MB in", "MPix", "MB/s in", "MPix/s", "inflate", "unfilt", "convert", "check");
+
+    int rt = 0;
+    size_t passed = 0, failed = 0;
+    double total_in = 0, total_mpix = 0, total_seconds = 0;
+    struct Apng_Decode_Stats total_stats = {0};
+
+    for (size_t f = 0; f < files.length; f++) {
+        const char *path = relative_path(files.elements[f]);
+        struct Apng_Byte_String file = apng_bin_file_read(files.elements[f]);
+        if (file.name == NULL) {
+            rt = 1;
+            continue;
+        }
+
+        bool ok = true;
+        size_t rows = 0, cols = 0;
+        uint64_t hash = 0;
+        double seconds = 0;
+        struct Apng_Decode_Stats stats = {0};
+        for (size_t rep = 0; rep < repetitions && ok; rep++) {
+            struct Apng_PNG_Image image = {0};
+            double start = apng_timer_now_sec();
+            ok = apng_png_decode(byte_string_copy(file), &image, false) == APNG_SUCCESS;
+            seconds += apng_timer_now_sec() - start;
+            stats.inflate_seconds  += image.stats.inflate_seconds;
+            stats.unfilter_seconds += image.stats.unfilter_seconds;
+            stats.convert_seconds  += image.stats.convert_seconds;
+            if (ok && rep == 0) {
+                rows = image.pixels.rows;
+                cols = image.pixels.cols;
+                hash = pixels_hash(image.pixels);
+            }
+            apng_png_free(&image);
+        }
+
+        const char *check = "new";
+        if (update) {
+            fprintf(out, "%-4s %zux%zu %016llx %s\n", ok ? "OK" : "FAIL", rows, cols, (unsigned long long)hash, path);
+            check = "updated";
+        } else {
+            struct Reference *ref = reference_find(&refs, path);
+            if (ref == NULL) {
+                rt = 1;
+            } else if (ref->ok != ok || (ok && (ref->rows != rows || ref->cols != cols || ref->hash != hash))) {
+                check = "MISMATCH";
+                rt = 1;
+            } else {
+                check = ok ? "pass" : "pass (fails)";
+            }
+        }
+
+        if (ok) {
+            double in_mb = file.length / 1e6;
+            double mpix = rows * cols / 1e6;
+            double mean = seconds / repetitions;
+            printf("%-44s %8.3f %8.3f %9.1f %8.2f %7.2fms %6.2fms %6.2fms  %s\n", path, in_mb, mpix, in_mb / mean, mpix / mean,
+                   stats.inflate_seconds / repetitions * 1e3, stats.unfilter_seconds / repetitions * 1e3,
+                   stats.convert_seconds / repetitions * 1e3, check);
+            total_in += in_mb * repetitions;
+            total_mpix += mpix * repetitions;
+            total_seconds += seconds;
+            total_stats.inflate_seconds  += stats.inflate_seconds;
+            total_stats.unfilter_seconds += stats.unfilter_seconds;
+            total_stats.convert_seconds  += stats.convert_seconds;
+            passed++;
+        } else {
+            printf("%-44s %8.3f %8s %9s %8s %8s %8s %8s  %s\n", path, file.length / 1e6, "-", "-", "-", "-", "-", "-", check);
+            failed++;
+        }
+        apng_byte_string_free(&file);
+    }
+
+    printf("\n%zu decoded, %zu rejected\n", passed, failed);
+    if (total_seconds > 0) {
+        double stage_total = total_stats.inflate_seconds + total_stats.unfilter_seconds + total_stats.convert_seconds;
+        printf("total: %.1f MB/s in, %.2f MPix/s out | inflate %.1f%%, unfilter %.1f%%, convert %.1f%% of stage time\n",
+               total_in / total_seconds, total_mpix / total_seconds,
+               100 * total_stats.inflate_seconds / stage_total, 100 * total_stats.unfilter_seconds / stage_total,
+               100 * total_stats.convert_seconds / stage_total);
+    }
+    if (update) {
+        fclose(out);
+        printf("wrote %s\n", REFERENCE_FILE);
+    } else {
+        printf("reference check: %s\n", rt == 0 ? "pass" : "FAILED");
+    }
+
+    for (size_t i = 0; i < files.length; i++) APNG_FREE(files.elements[i]);
+    APNG_FREE(files.elements);
+    APNG_FREE(refs.elements);
+
+    return rt;
+}
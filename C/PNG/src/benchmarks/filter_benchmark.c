@@ -0,0 +1,670 @@
+#include <stdio.h>
+#include <stdbool.h>
+
+#define MATRIX2D_IMPLEMENTATION
+#include "../include/Matrix2D.h"
+
+#define ALMOG_PNG_IMPLEMENTATION
+#include "../include/Almog_PNG.h"
+
+#define ALMOG_IMAGE_MANIPULATION_IMPLEMENTATION
+#include "../include/Almog_Image_Manipulation.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+    #define HAS_CYCLE_COUNTER 1
+#elif defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define HAS_CYCLE_COUNTER 1
+#else
+    #define HAS_CYCLE_COUNTER 0
+#endif
+
+/* Runs the aim filters headless over synthetic images at several resolutions
+ * and over a few bundled images, with several kernel sizes, and reports the
+ * best of -n runs as megapixels/s and cycles/pixel (time stamp counter cycles,
+ * x86 only). Megapixels count the larger of the source and the destination.
+ *
+ * Fast paths are checked against the implementation they replace: every
+ * filter run on -t threads against the serial run and the fused filter graph
+ * against its stages run one by one must match bit for bit, and the Laplacian
+ * pyramid round trip must give back its input. The recursive Gaussian is only
+ * an approximation of the exact one; it reports their largest channel
+ * difference away from the border, where the two pad differently. Flat opaque
+ * images are sharpened first: zero padding must not brighten their outer
+ * 3 * std pixels, serial or parallel.
+ *
+ * usage: filter_benchmark [-n repetitions] [-t threads] [--filter name]
+ *                         [--csv path] [--json path]
+ *   -t        threads of the parallel runs, 0 (default) uses every processor
+ *   --filter  only run the cases whose name contains the given text
+ *   --csv, --json  also write the results to a file */
+
+#define DEFAULT_REPETITIONS 5
+#define MAX_CASES 128
+#define GRAPH_THRESHOLD 40
+
+const char *file_name[] = {
+    "../src/test_images/Bikesgray.png",
+    "../src/test_images/Valve_original.PNG",
+    "../src/test_images/file_example_PNG_3MB.png",
+};
+size_t num_of_images = sizeof(file_name) / sizeof(file_name[0]);
+
+const size_t synthetic_size[][2] = {
+    {256, 256},
+    {720, 1280},
+    {1080, 1920},
+};
+size_t num_of_synthetic = sizeof(synthetic_size) / sizeof(synthetic_size[0]);
+
+const size_t box_kernel_size[]    = {3, 7, 15, 31};
+const size_t median_kernel_size[] = {3, 7, 15, 31};
+const size_t sobel_kernel_size[]  = {3, 7, 15};
+const mat2D_real gaussian_std[]   = {1, 3, 8};
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+enum Case_Kind {
+    CASE_COPY,
+    CASE_FILTER,
+    CASE_FILTER_PARALLEL,
+    CASE_GRAPH,
+    CASE_GRAPH_STAGES,
+    CASE_PYRAMID_DOWN,
+    CASE_PYRAMID_UP,
+    CASE_PYRAMID_ROUND_TRIP,
+    CASE_RESIZE,
+};
+
+/* one way of producing an output image */
+struct Run {
+    enum Case_Kind kind;
+    Aim_Filter filter;
+    enum Aim_Resize_Filter resize;
+};
+
+struct Bench_Case {
+    const char *name;
+    char params[32];
+    struct Run run;
+    bool parallel;
+    /* the output is compared with the one of `reference`; with `exact` any
+     * difference fails the benchmark */
+    bool has_reference;
+    bool exact;
+    const char *reference_name;
+    struct Run reference;
+    /* rows and columns at the border left out of the comparison */
+    size_t margin;
+};
+
+struct Result {
+    const char *name;
+    const char *params;
+    const char *image;
+    size_t rows;
+    size_t cols;
+    size_t threads;
+    double seconds;
+    double mpix_per_s;
+    double cycles_per_pixel;
+    const char *reference;
+    int max_diff;
+    const char *check;
+};
+
+struct Result_List {
+    size_t length;
+    size_t capacity;
+    struct Result *elements;
+};
+
+static uint64_t cycles_now(void)
+{
+#if HAS_CYCLE_COUNTER
+    return (uint64_t)__rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static const char *filter_kind_name(enum Aim_Filter_Kind kind)
+{
+    switch (kind) {
+        case AIM_FILTER_BOX_BLUR_BW:          return "box_blur_bw";
+        case AIM_FILTER_BOX_BLUR_RGBA:        return "box_blur_rgba";
+        case AIM_FILTER_GAUSSIAN_BW:          return "gaussian_bw";
+        case AIM_FILTER_GAUSSIAN_BW_FAST:     return "gaussian_bw_fast";
+        case AIM_FILTER_GAUSSIAN_RGBA_FAST:   return "gaussian_rgba_fast";
+        case AIM_FILTER_MEDIAN_BW:            return "median_bw";
+        case AIM_FILTER_MEDIAN_RGBA:          return "median_rgba";
+        case AIM_FILTER_SHARPEN_BW:           return "sharpen_bw";
+        case AIM_FILTER_SHARPEN_RGBA:         return "sharpen_rgba";
+        case AIM_FILTER_SCHARR_3X3:           return "scharr_3x3";
+        case AIM_FILTER_SOBEL_3X3:            return "sobel_3x3";
+        case AIM_FILTER_SOBEL_3X3_CUTOFF:     return "sobel_3x3_cutoff";
+        case AIM_FILTER_SOBEL_5X5:            return "sobel_5x5";
+        case AIM_FILTER_SOBEL_5X5_CUTOFF:     return "sobel_5x5_cutoff";
+        case AIM_FILTER_SOBEL_GENERAL:        return "sobel_general";
+        case AIM_FILTER_SOBEL_GENERAL_CUTOFF: return "sobel_general_cutoff";
+    }
+    return "?";
+}
+
+static size_t cases_add_filter(struct Bench_Case *cases, size_t n, Aim_Filter filter, const char *params)
+{
+    APNG_ASSERT(n + 2 <= MAX_CASES);
+    const char *name = filter_kind_name(filter.kind);
+
+    struct Bench_Case *c = &cases[n++];
+    c->name = name;
+    snprintf(c->params, sizeof(c->params), "%s", params);
+    c->run.kind = CASE_FILTER;
+    c->run.filter = filter;
+    if (filter.kind == AIM_FILTER_GAUSSIAN_BW_FAST) {
+        c->has_reference = true;
+        c->reference_name = "gaussian_bw";
+        c->reference.kind = CASE_FILTER;
+        c->reference.filter = filter;
+        c->reference.filter.kind = AIM_FILTER_GAUSSIAN_BW;
+        /* the exact Gaussian pads with zeros, the fast one clamps */
+        c->margin = (size_t)mat2D_ceil(4 * filter.std);
+    }
+
+    c = &cases[n++];
+    c->name = name;
+    snprintf(c->params, sizeof(c->params), "%s", params);
+    c->run.kind = CASE_FILTER_PARALLEL;
+    c->run.filter = filter;
+    c->parallel = true;
+    c->has_reference = true;
+    c->exact = true;
+    c->reference_name = "serial";
+    c->reference.kind = CASE_FILTER;
+    c->reference.filter = filter;
+
+    return n;
+}
+
+static size_t cases_add(struct Bench_Case *cases, size_t n, const char *name, const char *params, struct Run run)
+{
+    APNG_ASSERT(n + 1 <= MAX_CASES);
+    struct Bench_Case *c = &cases[n++];
+    c->name = name;
+    snprintf(c->params, sizeof(c->params), "%s", params);
+    c->run = run;
+    return n;
+}
+
+static size_t cases_build(struct Bench_Case *cases)
+{
+    size_t n = 0;
+    char params[32];
+
+    for (size_t k = 0; k < COUNT(box_kernel_size); k++) {
+        snprintf(params, sizeof(params), "k=%zu", box_kernel_size[k]);
+        n = cases_add_filter(cases, n, (Aim_Filter){.kind = AIM_FILTER_BOX_BLUR_BW,   .kernel_size = box_kernel_size[k]}, params);
+        n = cases_add_filter(cases, n, (Aim_Filter){.kind = AIM_FILTER_BOX_BLUR_RGBA, .kernel_size = box_kernel_size[k]}, params);
+    }
+    for (size_t k = 0; k < COUNT(gaussian_std); k++) {
+        snprintf(params, sizeof(params), "std=%g", (double)gaussian_std[k]);
+        n = cases_add_filter(cases, n, (Aim_Filter){.kind = AIM_FILTER_GAUSSIAN_BW,        .std = gaussian_std[k]}, params);
+        n = cases_add_filter(cases, n, (Aim_Filter){.kind = AIM_FILTER_GAUSSIAN_BW_FAST,   .std = gaussian_std[k]}, params);
+        n = cases_add_filter(cases, n, (Aim_Filter){.kind = AIM_FILTER_GAUSSIAN_RGBA_FAST, .std = gaussian_std[k]}, params);
+        snprintf(params, sizeof(params), "std=%g a=1.5", (double)gaussian_std[k]);
+        n = cases_add_filter(cases, n, (Aim_Filter){.kind = AIM_FILTER_SHARPEN_BW,   .std = gaussian_std[k], .amount = 1.5}, params);
+        n = cases_add_filter(cases, n, (Aim_Filter){.kind = AIM_FILTER_SHARPEN_RGBA, .std = gaussian_std[k], .amount = 1.5}, params);
+    }
+    for (size_t k = 0; k < COUNT(median_kernel_size); k++) {
+        snprintf(params, sizeof(params), "k=%zu", median_kernel_size[k]);
+        n = cases_add_filter(cases, n, (Aim_Filter){.kind = AIM_FILTER_MEDIAN_BW,   .kernel_size = median_kernel_size[k]}, params);
+        n = cases_add_filter(cases, n, (Aim_Filter){.kind = AIM_FILTER_MEDIAN_RGBA, .kernel_size = median_kernel_size[k]}, params);
+    }
+    n = cases_add_filter(cases, n, (Aim_Filter){.kind = AIM_FILTER_SCHARR_3X3}, "");
+    n = cases_add_filter(cases, n, (Aim_Filter){.kind = AIM_FILTER_SOBEL_3X3}, "");
+    n = cases_add_filter(cases, n, (Aim_Filter){.kind = AIM_FILTER_SOBEL_3X3_CUTOFF, .cutoff = 100}, "cutoff=100");
+    n = cases_add_filter(cases, n, (Aim_Filter){.kind = AIM_FILTER_SOBEL_5X5}, "");
+    n = cases_add_filter(cases, n, (Aim_Filter){.kind = AIM_FILTER_SOBEL_5X5_CUTOFF, .cutoff = 100}, "cutoff=100");
+    for (size_t k = 0; k < COUNT(sobel_kernel_size); k++) {
+        snprintf(params, sizeof(params), "k=%zu", sobel_kernel_size[k]);
+        n = cases_add_filter(cases, n, (Aim_Filter){.kind = AIM_FILTER_SOBEL_GENERAL, .kernel_size = sobel_kernel_size[k]}, params);
+        snprintf(params, sizeof(params), "k=%zu cutoff=100", sobel_kernel_size[k]);
+        n = cases_add_filter(cases, n, (Aim_Filter){.kind = AIM_FILTER_SOBEL_GENERAL_CUTOFF, .kernel_size = sobel_kernel_size[k], .cutoff = 100}, params);
+    }
+
+    /* Gaussian, Sobel and threshold, fused and stage by stage */
+    for (size_t k = 0; k < COUNT(sobel_kernel_size); k++) {
+        snprintf(params, sizeof(params), "std=1 k=%zu t=%d", sobel_kernel_size[k], GRAPH_THRESHOLD);
+        Aim_Filter filter = {.std = 1, .kernel_size = sobel_kernel_size[k], .cutoff = GRAPH_THRESHOLD};
+        n = cases_add(cases, n, "graph_stages", params, (struct Run){.kind = CASE_GRAPH_STAGES, .filter = filter});
+        n = cases_add(cases, n, "graph", params, (struct Run){.kind = CASE_GRAPH, .filter = filter});
+        struct Bench_Case *c = &cases[n - 1];
+        c->parallel = true;
+        c->has_reference = true;
+        c->exact = true;
+        c->reference_name = "graph_stages";
+        c->reference.kind = CASE_GRAPH_STAGES;
+        c->reference.filter = filter;
+    }
+
+    n = cases_add(cases, n, "pyramid_down", "", (struct Run){.kind = CASE_PYRAMID_DOWN});
+    n = cases_add(cases, n, "pyramid_up", "", (struct Run){.kind = CASE_PYRAMID_UP});
+    n = cases_add(cases, n, "laplacian_round_trip", "levels=4", (struct Run){.kind = CASE_PYRAMID_ROUND_TRIP});
+    cases[n - 1].has_reference = true;
+    cases[n - 1].exact = true;
+    cases[n - 1].reference_name = "input";
+    cases[n - 1].reference.kind = CASE_COPY;
+    n = cases_add(cases, n, "resize_area",     "2/3", (struct Run){.kind = CASE_RESIZE, .resize = AIM_RESIZE_AREA});
+    n = cases_add(cases, n, "resize_bilinear", "2/3", (struct Run){.kind = CASE_RESIZE, .resize = AIM_RESIZE_BILINEAR});
+    n = cases_add(cases, n, "resize_lanczos3", "2/3", (struct Run){.kind = CASE_RESIZE, .resize = AIM_RESIZE_LANCZOS3});
+
+    return n;
+}
+
+static void run_output_size(struct Run run, size_t rows, size_t cols, size_t *out_rows, size_t *out_cols)
+{
+    switch (run.kind) {
+        case CASE_PYRAMID_DOWN:
+            *out_rows = (rows + 1) / 2;
+            *out_cols = (cols + 1) / 2;
+            break;
+        case CASE_PYRAMID_UP:
+            *out_rows = rows * 2;
+            *out_cols = cols * 2;
+            break;
+        case CASE_RESIZE:
+            *out_rows = rows * 2 / 3 > 0 ? rows * 2 / 3 : 1;
+            *out_cols = cols * 2 / 3 > 0 ? cols * 2 / 3 : 1;
+            break;
+        default:
+            *out_rows = rows;
+            *out_cols = cols;
+            break;
+    }
+}
+
+static void graph_build(Aim_Filter_Graph *graph, Aim_Filter filter)
+{
+    aim_filter_graph_add_gaussian(graph, filter.std, AIM_BORDER_CLAMP);
+    aim_filter_graph_add_sobel(graph, filter.kernel_size, AIM_BORDER_CLAMP);
+    aim_filter_graph_add_threshold(graph, filter.cutoff);
+}
+
+/* the graph one stage at a time over the whole luminance plane */
+static void graph_stages_run(Mat2D_uint32 des, Mat2D_uint32 src, const Aim_Filter_Graph *graph)
+{
+    Aim_Plane_u8 plane = aim_plane_u8_alloc(src.rows, src.cols);
+#ifdef AIM_LINEAR_LIGHT_LUMA
+    aim_plane_luma_linear_from_argb(plane, src);
+#else
+    aim_plane_luma_from_argb(plane, src);
+#endif
+    for (size_t s = 0; s < graph->num_of_stages; s++) {
+        Aim_Filter_Graph stage = {0};
+        stage.num_of_stages = 1;
+        stage.stages[0] = graph->stages[s];
+        aim_filter_graph_run_plane(plane, plane, &stage, 1);
+    }
+    aim_plane_gray_to_argb(des, plane, src);
+    aim_plane_u8_free(plane);
+}
+
+static void run_execute(struct Run run, Mat2D_uint32 des, Mat2D_uint32 src, size_t threads, const Aim_Filter_Graph *graph)
+{
+    switch (run.kind) {
+        case CASE_COPY:
+            mat2D_copy_uint32(des, src);
+            break;
+        case CASE_FILTER:
+            aim_filter_apply(des, src, run.filter);
+            break;
+        case CASE_FILTER_PARALLEL:
+            aim_filter_apply_parallel(des, src, run.filter, threads);
+            break;
+        case CASE_GRAPH:
+            aim_filter_graph_run(des, src, graph, threads);
+            break;
+        case CASE_GRAPH_STAGES:
+            graph_stages_run(des, src, graph);
+            break;
+        case CASE_PYRAMID_DOWN:
+            aim_pyramid_down(des, src);
+            break;
+        case CASE_PYRAMID_UP:
+            aim_pyramid_up(des, src);
+            break;
+        case CASE_PYRAMID_ROUND_TRIP: {
+            Aim_Pyramid pyramid = {0};
+            aim_pyramid_laplacian_build(&pyramid, src, 4);
+            aim_pyramid_laplacian_collapse(des, &pyramid);
+            aim_pyramid_free(&pyramid);
+        } break;
+        case CASE_RESIZE:
+            aim_resize(des, src, run.resize);
+            break;
+    }
+}
+
+/* largest difference of any channel, `margin` pixels away from the border */
+static int max_channel_diff(Mat2D_uint32 a, Mat2D_uint32 b, size_t margin)
+{
+    int max_diff = 0;
+    for (size_t i = margin; i + margin < a.rows; i++) {
+        for (size_t j = margin; j + margin < a.cols; j++) {
+            uint32_t pa = MAT2D_AT(a, i, j);
+            uint32_t pb = MAT2D_AT(b, i, j);
+            if (pa == pb) continue;
+            for (int shift = 0; shift < 32; shift += 8) {
+                int diff = abs((int)((pa >> shift) & 0xFF) - (int)((pb >> shift) & 0xFF));
+                if (diff > max_diff) max_diff = diff;
+            }
+        }
+    }
+    return max_diff;
+}
+
+/* Sharpening a flat opaque image must leave it flat. With zero padding the
+ * blurred color and alpha both drop towards the border, so any pixel of the
+ * outer 3 * std that comes out brighter than the input (beyond one level of
+ * rounding) means the color was divided by a saturated alpha. Returns the
+ * number of failed filter runs. */
+static size_t sharpen_border_check(size_t threads)
+{
+    const uint32_t colors[] = {0xFF808080u, 0xFFC0C0C0u, 0xFF3050A0u, 0xFFFFFFFFu};
+    size_t failures = 0;
+    for (size_t k = 0; k < COUNT(gaussian_std); k++) {
+        mat2D_real std = gaussian_std[k];
+        size_t band = (size_t)mat2D_ceil(3 * std);
+        size_t size = 4 * band + 16;
+        Mat2D_uint32 src = mat2D_alloc_uint32(size, size);
+        Mat2D_uint32 des = mat2D_alloc_uint32(size, size);
+        for (size_t c = 0; c < COUNT(colors); c++) {
+            mat2D_fill_uint32(src, colors[c]);
+            Aim_Filter filter = {.kind = AIM_FILTER_SHARPEN_RGBA, .std = std, .amount = 1.5};
+            for (int parallel = 0; parallel < 2; parallel++) {
+                if (parallel) aim_filter_apply_parallel(des, src, filter, threads);
+                else aim_filter_apply(des, src, filter);
+                int brighter = 0;
+                for (size_t i = 0; i < size; i++) {
+                    for (size_t j = 0; j < size; j++) {
+                        if (i >= band && j >= band && i + band < size && j + band < size) continue;
+                        uint32_t pixel = MAT2D_AT(des, i, j);
+                        for (int shift = 0; shift < 24; shift += 8) {
+                            int diff = (int)((pixel >> shift) & 0xFF) - (int)((colors[c] >> shift) & 0xFF);
+                            if (diff > brighter) brighter = diff;
+                        }
+                    }
+                }
+                if (brighter > 1) {
+                    printf("sharpen_rgba std=%g color=0x%08X %s: border up to %d levels brighter\n", (double)std, colors[c],
+                           parallel ? "parallel" : "serial", brighter);
+                    failures++;
+                }
+            }
+        }
+        mat2D_free_uint32(src);
+        mat2D_free_uint32(des);
+    }
+    return failures;
+}
+
+/* smooth gradients, hard edged blocks and noise, so that every filter has
+ * flat areas, edges and texture to work on */
+static Mat2D_uint32 synthetic_image(size_t rows, size_t cols)
+{
+    Mat2D_uint32 image = mat2D_alloc_uint32(rows, cols);
+    uint32_t state = 2463534242u;
+    for (size_t i = 0; i < rows; i++) {
+        for (size_t j = 0; j < cols; j++) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            uint32_t noise = state & 0x1F;
+            uint32_t block = (((i / 64) + (j / 64)) & 1) ? 96 : 0;
+            uint32_t r = (uint32_t)(j * 255 / (cols > 1 ? cols - 1 : 1)) / 2 + block / 2 + noise;
+            uint32_t g = (uint32_t)(i * 255 / (rows > 1 ? rows - 1 : 1)) / 2 + block + noise / 2;
+            uint32_t b = (uint32_t)((i + j) & 0xFF) / 4 + block + (state >> 27);
+            if (r > 255) r = 255;
+            if (g > 255) g = 255;
+            if (b > 255) b = 255;
+            MAT2D_AT(image, i, j) = 0xFF000000u | (r << 16) | (g << 8) | b;
+        }
+    }
+    return image;
+}
+
+static void json_string(FILE *fp, const char *s)
+{
+    fputc('"', fp);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', fp);
+        fputc(*s, fp);
+    }
+    fputc('"', fp);
+}
+
+static bool csv_write(const char *path, struct Result_List *results)
+{
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL) return false;
+    fprintf(fp, "filter,params,image,rows,cols,threads,seconds,mpix_per_s,cycles_per_pixel,reference,max_diff,check\n");
+    for (size_t i = 0; i < results->length; i++) {
+        struct Result *r = &results->elements[i];
+        fprintf(fp, "%s,%s,%s,%zu,%zu,%zu,%.9f,%.3f,%.3f,%s,%d,%s\n", r->name, r->params, r->image, r->rows, r->cols,
+                r->threads, r->seconds, r->mpix_per_s, r->cycles_per_pixel, r->reference, r->max_diff, r->check);
+    }
+    fclose(fp);
+    return true;
+}
+
+static bool json_write(const char *path, struct Result_List *results, size_t repetitions, size_t threads)
+{
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL) return false;
+    fprintf(fp, "{\n  \"simd\": \"%s\",\n  \"threads\": %zu,\n  \"repetitions\": %zu,\n  \"cycle_counter\": %s,\n  \"results\": [\n",
+            apng_simd_level_name_get(apng_simd_level_get()), threads, repetitions, HAS_CYCLE_COUNTER ? "true" : "false");
+    for (size_t i = 0; i < results->length; i++) {
+        struct Result *r = &results->elements[i];
+        fprintf(fp, "    {\"filter\": ");
+        json_string(fp, r->name);
+        fprintf(fp, ", \"params\": ");
+        json_string(fp, r->params);
+        fprintf(fp, ", \"image\": ");
+        json_string(fp, r->image);
+        fprintf(fp, ", \"rows\": %zu, \"cols\": %zu, \"threads\": %zu, \"seconds\": %.9f, \"mpix_per_s\": %.3f, \"cycles_per_pixel\": %.3f, ",
+                r->rows, r->cols, r->threads, r->seconds, r->mpix_per_s, r->cycles_per_pixel);
+        fprintf(fp, "\"reference\": ");
+        json_string(fp, r->reference);
+        fprintf(fp, ", \"max_diff\": %d, \"check\": ", r->max_diff);
+        json_string(fp, r->check);
+        fprintf(fp, "}%s\n", i + 1 < results->length ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    fclose(fp);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    size_t repetitions = DEFAULT_REPETITIONS;
+    size_t threads = 0;
+    const char *only = NULL;
+    const char *csv_path = NULL;
+    const char *json_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            repetitions = (size_t)strtoul(argv[++i], NULL, 10);
+            if (repetitions == 0) repetitions = 1;
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            threads = (size_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            only = argv[++i];
+        } else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csv_path = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [-n repetitions] [-t threads] [--filter name] [--csv path] [--json path]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (threads == 0) threads = apng_cpu_count_get();
+
+    static struct Bench_Case cases[MAX_CASES];
+    size_t num_of_cases = cases_build(cases);
+
+    /* synthetic images first, then the bundled ones */
+    size_t num_of_inputs = num_of_synthetic + num_of_images;
+    Mat2D_uint32 *inputs = APNG_MALLOC(sizeof(*inputs) * num_of_inputs);
+    char (*input_names)[64] = APNG_MALLOC(sizeof(*input_names) * num_of_inputs);
+    struct Apng_PNG_Image *images = APNG_MALLOC(sizeof(*images) * num_of_images);
+    APNG_ASSERT(inputs != NULL && input_names != NULL && images != NULL);
+    size_t loaded = 0;
+    for (size_t s = 0; s < num_of_synthetic; s++) {
+        inputs[loaded] = synthetic_image(synthetic_size[s][0], synthetic_size[s][1]);
+        snprintf(input_names[loaded], sizeof(input_names[0]), "synthetic_%zux%zu", synthetic_size[s][1], synthetic_size[s][0]);
+        loaded++;
+    }
+    for (size_t f = 0; f < num_of_images; f++) {
+        images[f] = (struct Apng_PNG_Image){0};
+        if (apng_png_load((char *)file_name[f], &images[f], false) != APNG_SUCCESS) {
+            apng_dprintERROR("Cannot load '%s', skipping it.", file_name[f]);
+            continue;
+        }
+        inputs[loaded] = (Mat2D_uint32){
+            .rows = images[f].pixels.rows,
+            .cols = images[f].pixels.cols,
+            .stride_r = images[f].pixels.stride_r,
+            .elements = images[f].pixels.elements,
+        };
+        const char *base = strrchr(file_name[f], '/');
+        snprintf(input_names[loaded], sizeof(input_names[0]), "%s", base != NULL ? base + 1 : file_name[f]);
+        loaded++;
+    }
+
+    printf("%zu cases, %zu images, best of %zu, %zu threads, %s kernels%s\n\n", num_of_cases, loaded, repetitions, threads,
+           apng_simd_level_name_get(apng_simd_level_get()), HAS_CYCLE_COUNTER ? "" : ", no cycle counter");
+    size_t sharpen_failures = sharpen_border_check(threads);
+    printf("sharpen border check: %s\n\n", sharpen_failures == 0 ? "pass" : "FAILED");
+    printf("%-22s %-18s %-26s %4s %9s %9s %8s  %s\n", "filter", "params", "image", "thr", "ms", "MPix/s", "cyc/px", "check");
+
+    struct Result_List results = {0};
+    ada_init_array(struct Result, results);
+    int rt = sharpen_failures == 0 ? 0 : 1;
+    size_t mismatches = 0;
+
+    for (size_t in = 0; in < loaded; in++) {
+        Mat2D_uint32 src = inputs[in];
+        for (size_t k = 0; k < num_of_cases; k++) {
+            struct Bench_Case *c = &cases[k];
+            if (only != NULL && strstr(c->name, only) == NULL) continue;
+            size_t run_threads = c->parallel ? threads : 1;
+
+            Aim_Filter_Graph graph = {0};
+            if (c->run.kind == CASE_GRAPH || c->run.kind == CASE_GRAPH_STAGES) {
+                graph_build(&graph, c->run.filter);
+            }
+
+            size_t out_rows, out_cols;
+            run_output_size(c->run, src.rows, src.cols, &out_rows, &out_cols);
+            Mat2D_uint32 des = mat2D_alloc_uint32(out_rows, out_cols);
+
+            /* the first run warms the caches and gives the output to check */
+            run_execute(c->run, des, src, run_threads, &graph);
+            int max_diff = -1;
+            const char *check = "-";
+            if (c->has_reference) {
+                Mat2D_uint32 ref = mat2D_alloc_uint32(out_rows, out_cols);
+                run_execute(c->reference, ref, src, 1, &graph);
+                max_diff = max_channel_diff(des, ref, c->margin);
+                if (c->exact) {
+                    check = max_diff == 0 ? "pass" : "MISMATCH";
+                    if (max_diff != 0) {
+                        mismatches++;
+                        rt = 1;
+                    }
+                } else {
+                    check = "diff";
+                }
+                mat2D_free_uint32(ref);
+            }
+
+            double best_seconds = 0;
+            uint64_t best_cycles = 0;
+            for (size_t rep = 0; rep < repetitions; rep++) {
+                uint64_t cycles = cycles_now();
+                double start = apng_timer_now_sec();
+                run_execute(c->run, des, src, run_threads, &graph);
+                double seconds = apng_timer_now_sec() - start;
+                cycles = cycles_now() - cycles;
+                if (rep == 0 || seconds < best_seconds) {
+                    best_seconds = seconds;
+                    best_cycles = cycles;
+                }
+            }
+
+            size_t pixels = src.rows * src.cols > out_rows * out_cols ? src.rows * src.cols : out_rows * out_cols;
+            struct Result r = {0};
+            r.name = c->name;
+            r.params = c->params;
+            r.image = input_names[in];
+            r.rows = src.rows;
+            r.cols = src.cols;
+            r.threads = run_threads;
+            r.seconds = best_seconds;
+            r.mpix_per_s = best_seconds > 0 ? pixels / 1e6 / best_seconds : 0;
+            r.cycles_per_pixel = HAS_CYCLE_COUNTER ? (double)best_cycles / pixels : -1;
+            r.reference = c->has_reference ? c->reference_name : "";
+            r.max_diff = max_diff;
+            r.check = check;
+            ada_appand(struct Result, results, r);
+
+            char check_text[48];
+            if (c->has_reference) {
+                snprintf(check_text, sizeof(check_text), "%s (vs %s, max %d)", check, c->reference_name, max_diff);
+            } else {
+                snprintf(check_text, sizeof(check_text), "-");
+            }
+            char cycles_text[16];
+            if (HAS_CYCLE_COUNTER) {
+                snprintf(cycles_text, sizeof(cycles_text), "%.2f", r.cycles_per_pixel);
+            } else {
+                snprintf(cycles_text, sizeof(cycles_text), "-");
+            }
+            printf("%-22s %-18s %-26s %4zu %9.3f %9.2f %8s  %s\n", r.name, r.params, r.image, r.threads, r.seconds * 1e3,
+                   r.mpix_per_s, cycles_text, check_text);
+
+            mat2D_free_uint32(des);
+            aim_filter_graph_free(&graph);
+        }
+    }
+
+    printf("\n%zu results, %zu mismatches\n", results.length, mismatches);
+    if (csv_path != NULL) {
+        if (csv_write(csv_path, &results)) {
+            printf("wrote %s\n", csv_path);
+        } else {
+            apng_dprintERROR("Cannot write '%s'.", csv_path);
+            rt = 1;
+        }
+    }
+    if (json_path != NULL) {
+        if (json_write(json_path, &results, repetitions, threads)) {
+            printf("wrote %s\n", json_path);
+        } else {
+            apng_dprintERROR("Cannot write '%s'.", json_path);
+            rt = 1;
+        }
+    }
+    printf("reference check: %s\n", rt == 0 ? "pass" : "FAILED");
+
+    for (size_t s = 0; s < num_of_synthetic; s++) mat2D_free_uint32(inputs[s]);
+    for (size_t f = 0; f < num_of_images; f++) apng_png_free(&images[f]);
+    APNG_FREE(inputs);
+    APNG_FREE(input_names);
+    APNG_FREE(images);
+    APNG_FREE(results.elements);
+
+    return rt;
+}
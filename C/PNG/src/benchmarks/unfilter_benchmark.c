@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <stdbool.h>
+
+#define ALMOG_PNG_IMPLEMENTATION
+#include "../include/Almog_PNG.h"
+
+/* Times apng_IDAT_unfiltering_with_simd_level() at every level the CPU
+ * supports and checks that all levels reconstruct the same bytes. */
+
+#define REPETITIONS 20
+
+const char *file_name[] = {
+    "../src/test_images/Bikesgray.png",
+    "../src/test_images/Valve_original.PNG",
+    "../src/test_images/file_example_PNG_3MB.png",
+    "../src/test_images/gaussian_blur_test.png",
+    "../src/test_images/test-png.png",
+    "../src/test_images/test-png2.png",
+    "../src/test_images/test-png5.png",
+    "../src/test_images/test-png7.png",
+    "../src/test_images/test-png_wiki.png",
+    "../src/test_images/PngSuite/Basic-formats/basn0g08.png",
+    "../src/test_images/PngSuite/Basic-formats/basn2c08.png",
+    "../src/test_images/PngSuite/Basic-formats/basn4a08.png",
+    "../src/test_images/PngSuite/Basic-formats/basn6a08.png",
+    "../src/test_images/PngSuite/Image-filtering/f00n2c08.png",
+    "../src/test_images/PngSuite/Image-filtering/f01n2c08.png",
+    "../src/test_images/PngSuite/Image-filtering/f02n2c08.png",
+    "../src/test_images/PngSuite/Image-filtering/f03n2c08.png",
+    "../src/test_images/PngSuite/Image-filtering/f04n2c08.png",
+};
+size_t num_of_images = sizeof(file_name) / sizeof(file_name[0]);
+
+int main(void)
+{
+    enum Apng_Simd_Level max_level = apng_simd_level_get();
+    printf("CPU supports up to %s\n\n", apng_simd_level_name_get(max_level));
+    printf("%-52s %10s", "image", "MB");
+    for (int level = APNG_SIMD_NONE; level <= (int)max_level; level++) {
+        printf(" %9s MB/s", apng_simd_level_name_get((enum Apng_Simd_Level)level));
+    }
+    printf("\n");
+
+    int rt = 0;
+    double total_seconds[APNG_SIMD_COUNT] = {0};
+    size_t total_bytes = 0;
+
+    for (size_t i = 0; i < num_of_images; i++) {
+        struct Apng_PNG_Image image = {0};
+        if (APNG_FAIL == apng_png_load((char *)file_name[i], &image, false)) {
+            rt = 1;
+            continue;
+        }
+
+        struct Apng_Byte_String filtered = {0};
+        ada_init_array(uint8_t, filtered);
+        if (APNG_FAIL == apng_IDAT_decompress(&image, &filtered)) {
+            apng_byte_string_free(&filtered);
+            apng_png_free(&image);
+            rt = 1;
+            continue;
+        }
+
+        struct Apng_IHDR_Chunk ihdr = image.chunks.IHDR_chunk;
+        size_t num_of_channels = (ihdr.color_type == 0) ? 1 :
+                                 (ihdr.color_type == 2) ? 3 :
+                                 (ihdr.color_type == 4) ? 2 : 4;
+        size_t unfiltered_size = filtered.length - ihdr.height;
+        uint8_t *reference = APNG_MALLOC(unfiltered_size);
+        uint8_t *unfiltered = APNG_MALLOC(unfiltered_size);
+        APNG_ASSERT(reference != NULL && unfiltered != NULL);
+
+        printf("%-52s %10.3f", file_name[i], unfiltered_size / 1e6);
+        for (int level = APNG_SIMD_NONE; level <= (int)max_level; level++) {
+            uint8_t *out = (level == APNG_SIMD_NONE) ? reference : unfiltered;
+
+            double start = apng_timer_now_sec();
+            for (size_t rep = 0; rep < REPETITIONS; rep++) {
+                apng_IDAT_unfiltering_with_simd_level(out, filtered.elements, ihdr.width, ihdr.height, num_of_channels, ihdr.bit_depth, (enum Apng_Simd_Level)level);
+            }
+            double seconds = apng_timer_now_sec() - start;
+            total_seconds[level] += seconds;
+
+            if (level != APNG_SIMD_NONE && memcmp(reference, unfiltered, unfiltered_size) != 0) {
+                apng_dprintERROR("%s output differs from scalar output for '%s'.", apng_simd_level_name_get((enum Apng_Simd_Level)level), file_name[i]);
+                rt = 1;
+            }
+            printf(" %14.1f", unfiltered_size * (double)REPETITIONS / seconds / 1e6);
+        }
+        printf("\n");
+        total_bytes += unfiltered_size;
+
+        APNG_FREE(reference);
+        APNG_FREE(unfiltered);
+        apng_byte_string_free(&filtered);
+        apng_png_free(&image);
+    }
+
+    printf("%-52s %10.3f", "total", total_bytes / 1e6);
+    for (int level = APNG_SIMD_NONE; level <= (int)max_level; level++) {
+        printf(" %14.1f", total_bytes * (double)REPETITIONS / total_seconds[level] / 1e6);
+    }
+    printf("\n");
+
+    return rt;
+}
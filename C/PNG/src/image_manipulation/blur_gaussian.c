@@ -83,6 +83,14 @@ enum Apl_Return_Types apl_setup(struct Apl_Window_State *ws)
     // aim_blur_gaussian_bw_fast(results, image_pixels, 6);
     aim_blur_gaussian_rgba_fast(results, image_pixels, 6);
 
+    /* roughly the same blur on a quarter of the pixels: std 3 on the half
+     * size level, then back to full size */
+    // Aim_Pyramid pyramid = {0};
+    // aim_pyramid_gaussian_build(&pyramid, image_pixels, 2);
+    // aim_blur_gaussian_rgba_fast(pyramid.levels[1], pyramid.levels[1], 3);
+    // aim_resize(results, pyramid.levels[1], AIM_RESIZE_BILINEAR);
+    // aim_pyramid_free(&pyramid);
+
     // mat2D_copy_uint32(results, image_pixels);
 
     return APL_SUCCESS;
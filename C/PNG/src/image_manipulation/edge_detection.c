@@ -107,6 +107,14 @@ enum Apl_Return_Types apl_setup(struct Apl_Window_State *ws)
     // // aim_edge_detection_sobel_5x5(results, temp);
     // aim_edge_detection_sobel_5x5_cutoff(results, temp, 200);
 
+    /* the same chain fused tile by tile, with a fixed edge-contrast threshold */
+    // Aim_Filter_Graph graph = {0};
+    // aim_filter_graph_add_gaussian(&graph, 1.0, AIM_BORDER_CLAMP);
+    // aim_filter_graph_add_sobel(&graph, 5, AIM_BORDER_CLAMP);
+    // aim_filter_graph_add_threshold(&graph, 40);
+    // aim_filter_graph_run(results, image_pixels, &graph, 0);
+    // aim_filter_graph_free(&graph);
+
     return APL_SUCCESS;
 }
 
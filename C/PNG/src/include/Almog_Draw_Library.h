@@ -12,6 +12,8 @@
  * - Plotting helper types (Figure) and utilities for curve plots and
  *   2D scalar-field visualization using perceptual color interpolation
  *   in the OKLab/OKLch color spaces
+ * - Batch color conversion: table-based sRGB <-> linear and Oklab/OkLch
+ *   conversion of whole color buffers
  * - Cartesian grid generation in common planes
  *
  * All draw calls may accept an Offset_zoom_param that enables simple
@@ -28,7 +30,9 @@
  * @note
  * - Colors are ARGB in 0xAARRGGBB packed 32-bit format.
  * - Z buffering uses an inverse-Z buffer (bigger is closer).
- * - The OKLab/OKLch conversions here assume linear sRGB channels.
+ * - The OKLab/OKLch conversions here assume linear sRGB channels, except
+ *   adl_sRGB_to_okLab_batch() and adl_okLab_to_sRGB_batch(), which decode
+ *   and encode the sRGB transfer function with lookup tables.
  */
 
 #ifndef ALMOG_DRAW_LIBRARY_H_
@@ -263,6 +267,14 @@ typedef struct {
 #define ADL_MAX_SENTENCE_LEN 256
 #define ADL_MAX_ZOOM 1e3
 
+/* colors converted per block by the *_batch color functions, on the stack */
+#define ADL_COLOR_BATCH 64
+/* entries of the linear to sRGB table, enough to invert every 8-bit code */
+#define ADL_LINEAR_TO_SRGB_TABLE_SIZE 4096
+/* OkLch chroma below which a color counts as gray and its hue as undefined:
+ * 8-bit grays come out below 3e-7, a one-level tint above 4e-4 */
+#define ADL_OKLCH_GRAY_CHROMA 1e-5f
+
 #define ADL_DEFAULT_OFFSET_ZOOM (Offset_zoom_param){.zoom_multiplier = 1}
 #define adl_offset_zoom_point(p, window_w, window_h, offset_zoom_param)                                             \
     (p).x = ((p).x - (window_w)/2 + offset_zoom_param.offset_x) * offset_zoom_param.zoom_multiplier + (window_w)/2; \
@@ -312,6 +324,16 @@ void    adl_linear_sRGB_to_okLch(uint32_t hex_ARGB, float *L, float *c, float *h
 void    adl_okLch_to_linear_sRGB(float L, float c, float h_deg, uint32_t *hex_ARGB);
 void    adl_interpolate_ARGBcolor_on_okLch(uint32_t color1, uint32_t color2, float t, float num_of_rotations, uint32_t *color_out);
 
+float   adl_sRGB_to_linear(uint8_t c);
+uint8_t adl_linear_to_sRGB(float v);
+void    adl_linear_sRGB_to_okLab_batch(const uint32_t *hex_ARGB, size_t n, float *L, float *a, float *b);
+void    adl_sRGB_to_okLab_batch(const uint32_t *hex_ARGB, size_t n, float *L, float *a, float *b);
+void    adl_okLab_to_linear_sRGB_batch(const float *L, const float *a, const float *b, size_t n, uint32_t *hex_ARGB);
+void    adl_okLab_to_sRGB_batch(const float *L, const float *a, const float *b, size_t n, uint32_t *hex_ARGB);
+void    adl_okLab_to_okLch_batch(const float *a, const float *b, size_t n, float *c, float *h_deg);
+void    adl_okLch_to_okLab_batch(const float *c, const float *h_deg, size_t n, float *a, float *b);
+void    adl_interpolate_ARGBcolor_on_okLch_batch(uint32_t color1, uint32_t color2, const float *t, size_t n, float num_of_rotations, uint32_t *colors_out);
+
 Figure  adl_figure_alloc(size_t rows, size_t cols, Point top_left_position);
 void    adl_figure_copy_to_screen(Mat2D_uint32 screen_mat, Figure figure);
 void    adl_axis_draw_on_figure(Figure *figure);
@@ -1957,9 +1979,9 @@ void adl_linear_sRGB_to_okLab(uint32_t hex_ARGB, float *L, float *a, float *b)
     int R_255, G_255, B_255;
     ADL_HexARGB_RGB_VAR(hex_ARGB, R_255, G_255, B_255);
 
-    float R = (float)R_255;
-    float G = (float)G_255;
-    float B = (float)B_255;
+    float R = (float)R_255 / 255.0f;
+    float G = (float)G_255 / 255.0f;
+    float B = (float)B_255 / 255.0f;
 
     float l = 0.4122214705f * R + 0.5363325363f * G + 0.0514459929f * B;
     float m = 0.2119034982f * R + 0.6806995451f * G + 0.1073969566f * B;
@@ -2002,9 +2024,9 @@ void adl_okLab_to_linear_sRGB(float L, float a, float b, uint32_t *hex_ARGB)
     float G = - 1.2684380046f * l + 2.6097574011f * m - 0.3413193965f * s;
     float B = - 0.0041960863f * l - 0.7034186147f * m + 1.7076147010f * s;
 
-    R = fmaxf(fminf(R, 255), 0);
-    G = fmaxf(fminf(G, 255), 0);
-    B = fmaxf(fminf(B, 255), 0);
+    R = fmaxf(fminf(R * 255.0f, 255), 0);
+    G = fmaxf(fminf(G * 255.0f, 255), 0);
+    B = fmaxf(fminf(B * 255.0f, 255), 0);
 
     *hex_ARGB = (uint32_t)ADL_RGBA_hexARGB(R, G, B, 0xFF);
 }
@@ -2049,7 +2071,9 @@ void adl_okLch_to_linear_sRGB(float L, float c, float h_deg, uint32_t *hex_ARGB)
  *
  * Lightness and chroma are interpolated linearly. Hue is interpolated in
  * degrees after adding 360*num_of_rotations to the second hue, allowing
- * control over the winding direction.
+ * control over the winding direction. A gray end color (chroma below
+ * ADL_OKLCH_GRAY_CHROMA) has no hue of its own and takes the hue of the other
+ * one, so the path only changes in lightness and chroma.
  *
  * @param color1 Start color (0xAARRGGBB).
  * @param color2 End color (0xAARRGGBB).
@@ -2059,18 +2083,354 @@ void adl_okLch_to_linear_sRGB(float L, float c, float h_deg, uint32_t *hex_ARGB)
  * @param color_out [out] Interpolated ARGB color (A=255).
  */
 void adl_interpolate_ARGBcolor_on_okLch(uint32_t color1, uint32_t color2, float t, float num_of_rotations, uint32_t *color_out)
+{
+    adl_interpolate_ARGBcolor_on_okLch_batch(color1, color2, &t, 1, num_of_rotations, color_out);
+}
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+#endif
+
+static float         adl_sRGB_to_linear_table[256];
+static uint8_t       adl_linear_to_sRGB_table[ADL_LINEAR_TO_SRGB_TABLE_SIZE];
+static volatile long adl_sRGB_tables_state = 0; /* 0 empty, 1 filling, 2 ready */
+
+static long adl_sRGB_tables_state_load(void)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    #if defined(_M_IX86) || defined(_M_X64)
+    /* x86 loads already have acquire ordering, only the compiler must not
+     * move the table reads above this one */
+    long state = adl_sRGB_tables_state;
+    _ReadWriteBarrier();
+    return state;
+    #else
+    return _InterlockedCompareExchange(&adl_sRGB_tables_state, 0, 0);
+    #endif
+#else
+    return __atomic_load_n(&adl_sRGB_tables_state, __ATOMIC_ACQUIRE);
+#endif
+}
+
+/* fills both sRGB tables once: the first caller claims them and publishes
+ * them with a release store, callers that arrive meanwhile wait */
+static void adl_sRGB_tables_init(void)
+{
+    if (adl_sRGB_tables_state_load() == 2) return;
+#if defined(_MSC_VER) && !defined(__clang__)
+    bool claimed = _InterlockedCompareExchange(&adl_sRGB_tables_state, 1, 0) == 0;
+#else
+    long expected = 0;
+    bool claimed = __atomic_compare_exchange_n(&adl_sRGB_tables_state, &expected, 1, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#endif
+    if (!claimed) {
+        while (adl_sRGB_tables_state_load() != 2) {}
+        return;
+    }
+
+    /* https://en.wikipedia.org/wiki/SRGB#Transfer_function_(%22gamma%22) */
+    for (int i = 0; i < 256; i++) {
+        double c = i / 255.0;
+        double v = c <= 0.04045 ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4);
+        adl_sRGB_to_linear_table[i] = (float)v;
+    }
+    for (int i = 0; i < ADL_LINEAR_TO_SRGB_TABLE_SIZE; i++) {
+        double v = i / (double)(ADL_LINEAR_TO_SRGB_TABLE_SIZE - 1);
+        double c = v <= 0.0031308 ? 12.92 * v : 1.055 * pow(v, 1 / 2.4) - 0.055;
+        adl_linear_to_sRGB_table[i] = (uint8_t)(c * 255 + 0.5);
+    }
+#if defined(_MSC_VER) && !defined(__clang__)
+    _InterlockedExchange(&adl_sRGB_tables_state, 2);
+#else
+    __atomic_store_n(&adl_sRGB_tables_state, 2, __ATOMIC_RELEASE);
+#endif
+}
+
+/**
+ * @brief Decode an 8-bit sRGB channel to linear light.
+ *
+ * Reads a 256-entry table that is filled on first use.
+ *
+ * @param c Gamma-encoded sRGB channel value.
+ * @return Linear intensity in [0,1].
+ */
+float adl_sRGB_to_linear(uint8_t c)
+{
+    adl_sRGB_tables_init();
+    return adl_sRGB_to_linear_table[c];
+}
+
+/**
+ * @brief Encode a linear intensity as an 8-bit sRGB channel.
+ *
+ * Reads a table of ADL_LINEAR_TO_SRGB_TABLE_SIZE entries, which is fine
+ * enough that adl_linear_to_sRGB(adl_sRGB_to_linear(c)) == c for every c.
+ *
+ * @param v Linear intensity; clamped to [0,1].
+ * @return Gamma-encoded sRGB channel value.
+ */
+uint8_t adl_linear_to_sRGB(float v)
+{
+    adl_sRGB_tables_init();
+    v = fmaxf(fminf(v, 1), 0);
+    return adl_linear_to_sRGB_table[(int)(v * (ADL_LINEAR_TO_SRGB_TABLE_SIZE - 1) + 0.5f)];
+}
+
+/* cube root of x >= 0 without a library call, so the loops using it can be
+ * vectorized: a bit-level first guess refined by two Newton steps, about
+ * 1e-6 relative error */
+static inline float adl_cbrtf_fast(float x)
+{
+    uint32_t i;
+    memcpy(&i, &x, sizeof(i));
+    i = i / 3 + 0x2a5137a0;
+    float y;
+    memcpy(&y, &i, sizeof(y));
+    y = (2.0f * y + x / (y * y)) * (1.0f / 3.0f);
+    y = (2.0f * y + x / (y * y)) * (1.0f / 3.0f);
+    return y;
+}
+
+/* Oklab of n linear RGB triples in [0,1] */
+static void adl_linear_RGB_to_okLab_block(const float *R, const float *G, const float *B, size_t n, float *L, float *a, float *b)
+{
+    for (size_t k = 0; k < n; k++) {
+        float l = 0.4122214705f * R[k] + 0.5363325363f * G[k] + 0.0514459929f * B[k];
+        float m = 0.2119034982f * R[k] + 0.6806995451f * G[k] + 0.1073969566f * B[k];
+        float s = 0.0883024619f * R[k] + 0.2817188376f * G[k] + 0.6299787005f * B[k];
+
+        float l_ = adl_cbrtf_fast(l);
+        float m_ = adl_cbrtf_fast(m);
+        float s_ = adl_cbrtf_fast(s);
+
+        L[k] = 0.2104542553f * l_ + 0.7936177850f * m_ - 0.0040720468f * s_;
+        a[k] = 1.9779984951f * l_ - 2.4285922050f * m_ + 0.4505937099f * s_;
+        b[k] = 0.0259040371f * l_ + 0.7827717662f * m_ - 0.8086757660f * s_;
+    }
+}
+
+/* linear RGB in [0,1] of n Oklab colors */
+static void adl_okLab_to_linear_RGB_block(const float *L, const float *a, const float *b, size_t n, float *R, float *G, float *B)
+{
+    for (size_t k = 0; k < n; k++) {
+        float l_ = L[k] + 0.3963377774f * a[k] + 0.2158037573f * b[k];
+        float m_ = L[k] - 0.1055613458f * a[k] - 0.0638541728f * b[k];
+        float s_ = L[k] - 0.0894841775f * a[k] - 1.2914855480f * b[k];
+
+        float l = l_ * l_ * l_;
+        float m = m_ * m_ * m_;
+        float s = s_ * s_ * s_;
+
+        float r = + 4.0767416621f * l - 3.3077115913f * m + 0.2309699292f * s;
+        float g = - 1.2684380046f * l + 2.6097574011f * m - 0.3413193965f * s;
+        float c = - 0.0041960863f * l - 0.7034186147f * m + 1.7076147010f * s;
+
+        R[k] = fmaxf(fminf(r, 1), 0);
+        G[k] = fmaxf(fminf(g, 1), 0);
+        B[k] = fmaxf(fminf(c, 1), 0);
+    }
+}
+
+/**
+ * @brief Convert a buffer of linear sRGB colors (ARGB) to Oklab components.
+ *
+ * Same as adl_linear_sRGB_to_okLab() on each color, computed in blocks of
+ * ADL_COLOR_BATCH colors by loops without library calls that the compiler
+ * can vectorize. The cube root is approximated to about 1e-6 relative error.
+ *
+ * @param hex_ARGB Input colors (0xAARRGGBB). Alpha is ignored.
+ * @param n Number of colors.
+ * @param L [out] Perceptual lightness, n values.
+ * @param a [out] First opponent axis, n values.
+ * @param b [out] Second opponent axis, n values.
+ */
+void adl_linear_sRGB_to_okLab_batch(const uint32_t *hex_ARGB, size_t n, float *L, float *a, float *b)
+{
+    float R[ADL_COLOR_BATCH], G[ADL_COLOR_BATCH], B[ADL_COLOR_BATCH];
+    for (size_t start = 0; start < n; start += ADL_COLOR_BATCH) {
+        size_t count = n - start < ADL_COLOR_BATCH ? n - start : ADL_COLOR_BATCH;
+        for (size_t k = 0; k < count; k++) {
+            uint32_t color = hex_ARGB[start + k];
+            R[k] = (float)((color >> 16) & 0xFF) * (1.0f / 255.0f);
+            G[k] = (float)((color >> 8) & 0xFF) * (1.0f / 255.0f);
+            B[k] = (float)(color & 0xFF) * (1.0f / 255.0f);
+        }
+        adl_linear_RGB_to_okLab_block(R, G, B, count, L + start, a + start, b + start);
+    }
+}
+
+/**
+ * @brief Convert a buffer of gamma-encoded sRGB colors (ARGB) to Oklab
+ *        components.
+ *
+ * Like adl_linear_sRGB_to_okLab_batch(), but every channel is first decoded
+ * to linear light with the adl_sRGB_to_linear() table, which is the correct
+ * input for ordinary 8-bit images.
+ *
+ * @param hex_ARGB Input colors (0xAARRGGBB). Alpha is ignored.
+ * @param n Number of colors.
+ * @param L [out] Perceptual lightness, n values.
+ * @param a [out] First opponent axis, n values.
+ * @param b [out] Second opponent axis, n values.
+ */
+void adl_sRGB_to_okLab_batch(const uint32_t *hex_ARGB, size_t n, float *L, float *a, float *b)
+{
+    adl_sRGB_tables_init();
+
+    float R[ADL_COLOR_BATCH], G[ADL_COLOR_BATCH], B[ADL_COLOR_BATCH];
+    for (size_t start = 0; start < n; start += ADL_COLOR_BATCH) {
+        size_t count = n - start < ADL_COLOR_BATCH ? n - start : ADL_COLOR_BATCH;
+        for (size_t k = 0; k < count; k++) {
+            uint32_t color = hex_ARGB[start + k];
+            R[k] = adl_sRGB_to_linear_table[(color >> 16) & 0xFF];
+            G[k] = adl_sRGB_to_linear_table[(color >> 8) & 0xFF];
+            B[k] = adl_sRGB_to_linear_table[color & 0xFF];
+        }
+        adl_linear_RGB_to_okLab_block(R, G, B, count, L + start, a + start, b + start);
+    }
+}
+
+/**
+ * @brief Convert buffers of Oklab components to linear sRGB ARGB colors.
+ *
+ * Same as adl_okLab_to_linear_sRGB() on each color, computed in blocks of
+ * ADL_COLOR_BATCH colors. Output RGB components are clamped to [0,255],
+ * alpha is set to 255.
+ *
+ * @param L Oklab lightness, n values.
+ * @param a Oklab a component, n values.
+ * @param b Oklab b component, n values.
+ * @param n Number of colors.
+ * @param hex_ARGB [out] Output colors (0xAARRGGBB, A=255).
+ */
+void adl_okLab_to_linear_sRGB_batch(const float *L, const float *a, const float *b, size_t n, uint32_t *hex_ARGB)
+{
+    float R[ADL_COLOR_BATCH], G[ADL_COLOR_BATCH], B[ADL_COLOR_BATCH];
+    for (size_t start = 0; start < n; start += ADL_COLOR_BATCH) {
+        size_t count = n - start < ADL_COLOR_BATCH ? n - start : ADL_COLOR_BATCH;
+        adl_okLab_to_linear_RGB_block(L + start, a + start, b + start, count, R, G, B);
+        for (size_t k = 0; k < count; k++) {
+            hex_ARGB[start + k] = 0xFF000000u | ((uint32_t)(R[k] * 255.0f) << 16) | ((uint32_t)(G[k] * 255.0f) << 8) | (uint32_t)(B[k] * 255.0f);
+        }
+    }
+}
+
+/**
+ * @brief Convert buffers of Oklab components to gamma-encoded sRGB ARGB
+ *        colors.
+ *
+ * Like adl_okLab_to_linear_sRGB_batch(), but every channel is encoded with
+ * the adl_linear_to_sRGB() table. Inverts adl_sRGB_to_okLab_batch().
+ *
+ * @param L Oklab lightness, n values.
+ * @param a Oklab a component, n values.
+ * @param b Oklab b component, n values.
+ * @param n Number of colors.
+ * @param hex_ARGB [out] Output colors (0xAARRGGBB, A=255).
+ */
+void adl_okLab_to_sRGB_batch(const float *L, const float *a, const float *b, size_t n, uint32_t *hex_ARGB)
+{
+    adl_sRGB_tables_init();
+
+    const float scale = (float)(ADL_LINEAR_TO_SRGB_TABLE_SIZE - 1);
+    float R[ADL_COLOR_BATCH], G[ADL_COLOR_BATCH], B[ADL_COLOR_BATCH];
+    for (size_t start = 0; start < n; start += ADL_COLOR_BATCH) {
+        size_t count = n - start < ADL_COLOR_BATCH ? n - start : ADL_COLOR_BATCH;
+        adl_okLab_to_linear_RGB_block(L + start, a + start, b + start, count, R, G, B);
+        for (size_t k = 0; k < count; k++) {
+            uint32_t r = adl_linear_to_sRGB_table[(int)(R[k] * scale + 0.5f)];
+            uint32_t g = adl_linear_to_sRGB_table[(int)(G[k] * scale + 0.5f)];
+            uint32_t c = adl_linear_to_sRGB_table[(int)(B[k] * scale + 0.5f)];
+            hex_ARGB[start + k] = 0xFF000000u | (r << 16) | (g << 8) | c;
+        }
+    }
+}
+
+/**
+ * @brief Convert buffers of Oklab (a, b) components to OkLch chroma and hue.
+ *
+ * Lightness is shared by both spaces and is not touched. The outputs may
+ * alias the inputs.
+ *
+ * @param a Oklab a component, n values.
+ * @param b Oklab b component, n values.
+ * @param n Number of colors.
+ * @param c [out] Chroma (non-negative), n values.
+ * @param h_deg [out] Hue angle in degrees [-180,180] from atan2, n values.
+ */
+void adl_okLab_to_okLch_batch(const float *a, const float *b, size_t n, float *c, float *h_deg)
+{
+    for (size_t k = 0; k < n; k++) {
+        float a_k = a[k];
+        float b_k = b[k];
+        c[k] = sqrtf(a_k * a_k + b_k * b_k);
+        h_deg[k] = atan2f(b_k, a_k) * 180.0f / (float)ADL_PI;
+    }
+}
+
+/**
+ * @brief Convert buffers of OkLch chroma and hue to Oklab (a, b)
+ *        components.
+ *
+ * Hue is wrapped to [0,360) as in adl_okLch_to_linear_sRGB(). The outputs may
+ * alias the inputs.
+ *
+ * @param c Chroma, n values.
+ * @param h_deg Hue angle in degrees, n values.
+ * @param n Number of colors.
+ * @param a [out] Oklab a component, n values.
+ * @param b [out] Oklab b component, n values.
+ */
+void adl_okLch_to_okLab_batch(const float *c, const float *h_deg, size_t n, float *a, float *b)
+{
+    for (size_t k = 0; k < n; k++) {
+        float c_k = c[k];
+        float h = fmodf((h_deg[k] + 360), 360) * (float)ADL_PI / 180.0f;
+        a[k] = c_k * cosf(h);
+        b[k] = c_k * sinf(h);
+    }
+}
+
+/**
+ * @brief Interpolate between two ARGB colors in OkLch space at many
+ *        parameters.
+ *
+ * Same as adl_interpolate_ARGBcolor_on_okLch() for every t[k], but the two
+ * end colors are converted once and the conversion back to ARGB runs through
+ * adl_okLab_to_linear_sRGB_batch().
+ *
+ * @param color1 Start color (0xAARRGGBB).
+ * @param color2 End color (0xAARRGGBB).
+ * @param t Interpolation factors in [0,1], n values.
+ * @param n Number of colors to produce.
+ * @param num_of_rotations Number of hue turns to add to color2 (can be
+ *        fractional/negative).
+ * @param colors_out [out] Interpolated ARGB colors (A=255), n values.
+ */
+void adl_interpolate_ARGBcolor_on_okLch_batch(uint32_t color1, uint32_t color2, const float *t, size_t n, float num_of_rotations, uint32_t *colors_out)
 {
     float L_1, c_1, h_1;
     float L_2, c_2, h_2;
     adl_linear_sRGB_to_okLch(color1, &L_1, &c_1, &h_1);
     adl_linear_sRGB_to_okLch(color2, &L_2, &c_2, &h_2);
+    /* the hue of a gray is atan2 of rounding noise */
+    if (c_1 < ADL_OKLCH_GRAY_CHROMA) h_1 = h_2;
+    if (c_2 < ADL_OKLCH_GRAY_CHROMA) h_2 = h_1;
     h_2 = h_2 + 360 * num_of_rotations;
 
-    float L, c, h;
-    L = L_1 * (1 - t) + L_2 * (t);
-    c = c_1 * (1 - t) + c_2 * (t);
-    h = h_1 * (1 - t) + h_2 * (t);
-    adl_okLch_to_linear_sRGB(L, c, h, color_out);
+    float L[ADL_COLOR_BATCH], c[ADL_COLOR_BATCH], h[ADL_COLOR_BATCH];
+    float a[ADL_COLOR_BATCH], b[ADL_COLOR_BATCH];
+    for (size_t start = 0; start < n; start += ADL_COLOR_BATCH) {
+        size_t count = n - start < ADL_COLOR_BATCH ? n - start : ADL_COLOR_BATCH;
+        for (size_t k = 0; k < count; k++) {
+            float t_k = t[start + k];
+            L[k] = L_1 * (1 - t_k) + L_2 * (t_k);
+            c[k] = c_1 * (1 - t_k) + c_2 * (t_k);
+            h[k] = h_1 * (1 - t_k) + h_2 * (t_k);
+        }
+        adl_okLch_to_okLab_batch(c, h, count, a, b);
+        adl_okLab_to_linear_sRGB_batch(L, a, b, count, colors_out + start);
+    }
 }
 
 /**
@@ -2352,6 +2712,18 @@ void adl_2Dscalar_interp_on_figure(Figure figure, double *x_2Dmat, double *y_2Dm
     float window_w = (float)figure.pixels_mat.cols;
     float window_h = (float)figure.pixels_mat.rows;
 
+    uint32_t color1 = 0, color2 = 0;
+    bool has_color_scale = true;
+    if      (!strcmp(color_scale, "b-c")) { color1 = ADL_COLOR_BLUE_hexARGB;  color2 = ADL_COLOR_CYAN_hexARGB;   }
+    else if (!strcmp(color_scale, "b-g")) { color1 = ADL_COLOR_BLUE_hexARGB;  color2 = ADL_COLOR_GREEN_hexARGB;  }
+    else if (!strcmp(color_scale, "b-r")) { color1 = ADL_COLOR_BLUE_hexARGB;  color2 = ADL_COLOR_RED_hexARGB;    }
+    else if (!strcmp(color_scale, "b-y")) { color1 = ADL_COLOR_BLUE_hexARGB;  color2 = ADL_COLOR_YELLOW_hexARGB; }
+    else if (!strcmp(color_scale, "g-y")) { color1 = ADL_COLOR_GREEN_hexARGB; color2 = ADL_COLOR_YELLOW_hexARGB; }
+    else if (!strcmp(color_scale, "g-p")) { color1 = ADL_COLOR_GREEN_hexARGB; color2 = ADL_COLOR_PURPLE_hexARGB; }
+    else if (!strcmp(color_scale, "g-r")) { color1 = ADL_COLOR_GREEN_hexARGB; color2 = ADL_COLOR_RED_hexARGB;    }
+    else if (!strcmp(color_scale, "r-y")) { color1 = ADL_COLOR_RED_hexARGB;   color2 = ADL_COLOR_YELLOW_hexARGB; }
+    else has_color_scale = false;
+
     for (int i = 0; i < ni-1; i++) {
         for (int j = 0; j < nj-1; j++) {
             Quad quad = {0};
@@ -2385,110 +2757,9 @@ void adl_2Dscalar_interp_on_figure(Figure figure, double *x_2Dmat, double *y_2Dm
             float t0 = adl_linear_map((float)scalar_2Dmat[adl_offset2d(  i, j+1, ni)], (float)min_scalar, (float)max_scalar, 0.0f, 1.0f);
 
             /* https://en.wikipedia.org/wiki/Oklab_color_space */
-            if (!strcmp(color_scale, "b-c")) {
-                uint32_t color = 0, color1 = ADL_COLOR_BLUE_hexARGB, color2 = ADL_COLOR_CYAN_hexARGB;
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t0, num_of_rotations, &color);
-                quad.colors[0] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t1, num_of_rotations, &color);
-                quad.colors[1] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t2, num_of_rotations, &color);
-                quad.colors[2] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t3, num_of_rotations, &color);
-                quad.colors[3] = color;
-            } else if (!strcmp(color_scale, "b-g")) {
-                uint32_t color = 0, color1 = ADL_COLOR_BLUE_hexARGB, color2 = ADL_COLOR_GREEN_hexARGB;
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t0, num_of_rotations, &color);
-                quad.colors[0] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t1, num_of_rotations, &color);
-                quad.colors[1] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t2, num_of_rotations, &color);
-                quad.colors[2] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t3, num_of_rotations, &color);
-                quad.colors[3] = color;
-            } else if (!strcmp(color_scale, "b-r")) {
-                uint32_t color = 0, color1 = ADL_COLOR_BLUE_hexARGB, color2 = ADL_COLOR_RED_hexARGB;
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t0, num_of_rotations, &color);
-                quad.colors[0] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t1, num_of_rotations, &color);
-                quad.colors[1] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t2, num_of_rotations, &color);
-                quad.colors[2] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t3, num_of_rotations, &color);
-                quad.colors[3] = color;
-            } else if (!strcmp(color_scale, "b-y")) {
-                uint32_t color = 0, color1 = ADL_COLOR_BLUE_hexARGB, color2 = ADL_COLOR_YELLOW_hexARGB;
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t0, num_of_rotations, &color);
-                quad.colors[0] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t1, num_of_rotations, &color);
-                quad.colors[1] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t2, num_of_rotations, &color);
-                quad.colors[2] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t3, num_of_rotations, &color);
-                quad.colors[3] = color;
-            } else if (!strcmp(color_scale, "g-y")) {
-                uint32_t color = 0, color1 = ADL_COLOR_GREEN_hexARGB, color2 = ADL_COLOR_YELLOW_hexARGB;
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t0, num_of_rotations, &color);
-                quad.colors[0] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t1, num_of_rotations, &color);
-                quad.colors[1] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t2, num_of_rotations, &color);
-                quad.colors[2] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t3, num_of_rotations, &color);
-                quad.colors[3] = color;
-            } else if (!strcmp(color_scale, "g-p")) {
-                uint32_t color = 0, color1 = ADL_COLOR_GREEN_hexARGB, color2 = ADL_COLOR_PURPLE_hexARGB;
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t0, num_of_rotations, &color);
-                quad.colors[0] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t1, num_of_rotations, &color);
-                quad.colors[1] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t2, num_of_rotations, &color);
-                quad.colors[2] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t3, num_of_rotations, &color);
-                quad.colors[3] = color;
-            } else if (!strcmp(color_scale, "g-r")) {
-                uint32_t color = 0, color1 = ADL_COLOR_GREEN_hexARGB, color2 = ADL_COLOR_RED_hexARGB;
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t0, num_of_rotations, &color);
-                quad.colors[0] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t1, num_of_rotations, &color);
-                quad.colors[1] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t2, num_of_rotations, &color);
-                quad.colors[2] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t3, num_of_rotations, &color);
-                quad.colors[3] = color;
-            } else if (!strcmp(color_scale, "r-y")) {
-                uint32_t color = 0, color1 = ADL_COLOR_RED_hexARGB, color2 = ADL_COLOR_YELLOW_hexARGB;
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t0, num_of_rotations, &color);
-                quad.colors[0] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t1, num_of_rotations, &color);
-                quad.colors[1] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t2, num_of_rotations, &color);
-                quad.colors[2] = color;
-
-                adl_interpolate_ARGBcolor_on_okLch(color1, color2, t3, num_of_rotations, &color);
-                quad.colors[3] = color;
+            if (has_color_scale) {
+                float t[4] = {t0, t1, t2, t3};
+                adl_interpolate_ARGBcolor_on_okLch_batch(color1, color2, t, 4, num_of_rotations, quad.colors);
             }
 
             adl_quad_fill_interpolate_color_mean_value(figure.pixels_mat, figure.inv_z_buffer_mat, quad, ADL_DEFAULT_OFFSET_ZOOM); 
@@ -327,6 +327,33 @@ enum Apng_Return_Types {
  */
 #define APNG_OK APNG_SUCCESS
 
+/**
+ * @def APNG_SIMD_X86
+ * @brief 1 when the x86 SIMD kernels are compiled in, otherwise 0.
+ *
+ * Define APNG_NO_SIMD before including this file to force the scalar kernels
+ * on every target.
+ */
+#if !defined(APNG_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+#define APNG_SIMD_X86 1
+#else
+#define APNG_SIMD_X86 0
+#endif
+
+/**
+ * @brief Instruction-set levels the row kernels can be dispatched to.
+ *
+ * Every level falls back to the best kernel of a lower level when it has no
+ * dedicated implementation for a filter type or pixel size.
+ */
+enum Apng_Simd_Level {
+    APNG_SIMD_NONE,
+    APNG_SIMD_SSE2,
+    APNG_SIMD_SSSE3,
+    APNG_SIMD_AVX2,
+    APNG_SIMD_COUNT,
+};
+
 struct Apng_Pixel_Buffer {
     size_t rows;
     size_t cols;
@@ -571,8 +598,71 @@ struct Apng_zTXt_Chunk {
     uint8_t *body;   
 };
 
+/**
+ * @brief How a checksum is handled while decoding.
+ */
+enum Apng_Checksum_Policy {
+    /** Verify while decoding and fail on a mismatch (default). */
+    APNG_CHECKSUM_VERIFY,
+    /** Skip while decoding; the caller verifies later (see
+     *  apng_png_crc32_verify()). Only meaningful for chunk CRCs, the Adler-32
+     *  input is gone once decoding returns and is treated as skipped. */
+    APNG_CHECKSUM_DEFER,
+    /** Never verify. Only use for trusted inputs. */
+    APNG_CHECKSUM_SKIP,
+};
+
+/**
+ * @brief Reusable buffers for the inflated and unfiltered IDAT stream.
+ *
+ * apng_IDAT_decode() allocates and frees both buffers for every image unless
+ * the decode options point at a scratch, in which case it only grows them.
+ * One scratch must not be used by two decodes at the same time. Zero
+ * initialize before first use and release with apng_decode_scratch_free().
+ */
+struct Apng_Decode_Scratch {
+    struct Apng_Byte_String inflated;
+    struct Apng_Byte_String unfiltered;
+};
+
+/**
+ * @brief Options for apng_png_decode_with_options() and
+ *        apng_png_load_with_options().
+ *
+ * A zero-initialized struct gives the same behavior as apng_png_decode() with
+ * print_info set to false.
+ */
+struct Apng_Decode_Options {
+    bool print_info;
+    enum Apng_Checksum_Policy crc32_policy;
+    enum Apng_Checksum_Policy adler32_policy;
+    /** Optional buffers reused across decodes (NULL allocates per image). */
+    struct Apng_Decode_Scratch *scratch;
+    /** When either is non-zero, decode straight into a thumbnail that fits
+     *  in thumbnail_max_rows x thumbnail_max_cols (0 = unbounded), see
+     *  apng_thumbnail_size_get(). */
+    size_t thumbnail_max_rows;
+    size_t thumbnail_max_cols;
+};
+
+/**
+ * @brief Wall-clock time spent in each stage of the last decode of an image.
+ *
+ * parse_seconds covers the chunk walk (CRC checks and IDAT concatenation).
+ * For thumbnail decodes unfiltering and conversion are interleaved row by row
+ * and are both counted in convert_seconds.
+ */
+struct Apng_Decode_Stats {
+    double parse_seconds;
+    double inflate_seconds;
+    double unfilter_seconds;
+    double convert_seconds;
+};
+
 struct Apng_PNG_Image {
     struct Apng_Byte_String file;
+    struct Apng_Decode_Options options;
+    struct Apng_Decode_Stats stats;
     // struct Apng_Bit_Reader br;
     struct Apng_Pixel_Buffer pixels;
     struct {
@@ -831,8 +921,24 @@ struct Apng_PNG_Image {
  */
 #define APNG_FIX_HUFFMAN_HDIST 32
 
+/**
+ * @brief Result of one file in apng_png_batch_load().
+ *
+ * read_seconds covers reading the file into memory, decode_seconds the rest
+ * of apng_png_load(). worker is the index of the thread that decoded it.
+ */
+struct Apng_Batch_Result {
+    const char *file_name;
+    struct Apng_PNG_Image image;
+    enum Apng_Return_Types rt;
+    double read_seconds;
+    double decode_seconds;
+    size_t worker;
+};
+
 APNG_DEF enum Apng_Return_Types             apng_adler32_check(uint32_t original_adler32, uint8_t *buffer, size_t buffer_length);
 APNG_DEF uint32_t                           apng_adler32_update(uint32_t adler, uint8_t *buffer, size_t buffer_length);
+APNG_DEF uint32_t                           apng_adler32_update_with_simd_level(uint32_t adler, uint8_t *buffer, size_t buffer_length, enum Apng_Simd_Level level);
 APNG_DEF struct Apng_Byte_String            apng_bin_file_read(char *file_name);
 APNG_DEF void                               apng_byte_string_free(struct Apng_Byte_String *bs);
 APNG_DEF void                               apng_bit_reader_flash(struct Apng_Bit_Reader *br);
@@ -844,9 +950,15 @@ APNG_DEF struct Apng_Chunk_Footer           apng_chunk_footer_get(struct Apng_By
 APNG_DEF struct Apng_Chunk_Header           apng_chunk_header_get(struct Apng_Byte_String *bs);
 APNG_DEF void *                             apng_consume_bytes(struct Apng_Byte_String *bs, size_t amount);
 APNG_DEF enum Apng_Return_Types             apng_crc32_check(struct Apng_Chunk_Header header, void *chunk_data, struct Apng_Chunk_Footer footer);
+APNG_DEF bool                               apng_crc32_clmul_supported(void);
+APNG_DEF void                               apng_crc32_tables_init(void);
+APNG_DEF size_t                             apng_cpu_count_get(void);
+APNG_DEF void                               apng_decode_scratch_free(struct Apng_Decode_Scratch *scratch);
 APNG_DEF uint32_t                           apng_crc32_update(uint32_t crc, uint8_t *buf, size_t buf_len);
+APNG_DEF uint32_t                           apng_crc32_update_with_clmul(uint32_t crc, uint8_t *buf, size_t buf_len, bool use_clmul);
 APNG_DEF uint32_t                           apng_endian_swap_uint32(uint32_t x);
 APNG_DEF uint16_t                           apng_endian_swap_uint16(uint16_t x);
+APNG_DEF void                               apng_file_prefetch(const char *file_name);
 APNG_DEF uint32_t                           apng_four_char_to_uint32_t(const char *str);
 APNG_DEF enum Apng_Return_Types             apng_huffman_decode_symbol(struct Apng_Huffman_Entrys_Table table, struct Apng_Bit_Reader *br, uint16_t *symbol);
 APNG_DEF struct Apng_Huffman_Entrys_Table   apng_huffman_entry_table_create(uint32_t *code_length_array, size_t code_length_array_len);
@@ -855,21 +967,36 @@ APNG_DEF void                               apng_huffman_entry_table_print(struc
 APNG_DEF enum Apng_Return_Types             apng_huffman_entry_table_get_symbol(struct Apng_Huffman_Entrys_Table table, uint16_t code, uint8_t code_length, uint16_t *symbol);
 APNG_DEF enum Apng_Return_Types             apng_lit_len_dist_code_length_decode(struct Apng_Huffman_Entrys_Table dict_huffman, struct Apng_Bit_Reader *br, uint32_t HLIT, uint32_t HDIST, uint32_t *lit_len_dist_code_length);
 APNG_DEF struct Apng_Pixel_Buffer           apng_pixel_buffer_malloc(size_t rows, size_t cols);
+APNG_DEF void                               apng_png_batch_free(struct Apng_Batch_Result *results, size_t num_of_files);
+APNG_DEF enum Apng_Return_Types             apng_png_batch_load(char **file_names, size_t num_of_files, struct Apng_Batch_Result *results, size_t num_of_threads, struct Apng_Decode_Options options);
+APNG_DEF enum Apng_Return_Types             apng_png_crc32_verify(struct Apng_PNG_Image *image);
 APNG_DEF enum Apng_Return_Types             apng_png_decode(struct Apng_Byte_String file, struct Apng_PNG_Image *image, bool print_info);
+APNG_DEF enum Apng_Return_Types             apng_png_decode_with_options(struct Apng_Byte_String file, struct Apng_PNG_Image *image, struct Apng_Decode_Options options);
 APNG_DEF void                               apng_png_free(struct Apng_PNG_Image *image);
 APNG_DEF bool                               apng_png_header_signature_correct(struct Apng_PNG_Header h);
 APNG_DEF enum Apng_Return_Types             apng_png_load(char *file_name, struct Apng_PNG_Image *image, bool print_info);
+APNG_DEF enum Apng_Return_Types             apng_png_load_with_options(char *file_name, struct Apng_PNG_Image *image, struct Apng_Decode_Options options);
 APNG_DEF struct Apng_PNG_Header             apng_png_header_get(struct Apng_Byte_String *bs);
+APNG_DEF enum Apng_Return_Types             apng_png_thumbnail_load(char *file_name, struct Apng_PNG_Image *image, size_t max_rows, size_t max_cols);
+APNG_DEF enum Apng_Simd_Level               apng_simd_level_detect(void);
+APNG_DEF enum Apng_Simd_Level               apng_simd_level_get(void);
+APNG_DEF const char *                       apng_simd_level_name_get(enum Apng_Simd_Level level);
+APNG_DEF void                               apng_thumbnail_size_get(size_t width, size_t height, size_t max_rows, size_t max_cols, size_t *rows, size_t *cols);
+APNG_DEF double                             apng_timer_now_sec(void);
 APNG_DEF void                               apng_uint16_print_binary(uint16_t value, uint8_t bit_count);
 APNG_DEF enum Apng_Chunk_Type               apng_type_get_from_type_raw(uint32_t raw_type);
 APNG_DEF const char *                       apng_type_name_get(enum Apng_Chunk_Type type);
+APNG_DEF enum Apng_Return_Types             apng_unfilter_row(uint8_t *current_row, const uint8_t *src, const uint8_t *row_above, size_t width_in_bytes, size_t bytes_in_pixel, uint8_t filter, enum Apng_Simd_Level level);
 
 /* chunk parsers */
 APNG_DEF enum Apng_Return_Types             apng_IHDR_chunk_parse(struct Apng_IHDR_Chunk *chunk);
 APNG_DEF enum Apng_Return_Types             apng_IDAT_chunk_parse(struct Apng_IDAT_Chunk *chunk);
 APNG_DEF enum Apng_Return_Types             apng_IDAT_decode(struct Apng_PNG_Image *image);
 APNG_DEF enum Apng_Return_Types             apng_IDAT_decompress(struct Apng_PNG_Image *image, struct Apng_Byte_String *temp_bs);
+APNG_DEF enum Apng_Return_Types             apng_IDAT_scanline_convert(uint32_t *pixels_row, const uint8_t *unfiltered_row, size_t width, uint8_t color_type, size_t bit_per_channel);
+APNG_DEF enum Apng_Return_Types             apng_IDAT_thumbnail_build(struct Apng_PNG_Image *image, uint8_t *decompressed_data);
 APNG_DEF enum Apng_Return_Types             apng_IDAT_unfiltering(uint8_t *unfiltered_data, uint8_t *decompressed_data, size_t width, size_t height, size_t num_of_channels, size_t bit_per_channel);
+APNG_DEF enum Apng_Return_Types             apng_IDAT_unfiltering_with_simd_level(uint8_t *unfiltered_data, uint8_t *decompressed_data, size_t width, size_t height, size_t num_of_channels, size_t bit_per_channel, enum Apng_Simd_Level level);
 APNG_DEF struct Apng_IDAT_Header            apng_IDAT_header_get_from_IDAT_chunk(struct Apng_IDAT_Chunk chunk);
 
 #endif /*ALMOG_PNG_H_*/
@@ -877,6 +1004,43 @@ APNG_DEF struct Apng_IDAT_Header            apng_IDAT_header_get_from_IDAT_chunk
 #ifdef ALMOG_PNG_IMPLEMENTATION
 #undef ALMOG_PNG_IMPLEMENTATION
 
+#if APNG_SIMD_X86
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif
+#endif
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+#else
+    #include <time.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #if !defined(APNG_NO_THREADS)
+        #include <pthread.h>
+    #endif
+#endif
+
+/**
+ * @def APNG_TARGET
+ * @brief Compile one function for an instruction set that is only selected
+ *        at runtime.
+ *
+ * GCC and Clang need the target attribute to accept the intrinsics, MSVC
+ * accepts them without any flag.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+    #define APNG_TARGET(isa) __attribute__((target(isa)))
+    #define APNG_FORCE_INLINE static inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+    #define APNG_TARGET(isa)
+    #define APNG_FORCE_INLINE static __forceinline
+#else
+    #define APNG_TARGET(isa)
+    #define APNG_FORCE_INLINE static inline
+#endif
+
 /**
  * @brief Validate the Adler-32 checksum at the end of the zlib stream.
  *
@@ -907,6 +1071,10 @@ APNG_DEF enum Apng_Return_Types apng_adler32_check(uint32_t original_adler32, ui
 
 /**
  * @brief Update or compute an Adler-32 checksum over a buffer.
+ *
+ * Uses the fastest kernel apng_simd_level_get() reports, see
+ * apng_adler32_update_with_simd_level().
+ *
  * @param adler Initial Adler-32 state. Use 1 for a fresh checksum.
  * @param buffer Input buffer.
  * @param buffer_length Length of buffer in bytes.
@@ -914,17 +1082,113 @@ APNG_DEF enum Apng_Return_Types apng_adler32_check(uint32_t original_adler32, ui
  */
 APNG_DEF uint32_t apng_adler32_update(uint32_t adler, uint8_t *buffer, size_t buffer_length)
 {
-    /* according to the ZLIB specification: https://www.ietf.org/rfc/rfc1950.txt */
-    uint32_t BASE = 65521; /* largest prime smaller than 65536 */
+    return apng_adler32_update_with_simd_level(adler, buffer, buffer_length, apng_simd_level_get());
+}
+
+/* according to the ZLIB specification: https://www.ietf.org/rfc/rfc1950.txt */
+#define APNG_ADLER32_BASE 65521u /* largest prime smaller than 65536 */
+/* largest n such that 255n(n+1)/2 + (n+1)(BASE-1) <= 2^32-1, so s1 and s2 can
+ * go n bytes without a modulo and without overflowing */
+#define APNG_ADLER32_NMAX 5552
+
+#if APNG_SIMD_X86
+/* Sums 32 byte blocks in four 32 bit lanes. Inside one block byte i adds
+ * (32 - i) * byte to s2, which _mm_maddubs_epi16 computes against the tap
+ * vectors. Every earlier block adds its s1 another 32 times, which is
+ * collected in v_ps and applied with one shift per NMAX run. */
+static APNG_TARGET("ssse3") uint32_t apng_adler32_update_ssse3(uint32_t adler, const uint8_t *buffer, size_t buffer_length, size_t *consumed)
+{
+    const size_t block_size = 32;
+    uint32_t s1 = adler & 0xffff;
+    uint32_t s2 = (adler >> 16) & 0xffff;
+    size_t blocks = buffer_length / block_size;
+    *consumed = blocks * block_size;
+
+    const __m128i tap1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+    const __m128i tap2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+
+    while (blocks) {
+        size_t n = APNG_ADLER32_NMAX / block_size;
+        if (n > blocks) n = blocks;
+        blocks -= n;
+
+        __m128i v_ps = _mm_cvtsi32_si128((int)(s1 * (uint32_t)n));
+        __m128i v_s2 = _mm_cvtsi32_si128((int)s2);
+        __m128i v_s1 = _mm_setzero_si128();
+
+        do {
+            __m128i bytes1 = _mm_loadu_si128((const __m128i *)(buffer));
+            __m128i bytes2 = _mm_loadu_si128((const __m128i *)(buffer + 16));
+            v_ps = _mm_add_epi32(v_ps, v_s1);
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes1, zero));
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_maddubs_epi16(bytes1, tap1), ones));
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes2, zero));
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_maddubs_epi16(bytes2, tap2), ones));
+            buffer += block_size;
+        } while (--n);
+
+        v_s2 = _mm_add_epi32(v_s2, _mm_slli_epi32(v_ps, 5));
+
+        v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(2, 3, 0, 1)));
+        v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(1, 0, 3, 2)));
+        s1 += (uint32_t)_mm_cvtsi128_si32(v_s1);
+        v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(2, 3, 0, 1)));
+        v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(1, 0, 3, 2)));
+        s2 = (uint32_t)_mm_cvtsi128_si32(v_s2);
+
+        s1 %= APNG_ADLER32_BASE;
+        s2 %= APNG_ADLER32_BASE;
+    }
+
+    return (s2 << 16) | s1;
+}
+#endif
+
+/**
+ * @brief Update an Adler-32 checksum with an explicitly chosen kernel.
+ *
+ * The scalar kernel defers the modulo to once every APNG_ADLER32_NMAX bytes
+ * instead of once per byte. From APNG_SIMD_SSSE3 up the bulk of the buffer is
+ * summed 32 bytes at a time and the scalar kernel finishes the tail. All
+ * levels return the same value.
+ *
+ * @param adler Initial Adler-32 state. Use 1 for a fresh checksum.
+ * @param buffer Input buffer.
+ * @param buffer_length Length of buffer in bytes.
+ * @param level Kernel to use. Must not exceed apng_simd_level_get().
+ * @return Updated Adler-32 checksum.
+ */
+APNG_DEF uint32_t apng_adler32_update_with_simd_level(uint32_t adler, uint8_t *buffer, size_t buffer_length, enum Apng_Simd_Level level)
+{
+#if APNG_SIMD_X86
+    if (level >= APNG_SIMD_SSSE3 && buffer_length >= 32) {
+        size_t consumed = 0;
+        adler = apng_adler32_update_ssse3(adler, buffer, buffer_length, &consumed);
+        buffer += consumed;
+        buffer_length -= consumed;
+    }
+#else
+    (void)level;
+#endif
+
     uint32_t s1 = adler & 0xffff;
     uint32_t s2 = (adler >> 16) & 0xffff;
 
-    for (size_t n = 0; n < buffer_length; n++) {
-        s1 = (s1 + buffer[n]) % BASE;
-        s2 = (s2 + s1) % BASE;
+    while (buffer_length > 0) {
+        size_t n = buffer_length < APNG_ADLER32_NMAX ? buffer_length : APNG_ADLER32_NMAX;
+        buffer_length -= n;
+        for (size_t i = 0; i < n; i++) {
+            s1 += buffer[i];
+            s2 += s1;
+        }
+        buffer += n;
+        s1 %= APNG_ADLER32_BASE;
+        s2 %= APNG_ADLER32_BASE;
     }
 
-    return (s2 << 16) + s1;
+    return (s2 << 16) | s1;
 }
 
 /**
@@ -1244,8 +1508,171 @@ APNG_DEF enum Apng_Return_Types apng_crc32_check(struct Apng_Chunk_Header header
     }
 }
 
+/**
+ * @brief Report whether the CPU can run the carry-less multiply CRC kernel.
+ *
+ * The result is cached after the first call. Always false when the SIMD
+ * kernels are compiled out.
+ *
+ * @return true if the CPU supports PCLMULQDQ.
+ */
+APNG_DEF bool apng_crc32_clmul_supported(void)
+{
+    static int cached = -1;
+    if (cached < 0) {
+        bool supported = false;
+#if APNG_SIMD_X86
+    #if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        supported = (info[2] & (1 << 1)) != 0;
+    #else
+        __builtin_cpu_init();
+        supported = __builtin_cpu_supports("pclmul");
+    #endif
+#endif
+        cached = supported ? 1 : 0;
+    }
+    return cached == 1;
+}
+
+static uint32_t apng_crc32_table[8][256];
+static bool apng_crc32_table_ready = false;
+
+/**
+ * @brief Build the slice-by-8 CRC-32 lookup tables.
+ *
+ * apng_crc32_update() calls this lazily. Code that computes CRCs from several
+ * threads should call it once up front so the tables are never written while
+ * being read.
+ */
+APNG_DEF void apng_crc32_tables_init(void)
+{
+    if (apng_crc32_table_ready) return;
+
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (size_t bit = 0; bit < 8; bit++) {
+            c = (c & 1) ? (c >> 1) ^ 0xEDB88320u : c >> 1;
+        }
+        apng_crc32_table[0][n] = c;
+    }
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = apng_crc32_table[0][n];
+        for (size_t k = 1; k < 8; k++) {
+            c = (c >> 8) ^ apng_crc32_table[0][c & 0xff];
+            apng_crc32_table[k][n] = c;
+        }
+    }
+    apng_crc32_table_ready = true;
+}
+
+/* Reads eight bytes per step and looks each one up in its own table, so the
+ * eight lookups are independent instead of a chain of byte-at-a-time steps. */
+static uint32_t apng_crc32_update_slice8(uint32_t crc, const uint8_t *buf, size_t buf_len)
+{
+    while (buf_len >= 8) {
+        uint32_t lo = crc ^ ((uint32_t)buf[0] | ((uint32_t)buf[1] << 8) | ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24));
+        uint32_t hi = (uint32_t)buf[4] | ((uint32_t)buf[5] << 8) | ((uint32_t)buf[6] << 16) | ((uint32_t)buf[7] << 24);
+        crc = apng_crc32_table[7][lo & 0xff]         ^ apng_crc32_table[6][(lo >> 8) & 0xff] ^
+              apng_crc32_table[5][(lo >> 16) & 0xff] ^ apng_crc32_table[4][lo >> 24]         ^
+              apng_crc32_table[3][hi & 0xff]         ^ apng_crc32_table[2][(hi >> 8) & 0xff] ^
+              apng_crc32_table[1][(hi >> 16) & 0xff] ^ apng_crc32_table[0][hi >> 24];
+        buf += 8;
+        buf_len -= 8;
+    }
+    while (buf_len--) {
+        crc = (crc >> 8) ^ apng_crc32_table[0][(crc ^ *buf++) & 0xff];
+    }
+
+    return crc;
+}
+
+#if APNG_SIMD_X86
+/* Folds four 128 bit lanes in parallel with carry-less multiplies, then
+ * reduces to 32 bits with a Barrett reduction. Constants are the bit-reflected
+ * ones from Intel's "Fast CRC Computation for Generic Polynomials Using
+ * PCLMULQDQ". buf_len must be a multiple of 16 and at least 64. */
+static APNG_TARGET("pclmul") uint32_t apng_crc32_update_clmul(uint32_t crc, const uint8_t *buf, size_t buf_len)
+{
+    const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+    const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+    const __m128i k5k0 = _mm_set_epi64x(0x0000000000, 0x0163cd6124);
+    const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+    x1 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+    x2 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+    x3 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+    x4 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+    buf += 64;
+    buf_len -= 64;
+
+    x0 = k1k2;
+    while (buf_len >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i *)(buf + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i *)(buf + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i *)(buf + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i *)(buf + 0x30)));
+        buf += 64;
+        buf_len -= 64;
+    }
+
+    /* fold the four lanes into one */
+    x0 = k3k4;
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    while (buf_len >= 16) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128((const __m128i *)buf)), x5);
+        buf += 16;
+        buf_len -= 16;
+    }
+
+    /* 128 -> 64 bits */
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, mask32);
+    x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    /* Barrett reduction to 32 bits */
+    x2 = _mm_and_si128(x1, mask32);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+    x2 = _mm_and_si128(x2, mask32);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(x1, 4));
+}
+#endif
+
 /**
  * @brief Update a CRC-32 value over a byte buffer.
+ *
+ * Uses the carry-less multiply kernel when apng_crc32_clmul_supported() and
+ * slice-by-8 tables otherwise.
+ *
  * @param crc Initial CRC state.
  * @param buf Input bytes.
  * @param buf_len Number of bytes in buf.
@@ -1253,18 +1680,67 @@ APNG_DEF enum Apng_Return_Types apng_crc32_check(struct Apng_Chunk_Header header
  */
 APNG_DEF uint32_t apng_crc32_update(uint32_t crc, uint8_t *buf, size_t buf_len)
 {
-    for (size_t i = 0; i < buf_len; i++) {
-        crc ^= buf[i];
-        for (size_t bit = 0; bit < 8; bit++) {
-            if (crc & 1) {
-                crc = (crc >> 1) ^ 0xEDB88320u;
-            } else {
-                crc >>= 1;
-            }
-        }
+    return apng_crc32_update_with_clmul(crc, buf, buf_len, apng_crc32_clmul_supported());
+}
+
+/**
+ * @brief Update a CRC-32 value with an explicitly chosen kernel.
+ *
+ * Buffers shorter than 64 bytes (chunk types, IHDR, most ancillary chunks)
+ * always go through the tables; for longer ones the carry-less multiply kernel
+ * handles the largest multiple of 16 bytes and the tables finish the tail.
+ *
+ * @param crc Initial CRC state.
+ * @param buf Input bytes.
+ * @param buf_len Number of bytes in buf.
+ * @param use_clmul Use the carry-less multiply kernel. Must only be true when
+ *                  apng_crc32_clmul_supported() is.
+ * @return Updated CRC-32 value.
+ */
+APNG_DEF uint32_t apng_crc32_update_with_clmul(uint32_t crc, uint8_t *buf, size_t buf_len, bool use_clmul)
+{
+    apng_crc32_tables_init();
+#if APNG_SIMD_X86
+    if (use_clmul && buf_len >= 64) {
+        size_t bulk = buf_len & ~(size_t)15;
+        crc = apng_crc32_update_clmul(crc, buf, bulk);
+        buf += bulk;
+        buf_len -= bulk;
     }
+#else
+    (void)use_clmul;
+#endif
 
-    return crc;
+    return apng_crc32_update_slice8(crc, buf, buf_len);
+}
+
+/**
+ * @brief Return the number of logical processors available to the process.
+ * @return Processor count, at least 1.
+ */
+APNG_DEF size_t apng_cpu_count_get(void)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+#else
+    return 1;
+#endif
+}
+
+/**
+ * @brief Free the buffers of a decode scratch and zero it.
+ * @param scratch Scratch to release.
+ */
+APNG_DEF void apng_decode_scratch_free(struct Apng_Decode_Scratch *scratch)
+{
+    apng_byte_string_free(&scratch->inflated);
+    apng_byte_string_free(&scratch->unfiltered);
+    memset(scratch, 0, sizeof(*scratch));
 }
 
 /**
@@ -1290,6 +1766,53 @@ APNG_DEF uint16_t apng_endian_swap_uint16(uint16_t x)
     return ((x << 8) | (x >> 8));
 }
 
+/**
+ * @brief Hint the operating system to start reading a file into the page
+ *        cache.
+ *
+ * Returns immediately; the read continues in the background so a later
+ * apng_bin_file_read() of the same file does not wait on the disk. Used by
+ * apng_png_batch_load() to read upcoming files while the current ones decode.
+ * Does nothing where no readahead interface is available.
+ *
+ * @param file_name Path of the file to prefetch.
+ */
+APNG_DEF void apng_file_prefetch(const char *file_name)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    HANDLE file = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    #if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+    LARGE_INTEGER size;
+    HANDLE mapping = NULL;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    }
+    if (mapping != NULL) {
+        void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view != NULL) {
+            WIN32_MEMORY_RANGE_ENTRY range = {view, (SIZE_T)size.QuadPart};
+            PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+            UnmapViewOfFile(view);
+        }
+        CloseHandle(mapping);
+    }
+    #endif
+    CloseHandle(file);
+#elif defined(POSIX_FADV_WILLNEED)
+    int fd = open(file_name, O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    (void)posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    close(fd);
+#else
+    APNG_UNUSED(file_name);
+#endif
+}
+
 /**
  * @brief Pack four characters into a uint32_t in library-defined order.
  * @param str Pointer to at least four characters.
@@ -1552,6 +2075,244 @@ APNG_DEF struct Apng_Pixel_Buffer apng_pixel_buffer_malloc(size_t rows, size_t c
     return m;
 }
 
+/* Shared state of one apng_png_batch_load() call. Workers claim files in
+ * order through next_file. */
+struct Apng_Batch_Context {
+    char **file_names;
+    size_t num_of_files;
+    struct Apng_Batch_Result *results;
+    struct Apng_Decode_Options options;
+    size_t num_of_threads;
+    volatile long next_file;
+};
+
+struct Apng_Batch_Worker {
+    struct Apng_Batch_Context *context;
+    size_t index;
+};
+
+static size_t apng_batch_next_file(struct Apng_Batch_Context *context)
+{
+#if defined(APNG_NO_THREADS)
+    return (size_t)context->next_file++;
+#elif defined(_WIN32) || defined(_WIN64)
+    return (size_t)(InterlockedIncrement(&context->next_file) - 1);
+#else
+    return (size_t)__atomic_fetch_add(&context->next_file, 1, __ATOMIC_RELAXED);
+#endif
+}
+
+static void apng_batch_worker_run(struct Apng_Batch_Worker *worker)
+{
+    struct Apng_Batch_Context *context = worker->context;
+    struct Apng_Decode_Scratch scratch = {0};
+    struct Apng_Decode_Options options = context->options;
+    options.scratch = &scratch;
+
+    for (;;) {
+        size_t i = apng_batch_next_file(context);
+        if (i >= context->num_of_files) {
+            break;
+        }
+        /* the file this worker will most likely get next round */
+        size_t ahead = i + context->num_of_threads;
+        if (ahead < context->num_of_files) {
+            apng_file_prefetch(context->file_names[ahead]);
+        }
+
+        struct Apng_Batch_Result *result = &context->results[i];
+        result->file_name = context->file_names[i];
+        result->worker = worker->index;
+
+        double start = apng_timer_now_sec();
+        struct Apng_Byte_String file = apng_bin_file_read(context->file_names[i]);
+        double read_end = apng_timer_now_sec();
+        result->read_seconds = read_end - start;
+        if (file.name == NULL) {
+            apng_dprintERROR("Failed to open file at '%s'.", context->file_names[i]);
+            result->rt = APNG_FAIL;
+            continue;
+        }
+
+        result->rt = apng_png_decode_with_options(file, &result->image, options);
+        result->decode_seconds = apng_timer_now_sec() - read_end;
+        result->image.options.scratch = NULL;
+        if (result->rt == APNG_FAIL) {
+            apng_dprintERROR("Failed to load png image '%s'.", context->file_names[i]);
+        }
+    }
+
+    apng_decode_scratch_free(&scratch);
+}
+
+#if !defined(APNG_NO_THREADS)
+#if defined(_WIN32) || defined(_WIN64)
+static DWORD WINAPI apng_batch_worker_entry(LPVOID arg)
+{
+    apng_batch_worker_run((struct Apng_Batch_Worker *)arg);
+    return 0;
+}
+#else
+static void *apng_batch_worker_entry(void *arg)
+{
+    apng_batch_worker_run((struct Apng_Batch_Worker *)arg);
+    return NULL;
+}
+#endif
+#endif
+
+/**
+ * @brief Free every image of a batch and zero the results.
+ * @param results Results filled by apng_png_batch_load().
+ * @param num_of_files Number of entries in results.
+ */
+APNG_DEF void apng_png_batch_free(struct Apng_Batch_Result *results, size_t num_of_files)
+{
+    for (size_t i = 0; i < num_of_files; i++) {
+        apng_png_free(&results[i].image);
+    }
+    memset(results, 0, sizeof(*results) * num_of_files);
+}
+
+/**
+ * @brief Load and decode many PNG files on a pool of worker threads.
+ *
+ * Workers take the next unclaimed file, so a slow image does not hold up the
+ * others. Each worker keeps one Apng_Decode_Scratch for all the files it
+ * decodes, and before reading a file it calls apng_file_prefetch() on the one
+ * it will most likely take next, so disk reads overlap with decoding. The
+ * calling thread works as one of the workers.
+ *
+ * Define APNG_NO_THREADS to build without thread support; the batch then runs
+ * on the calling thread only.
+ *
+ * @param file_names Paths of the files to load.
+ * @param num_of_files Number of paths.
+ * @param results Output array with num_of_files entries. results[i] receives
+ *                the image, status and timings of file_names[i].
+ * @param num_of_threads Number of workers, 0 uses apng_cpu_count_get().
+ * @param options Decode options applied to every file. options.scratch is
+ *                ignored, every worker uses its own.
+ * @return APNG_SUCCESS if every file decoded, otherwise APNG_FAIL. Check
+ *         results[i].rt for the individual files.
+ * @note The caller must later call apng_png_batch_free() on results, also
+ *       when this returns APNG_FAIL.
+ */
+APNG_DEF enum Apng_Return_Types apng_png_batch_load(char **file_names, size_t num_of_files, struct Apng_Batch_Result *results, size_t num_of_threads, struct Apng_Decode_Options options)
+{
+    memset(results, 0, sizeof(*results) * num_of_files);
+    if (num_of_files == 0) {
+        return APNG_SUCCESS;
+    }
+    if (num_of_threads == 0) {
+        num_of_threads = apng_cpu_count_get();
+    }
+    if (num_of_threads > num_of_files) {
+        num_of_threads = num_of_files;
+    }
+#if defined(APNG_NO_THREADS)
+    num_of_threads = 1;
+#endif
+
+    /* lazily initialized shared state, set up before any worker reads it */
+    apng_crc32_tables_init();
+    (void)apng_crc32_clmul_supported();
+    (void)apng_simd_level_get();
+
+    struct Apng_Batch_Context context = {0};
+    context.file_names      = file_names;
+    context.num_of_files    = num_of_files;
+    context.results         = results;
+    context.options         = options;
+    context.options.scratch = NULL;
+    context.num_of_threads  = num_of_threads;
+    context.next_file       = 0;
+
+    struct Apng_Batch_Worker *workers = (struct Apng_Batch_Worker *)APNG_MALLOC(sizeof(*workers) * num_of_threads);
+    APNG_ASSERT(workers != NULL);
+    for (size_t t = 0; t < num_of_threads; t++) {
+        workers[t].context = &context;
+        workers[t].index   = t;
+    }
+
+    /* A thread that fails to start only means fewer workers; the calling
+     * thread is worker 0 and drains whatever is left. */
+#if defined(APNG_NO_THREADS)
+    apng_batch_worker_run(&workers[0]);
+#elif defined(_WIN32) || defined(_WIN64)
+    HANDLE *threads = (HANDLE *)APNG_MALLOC(sizeof(*threads) * num_of_threads);
+    APNG_ASSERT(threads != NULL);
+    for (size_t t = 1; t < num_of_threads; t++) {
+        threads[t] = CreateThread(NULL, 0, apng_batch_worker_entry, &workers[t], 0, NULL);
+    }
+    apng_batch_worker_run(&workers[0]);
+    for (size_t t = 1; t < num_of_threads; t++) {
+        if (threads[t] != NULL) {
+            WaitForSingleObject(threads[t], INFINITE);
+            CloseHandle(threads[t]);
+        }
+    }
+    APNG_FREE(threads);
+#else
+    pthread_t *threads = (pthread_t *)APNG_MALLOC(sizeof(*threads) * num_of_threads);
+    bool *started = (bool *)APNG_MALLOC(sizeof(*started) * num_of_threads);
+    APNG_ASSERT(threads != NULL && started != NULL);
+    for (size_t t = 1; t < num_of_threads; t++) {
+        started[t] = pthread_create(&threads[t], NULL, apng_batch_worker_entry, &workers[t]) == 0;
+    }
+    apng_batch_worker_run(&workers[0]);
+    for (size_t t = 1; t < num_of_threads; t++) {
+        if (started[t]) {
+            pthread_join(threads[t], NULL);
+        }
+    }
+    APNG_FREE(threads);
+    APNG_FREE(started);
+#endif
+    APNG_FREE(workers);
+
+    for (size_t i = 0; i < num_of_files; i++) {
+        if (results[i].rt != APNG_SUCCESS) {
+            return APNG_FAIL;
+        }
+    }
+    return APNG_SUCCESS;
+}
+
+/**
+ * @brief Verify the CRC of every chunk of an already decoded image.
+ *
+ * Meant for images decoded with crc32_policy set to APNG_CHECKSUM_DEFER, so
+ * the CRC pass can run later or on another thread. It walks image->file from
+ * the start with its own cursor and does not modify the image.
+ *
+ * @param image Image whose file bytes are still owned (not yet freed).
+ * @return APNG_SUCCESS if every chunk CRC matches, otherwise APNG_FAIL.
+ */
+APNG_DEF enum Apng_Return_Types apng_png_crc32_verify(struct Apng_PNG_Image *image)
+{
+    struct Apng_Byte_String file = image->file;
+    file.cursor = 0;
+
+    struct Apng_PNG_Header png_header = apng_png_header_get(&file);
+    if (!apng_png_header_signature_correct(png_header)) {
+        return APNG_FAIL;
+    }
+
+    for ( ; file.cursor < file.length ; ) {
+        struct Apng_Chunk_Header chunk_header = apng_chunk_header_get(&file);
+        void *chunk_data = apng_consume_bytes(&file, chunk_header.length);
+        struct Apng_Chunk_Footer chunk_footer = apng_chunk_footer_get(&file);
+
+        if (APNG_FAIL == apng_crc32_check(chunk_header, chunk_data, chunk_footer)) {
+            apng_dprintERROR("Failed CRC verification of file '%s'.", file.name);
+            return APNG_FAIL;
+        }
+    }
+
+    return APNG_SUCCESS;
+}
+
 /**
  * @brief Decode a PNG image from an in-memory byte buffer.
  *
@@ -1593,15 +2354,46 @@ APNG_DEF struct Apng_Pixel_Buffer apng_pixel_buffer_malloc(size_t rows, size_t c
  * @post On success, image contains parsed chunk data and decoded pixels.
  */
 APNG_DEF enum Apng_Return_Types apng_png_decode(struct Apng_Byte_String file, struct Apng_PNG_Image *image, bool print_info)
+{
+    struct Apng_Decode_Options options = {0};
+    options.print_info = print_info;
+
+    return apng_png_decode_with_options(file, image, options);
+}
+
+/**
+ * @brief Decode a PNG image from memory with explicit decode options.
+ *
+ * Same pipeline as apng_png_decode(). options.crc32_policy controls the
+ * per-chunk CRC checks and options.adler32_policy the Adler-32 check of the
+ * inflated IDAT stream. With APNG_CHECKSUM_DEFER the chunk CRCs can be checked
+ * later with apng_png_crc32_verify(); the inflated stream is gone by then, so
+ * deferring Adler-32 behaves like skipping it.
+ *
+ * @param file Byte string containing the full PNG file contents.
+ * @param image Output image structure. The options are stored in
+ *              image->options.
+ * @param options Decode options. A zero-initialized struct verifies
+ *                everything.
+ * @return APNG_SUCCESS on success, otherwise APNG_FAIL.
+ */
+APNG_DEF enum Apng_Return_Types apng_png_decode_with_options(struct Apng_Byte_String file, struct Apng_PNG_Image *image, struct Apng_Decode_Options options)
 {
     image->file = file;
+    image->options = options;
+    bool print_info = options.print_info;
     APNG_UNUSED(file);
     enum Apng_Return_Types rt = APNG_OK;
+    double parse_start = apng_timer_now_sec();
 
     if (print_info) apng_dprintINFO("Decoding file: '%s'. File size: %zu bytes", image->file.name, image->file.length);
 
     struct Apng_PNG_Header png_header = apng_png_header_get(&image->file);
-    APNG_ASSERT(apng_png_header_signature_correct(png_header));
+    if (!apng_png_header_signature_correct(png_header)) {
+        apng_dprintERROR("Failed to decode PNG in file '%s'.", file.name);
+        rt = APNG_FAIL;
+        goto apng_decode_exit;
+    }
 
     for ( ; image->file.cursor < image->file.length ; ) {
         struct Apng_Chunk_Header chunk_header = apng_chunk_header_get(&image->file);
@@ -1609,7 +2401,8 @@ APNG_DEF enum Apng_Return_Types apng_png_decode(struct Apng_Byte_String file, st
         void *chunk_data = apng_consume_bytes(&image->file, chunk_header.length);
         struct Apng_Chunk_Footer chunk_footer = apng_chunk_footer_get(&image->file);
 
-        if (APNG_FAIL == apng_crc32_check(chunk_header, chunk_data, chunk_footer)) {
+        if (options.crc32_policy == APNG_CHECKSUM_VERIFY &&
+            APNG_FAIL == apng_crc32_check(chunk_header, chunk_data, chunk_footer)) {
             apng_dprintERROR("Failed to decode PNG in file '%s'.", file.name);
             rt = APNG_FAIL;
             goto apng_decode_exit;
@@ -1705,6 +2498,12 @@ APNG_DEF enum Apng_Return_Types apng_png_decode(struct Apng_Byte_String file, st
         rt = APNG_FAIL;
         goto apng_decode_exit;
     }
+    if (image->chunks.IDAT_chunk.IDAT_data.elements == NULL) {
+        apng_dprintERROR("%s", "No IDAT chunk.");
+        rt = APNG_FAIL;
+        goto apng_decode_exit;
+    }
+    image->stats.parse_seconds = apng_timer_now_sec() - parse_start;
 
     /* decompressing the image */
     {
@@ -1794,12 +2593,32 @@ APNG_DEF bool apng_png_header_signature_correct(struct Apng_PNG_Header h)
  */
 APNG_DEF enum Apng_Return_Types apng_png_load(char *file_name, struct Apng_PNG_Image *image, bool print_info)
 {
-    struct Apng_Byte_String file = apng_bin_file_read(file_name);
-    if (file.name == NULL) {
-        apng_dprintERROR("Failed to open file at '%s'.", file_name);
-        return APNG_FAIL;
-    }
-    if (APNG_FAIL == apng_png_decode(file, image, print_info)) {
+    struct Apng_Decode_Options options = {0};
+    options.print_info = print_info;
+
+    return apng_png_load_with_options(file_name, image, options);
+}
+
+/**
+ * @brief Load and decode a PNG image from disk with explicit decode options.
+ *
+ * Same as apng_png_load(), see apng_png_decode_with_options() for the
+ * options.
+ *
+ * @param file_name Path to the PNG file on disk.
+ * @param image Output image structure that receives the decoded result.
+ * @param options Decode options.
+ * @return APNG_SUCCESS on successful decode, otherwise APNG_FAIL.
+ * @note The caller must later call apng_png_free() on image.
+ */
+APNG_DEF enum Apng_Return_Types apng_png_load_with_options(char *file_name, struct Apng_PNG_Image *image, struct Apng_Decode_Options options)
+{
+    struct Apng_Byte_String file = apng_bin_file_read(file_name);
+    if (file.name == NULL) {
+        apng_dprintERROR("Failed to open file at '%s'.", file_name);
+        return APNG_FAIL;
+    }
+    if (APNG_FAIL == apng_png_decode_with_options(file, image, options)) {
         apng_dprintERROR("Failed to load png image '%s'.", file_name);
         return APNG_FAIL;
     }
@@ -1824,6 +2643,157 @@ APNG_DEF struct Apng_PNG_Header apng_png_header_get(struct Apng_Byte_String *bs)
     return header;
 }
 
+/**
+ * @brief Load a PNG from disk straight into a thumbnail.
+ *
+ * Convenience wrapper around apng_png_load_with_options() with
+ * thumbnail_max_rows / thumbnail_max_cols set. image->pixels receives the
+ * thumbnail, the full-resolution pixel buffer is never allocated.
+ *
+ * @param file_name Path to the PNG file on disk.
+ * @param image Output image structure.
+ * @param max_rows Maximum thumbnail rows, 0 for no limit.
+ * @param max_cols Maximum thumbnail columns, 0 for no limit.
+ * @return APNG_SUCCESS on success, otherwise APNG_FAIL.
+ * @note The caller must later call apng_png_free() on image.
+ */
+APNG_DEF enum Apng_Return_Types apng_png_thumbnail_load(char *file_name, struct Apng_PNG_Image *image, size_t max_rows, size_t max_cols)
+{
+    struct Apng_Decode_Options options = {0};
+    options.thumbnail_max_rows = max_rows;
+    options.thumbnail_max_cols = max_cols;
+
+    return apng_png_load_with_options(file_name, image, options);
+}
+
+/**
+ * @brief Query the CPU for the highest instruction-set level the row kernels
+ *        can use.
+ *
+ * AVX2 is only reported when the operating system also saves the YMM
+ * registers. When the SIMD kernels are compiled out (APNG_NO_SIMD or a non-x86
+ * target) this always returns APNG_SIMD_NONE.
+ *
+ * @return Highest supported Apng_Simd_Level.
+ */
+APNG_DEF enum Apng_Simd_Level apng_simd_level_detect(void)
+{
+#if APNG_SIMD_X86
+    #if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+    __cpuid(info, 1);
+    bool sse2    = (info[3] & (1 << 26)) != 0;
+    bool ssse3   = (info[2] & (1 << 9))  != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx     = (info[2] & (1 << 28)) != 0;
+    bool avx2    = false;
+    if (max_leaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+    #else
+    __builtin_cpu_init();
+    bool sse2  = __builtin_cpu_supports("sse2");
+    bool ssse3 = __builtin_cpu_supports("ssse3");
+    bool avx2  = __builtin_cpu_supports("avx2");
+    #endif
+
+    if (avx2 && ssse3) return APNG_SIMD_AVX2;
+    if (ssse3)         return APNG_SIMD_SSSE3;
+    if (sse2)          return APNG_SIMD_SSE2;
+#endif
+    return APNG_SIMD_NONE;
+}
+
+/**
+ * @brief Return the cached result of apng_simd_level_detect().
+ *
+ * The CPU is queried on the first call only. Concurrent first calls may both
+ * query the CPU, but they store the same value.
+ *
+ * @return Highest supported Apng_Simd_Level.
+ */
+APNG_DEF enum Apng_Simd_Level apng_simd_level_get(void)
+{
+    static int cached_level = -1;
+    if (cached_level < 0) {
+        cached_level = (int)apng_simd_level_detect();
+    }
+    return (enum Apng_Simd_Level)cached_level;
+}
+
+/**
+ * @brief Return a human-readable name for an Apng_Simd_Level value.
+ * @param level SIMD level.
+ * @return String representation of the level.
+ */
+APNG_DEF const char * apng_simd_level_name_get(enum Apng_Simd_Level level)
+{
+    switch (level) {
+        case APNG_SIMD_NONE:  return "scalar";
+        case APNG_SIMD_SSE2:  return "SSE2";
+        case APNG_SIMD_SSSE3: return "SSSE3";
+        case APNG_SIMD_AVX2:  return "AVX2";
+        default:              return "unknown";
+    }
+}
+
+/**
+ * @brief Compute the size of a thumbnail that fits in a bounding box.
+ *
+ * Keeps the aspect ratio of the source and never upscales: the result is the
+ * largest size no bigger than max_rows x max_cols and no bigger than the
+ * source, with at least one row and one column.
+ *
+ * @param width Source width in pixels.
+ * @param height Source height in pixels.
+ * @param max_rows Maximum thumbnail rows, 0 for no limit.
+ * @param max_cols Maximum thumbnail columns, 0 for no limit.
+ * @param rows Output thumbnail rows.
+ * @param cols Output thumbnail columns.
+ */
+APNG_DEF void apng_thumbnail_size_get(size_t width, size_t height, size_t max_rows, size_t max_cols, size_t *rows, size_t *cols)
+{
+    double scale = 1.0;
+    if (max_cols != 0 && (double)max_cols / (double)width < scale) {
+        scale = (double)max_cols / (double)width;
+    }
+    if (max_rows != 0 && (double)max_rows / (double)height < scale) {
+        scale = (double)max_rows / (double)height;
+    }
+
+    *cols = (size_t)((double)width * scale + 0.5);
+    *rows = (size_t)((double)height * scale + 0.5);
+    if (max_cols != 0 && *cols > max_cols) *cols = max_cols;
+    if (max_rows != 0 && *rows > max_rows) *rows = max_rows;
+    if (*cols < 1) *cols = 1;
+    if (*rows < 1) *rows = 1;
+}
+
+/**
+ * @brief Read a monotonic-enough wall clock for timing decode stages.
+ * @return Current time in seconds. Only differences between calls are
+ *         meaningful.
+ */
+APNG_DEF double apng_timer_now_sec(void)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    static LARGE_INTEGER frequency = {0};
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
 /**
  * @brief Print the lowest bit_count bits of a uint16_t in binary.
  * @param value Value to print.
@@ -1980,6 +2950,347 @@ APNG_DEF const char * apng_type_name_get(enum Apng_Chunk_Type type)
     }
 }
 
+/* Scalar row kernels. They are forced inline and always called with a
+ * literal bytes_in_pixel, so every pixel size gets its own specialized loop. */
+
+APNG_FORCE_INLINE uint8_t apng_paeth_predictor(int a, int b, int c)
+{
+    int p = a + b - c;
+    int pa = p - a;
+    if (pa < 0) pa = -pa;
+    int pb = p - b;
+    if (pb < 0) pb = -pb;
+    int pc = p - c;
+    if (pc < 0) pc = -pc;
+
+    if ((pa <= pb) && (pa <= pc)) return (uint8_t)a;
+    if (pb <= pc) return (uint8_t)b;
+    return (uint8_t)c;
+}
+
+APNG_FORCE_INLINE void apng_unfilter_sub_scalar(uint8_t *row, const uint8_t *src, size_t n, size_t bpp)
+{
+    size_t x = 0;
+    for (; x < bpp && x < n; x++) {
+        row[x] = src[x];
+    }
+    for (; x < n; x++) {
+        row[x] = (uint8_t)(src[x] + row[x - bpp]);
+    }
+}
+
+APNG_FORCE_INLINE void apng_unfilter_up_scalar(uint8_t *row, const uint8_t *src, const uint8_t *above, size_t n)
+{
+    for (size_t x = 0; x < n; x++) {
+        row[x] = (uint8_t)(src[x] + above[x]);
+    }
+}
+
+APNG_FORCE_INLINE void apng_unfilter_average_scalar(uint8_t *row, const uint8_t *src, const uint8_t *above, size_t n, size_t bpp)
+{
+    size_t x = 0;
+    if (above == NULL) {
+        for (; x < bpp && x < n; x++) {
+            row[x] = src[x];
+        }
+        for (; x < n; x++) {
+            row[x] = (uint8_t)(src[x] + (row[x - bpp] >> 1));
+        }
+        return;
+    }
+    for (; x < bpp && x < n; x++) {
+        row[x] = (uint8_t)(src[x] + (above[x] >> 1));
+    }
+    for (; x < n; x++) {
+        row[x] = (uint8_t)(src[x] + (((uint32_t)row[x - bpp] + (uint32_t)above[x]) >> 1));
+    }
+}
+
+APNG_FORCE_INLINE void apng_unfilter_paeth_scalar(uint8_t *row, const uint8_t *src, const uint8_t *above, size_t n, size_t bpp)
+{
+    size_t x = 0;
+    for (; x < bpp && x < n; x++) {
+        row[x] = (uint8_t)(src[x] + above[x]);
+    }
+    for (; x < n; x++) {
+        row[x] = (uint8_t)(src[x] + apng_paeth_predictor(row[x - bpp], above[x], above[x - bpp]));
+    }
+}
+
+#if APNG_SIMD_X86
+/* SIMD row kernels. Sub, Average and Paeth depend on the pixel to the left, so
+ * they process one whole pixel (3, 4, 6 or 8 bytes) per step; Up has no such
+ * dependency and runs a full register per step. */
+
+APNG_FORCE_INLINE APNG_TARGET("sse2") __m128i apng_pixel_load_sse2(const uint8_t *p, size_t bpp)
+{
+    /* Partial pixels are assembled in general-purpose registers; a memcpy of
+     * 3 or 6 bytes goes through the stack and stalls on store forwarding. */
+    uint32_t lo;
+    switch (bpp) {
+        case 3:
+            lo = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+            return _mm_cvtsi32_si128((int)lo);
+        case 4:
+            memcpy(&lo, p, 4);
+            return _mm_cvtsi32_si128((int)lo);
+        case 6:
+        {
+            memcpy(&lo, p, 4);
+            uint32_t hi = (uint32_t)p[4] | ((uint32_t)p[5] << 8);
+            return _mm_unpacklo_epi32(_mm_cvtsi32_si128((int)lo), _mm_cvtsi32_si128((int)hi));
+        }
+        default:
+            return _mm_loadl_epi64((const __m128i *)p);
+    }
+}
+
+APNG_FORCE_INLINE APNG_TARGET("sse2") void apng_pixel_store_sse2(uint8_t *p, __m128i v, size_t bpp)
+{
+    uint32_t lo = (uint32_t)_mm_cvtsi128_si32(v);
+    switch (bpp) {
+        case 3:
+            p[0] = (uint8_t)lo;
+            p[1] = (uint8_t)(lo >> 8);
+            p[2] = (uint8_t)(lo >> 16);
+            break;
+        case 4:
+            memcpy(p, &lo, 4);
+            break;
+        case 6:
+        {
+            uint32_t hi = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(v, 4));
+            memcpy(p, &lo, 4);
+            p[4] = (uint8_t)hi;
+            p[5] = (uint8_t)(hi >> 8);
+        } break;
+        default:
+            _mm_storel_epi64((__m128i *)p, v);
+            break;
+    }
+}
+
+APNG_FORCE_INLINE APNG_TARGET("sse2") void apng_unfilter_sub_sse2(uint8_t *row, const uint8_t *src, size_t n, size_t bpp)
+{
+    __m128i a = _mm_setzero_si128();
+    for (size_t x = 0; x < n; x += bpp) {
+        a = _mm_add_epi8(a, apng_pixel_load_sse2(src + x, bpp));
+        apng_pixel_store_sse2(row + x, a, bpp);
+    }
+}
+
+APNG_FORCE_INLINE APNG_TARGET("sse2") void apng_unfilter_average_sse2(uint8_t *row, const uint8_t *src, const uint8_t *above, size_t n, size_t bpp)
+{
+    const __m128i ones = _mm_set1_epi8(1);
+    __m128i a = _mm_setzero_si128();
+    for (size_t x = 0; x < n; x += bpp) {
+        __m128i b = apng_pixel_load_sse2(above + x, bpp);
+        /* _mm_avg_epu8 rounds up, PNG rounds down */
+        __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), ones));
+        a = _mm_add_epi8(apng_pixel_load_sse2(src + x, bpp), avg);
+        apng_pixel_store_sse2(row + x, a, bpp);
+    }
+}
+
+APNG_FORCE_INLINE APNG_TARGET("sse2") __m128i apng_select_sse2(__m128i mask, __m128i if_true, __m128i if_false)
+{
+    return _mm_or_si128(_mm_and_si128(mask, if_true), _mm_andnot_si128(mask, if_false));
+}
+
+APNG_FORCE_INLINE APNG_TARGET("sse2") void apng_unfilter_paeth_sse2(uint8_t *row, const uint8_t *src, const uint8_t *above, size_t n, size_t bpp)
+{
+    /* The predictor works on 16-bit lanes: pa = |b - c|, pb = |a - c| and
+     * pc = |a + b - 2c| are the same distances as in the specification. */
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a = zero;
+    __m128i c = zero;
+    for (size_t x = 0; x < n; x += bpp) {
+        __m128i b = _mm_unpacklo_epi8(apng_pixel_load_sse2(above + x, bpp), zero);
+        __m128i d = _mm_unpacklo_epi8(apng_pixel_load_sse2(src + x, bpp), zero);
+
+        __m128i pa = _mm_sub_epi16(b, c);
+        __m128i pb = _mm_sub_epi16(a, c);
+        __m128i pc = _mm_add_epi16(pa, pb);
+        pa = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+        pb = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+        pc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+
+        __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+        __m128i nearest = apng_select_sse2(_mm_cmpeq_epi16(smallest, pa), a,
+                          apng_select_sse2(_mm_cmpeq_epi16(smallest, pb), b, c));
+
+        a = _mm_add_epi8(d, nearest);
+        apng_pixel_store_sse2(row + x, _mm_packus_epi16(a, a), bpp);
+        c = b;
+    }
+}
+
+APNG_FORCE_INLINE APNG_TARGET("ssse3") void apng_unfilter_paeth_ssse3(uint8_t *row, const uint8_t *src, const uint8_t *above, size_t n, size_t bpp)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a = zero;
+    __m128i c = zero;
+    for (size_t x = 0; x < n; x += bpp) {
+        __m128i b = _mm_unpacklo_epi8(apng_pixel_load_sse2(above + x, bpp), zero);
+        __m128i d = _mm_unpacklo_epi8(apng_pixel_load_sse2(src + x, bpp), zero);
+
+        __m128i pa = _mm_sub_epi16(b, c);
+        __m128i pb = _mm_sub_epi16(a, c);
+        __m128i pc = _mm_abs_epi16(_mm_add_epi16(pa, pb));
+        pa = _mm_abs_epi16(pa);
+        pb = _mm_abs_epi16(pb);
+
+        __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+        __m128i nearest = apng_select_sse2(_mm_cmpeq_epi16(smallest, pa), a,
+                          apng_select_sse2(_mm_cmpeq_epi16(smallest, pb), b, c));
+
+        a = _mm_add_epi8(d, nearest);
+        apng_pixel_store_sse2(row + x, _mm_packus_epi16(a, a), bpp);
+        c = b;
+    }
+}
+
+static APNG_TARGET("sse2") void apng_unfilter_up_sse2(uint8_t *row, const uint8_t *src, const uint8_t *above, size_t n)
+{
+    size_t x = 0;
+    for (; x + 16 <= n; x += 16) {
+        __m128i s = _mm_loadu_si128((const __m128i *)(src + x));
+        __m128i b = _mm_loadu_si128((const __m128i *)(above + x));
+        _mm_storeu_si128((__m128i *)(row + x), _mm_add_epi8(s, b));
+    }
+    apng_unfilter_up_scalar(row + x, src + x, above + x, n - x);
+}
+
+static APNG_TARGET("avx2") void apng_unfilter_up_avx2(uint8_t *row, const uint8_t *src, const uint8_t *above, size_t n)
+{
+    size_t x = 0;
+    for (; x + 32 <= n; x += 32) {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(src + x));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(above + x));
+        _mm256_storeu_si256((__m256i *)(row + x), _mm256_add_epi8(s, b));
+    }
+    apng_unfilter_up_scalar(row + x, src + x, above + x, n - x);
+}
+
+static APNG_TARGET("sse2") void apng_unfilter_pixel_filter_sse2(uint8_t *row, const uint8_t *src, const uint8_t *above, size_t n, size_t bpp, uint8_t filter)
+{
+    switch (bpp) {
+        case 3: if (filter == 1) apng_unfilter_sub_sse2(row, src, n, 3); else if (filter == 3) apng_unfilter_average_sse2(row, src, above, n, 3); else apng_unfilter_paeth_sse2(row, src, above, n, 3); break;
+        case 4: if (filter == 1) apng_unfilter_sub_sse2(row, src, n, 4); else if (filter == 3) apng_unfilter_average_sse2(row, src, above, n, 4); else apng_unfilter_paeth_sse2(row, src, above, n, 4); break;
+        case 6: if (filter == 1) apng_unfilter_sub_sse2(row, src, n, 6); else if (filter == 3) apng_unfilter_average_sse2(row, src, above, n, 6); else apng_unfilter_paeth_sse2(row, src, above, n, 6); break;
+        case 8: if (filter == 1) apng_unfilter_sub_sse2(row, src, n, 8); else if (filter == 3) apng_unfilter_average_sse2(row, src, above, n, 8); else apng_unfilter_paeth_sse2(row, src, above, n, 8); break;
+    }
+}
+
+static APNG_TARGET("ssse3") void apng_unfilter_paeth_dispatch_ssse3(uint8_t *row, const uint8_t *src, const uint8_t *above, size_t n, size_t bpp)
+{
+    switch (bpp) {
+        case 3: apng_unfilter_paeth_ssse3(row, src, above, n, 3); break;
+        case 4: apng_unfilter_paeth_ssse3(row, src, above, n, 4); break;
+        case 6: apng_unfilter_paeth_ssse3(row, src, above, n, 6); break;
+        case 8: apng_unfilter_paeth_ssse3(row, src, above, n, 8); break;
+    }
+}
+#endif /* APNG_SIMD_X86 */
+
+/**
+ * @brief Reverse the PNG filter of a single scanline.
+ *
+ * This is the per-row worker of apng_IDAT_unfiltering(). It picks a kernel by
+ * filter type, bytes per pixel and the requested instruction-set level:
+ * - Up runs 16 (SSE2) or 32 (AVX2) bytes per step.
+ * - Sub, Average and Paeth run one pixel per SSE2 register for 3, 4, 6 and 8
+ *   bytes per pixel; SSSE3 and above use a shorter Paeth kernel.
+ * - Everything else, including 1 and 2 bytes per pixel where a register would
+ *   hold a single sample, uses scalar loops specialized per pixel size.
+ *
+ * The first row of an image has no row above. PNG treats the missing row as
+ * zeros, so Up degenerates to None and Paeth to Sub.
+ *
+ * @param current_row Output row of width_in_bytes bytes.
+ * @param src Filtered row bytes, without the leading filter-type byte.
+ * @param row_above Previously reconstructed row, or NULL for the first row.
+ * @param width_in_bytes Number of bytes in the row.
+ * @param bytes_in_pixel Filter distance in bytes (at least 1).
+ * @param filter PNG filter type (0-4).
+ * @param level Highest instruction-set level the kernels may use. Pass
+ *              apng_simd_level_get() for the best level of this CPU.
+ * @return APNG_SUCCESS on success, APNG_FAIL on an unknown filter type.
+ */
+APNG_DEF enum Apng_Return_Types apng_unfilter_row(uint8_t *current_row, const uint8_t *src, const uint8_t *row_above, size_t width_in_bytes, size_t bytes_in_pixel, uint8_t filter, enum Apng_Simd_Level level)
+{
+    if (row_above == NULL) {
+        if (filter == 2) filter = 0;
+        if (filter == 4) filter = 1;
+    }
+    APNG_UNUSED(level);
+
+    switch (filter) {
+    case 0:
+    {
+        memcpy(current_row, src, width_in_bytes);
+    } break;
+    case 2:
+    {
+        #if APNG_SIMD_X86
+        if (level >= APNG_SIMD_AVX2) {
+            apng_unfilter_up_avx2(current_row, src, row_above, width_in_bytes);
+            break;
+        }
+        if (level >= APNG_SIMD_SSE2) {
+            apng_unfilter_up_sse2(current_row, src, row_above, width_in_bytes);
+            break;
+        }
+        #endif
+        apng_unfilter_up_scalar(current_row, src, row_above, width_in_bytes);
+    } break;
+    case 1:
+    case 3:
+    case 4:
+    {
+        #if APNG_SIMD_X86
+        bool simd_bpp = (bytes_in_pixel == 3 || bytes_in_pixel == 4 || bytes_in_pixel == 6 || bytes_in_pixel == 8) &&
+                        width_in_bytes % bytes_in_pixel == 0;
+        if (simd_bpp && row_above != NULL && level >= APNG_SIMD_SSSE3 && filter == 4) {
+            apng_unfilter_paeth_dispatch_ssse3(current_row, src, row_above, width_in_bytes, bytes_in_pixel);
+            break;
+        }
+        if (simd_bpp && (row_above != NULL || filter == 1) && level >= APNG_SIMD_SSE2) {
+            apng_unfilter_pixel_filter_sse2(current_row, src, row_above, width_in_bytes, bytes_in_pixel, filter);
+            break;
+        }
+        #endif
+        switch (bytes_in_pixel) {
+            #define APNG_UNFILTER_SCALAR_CASE(bpp)                                                                          \
+            case bpp:                                                                                                       \
+                if (filter == 1)      apng_unfilter_sub_scalar(current_row, src, width_in_bytes, bpp);                      \
+                else if (filter == 3) apng_unfilter_average_scalar(current_row, src, row_above, width_in_bytes, bpp);       \
+                else                  apng_unfilter_paeth_scalar(current_row, src, row_above, width_in_bytes, bpp);         \
+                break;
+            APNG_UNFILTER_SCALAR_CASE(1)
+            APNG_UNFILTER_SCALAR_CASE(2)
+            APNG_UNFILTER_SCALAR_CASE(3)
+            APNG_UNFILTER_SCALAR_CASE(4)
+            APNG_UNFILTER_SCALAR_CASE(6)
+            APNG_UNFILTER_SCALAR_CASE(8)
+            #undef APNG_UNFILTER_SCALAR_CASE
+            default:
+                if (filter == 1)      apng_unfilter_sub_scalar(current_row, src, width_in_bytes, bytes_in_pixel);
+                else if (filter == 3) apng_unfilter_average_scalar(current_row, src, row_above, width_in_bytes, bytes_in_pixel);
+                else                  apng_unfilter_paeth_scalar(current_row, src, row_above, width_in_bytes, bytes_in_pixel);
+                break;
+        }
+    } break;
+    default:
+    {
+        apng_dprintERROR("Unknown row filter :%d", filter);
+        return APNG_FAIL;
+    }
+    }
+
+    return APNG_SUCCESS;
+}
+
 /**
  * @brief Parse and validate the contents of an IHDR chunk.
  * @param chunk IHDR chunk to parse.
@@ -2097,6 +3408,9 @@ APNG_DEF enum Apng_Return_Types apng_IDAT_chunk_parse(struct Apng_IDAT_Chunk *ch
  * filtering, and converts the resulting raw sample data into packed 32-bit ARGB
  * pixels.
  *
+ * When image->options asks for a thumbnail, the inflated stream is handed to
+ * apng_IDAT_thumbnail_build() instead and only the thumbnail is allocated.
+ *
  * It is called by apng_png_decode() once IHDR has been parsed and all IDAT
  * payload bytes have been collected.
  *
@@ -2110,16 +3424,27 @@ APNG_DEF enum Apng_Return_Types apng_IDAT_decode(struct Apng_PNG_Image *image)
 {
     size_t width = image->chunks.IHDR_chunk.width;
     size_t height = image->chunks.IHDR_chunk.height;
-    image->pixels = apng_pixel_buffer_malloc(height, width);
 
     enum Apng_Return_Types rt = APNG_SUCCESS;
 
-    struct Apng_Byte_String decompress_bs = {0};
-    ada_init_array(uint8_t, decompress_bs);
-    struct Apng_Byte_String unfiltered_bs = {0};
-    ada_init_array(uint8_t, unfiltered_bs);
-
+    struct Apng_Decode_Scratch local_scratch = {0};
+    struct Apng_Decode_Scratch *scratch = image->options.scratch ? image->options.scratch : &local_scratch;
+    if (scratch->inflated.elements == NULL) {
+        ada_init_array(uint8_t, scratch->inflated);
+    }
+    if (scratch->unfiltered.elements == NULL) {
+        ada_init_array(uint8_t, scratch->unfiltered);
+    }
+    scratch->inflated.length = 0;
+    scratch->inflated.cursor = 0;
+    scratch->unfiltered.length = 0;
+    scratch->unfiltered.cursor = 0;
+    struct Apng_Byte_String decompress_bs = scratch->inflated;
+    struct Apng_Byte_String unfiltered_bs = scratch->unfiltered;
+
+    double stage_start = apng_timer_now_sec();
     rt = apng_IDAT_decompress(image, &decompress_bs);
+    image->stats.inflate_seconds = apng_timer_now_sec() - stage_start;
     if (rt == APNG_FAIL) {
         apng_dprintERROR("%s", "Failed to decompress the IDAT chunks.");
         goto apng_IDAT_decode_end;
@@ -2135,87 +3460,50 @@ APNG_DEF enum Apng_Return_Types apng_IDAT_decode(struct Apng_PNG_Image *image)
         rt = APNG_FAIL;
         goto apng_IDAT_decode_end;
     }
-    /* allocate enough bytes in unfiltered_bs */
-    for (size_t i = 0; i < decompress_bs.length; i++) {
-        ada_appand(uint8_t, unfiltered_bs, decompress_bs.elements[i]);
+    if (image->options.thumbnail_max_rows != 0 || image->options.thumbnail_max_cols != 0) {
+        stage_start = apng_timer_now_sec();
+        rt = apng_IDAT_thumbnail_build(image, decompress_bs.elements);
+        image->stats.unfilter_seconds = 0;
+        image->stats.convert_seconds = apng_timer_now_sec() - stage_start;
+        goto apng_IDAT_decode_end;
     }
-    /* set bytes per pixel according to the color type in IHDR */
-    size_t num_of_channels = 4;
-    size_t bit_per_channel = image->chunks.IHDR_chunk.bit_depth;
-    if (image->chunks.IHDR_chunk.color_type == 6) {
-        num_of_channels = 4;
-    } else if (image->chunks.IHDR_chunk.color_type == 2) {
-        num_of_channels = 3;
-    } else if (image->chunks.IHDR_chunk.color_type == 0) {
-        num_of_channels = 1;
-    } else if (image->chunks.IHDR_chunk.color_type == 4) {
-        num_of_channels = 2;
+    image->pixels = apng_pixel_buffer_malloc(height, width);
+
+    /* allocate enough bytes in unfiltered_bs, every byte is overwritten by the
+     * unfiltering */
+    if (unfiltered_bs.capacity < decompress_bs.length) {
+        ada_resize(uint8_t, unfiltered_bs, decompress_bs.length);
     }
-    size_t bytes_per_pixel = ((bit_per_channel + 7) / 8) * num_of_channels;
+    unfiltered_bs.length = decompress_bs.length;
+    size_t bit_per_channel = image->chunks.IHDR_chunk.bit_depth;
+    size_t num_of_channels = bits_per_pixel / bit_per_channel;
 
-    #if 1
-    rt = apng_IDAT_unfiltering(unfiltered_bs.elements, decompress_bs.elements, width, height, num_of_channels, bit_per_channel); 
+    stage_start = apng_timer_now_sec();
+    rt = apng_IDAT_unfiltering(unfiltered_bs.elements, decompress_bs.elements, width, height, num_of_channels, bit_per_channel);
+    image->stats.unfilter_seconds = apng_timer_now_sec() - stage_start;
     if (rt == APNG_FAIL) {
         apng_dprintERROR("%s", "Failed to decompress the IDAT chunks.");
         goto apng_IDAT_decode_end;
     }
-    #endif
 
     /* swizzle and copy the color channels */
+    stage_start = apng_timer_now_sec();
     for (size_t i = 0; i < image->pixels.rows; i++) {
-        for (size_t j = 0; j < image->pixels.cols; j++) {
-            if (image->chunks.IHDR_chunk.color_type == 6) {
-                size_t idx = i * bytes_per_row + j * bytes_per_pixel;
-                uint8_t r = unfiltered_bs.elements[idx + 0];
-                uint8_t g = unfiltered_bs.elements[idx + 1];
-                uint8_t b = unfiltered_bs.elements[idx + 2];
-                uint8_t a = unfiltered_bs.elements[idx + 3];
-                APNG_PIXEL_BUFFER_AT(image->pixels, i, j) = APNG_RGBA_TO_hexARGB(r, g, b, a);
-            } else if (image->chunks.IHDR_chunk.color_type == 4) {
-                size_t idx = i * bytes_per_row + j * bytes_per_pixel;
-                uint8_t value = unfiltered_bs.elements[idx + 0];
-                uint8_t a = unfiltered_bs.elements[idx + 1];
-                APNG_PIXEL_BUFFER_AT(image->pixels, i, j) = APNG_RGBA_TO_hexARGB(value, value, value, a);
-            } else if (image->chunks.IHDR_chunk.color_type == 2) {
-                size_t idx = i * bytes_per_row + j * bytes_per_pixel;
-                uint8_t r = unfiltered_bs.elements[idx + 0];
-                uint8_t g = unfiltered_bs.elements[idx + 1];
-                uint8_t b = unfiltered_bs.elements[idx + 2];
-                APNG_PIXEL_BUFFER_AT(image->pixels, i, j) = APNG_RGBA_TO_hexARGB(r, g, b, 255);
-            } else if (image->chunks.IHDR_chunk.color_type == 0) {
-                uint8_t *row = &unfiltered_bs.elements[i * bytes_per_row];
-                if (bit_per_channel == 1) {
-                    uint8_t packed = row[j / 8];
-                    uint8_t bit_index = (uint8_t)(7 - (j % 8));
-                    uint8_t sample = (packed >> bit_index) & 0x01;
-                    uint8_t value = sample ? 255 : 0;
-                    APNG_PIXEL_BUFFER_AT(image->pixels, i, j) = APNG_RGBA_TO_hexARGB(value, value, value, 255);
-                } else if (bit_per_channel == 2) {
-                    uint8_t packed = row[j / 4];
-                    uint8_t bit_index = (uint8_t)(6 - 2 * (j % 4));
-                    uint8_t sample = (packed >> bit_index) & 0x03;
-                    uint8_t value = (uint8_t)((sample * 255) / 3);
-                    APNG_PIXEL_BUFFER_AT(image->pixels, i, j) = APNG_RGBA_TO_hexARGB(value, value, value, 255);
-                } else if (bit_per_channel == 4) {
-                    uint8_t packed = row[j / 2];
-                    uint8_t sample = (j % 2) ? (packed & 0x0F) : (packed >> 4);
-                    uint8_t value = (uint8_t)((sample * 255) / 15);
-                    APNG_PIXEL_BUFFER_AT(image->pixels, i, j) = APNG_RGBA_TO_hexARGB(value, value, value, 255);
-                } else if (bit_per_channel == 8) {
-                    uint8_t value = row[j];
-                    APNG_PIXEL_BUFFER_AT(image->pixels, i, j) = APNG_RGBA_TO_hexARGB(value, value, value, 255);
-                } else {
-                    apng_dprintERROR("Unsupported grayscale bit depth: %zu", bit_per_channel);
-                    rt = APNG_FAIL;
-                    goto apng_IDAT_decode_end;
-                }
-            }
+        rt = apng_IDAT_scanline_convert(&APNG_PIXEL_BUFFER_AT(image->pixels, i, 0), &unfiltered_bs.elements[i * bytes_per_row],
+                                        width, image->chunks.IHDR_chunk.color_type, bit_per_channel);
+        if (rt == APNG_FAIL) {
+            goto apng_IDAT_decode_end;
         }
     }
+    image->stats.convert_seconds = apng_timer_now_sec() - stage_start;
 
 apng_IDAT_decode_end:
-    apng_byte_string_free(&decompress_bs);
-    apng_byte_string_free(&unfiltered_bs);
+    /* hand the possibly grown buffers back */
+    scratch->inflated = decompress_bs;
+    scratch->unfiltered = unfiltered_bs;
+    if (scratch == &local_scratch) {
+        apng_decode_scratch_free(&local_scratch);
+    }
     return rt;
 }
 
@@ -2516,6 +3804,9 @@ APNG_DEF enum Apng_Return_Types apng_IDAT_decompress(struct Apng_PNG_Image *imag
     }
     uint32_t *original_adler32_ptr = (uint32_t *)apng_consume_bytes(&br->file, 4);
     uint32_t original_adler32 = apng_endian_swap_uint32(*original_adler32_ptr);
+    if (image->options.adler32_policy != APNG_CHECKSUM_VERIFY) {
+        goto apng_IDAT_decompress_end;
+    }
     rt = apng_adler32_check(original_adler32, temp_bs->elements, temp_bs->length);
     if (rt == APNG_FAIL) {
         apng_dprintERROR("%s", "Failed to decompress the data correctly, adler32 error.");
@@ -2527,6 +3818,193 @@ apng_IDAT_decompress_end:
     return rt;
 }
 
+/**
+ * @brief Convert one unfiltered scanline into packed 0xAARRGGBB pixels.
+ *
+ * Used per row by apng_IDAT_decode() and apng_IDAT_thumbnail_build().
+ *
+ * @param pixels_row Output row with room for width pixels.
+ * @param unfiltered_row Reconstructed scanline bytes (no filter byte).
+ * @param width Number of pixels in the row.
+ * @param color_type PNG color type from IHDR.
+ * @param bit_per_channel Bit depth from IHDR.
+ * @return APNG_SUCCESS on success, APNG_FAIL on an unsupported grayscale bit
+ *         depth.
+ */
+APNG_DEF enum Apng_Return_Types apng_IDAT_scanline_convert(uint32_t *pixels_row, const uint8_t *unfiltered_row, size_t width, uint8_t color_type, size_t bit_per_channel)
+{
+    size_t num_of_channels = (color_type == 0) ? 1 :
+                             (color_type == 2) ? 3 :
+                             (color_type == 4) ? 2 : 4;
+    size_t bytes_per_pixel = ((bit_per_channel + 7) / 8) * num_of_channels;
+    const uint8_t *row = unfiltered_row;
+
+    switch (color_type) {
+        case 6:
+        {
+            for (size_t j = 0; j < width; j++) {
+                const uint8_t *p = &row[j * bytes_per_pixel];
+                pixels_row[j] = APNG_RGBA_TO_hexARGB(p[0], p[1], p[2], p[3]);
+            }
+        } break;
+        case 4:
+        {
+            for (size_t j = 0; j < width; j++) {
+                const uint8_t *p = &row[j * bytes_per_pixel];
+                pixels_row[j] = APNG_RGBA_TO_hexARGB(p[0], p[0], p[0], p[1]);
+            }
+        } break;
+        case 2:
+        {
+            for (size_t j = 0; j < width; j++) {
+                const uint8_t *p = &row[j * bytes_per_pixel];
+                pixels_row[j] = APNG_RGBA_TO_hexARGB(p[0], p[1], p[2], 255);
+            }
+        } break;
+        case 0:
+        {
+            if (bit_per_channel == 1) {
+                for (size_t j = 0; j < width; j++) {
+                    uint8_t value = ((row[j / 8] >> (7 - (j % 8))) & 0x01) ? 255 : 0;
+                    pixels_row[j] = APNG_RGBA_TO_hexARGB(value, value, value, 255);
+                }
+            } else if (bit_per_channel == 2) {
+                for (size_t j = 0; j < width; j++) {
+                    uint8_t sample = (row[j / 4] >> (6 - 2 * (j % 4))) & 0x03;
+                    uint8_t value = (uint8_t)((sample * 255) / 3);
+                    pixels_row[j] = APNG_RGBA_TO_hexARGB(value, value, value, 255);
+                }
+            } else if (bit_per_channel == 4) {
+                for (size_t j = 0; j < width; j++) {
+                    uint8_t packed = row[j / 2];
+                    uint8_t sample = (j % 2) ? (packed & 0x0F) : (packed >> 4);
+                    uint8_t value = (uint8_t)((sample * 255) / 15);
+                    pixels_row[j] = APNG_RGBA_TO_hexARGB(value, value, value, 255);
+                }
+            } else if (bit_per_channel == 8) {
+                for (size_t j = 0; j < width; j++) {
+                    uint8_t value = row[j];
+                    pixels_row[j] = APNG_RGBA_TO_hexARGB(value, value, value, 255);
+                }
+            } else {
+                apng_dprintERROR("Unsupported grayscale bit depth: %zu", bit_per_channel);
+                return APNG_FAIL;
+            }
+        } break;
+        default:
+            break;
+    }
+
+    return APNG_SUCCESS;
+}
+
+/**
+ * @brief Reconstruct the IDAT stream directly into a downscaled image.
+ *
+ * Scanlines are unfiltered one at a time into two alternating row buffers,
+ * converted to ARGB and area-averaged into per-column sums, so neither the
+ * full unfiltered image nor the full-resolution pixel buffer is allocated.
+ * Every thumbnail pixel is the rounded mean of the source pixels in its box;
+ * boxes split the source rows and columns as evenly as integers allow.
+ *
+ * The thumbnail size comes from apng_thumbnail_size_get() with
+ * image->options.thumbnail_max_rows / thumbnail_max_cols.
+ *
+ * @param image Image with parsed IHDR. image->pixels receives the thumbnail.
+ * @param decompressed_data Inflated, still filtered scanline stream.
+ * @return APNG_SUCCESS on success, otherwise APNG_FAIL.
+ */
+APNG_DEF enum Apng_Return_Types apng_IDAT_thumbnail_build(struct Apng_PNG_Image *image, uint8_t *decompressed_data)
+{
+    size_t width = image->chunks.IHDR_chunk.width;
+    size_t height = image->chunks.IHDR_chunk.height;
+    uint8_t color_type = image->chunks.IHDR_chunk.color_type;
+    size_t bit_per_channel = image->chunks.IHDR_chunk.bit_depth;
+    size_t num_of_channels = (color_type == 0) ? 1 :
+                             (color_type == 2) ? 3 :
+                             (color_type == 4) ? 2 : 4;
+    size_t bits_per_pixel = num_of_channels * bit_per_channel;
+    size_t bytes_in_pixel = (bits_per_pixel + 7) / 8;
+    size_t width_in_bytes = (width * bits_per_pixel + 7) / 8;
+    enum Apng_Simd_Level level = apng_simd_level_get();
+    enum Apng_Return_Types rt = APNG_SUCCESS;
+
+    size_t rows = 0, cols = 0;
+    apng_thumbnail_size_get(width, height, image->options.thumbnail_max_rows, image->options.thumbnail_max_cols, &rows, &cols);
+    image->pixels = apng_pixel_buffer_malloc(rows, cols);
+
+    uint8_t *row_buffers = (uint8_t *)APNG_MALLOC(2 * width_in_bytes);
+    uint32_t *argb_row = (uint32_t *)APNG_MALLOC(sizeof(uint32_t) * width);
+    uint64_t *sums = (uint64_t *)APNG_MALLOC(sizeof(uint64_t) * 4 * cols);
+    size_t *col_start = (size_t *)APNG_MALLOC(sizeof(size_t) * (cols + 1));
+    APNG_ASSERT(row_buffers != NULL && argb_row != NULL && sums != NULL && col_start != NULL);
+    memset(argb_row, 0, sizeof(uint32_t) * width);
+    memset(sums, 0, sizeof(uint64_t) * 4 * cols);
+    for (size_t x = 0; x <= cols; x++) {
+        col_start[x] = x * width / cols;
+    }
+
+    const uint8_t *src = decompressed_data;
+    uint8_t *row_above = NULL;
+    size_t out_row = 0;
+    size_t out_row_end = height / rows;
+    size_t rows_in_box = 0;
+
+    for (size_t r = 0; r < height; r++) {
+        uint8_t filter = *src++;
+        uint8_t *current_row = row_buffers + (r & 1) * width_in_bytes;
+        rt = apng_unfilter_row(current_row, src, row_above, width_in_bytes, bytes_in_pixel, filter, level);
+        if (rt == APNG_FAIL) {
+            goto apng_IDAT_thumbnail_build_end;
+        }
+        src += width_in_bytes;
+        row_above = current_row;
+
+        rt = apng_IDAT_scanline_convert(argb_row, current_row, width, color_type, bit_per_channel);
+        if (rt == APNG_FAIL) {
+            goto apng_IDAT_thumbnail_build_end;
+        }
+
+        for (size_t x = 0; x < cols; x++) {
+            uint64_t a = 0, red = 0, g = 0, b = 0;
+            for (size_t j = col_start[x]; j < col_start[x + 1]; j++) {
+                uint32_t pixel = argb_row[j];
+                a   += (pixel >> 24) & 0xFF;
+                red += (pixel >> 16) & 0xFF;
+                g   += (pixel >> 8)  & 0xFF;
+                b   += (pixel >> 0)  & 0xFF;
+            }
+            sums[4 * x + 0] += a;
+            sums[4 * x + 1] += red;
+            sums[4 * x + 2] += g;
+            sums[4 * x + 3] += b;
+        }
+        rows_in_box++;
+
+        if (r + 1 == out_row_end) {
+            for (size_t x = 0; x < cols; x++) {
+                uint64_t count = rows_in_box * (col_start[x + 1] - col_start[x]);
+                uint8_t a   = (uint8_t)((sums[4 * x + 0] + count / 2) / count);
+                uint8_t red = (uint8_t)((sums[4 * x + 1] + count / 2) / count);
+                uint8_t g   = (uint8_t)((sums[4 * x + 2] + count / 2) / count);
+                uint8_t b   = (uint8_t)((sums[4 * x + 3] + count / 2) / count);
+                APNG_PIXEL_BUFFER_AT(image->pixels, out_row, x) = APNG_RGBA_TO_hexARGB(red, g, b, a);
+            }
+            memset(sums, 0, sizeof(uint64_t) * 4 * cols);
+            rows_in_box = 0;
+            out_row++;
+            out_row_end = (out_row + 1) * height / rows;
+        }
+    }
+
+apng_IDAT_thumbnail_build_end:
+    APNG_FREE(row_buffers);
+    APNG_FREE(argb_row);
+    APNG_FREE(sums);
+    APNG_FREE(col_start);
+    return rt;
+}
+
 /**
  * @brief Reverse PNG scanline filtering and reconstruct original row bytes.
  *
@@ -2540,6 +4018,9 @@ apng_IDAT_decompress_end:
  * The reconstructed bytes are then interpreted according to the color type and
  * bit depth from IHDR.
  *
+ * Each row is handed to apng_unfilter_row() with the best SIMD level of the
+ * running CPU (see apng_simd_level_get()).
+ *
  * @param unfiltered_data Output buffer that receives the reconstructed scanline
  *                        bytes without filter markers.
  * @param decompressed_data Input buffer containing the filtered scanline stream
@@ -2551,6 +4032,30 @@ apng_IDAT_decompress_end:
  * @return APNG_SUCCESS on success, otherwise APNG_FAIL.
  */
 APNG_DEF enum Apng_Return_Types apng_IDAT_unfiltering(uint8_t *unfiltered_data, uint8_t *decompressed_data, size_t width, size_t height, size_t num_of_channels, size_t bit_per_channel)
+{
+    return apng_IDAT_unfiltering_with_simd_level(unfiltered_data, decompressed_data, width, height, num_of_channels, bit_per_channel, apng_simd_level_get());
+}
+
+/**
+ * @brief Reverse PNG scanline filtering using kernels up to a given
+ *        instruction-set level.
+ *
+ * Same as apng_IDAT_unfiltering(), but the caller chooses the SIMD level
+ * instead of using the best one of the running CPU. Levels above what the CPU
+ * supports must not be requested. Every level produces identical output, so
+ * this is mainly useful to benchmark and cross-check the kernels.
+ *
+ * @param unfiltered_data Output buffer that receives the reconstructed scanline
+ *                        bytes without filter markers.
+ * @param decompressed_data Input buffer containing the filtered scanline stream.
+ * @param width Image width in pixels.
+ * @param height Image height in pixels.
+ * @param num_of_channels Number of channels per pixel.
+ * @param bit_per_channel Number of bits in each channel.
+ * @param level Highest instruction-set level the row kernels may use.
+ * @return APNG_SUCCESS on success, otherwise APNG_FAIL.
+ */
+APNG_DEF enum Apng_Return_Types apng_IDAT_unfiltering_with_simd_level(uint8_t *unfiltered_data, uint8_t *decompressed_data, size_t width, size_t height, size_t num_of_channels, size_t bit_per_channel, enum Apng_Simd_Level level)
 {
     uint8_t *src = decompressed_data;
     uint8_t *des = unfiltered_data;
@@ -2562,69 +4067,9 @@ APNG_DEF enum Apng_Return_Types apng_IDAT_unfiltering(uint8_t *unfiltered_data,
     for (size_t r = 0; r < height; r++) {
         uint8_t filter = *src++;
         uint8_t *current_row = des;
-        switch (filter) {
-        case 0:
-        {
-            for (size_t x = 0; x < width_in_bytes; x++) {
-                current_row[x] = src[x];
-            }
-        } break;
-        case 1:
-        {
-            for (size_t x = 0; x < width_in_bytes; x++) {
-                uint8_t a_byte = (x >= bytes_in_pixel) ? current_row[x - bytes_in_pixel] : 0 ;
-
-                current_row[x] = (uint8_t)src[x] + (uint8_t)a_byte;
-            }
-        } break;
-        case 2:
-        {
-            for (size_t x = 0; x < width_in_bytes; x++) {
-                uint8_t b_byte = row_above ? row_above[x] : 0;
-
-                current_row[x] = (uint8_t)src[x] + (uint8_t)b_byte;
-            }
-        } break;
-        case 3:
-        {
-            for (size_t x = 0; x < width_in_bytes; x++) {
-                uint8_t a_byte = (x >= bytes_in_pixel) ? current_row[x - bytes_in_pixel] : 0 ;
-                uint8_t b_byte = row_above ? row_above[x] : 0;
-
-                current_row[x] = (uint8_t)src[x] + (uint8_t)(((uint32_t)a_byte + (uint32_t)b_byte) / 2);
-            }
-        } break;
-        case 4:
-        {
-            for (size_t x = 0; x < width_in_bytes; x++) {
-                uint8_t a_byte = (x >= bytes_in_pixel) ? current_row[x - bytes_in_pixel] : 0 ;
-                uint8_t b_byte = row_above ? row_above[x] : 0;
-                uint8_t c_byte = (x >= bytes_in_pixel && row_above) ? row_above[x - bytes_in_pixel] : 0 ;
-
-                int p = (int)a_byte + (int)b_byte - (int)c_byte;
-                int pa = p - a_byte;
-                if (pa < 0) pa = -pa;
-                int pb = p - b_byte;
-                if (pb < 0) pb = -pb;
-                int pc = p - c_byte;
-                if (pc < 0) pc = -pc;
-
-                int paeth = (int)c_byte;
-                if ((pa <= pb) && (pa <= pc)) {
-                    paeth = (int)a_byte;
-                } else if (pb <= pc) {
-                    paeth = (int)b_byte;
-                }
-
-                current_row[x] = (uint8_t)src[x] + (uint8_t)paeth;
-            }
-        } break;
-        default: 
-        {
-            apng_dprintERROR("Unknown row filter :%d", filter);
+        if (APNG_FAIL == apng_unfilter_row(current_row, src, row_above, width_in_bytes, bytes_in_pixel, filter, level)) {
             return APNG_FAIL;
         }
-        }
         src += width_in_bytes;
         row_above = current_row;
         des += width_in_bytes;